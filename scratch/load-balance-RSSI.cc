@@ -93,6 +93,7 @@ main (int argc, char *argv[])
 	bool trace = true;
 	std::string errorModelType = "ns3::NistErrorRateModel";
 	double distance = 5;        //meters
+	bool linkAbstraction = false;
 	std::string outputFileName = "throughput";
 
 	// Configure command line parameters
@@ -102,6 +103,7 @@ main (int argc, char *argv[])
 	cmd.AddValue ("trace", "Enable datapath stats and pcap traces", trace);
 	cmd.AddValue ("errorModelType", "select ns3::NistErrorRateModel or ns3::YansErrorRateModel", errorModelType);
 	cmd.AddValue ("distance", "distance between nodes", distance);
+	cmd.AddValue ("linkAbstraction", "Compute the PER of the payloads from cached PER curves", linkAbstraction);
 	cmd.Parse (argc, argv);
 
 	if (verbose)
@@ -196,6 +198,7 @@ main (int argc, char *argv[])
 	spectrumPhy.Set ("TxPowerEnd", DoubleValue (100));
 	spectrumPhy.Set ("ShortGuardEnabled", BooleanValue (false));
 	spectrumPhy.Set ("ChannelWidth", UintegerValue (20));
+	spectrumPhy.Set ("LinkAbstraction", BooleanValue (linkAbstraction));
 
 	WifiHelper wifi;
 	//wifi.SetStandard (WIFI_PHY_STANDARD_80211ac);
@@ -27,6 +27,8 @@
 #include "log.h"
 
 #include <sstream>
+#include <limits>
+#include <map>
 
 /**
  * \file
@@ -105,11 +107,23 @@ MatchContainer::Connect (std::string name, const CallbackBase &cb)
 {
   NS_LOG_FUNCTION (this << name << &cb);
   NS_ASSERT (m_objects.size () == m_contexts.size ());
+  // the matched objects are mostly of the same type: look up the trace
+  // source once per type, rather than once per object
+  TypeId tid;
+  Ptr<const TraceSourceAccessor> accessor;
   for (uint32_t i = 0; i < m_objects.size (); ++i)
     {
       Ptr<Object> object = m_objects[i];
-      std::string ctx = m_contexts[i] + name;
-      object->TraceConnect (name, ctx, cb);
+      if (i == 0 || object->GetInstanceTypeId () != tid)
+        {
+          tid = object->GetInstanceTypeId ();
+          accessor = tid.LookupTraceSourceByName (name);
+        }
+      if (accessor != 0)
+        {
+          std::string ctx = m_contexts[i] + name;
+          accessor->Connect (PeekPointer (object), ctx, cb);
+        }
     }
 }
 void 
@@ -117,10 +131,20 @@ MatchContainer::ConnectWithoutContext (std::string name, const CallbackBase &cb)
 {
   NS_LOG_FUNCTION (this << name << &cb);
 
+  TypeId tid;
+  Ptr<const TraceSourceAccessor> accessor;
   for (Iterator tmp = Begin (); tmp != End (); ++tmp)
     {
       Ptr<Object> object = *tmp;
-      object->TraceConnectWithoutContext (name, cb);
+      if (tmp == Begin () || object->GetInstanceTypeId () != tid)
+        {
+          tid = object->GetInstanceTypeId ();
+          accessor = tid.LookupTraceSourceByName (name);
+        }
+      if (accessor != 0)
+        {
+          accessor->ConnectWithoutContext (PeekPointer (object), cb);
+        }
     }
 }
 void 
@@ -167,7 +191,20 @@ public:
    * \returns \c true if the index matches the Config Path.
    */
   bool Matches (std::size_t i) const;
+  /**
+   * Get the index matched by the Config Path, if it matches a single one.
+   *
+   * \param [out] i The index.
+   * \returns \c true if the Config Path matches a single index.
+   */
+  bool GetIndex (std::size_t *i) const;
 private:
+  /**
+   * Parse a Config path specification into ranges of indices.
+   *
+   * \param [in] element The Config path specification.
+   */
+  void Parse (std::string element);
   /**
    * Convert a string to an \c uint32_t.
    *
@@ -178,6 +215,8 @@ private:
   bool StringToUint32 (std::string str, uint32_t *value) const;
   /** The Config path element. */
   std::string m_element;
+  /** The ranges of the indices matching the element, bounds included. */
+  std::vector<std::pair<std::size_t, std::size_t> > m_ranges;
 
 };  // class ArrayMatcher
 
@@ -186,68 +225,75 @@ ArrayMatcher::ArrayMatcher (std::string element)
   : m_element (element)
 {
   NS_LOG_FUNCTION (this << element);
+  Parse (element);
 }
-bool
-ArrayMatcher::Matches (std::size_t i) const
+void
+ArrayMatcher::Parse (std::string element)
 {
-  NS_LOG_FUNCTION (this << i);
-  if (m_element == "*")
+  NS_LOG_FUNCTION (this << element);
+  if (element == "*")
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches *");
-      return true;
+      m_ranges.push_back (std::make_pair (0, std::numeric_limits<std::size_t>::max ()));
+      return;
     }
   std::string::size_type tmp;
-  tmp = m_element.find ("|");
+  tmp = element.find ("|");
   if (tmp != std::string::npos)
     {
-      std::string left = m_element.substr (0, tmp-0);
-      std::string right = m_element.substr (tmp+1, m_element.size () - (tmp + 1));
-      ArrayMatcher matcher = ArrayMatcher (left);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<left);
-          return true;
-        }
-      matcher = ArrayMatcher (right);
-      if (matcher.Matches (i))
-        {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<right);
-          return true;
-        }
-      NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
-      return false;
+      std::string left = element.substr (0, tmp-0);
+      std::string right = element.substr (tmp+1, element.size () - (tmp + 1));
+      Parse (left);
+      Parse (right);
+      return;
     }
-  std::string::size_type leftBracket = m_element.find ("[");
-  std::string::size_type rightBracket = m_element.find ("]");
-  std::string::size_type dash = m_element.find ("-");
-  if (leftBracket == 0 && rightBracket == m_element.size () - 1 &&
+  std::string::size_type leftBracket = element.find ("[");
+  std::string::size_type rightBracket = element.find ("]");
+  std::string::size_type dash = element.find ("-");
+  if (leftBracket == 0 && rightBracket == element.size () - 1 &&
       dash > leftBracket && dash < rightBracket)
     {
-      std::string lowerBound = m_element.substr (leftBracket + 1, dash - (leftBracket + 1));
-      std::string upperBound = m_element.substr (dash + 1, rightBracket - (dash + 1));
+      std::string lowerBound = element.substr (leftBracket + 1, dash - (leftBracket + 1));
+      std::string upperBound = element.substr (dash + 1, rightBracket - (dash + 1));
       uint32_t min;
       uint32_t max;
       if (StringToUint32 (lowerBound, &min) && 
           StringToUint32 (upperBound, &max) &&
-          i >= min && i <= max)
+          min <= max)
         {
-          NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
-          return true;
+          m_ranges.push_back (std::make_pair (min, max));
         }
-      else
+      return;
+    }
+  uint32_t value;
+  if (StringToUint32 (element, &value))
+    {
+      m_ranges.push_back (std::make_pair (value, value));
+    }
+}
+bool
+ArrayMatcher::Matches (std::size_t i) const
+{
+  NS_LOG_FUNCTION (this << i);
+  for (std::size_t j = 0; j < m_ranges.size (); j++)
+    {
+      if (i >= m_ranges[j].first && i <= m_ranges[j].second)
         {
-          NS_LOG_DEBUG ("Array "<<i<<" does not "<<m_element);
-          return false;
+          NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
+          return true;
         }
     }
-  uint32_t value;
-  if (StringToUint32 (m_element, &value) &&
-      i == value)
+  NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
+  return false;
+}
+bool
+ArrayMatcher::GetIndex (std::size_t *i) const
+{
+  NS_LOG_FUNCTION (this << i);
+  if (m_ranges.size () == 1 && m_ranges[0].first == m_ranges[0].second)
     {
-      NS_LOG_DEBUG ("Array "<<i<<" matches "<<m_element);
+      *i = m_ranges[0].first;
       return true;
     }
-  NS_LOG_DEBUG ("Array "<<i<<" does not match "<<m_element);
   return false;
 }
 
@@ -261,13 +307,104 @@ ArrayMatcher::StringToUint32 (std::string str, uint32_t *value) const
   return !iss.bad () && !iss.fail ();
 }
 
+/**
+ * \ingroup config-impl
+ * An attribute leading from an object to other objects.
+ */
+struct ObjectAttribute
+{
+  std::string name;  //!< The name of the attribute.
+  bool isVector;     //!< Does it hold a container of objects, rather than a pointer?
+};
+
+/**
+ * \ingroup config-impl
+ * Get the attributes of a TypeId and of its parents which lead to other
+ * objects and match a Config path item, in the order of the walk of the
+ * TypeId hierarchy.
+ *
+ * Matching the item against every attribute of every object on the path
+ * dominated the resolution of the paths, and the objects matched by a path
+ * are mostly of a handful of types, so the matching attributes are indexed
+ * by TypeId and item.
+ *
+ * \param [in] tid The TypeId of the object.
+ * \param [in] item The Config path item, an attribute name or "*".
+ * \returns The matching attributes.
+ */
+static const std::vector<ObjectAttribute> &
+GetObjectAttributes (TypeId tid, const std::string &item)
+{
+  NS_LOG_FUNCTION (tid << item);
+  /** The matching attributes, with the number of attributes they were found among. */
+  typedef std::pair<uint32_t, std::vector<ObjectAttribute> > Entry;
+  static std::map<std::pair<uint16_t, std::string>, Entry> index;
+
+  // attributes may still be added to a TypeId, e.g., by tests
+  uint32_t nAttributes = 0;
+  TypeId tmp = tid;
+  for (;;)
+    {
+      nAttributes += tmp.GetAttributeN ();
+      TypeId parent = tmp.GetParent ();
+      if (parent == tmp)
+        {
+          break;
+        }
+      tmp = parent;
+    }
+
+  Entry &entry = index[std::make_pair (tid.GetUid (), item)];
+  if (entry.first == nAttributes && nAttributes != 0)
+    {
+      return entry.second;
+    }
+  entry.first = nAttributes;
+  entry.second.clear ();
+  TypeId nextTid = tid;
+  do
+    {
+      tmp = nextTid;
+      for (uint32_t i = 0; i < tmp.GetAttributeN (); i++)
+        {
+          struct TypeId::AttributeInformation info = tmp.GetAttribute (i);
+          if (info.name != item && item != "*")
+            {
+              continue;
+            }
+          ObjectAttribute attribute;
+          attribute.name = info.name;
+          if (dynamic_cast<const PointerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              attribute.isVector = false;
+              entry.second.push_back (attribute);
+            }
+          else if (dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker)) != 0)
+            {
+              attribute.isVector = true;
+              entry.second.push_back (attribute);
+            }
+          // this could be anything else and we don't know what to do with it.
+          // So, we just ignore it.
+        }
+      nextTid = tmp.GetParent ();
+    } while (nextTid != tmp);
+  return entry.second;
+}
+
 /**
  * \ingroup config-impl
  * Abstract class to parse Config paths into object references.
+ *
+ * The paths are tokenized once, into a tree merging their common
+ * prefixes, so that several paths are resolved in a single walk of the
+ * objects.
  */
 class Resolver
 {
 public:
+  /** Constructor, without any Config path. */
+  Resolver ();
   /**
    * Construct from a base Config path.
    *
@@ -278,7 +415,14 @@ public:
   virtual ~Resolver ();
 
   /**
-   * Parse the stored Config path into an object reference,
+   * Add a Config path to resolve.
+   *
+   * \param [in] path The Config path.
+   * \returns The index of the path, passed to DoOne.
+   */
+  std::size_t AddPath (std::string path);
+  /**
+   * Parse the stored Config paths into object references,
    * beginning at the indicated root object.
    *
    * \param [in] root The object corresponding to the current position in
@@ -287,29 +431,55 @@ public:
   void Resolve (Ptr<Object> root);
   
 private:
-  /** Ensure the Config path starts and ends with a '/'. */
-  void Canonicalize (void);
+  /** A node of the tree of the tokens of the Config paths. */
+  struct PathNode
+  {
+    /**
+     * Constructor.
+     *
+     * \param [in] item The Config path token leading to this node.
+     */
+    PathNode (std::string item);
+    /** The Config path token leading to this node. */
+    std::string item;
+    /** The matcher of the token, when it follows an object container. */
+    ArrayMatcher matcher;
+    /** The indices of the nodes of the tokens following this one. */
+    std::vector<std::size_t> children;
+    /** The indices of the Config paths ending with this token. */
+    std::vector<std::size_t> paths;
+  };
+
   /**
-   * Parse the next element in the Config path.
+   * Ensure the Config path starts and ends with a '/'.
    *
-   * \param [in] path The remaining portion of the Config path.
+   * \param [in] path The Config path.
+   * \returns The canonical Config path.
+   */
+  std::string Canonicalize (std::string path) const;
+  /**
+   * Handle the objects found at a node, and parse the tokens following it.
+   *
+   * \param [in] node The index of the node.
    * \param [in] root The object corresponding to the current position
    *                  in the Config path.
    */
-  void DoResolve (std::string path, Ptr<Object> root);
+  void DoResolve (std::size_t node, Ptr<Object> root);
   /**
-   * Parse an index on the Config path.
+   * Parse the token of a node.
    *
-   * \param [in] path The remaining Config path.
-   * \param [in,out] vector The resulting list of matching objects.
+   * \param [in] node The index of the node.
+   * \param [in] root The object corresponding to the current position
+   *                  in the Config path.
    */
-  void DoArrayResolve (std::string path, const ObjectPtrContainerValue &vector);
+  void DoResolveItem (std::size_t node, Ptr<Object> root);
   /**
-   * Handle one object found on the path.
+   * Parse the indices following a node.
    *
-   * \param [in] object The current object on the Config path.
+   * \param [in] node The index of the node of the container.
+   * \param [in] container The objects of the container.
    */
-  void DoResolveOne (Ptr<Object> object);
+  void DoArrayResolve (std::size_t node, const ObjectPtrContainerValue &container);
   /**
    * Get the current Config path.
    *
@@ -319,46 +489,97 @@ private:
   /**
    * Handle one found object.
    *
+   * \param [in] index The index of the matching Config path.
    * \param [in] object The found object.
    * \param [in] path The matching Config path context.
    */
-  virtual void DoOne (Ptr<Object> object, std::string path) = 0;
+  virtual void DoOne (std::size_t index, Ptr<Object> object, std::string path) = 0;
 
   /** Current list of path tokens. */
   std::vector<std::string> m_workStack;
-  /** The Config path. */
-  std::string m_path;
+  /** The tree of the tokens of the Config paths, rooted at the first node. */
+  std::vector<PathNode> m_nodes;
+  /** The number of Config paths. */
+  std::size_t m_nPaths;
 
 };  // class Resolver
 
+Resolver::PathNode::PathNode (std::string item)
+  : item (item),
+    matcher (item)
+{
+}
+
+Resolver::Resolver ()
+  : m_nPaths (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_nodes.push_back (PathNode (""));
+}
 Resolver::Resolver (std::string path)
-  : m_path (path)
+  : m_nPaths (0)
 {
   NS_LOG_FUNCTION (this << path);
-  Canonicalize ();
+  m_nodes.push_back (PathNode (""));
+  AddPath (path);
 }
 Resolver::~Resolver ()
 {
   NS_LOG_FUNCTION (this);
 }
-void
-Resolver::Canonicalize (void)
+std::string
+Resolver::Canonicalize (std::string path) const
 {
-  NS_LOG_FUNCTION (this);
+  NS_LOG_FUNCTION (this << path);
 
   // ensure that we start and end with a '/'
-  std::string::size_type tmp = m_path.find ("/");
+  std::string::size_type tmp = path.find ("/");
   if (tmp != 0)
     {
       // no slash at start
-      m_path = "/" + m_path;
+      path = "/" + path;
     }
-  tmp = m_path.find_last_of ("/");
-  if (tmp != (m_path.size () - 1))
+  tmp = path.find_last_of ("/");
+  if (tmp != (path.size () - 1))
     {
       // no slash at end
-      m_path = m_path + "/";
+      path = path + "/";
     }
+  return path;
+}
+
+std::size_t
+Resolver::AddPath (std::string path)
+{
+  NS_LOG_FUNCTION (this << path);
+
+  path = Canonicalize (path);
+  std::size_t node = 0;
+  std::string::size_type start = 1;
+  std::string::size_type next;
+  while ((next = path.find ("/", start)) != std::string::npos)
+    {
+      std::string item = path.substr (start, next - start);
+      std::size_t child = 0;
+      for (std::size_t i = 0; i < m_nodes[node].children.size (); i++)
+        {
+          if (m_nodes[m_nodes[node].children[i]].item == item)
+            {
+              child = m_nodes[node].children[i];
+              break;
+            }
+        }
+      if (child == 0)
+        {
+          child = m_nodes.size ();
+          m_nodes.push_back (PathNode (item));
+          m_nodes[node].children.push_back (child);
+        }
+      node = child;
+      start = next + 1;
+    }
+  m_nodes[node].paths.push_back (m_nPaths);
+  return m_nPaths++;
 }
 
 void 
@@ -366,7 +587,7 @@ Resolver::Resolve (Ptr<Object> root)
 {
   NS_LOG_FUNCTION (this << root);
 
-  DoResolve (m_path, root);
+  DoResolve (0, root);
 }
 
 std::string
@@ -382,40 +603,39 @@ Resolver::GetResolvedPath (void) const
   return fullPath;
 }
 
-void 
-Resolver::DoResolveOne (Ptr<Object> object)
+void
+Resolver::DoResolve (std::size_t node, Ptr<Object> root)
 {
-  NS_LOG_FUNCTION (this << object);
+  NS_LOG_FUNCTION (this << node << root);
 
-  NS_LOG_DEBUG ("resolved="<<GetResolvedPath ());
-  DoOne (object, GetResolvedPath ());
-}
-
-void
-Resolver::DoResolve (std::string path, Ptr<Object> root)
-{
-  NS_LOG_FUNCTION (this << path << root);
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
-
-  if (next == std::string::npos)
-    {
-      //
-      // If root is zero, we're beginning to see if we can use the object name 
-      // service to resolve this path.  It is impossible to have a object name 
-      // associated with the root of the object name service since that root
-      // is not an object.  This path must be referring to something in another
-      // namespace and it will have been found already since the name service
-      // is always consulted last.
-      // 
-      if (root)
+  //
+  // If root is zero, we're beginning to see if we can use the object name 
+  // service to resolve this path.  It is impossible to have a object name 
+  // associated with the root of the object name service since that root
+  // is not an object.  This path must be referring to something in another
+  // namespace and it will have been found already since the name service
+  // is always consulted last.
+  // 
+  if (root && !m_nodes[node].paths.empty ())
+    {
+      std::string resolved = GetResolvedPath ();
+      NS_LOG_DEBUG ("resolved="<<resolved);
+      for (std::size_t i = 0; i < m_nodes[node].paths.size (); i++)
         {
-          DoResolveOne (root);
+          DoOne (m_nodes[node].paths[i], root, resolved);
         }
-      return;
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
+  for (std::size_t i = 0; i < m_nodes[node].children.size (); i++)
+    {
+      DoResolveItem (m_nodes[node].children[i], root);
+    }
+}
+
+void
+Resolver::DoResolveItem (std::size_t node, Ptr<Object> root)
+{
+  const std::string &item = m_nodes[node].item;
+  NS_LOG_FUNCTION (this << item << root);
 
   //
   // If root is zero, we're beginning to see if we can use the object name 
@@ -426,11 +646,10 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
   //
   if (root == 0)
     {
-      std::string::size_type offset = path.find ("/Names");
-      if (offset == 0)
+      if (item.compare (0, 5, "Names") == 0)
         {
           m_workStack.push_back (item);
-          DoResolve (pathLeft, root);
+          DoResolve (node, root);
           m_workStack.pop_back ();
           return;
         }
@@ -447,7 +666,7 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
     {
       NS_LOG_DEBUG ("Name system resolved item = " << item << " to " << namedObject);
       m_workStack.push_back (item);
-      DoResolve (pathLeft, namedObject);
+      DoResolve (node, namedObject);
       m_workStack.pop_back ();
       return;
     }
@@ -477,102 +696,103 @@ Resolver::DoResolve (std::string path, Ptr<Object> root)
           return;
         }
       m_workStack.push_back (item);
-      DoResolve (pathLeft, object);
+      DoResolve (node, object);
       m_workStack.pop_back ();
     }
   else 
     {
       // this is a normal attribute.
-      TypeId tid;
-      TypeId nextTid = root->GetInstanceTypeId ();
-      bool foundMatch = false;
-      
-      do
+      const std::vector<ObjectAttribute> &attributes =
+        GetObjectAttributes (root->GetInstanceTypeId (), item);
+      if (attributes.empty ())
+        {
+          NS_LOG_DEBUG ("Requested item="<<item<<" does not exist on path="<<GetResolvedPath ());
+          return;
+        }
+      for (std::size_t i = 0; i < attributes.size (); i++)
         {
-          tid = nextTid;
-          
-          for (uint32_t i = 0; i < tid.GetAttributeN(); i++)
+          const ObjectAttribute &attribute = attributes[i];
+          if (!attribute.isVector)
             {
-              struct TypeId::AttributeInformation info;
-              info = tid.GetAttribute(i);
-              if (info.name != item && item != "*")
+              NS_LOG_DEBUG ("GetAttribute(ptr)="<<attribute.name<<" on path="<<GetResolvedPath ());
+              PointerValue pValue;
+              root->GetAttribute (attribute.name, pValue);
+              Ptr<Object> object = pValue.Get<Object> ();
+              if (object == 0)
                 {
+                  NS_LOG_ERROR ("Requested object name=\""<<item<<
+                                "\" exists on path=\""<<GetResolvedPath ()<<"\""
+                                " but is null.");
                   continue;
                 }
-              // attempt to cast to a pointer checker.
-              const PointerChecker *pChecker = dynamic_cast<const PointerChecker *> (PeekPointer(info.checker));
-              if (pChecker != 0)
-                {
-                  NS_LOG_DEBUG ("GetAttribute(ptr)="<<info.name<<" on path="<<GetResolvedPath ());
-                  PointerValue pValue;
-                  root->GetAttribute (info.name, pValue);
-                  Ptr<Object> object = pValue.Get<Object> ();
-                  if (object == 0)
-                    {
-                      NS_LOG_ERROR ("Requested object name=\""<<item<<
-                                    "\" exists on path=\""<<GetResolvedPath ()<<"\""
-                                    " but is null.");
-                      continue;
-                    }
-                  foundMatch = true;
-                  m_workStack.push_back (info.name);
-                  DoResolve (pathLeft, object);
-                  m_workStack.pop_back ();
-                }
-              // attempt to cast to an object vector.
-              const ObjectPtrContainerChecker *vectorChecker = 
-                dynamic_cast<const ObjectPtrContainerChecker *> (PeekPointer (info.checker));
-              if (vectorChecker != 0)
-                {
-                  NS_LOG_DEBUG ("GetAttribute(vector)="<<info.name<<" on path="<<GetResolvedPath () << pathLeft);
-                  foundMatch = true;
-                  ObjectPtrContainerValue vector;
-                  root->GetAttribute (info.name, vector);
-                  m_workStack.push_back (info.name);
-                  DoArrayResolve (pathLeft, vector);
-                  m_workStack.pop_back ();
-                }
-              // this could be anything else and we don't know what to do with it.
-              // So, we just ignore it.
+              m_workStack.push_back (attribute.name);
+              DoResolve (node, object);
+              m_workStack.pop_back ();
+            }
+          else
+            {
+              NS_LOG_DEBUG ("GetAttribute(vector)="<<attribute.name<<" on path="<<GetResolvedPath ());
+              ObjectPtrContainerValue vector;
+              root->GetAttribute (attribute.name, vector);
+              m_workStack.push_back (attribute.name);
+              DoArrayResolve (node, vector);
+              m_workStack.pop_back ();
             }
-
-          nextTid = tid.GetParent ();
-        } while (nextTid != tid);
-      
-      if (!foundMatch)
-        {
-          NS_LOG_DEBUG ("Requested item="<<item<<" does not exist on path="<<GetResolvedPath ());
-          return;
         }
     }
 }
 
 void 
-Resolver::DoArrayResolve (std::string path, const ObjectPtrContainerValue &container)
+Resolver::DoArrayResolve (std::size_t node, const ObjectPtrContainerValue &container)
 {
-  NS_LOG_FUNCTION(this << path << &container);
-  NS_ASSERT (path != "");
-  NS_ASSERT ((path.find ("/")) == 0);
-  std::string::size_type next = path.find ("/", 1);
-  if (next == std::string::npos)
+  NS_LOG_FUNCTION(this << node << &container);
+
+  // the Config paths ending with the container do not match anything.
+  // The children matching a single index, e.g., "/NodeList/3" for each
+  // node, are looked up by index, rather than matched with every object.
+  std::map<std::size_t, std::vector<std::size_t> > byIndex;
+  std::vector<std::size_t> others;
+  for (std::size_t i = 0; i < m_nodes[node].children.size (); i++)
     {
-      return;
+      std::size_t child = m_nodes[node].children[i];
+      std::size_t index;
+      if (m_nodes[child].matcher.GetIndex (&index))
+        {
+          byIndex[index].push_back (child);
+        }
+      else
+        {
+          others.push_back (child);
+        }
     }
-  std::string item = path.substr (1, next-1);
-  std::string pathLeft = path.substr (next, path.size ()-next);
-
-  ArrayMatcher matcher = ArrayMatcher (item);
   ObjectPtrContainerValue::Iterator it;
   for (it = container.Begin (); it != container.End (); ++it)
     {
-      if (matcher.Matches ((*it).first))
+      std::vector<std::size_t> matching;
+      std::map<std::size_t, std::vector<std::size_t> >::const_iterator found = byIndex.find ((*it).first);
+      if (found != byIndex.end ())
         {
-          std::ostringstream oss;
-          oss << (*it).first;
-          m_workStack.push_back (oss.str ());
-          DoResolve (pathLeft, (*it).second);
-          m_workStack.pop_back ();
+          matching = found->second;
         }
+      for (std::size_t i = 0; i < others.size (); i++)
+        {
+          if (m_nodes[others[i]].matcher.Matches ((*it).first))
+            {
+              matching.push_back (others[i]);
+            }
+        }
+      if (matching.empty ())
+        {
+          continue;
+        }
+      std::ostringstream oss;
+      oss << (*it).first;
+      m_workStack.push_back (oss.str ());
+      for (std::size_t i = 0; i < matching.size (); i++)
+        {
+          DoResolve (matching[i], (*it).second);
+        }
+      m_workStack.pop_back ();
     }
 }
 
@@ -595,6 +815,12 @@ public:
   void Disconnect (std::string path, const CallbackBase &cb);
   /** \copydoc Config::LookupMatches() */
   MatchContainer LookupMatches (std::string path);
+  /**
+   * Look up the objects matching several Config paths at once.
+   * \param [in] paths The Config paths.
+   * \returns The objects matching each of the \p paths.
+   */
+  std::vector<MatchContainer> LookupMatches (const std::vector<std::string> &paths);
 
   /** \copydoc Config::RegisterRootNamespaceObject() */
   void RegisterRootNamespaceObject (Ptr<Object> obj);
@@ -616,6 +842,8 @@ private:
    */
   void ParsePath (std::string path, std::string *root, std::string *leaf) const;
 
+  friend class PathBatch;
+
   /** Container type to hold the root Config path tokens. */
   typedef std::vector<Ptr<Object> > Roots;
 
@@ -689,20 +917,33 @@ MatchContainer
 ConfigImpl::LookupMatches (std::string path)
 {
   NS_LOG_FUNCTION (this << path);
+  return LookupMatches (std::vector<std::string> (1, path)).front ();
+}
+
+std::vector<MatchContainer>
+ConfigImpl::LookupMatches (const std::vector<std::string> &paths)
+{
+  NS_LOG_FUNCTION (this << paths.size ());
   class LookupMatchesResolver : public Resolver 
   {
   public:
-    LookupMatchesResolver (std::string path)
-      : Resolver (path)
-    {}
-    virtual void DoOne (Ptr<Object> object, std::string path)
+    LookupMatchesResolver (const std::vector<std::string> &paths)
+      : m_objects (paths.size ()),
+        m_contexts (paths.size ())
     {
-      m_objects.push_back (object);
-      m_contexts.push_back (path);
+      for (std::size_t i = 0; i < paths.size (); i++)
+        {
+          AddPath (paths[i]);
+        }
     }
-    std::vector<Ptr<Object> > m_objects;
-    std::vector<std::string> m_contexts;
-  } resolver = LookupMatchesResolver (path);
+    virtual void DoOne (std::size_t index, Ptr<Object> object, std::string path)
+    {
+      m_objects[index].push_back (object);
+      m_contexts[index].push_back (path);
+    }
+    std::vector<std::vector<Ptr<Object> > > m_objects;
+    std::vector<std::vector<std::string> > m_contexts;
+  } resolver (paths);
   for (Roots::const_iterator i = m_roots.begin (); i != m_roots.end (); i++)
     {
       resolver.Resolve (*i);
@@ -715,7 +956,13 @@ ConfigImpl::LookupMatches (std::string path)
   //
   resolver.Resolve (0);
 
-  return MatchContainer (resolver.m_objects, resolver.m_contexts, path);
+  std::vector<MatchContainer> containers;
+  containers.reserve (paths.size ());
+  for (std::size_t i = 0; i < paths.size (); i++)
+    {
+      containers.push_back (MatchContainer (resolver.m_objects[i], resolver.m_contexts[i], paths[i]));
+    }
+  return containers;
 }
 
 void 
@@ -754,6 +1001,77 @@ ConfigImpl::GetRootNamespaceObject (std::size_t i) const
 }
 
 
+void
+PathBatch::Set (std::string path, const AttributeValue &value)
+{
+  NS_LOG_FUNCTION (this << path << &value);
+  Operation operation;
+  operation.kind = Operation::SET;
+  operation.path = path;
+  operation.value = value.Copy ();
+  m_operations.push_back (operation);
+}
+
+void
+PathBatch::Connect (std::string path, const CallbackBase &cb)
+{
+  NS_LOG_FUNCTION (this << path << &cb);
+  Operation operation;
+  operation.kind = Operation::CONNECT;
+  operation.path = path;
+  operation.cb = cb;
+  m_operations.push_back (operation);
+}
+
+void
+PathBatch::ConnectWithoutContext (std::string path, const CallbackBase &cb)
+{
+  NS_LOG_FUNCTION (this << path << &cb);
+  Operation operation;
+  operation.kind = Operation::CONNECT_WITHOUT_CONTEXT;
+  operation.path = path;
+  operation.cb = cb;
+  m_operations.push_back (operation);
+}
+
+std::size_t
+PathBatch::GetN (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_operations.size ();
+}
+
+void
+PathBatch::Apply (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  ConfigImpl *impl = ConfigImpl::Get ();
+  std::vector<std::string> roots (m_operations.size ());
+  std::vector<std::string> leaves (m_operations.size ());
+  for (std::size_t i = 0; i < m_operations.size (); i++)
+    {
+      impl->ParsePath (m_operations[i].path, &roots[i], &leaves[i]);
+    }
+  std::vector<MatchContainer> containers = impl->LookupMatches (roots);
+  for (std::size_t i = 0; i < m_operations.size (); i++)
+    {
+      switch (m_operations[i].kind)
+        {
+        case Operation::SET:
+          containers[i].Set (leaves[i], *m_operations[i].value);
+          break;
+        case Operation::CONNECT:
+          containers[i].Connect (leaves[i], m_operations[i].cb);
+          break;
+        case Operation::CONNECT_WITHOUT_CONTEXT:
+          containers[i].ConnectWithoutContext (leaves[i], m_operations[i].cb);
+          break;
+        }
+    }
+  m_operations.clear ();
+}
+
 void Reset (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
@@ -21,6 +21,7 @@
 #define CONFIG_H
 
 #include "ptr.h"
+#include "callback.h"
 #include <string>
 #include <vector>
 
@@ -258,6 +259,82 @@ private:
  */
 MatchContainer LookupMatches (std::string path);
 
+/**
+ * \ingroup config
+ * \brief Resolve many paths in a single walk of the objects.
+ *
+ * Each call to Config::Set or Config::Connect walks all the objects which
+ * may match its path, so that hooking many traces on thousands of nodes
+ * walks all the nodes and devices again for each trace.  The operations
+ * added to a PathBatch are only applied by Apply(), which resolves all
+ * their paths in one go: the common prefixes of the paths, such as the
+ * nodes and devices leading to the traces of the wifi devices, are walked
+ * once, and each matched object is only looked up once.
+ *
+ * \code
+ *   std::string devices = "/NodeList/[0-999]/DeviceList/[0-9]/";
+ *   Config::PathBatch batch;
+ *   batch.Connect (devices + "$ns3::WifiNetDevice/Phy/PhyTxBegin", MakeCallback (&TxBegin));
+ *   batch.Connect (devices + "$ns3::WifiNetDevice/Phy/PhyRxEnd", MakeCallback (&RxEnd));
+ *   batch.Set (devices + "Mtu", UintegerValue (1400));
+ *   batch.Apply ();
+ * \endcode
+ *
+ * All the paths are resolved before applying the operations, in the order
+ * they were added, so that the objects matched by a path do not depend on
+ * the operations of the other paths of the batch.
+ */
+class PathBatch
+{
+public:
+  /**
+   * Add a Config::Set to the batch.
+   * \param [in] path A path to match attributes.
+   * \param [in] value The value to set in all matching attributes.
+   */
+  void Set (std::string path, const AttributeValue &value);
+  /**
+   * Add a Config::Connect to the batch.
+   * \param [in] path A path to match trace sources.
+   * \param [in] cb The callback to connect to the matching trace sources.
+   */
+  void Connect (std::string path, const CallbackBase &cb);
+  /**
+   * Add a Config::ConnectWithoutContext to the batch.
+   * \param [in] path A path to match trace sources.
+   * \param [in] cb The callback to connect to the matching trace sources.
+   */
+  void ConnectWithoutContext (std::string path, const CallbackBase &cb);
+  /**
+   * \returns The number of operations in the batch.
+   */
+  std::size_t GetN (void) const;
+  /**
+   * Resolve the paths of the batch, apply its operations and empty it.
+   */
+  void Apply (void);
+
+private:
+  /** An operation of the batch. */
+  struct Operation
+  {
+    /** The kinds of operations. */
+    enum Kind
+    {
+      SET,                     //!< Config::Set
+      CONNECT,                 //!< Config::Connect
+      CONNECT_WITHOUT_CONTEXT  //!< Config::ConnectWithoutContext
+    };
+    Kind kind;                       //!< The kind of operation.
+    std::string path;                //!< The path of the operation.
+    Ptr<const AttributeValue> value; //!< The value to set.
+    CallbackBase cb;                 //!< The callback to connect.
+  };
+
+  /** The operations of the batch. */
+  std::vector<Operation> m_operations;
+};
+
 /**
  * \ingroup config
  * \param [in] obj A new root object
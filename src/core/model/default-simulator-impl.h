@@ -77,6 +77,7 @@ public:
   virtual void SetScheduler (ObjectFactory schedulerFactory);
   virtual uint32_t GetSystemId (void) const; 
   virtual uint32_t GetContext (void) const;
+  virtual uint64_t GetEventCount (void) const;
 
 private:
   virtual void DoDispose (void);
@@ -120,6 +121,8 @@ private:
   uint32_t m_uid;
   /** Unique id of the current event. */
   uint32_t m_currentUid;
+  /** Number of events executed. */
+  uint64_t m_eventCount;
   /** Timestamp of the current event. */
   uint64_t m_currentTs;
   /** Execution context of the current event. */
@@ -31,6 +31,55 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
 
+namespace {
+
+/** Granularity of the size classes of the event pool, in bytes. */
+const std::size_t EVENT_POOL_GRANULARITY = 16;
+/** Number of size classes of the event pool; larger events are not pooled. */
+const std::size_t EVENT_POOL_SIZE_CLASSES = 16;
+
+/**
+ * \ingroup events
+ * The free lists of the event storage recycled by a thread. The storage
+ * of a free event starts with the pointer to the next free event of the
+ * same size class.
+ */
+struct EventPool
+{
+  /** Release the free events when the thread exits. */
+  ~EventPool ()
+  {
+    Release ();
+  }
+  /** Return the storage of the free events to the system. */
+  void Release (void)
+  {
+    for (std::size_t i = 0; i < EVENT_POOL_SIZE_CLASSES; i++)
+      {
+        while (freeList[i] != 0)
+          {
+            void *p = freeList[i];
+            freeList[i] = *static_cast<void **> (p);
+            ::operator delete (p);
+          }
+      }
+  }
+
+  void *freeList[EVENT_POOL_SIZE_CLASSES]; //!< Head of the free list of each size class.
+  uint64_t nAllocations;                   //!< Number of events allocated from the system.
+  uint64_t nRecycled;                      //!< Number of events recycled from the free lists.
+};
+
+/**
+ * \ingroup events
+ * The event pool of each thread, zero-initialized, and released when the
+ * thread exits. Events may be created by a thread and destroyed by another
+ * one: their storage then moves to the pool of the latter.
+ */
+thread_local EventPool g_eventPool;
+
+} // unnamed namespace
+
 EventImpl::~EventImpl ()
 {
   NS_LOG_FUNCTION (this);
@@ -66,4 +115,60 @@ EventImpl::IsCancelled (void)
   return m_cancel;
 }
 
+void *
+EventImpl::operator new (std::size_t size)
+{
+  std::size_t sizeClass = (size - 1) / EVENT_POOL_GRANULARITY;
+  if (sizeClass >= EVENT_POOL_SIZE_CLASSES)
+    {
+      g_eventPool.nAllocations++;
+      return ::operator new (size);
+    }
+  void *p = g_eventPool.freeList[sizeClass];
+  if (p != 0)
+    {
+      g_eventPool.freeList[sizeClass] = *static_cast<void **> (p);
+      g_eventPool.nRecycled++;
+      return p;
+    }
+  g_eventPool.nAllocations++;
+  return ::operator new ((sizeClass + 1) * EVENT_POOL_GRANULARITY);
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+  if (p == 0)
+    {
+      return;
+    }
+  std::size_t sizeClass = (size - 1) / EVENT_POOL_GRANULARITY;
+  if (sizeClass >= EVENT_POOL_SIZE_CLASSES)
+    {
+      ::operator delete (p);
+      return;
+    }
+  *static_cast<void **> (p) = g_eventPool.freeList[sizeClass];
+  g_eventPool.freeList[sizeClass] = p;
+}
+
+uint64_t
+EventImpl::GetAllocationCount (void)
+{
+  return g_eventPool.nAllocations;
+}
+
+uint64_t
+EventImpl::GetRecycleCount (void)
+{
+  return g_eventPool.nRecycled;
+}
+
+void
+EventImpl::ReleasePool (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  g_eventPool.Release ();
+}
+
 } // namespace ns3
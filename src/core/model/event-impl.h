@@ -21,6 +21,7 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
 #include "simple-ref-count.h"
 
 /**
@@ -40,6 +41,13 @@ namespace ns3 {
  * when it reaches the time associated to this event. Most subclasses
  * are usually created by one of the many Simulator::Schedule
  * methods.
+ *
+ * Events are short-lived and created at a very high rate, hence their
+ * memory is recycled: the storage of a destroyed event, together with the
+ * arguments bound to it by MakeEvent(), is kept in a per-thread free list
+ * of its size class and reused by the next event of the same size class.
+ * Once a simulation reaches its steady state, scheduling an event does not
+ * allocate memory anymore.
  */
 class EventImpl : public SimpleRefCount<EventImpl>
 {
@@ -66,6 +74,38 @@ public:
    */
   bool IsCancelled (void);
 
+  /**
+   * Allocate the storage of an event from the pool of the calling thread.
+   *
+   * \param [in] size The size of the event, in bytes.
+   * \returns The storage of the event.
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * Return the storage of an event to the pool of the calling thread.
+   *
+   * \param [in] p The storage of the event.
+   * \param [in] size The size of the event, in bytes.
+   */
+  static void operator delete (void *p, std::size_t size);
+
+  /**
+   * \returns the number of events whose storage was allocated from the
+   * system by the calling thread, i.e., not recycled from its pool.
+   */
+  static uint64_t GetAllocationCount (void);
+  /**
+   * \returns the number of events whose storage was recycled from the
+   * pool of the calling thread.
+   */
+  static uint64_t GetRecycleCount (void);
+  /**
+   * Release the storage of the events kept in the pool of the calling
+   * thread. The counters are left untouched. The pool of a thread is
+   * also released when the thread exits.
+   */
+  static void ReleasePool (void);
+
 protected:
   /**
    * Implementation for Invoke().
@@ -0,0 +1,300 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+#include "event-impl.h"
+#include "assert.h"
+#include "log.h"
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+const std::size_t LadderScheduler::MAX_RUNGS;
+const std::size_t LadderScheduler::THRESHOLD;
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<LadderScheduler> ()
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_topStart (0),
+    m_topMin (0),
+    m_topMax (0),
+    m_rungs (MAX_RUNGS),
+    m_nRungs (0),
+    m_bottomHead (0),
+    m_nEvents (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LadderScheduler::Rung &
+LadderScheduler::AddRung (uint64_t start, uint64_t span, std::size_t nEvents)
+{
+  NS_LOG_FUNCTION (this << start << span << nEvents);
+  // the rungs are allocated once, so that references to them stay valid
+  NS_ASSERT (m_nRungs < MAX_RUNGS);
+  Rung &rung = m_rungs[m_nRungs++];
+  rung.start = start;
+  rung.width = std::max<uint64_t> (1, (span + nEvents - 1) / nEvents);
+  rung.nBuckets = (span + rung.width - 1) / rung.width;
+  rung.current = 0;
+  if (rung.buckets.size () < rung.nBuckets)
+    {
+      rung.buckets.resize (rung.nBuckets);
+    }
+  return rung;
+}
+
+void
+LadderScheduler::InsertInRung (Rung &rung, const Scheduler::Event &ev)
+{
+  std::size_t i = (ev.key.m_ts - rung.start) / rung.width;
+  NS_ASSERT (i >= rung.current && i < rung.nBuckets);
+  rung.buckets[i].push_back (ev);
+}
+
+std::size_t
+LadderScheduler::FindRung (uint64_t ts) const
+{
+  std::size_t i = 0;
+  while (i < m_nRungs
+         && ts < m_rungs[i].start + m_rungs[i].current * m_rungs[i].width)
+    {
+      i++;
+    }
+  return i;
+}
+
+void
+LadderScheduler::InsertInBottom (const Scheduler::Event &ev)
+{
+  NS_LOG_FUNCTION (this << &ev);
+  Bucket::iterator i = std::upper_bound (m_bottom.begin () + m_bottomHead, m_bottom.end (), ev);
+  if (i == m_bottom.begin () + m_bottomHead && m_bottomHead > 0)
+    {
+      m_bottom[--m_bottomHead] = ev;
+    }
+  else
+    {
+      m_bottom.insert (i, ev);
+    }
+  if (m_bottom.size () - m_bottomHead <= THRESHOLD || m_nRungs == MAX_RUNGS)
+    {
+      return;
+    }
+  // the bottom has grown too large: spread its events over a new rung,
+  // unless they all share the same timestamp
+  uint64_t start = m_bottom[m_bottomHead].key.m_ts;
+  uint64_t end = m_topStart;
+  if (m_nRungs > 0)
+    {
+      const Rung &last = m_rungs[m_nRungs - 1];
+      end = last.start + last.current * last.width;
+    }
+  if (end - start <= 1)
+    {
+      return;
+    }
+  Rung &rung = AddRung (start, end - start, m_bottom.size () - m_bottomHead);
+  for (std::size_t j = m_bottomHead; j < m_bottom.size (); j++)
+    {
+      InsertInRung (rung, m_bottom[j]);
+    }
+  m_bottom.clear ();
+  m_bottomHead = 0;
+}
+
+void
+LadderScheduler::RefillBottom (void)
+{
+  NS_LOG_FUNCTION (this);
+  while (m_bottomHead == m_bottom.size () && m_nEvents > 0)
+    {
+      m_bottom.clear ();
+      m_bottomHead = 0;
+      if (m_nRungs == 0)
+        {
+          NS_ASSERT (!m_top.empty ());
+          if (m_top.size () <= THRESHOLD)
+            {
+              m_bottom.swap (m_top);
+              std::sort (m_bottom.begin (), m_bottom.end ());
+              m_topStart = m_topMax + 1;
+              return;
+            }
+          Rung &first = AddRung (m_topMin, m_topMax - m_topMin + 1, m_top.size ());
+          m_topStart = first.start + first.nBuckets * first.width;
+          for (Bucket::const_iterator i = m_top.begin (); i != m_top.end (); i++)
+            {
+              InsertInRung (first, *i);
+            }
+          m_top.clear ();
+        }
+      Rung &rung = m_rungs[m_nRungs - 1];
+      while (rung.current < rung.nBuckets && rung.buckets[rung.current].empty ())
+        {
+          rung.current++;
+        }
+      if (rung.current == rung.nBuckets)
+        {
+          m_nRungs--;
+          continue;
+        }
+      Bucket &bucket = rung.buckets[rung.current];
+      uint64_t bucketStart = rung.start + rung.current * rung.width;
+      rung.current++;
+      if (bucket.size () > THRESHOLD && rung.width > 1 && m_nRungs < MAX_RUNGS)
+        {
+          Rung &child = AddRung (bucketStart, rung.width, bucket.size ());
+          for (Bucket::const_iterator i = bucket.begin (); i != bucket.end (); i++)
+            {
+              InsertInRung (child, *i);
+            }
+          bucket.clear ();
+          continue;
+        }
+      m_bottom.swap (bucket);
+      std::sort (m_bottom.begin (), m_bottom.end ());
+    }
+}
+
+void
+LadderScheduler::Insert (const Scheduler::Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  m_nEvents++;
+  uint64_t ts = ev.key.m_ts;
+  if (ts >= m_topStart)
+    {
+      if (m_top.empty ())
+        {
+          m_topMin = ts;
+          m_topMax = ts;
+        }
+      else
+        {
+          m_topMin = std::min (m_topMin, ts);
+          m_topMax = std::max (m_topMax, ts);
+        }
+      m_top.push_back (ev);
+    }
+  else
+    {
+      std::size_t i = FindRung (ts);
+      if (i < m_nRungs)
+        {
+          InsertInRung (m_rungs[i], ev);
+        }
+      else
+        {
+          InsertInBottom (ev);
+        }
+    }
+  RefillBottom ();
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_nEvents == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  return m_bottom[m_bottomHead];
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  Scheduler::Event ev = m_bottom[m_bottomHead++];
+  m_nEvents--;
+  RefillBottom ();
+  return ev;
+}
+
+void
+LadderScheduler::Remove (const Scheduler::Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  NS_ASSERT (!IsEmpty ());
+  uint64_t ts = ev.key.m_ts;
+  Bucket *bucket = &m_top;
+  std::size_t i = FindRung (ts);
+  if (ts < m_topStart && i < m_nRungs)
+    {
+      const Rung &rung = m_rungs[i];
+      bucket = &m_rungs[i].buckets[(ts - rung.start) / rung.width];
+    }
+  if (ts >= m_topStart || i < m_nRungs)
+    {
+      for (Bucket::iterator j = bucket->begin (); j != bucket->end (); j++)
+        {
+          if (j->key.m_uid == ev.key.m_uid)
+            {
+              NS_ASSERT (j->impl == ev.impl);
+              *j = bucket->back ();
+              bucket->pop_back ();
+              m_nEvents--;
+              return;
+            }
+        }
+      NS_ASSERT (false);
+    }
+  Bucket::iterator j = std::lower_bound (m_bottom.begin () + m_bottomHead, m_bottom.end (), ev);
+  NS_ASSERT (j != m_bottom.end () && j->key.m_uid == ev.key.m_uid);
+  if (j == m_bottom.begin () + m_bottomHead)
+    {
+      m_bottomHead++;
+    }
+  else
+    {
+      m_bottom.erase (j);
+    }
+  m_nEvents--;
+  RefillBottom ();
+}
+
+} // namespace ns3
@@ -0,0 +1,150 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler is an implementation of the ladder queue described in
+ * "Ladder queue: An O(1) priority queue structure for large-scale discrete
+ * event simulation", W. T. Tang, R. S. M. Goh and I. L.-J. Thng, ACM TOMACS,
+ * 2005.
+ *
+ * The events are kept in three tiers:
+ *  - the top, an unsorted array of the events far in the future;
+ *  - the ladder, made of rungs of buckets. The first rung spreads the events
+ *    taken from the top over buckets of equal width, and each following rung
+ *    spreads the events of a single bucket of the previous rung which holds
+ *    too many events over narrower buckets. The events of a bucket are not
+ *    sorted;
+ *  - the bottom, a small sorted array holding the earliest events, from
+ *    which the events are removed.
+ *
+ * When the bottom is empty, the first non-empty bucket of the last rung is
+ * either spread over a new rung, if it holds more than a threshold number
+ * of events, or sorted into the bottom. When the ladder is empty, the top
+ * is spread over a new first rung. Hence every event is moved a bounded
+ * number of times, and inserting and removing events takes O(1) amortized
+ * time, even when the timestamps are strongly clustered.
+ *
+ * The buckets and the rungs are arrays which are reused, so that the
+ * scheduler stops allocating memory once it reaches its steady state.
+ * The bottom is sorted with the (timestamp, uid) key of the events, so
+ * that events with the same timestamp are removed in insertion order.
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  LadderScheduler ();
+  /** Destructor. */
+  virtual ~LadderScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /** Event bucket type. */
+  typedef std::vector<Scheduler::Event> Bucket;
+
+  /** A rung of the ladder. */
+  struct Rung
+  {
+    uint64_t start;              //!< Timestamp of the start of the first bucket.
+    uint64_t width;              //!< Width of the buckets.
+    std::size_t current;         //!< Index of the first bucket which has not been consumed.
+    std::size_t nBuckets;        //!< Number of buckets in use.
+    std::vector<Bucket> buckets; //!< The buckets, possibly more than in use.
+  };
+
+  /**
+   * Set up the next rung of the ladder to spread events over the given
+   * range of timestamps.
+   *
+   * \param [in] start The first timestamp of the range.
+   * \param [in] span The number of timestamps in the range.
+   * \param [in] nEvents The number of events to spread.
+   * \returns The new rung.
+   */
+  Rung & AddRung (uint64_t start, uint64_t span, std::size_t nEvents);
+  /**
+   * Insert an event in a bucket of a rung.
+   *
+   * \param [in] rung The rung.
+   * \param [in] ev The event.
+   */
+  void InsertInRung (Rung &rung, const Scheduler::Event &ev);
+  /**
+   * \param [in] ts The timestamp of an event.
+   * \returns The index of the rung where an event with the given timestamp
+   *          belongs, or the number of rungs if it belongs to the bottom.
+   */
+  std::size_t FindRung (uint64_t ts) const;
+  /**
+   * Insert an event in the bottom, keeping it sorted.
+   *
+   * \param [in] ev The event.
+   */
+  void InsertInBottom (const Scheduler::Event &ev);
+  /**
+   * Move the earliest events to the bottom, if the bottom is empty.
+   */
+  void RefillBottom (void);
+
+  /** Maximum number of rungs. */
+  static const std::size_t MAX_RUNGS = 8;
+  /** Maximum number of events a bucket may hold without being spread over a new rung. */
+  static const std::size_t THRESHOLD = 50;
+
+  Bucket m_top;                  //!< The events far in the future, not sorted.
+  uint64_t m_topStart;           //!< Events with an earlier timestamp are in the ladder or in the bottom.
+  uint64_t m_topMin;             //!< The earliest timestamp of the top.
+  uint64_t m_topMax;             //!< The latest timestamp of the top.
+  std::vector<Rung> m_rungs;     //!< The rungs, possibly more than in use.
+  std::size_t m_nRungs;          //!< Number of rungs in use.
+  Bucket m_bottom;               //!< The earliest events, sorted from m_bottomHead on.
+  std::size_t m_bottomHead;      //!< Index of the first event of the bottom.
+  uint32_t m_nEvents;            //!< Number of events in the scheduler.
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
@@ -0,0 +1,991 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "log-binary.h"
+#include "log.h"
+#include "ns3/core-config.h"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <unistd.h>
+
+#ifdef HAVE_STDLIB_H
+#include <cstdlib>
+#endif
+
+/**
+ * \file
+ * \ingroup logbinary
+ * Binary logging backend implementation.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup logbinary
+ * Is the binary backend open?
+ * This is private to the logging implementation.
+ */
+static bool g_logBinaryOpen = false;
+
+/**
+ * \ingroup logbinary
+ * The LogBinaryStamper.
+ */
+static LogBinaryStamper g_logBinaryStamper = 0;
+
+/**
+ * \ingroup logbinary
+ * The buffers of the records being built by this thread, one per nested
+ * record, e.g., when an argument of a log message logs itself.
+ */
+static thread_local std::deque<std::string> g_recordBuffers;
+/**
+ * \ingroup logbinary
+ * The number of records being built by this thread.
+ */
+static thread_local std::size_t g_recordDepth = 0;
+
+/** The magic number starting a binary log file. */
+static const char LOG_BINARY_MAGIC[8] = { 'n', 's', '3', 'b', 'l', 'o', 'g', '\n' };
+/** The version of the binary log format. */
+static const uint32_t LOG_BINARY_VERSION = 1;
+/** The byte order mark of a binary log file. */
+static const uint32_t LOG_BINARY_BYTE_ORDER = 0x01020304;
+/** The kind of the entries defining a call site. */
+static const uint8_t LOG_BINARY_SITE = 1;
+/** The size of the kind and length of an entry. */
+static const uint32_t LOG_BINARY_ENTRY_HEADER = 5;
+
+/**
+ * \ingroup logbinary
+ * The ring buffer of the binary log records, and the file they are
+ * written to.
+ *
+ * The entries of the file are a kind, LOG_BINARY_SITE or one of the
+ * LogBinaryRecord::Kind, a length and a payload of that length.  The
+ * call sites are written to the file when registered, and the records
+ * are buffered.
+ */
+class LogBinaryBuffer
+{
+public:
+  /** \return The buffer. */
+  static LogBinaryBuffer * Get (void);
+
+  /** Constructor. */
+  LogBinaryBuffer ();
+  /** Destructor, closing the file. */
+  ~LogBinaryBuffer ();
+  /** \copydoc LogBinaryOpen */
+  bool Open (const std::string &filename, uint32_t size, bool wrap);
+  /** \copydoc LogBinaryClose */
+  void Close (void);
+  /** \copydoc LogBinaryFlush */
+  void Sync (void);
+  /** \copydoc LogBinaryReopen */
+  bool Reopen (const std::string &suffix);
+  /** \copydoc LogBinaryRegisterSite */
+  uint32_t RegisterSite (const char *component, const char *file,
+                         uint32_t line, const char *function);
+  /**
+   * Write a record to the ring buffer.
+   * \param [in] kind The kind of record.
+   * \param [in] data The bytes of the record.
+   */
+  void Write (uint8_t kind, const std::string &data);
+
+private:
+  /**
+   * Write an entry to the file, skipping the ring buffer.
+   * \param [in] kind The kind of entry.
+   * \param [in] data The payload.
+   * \param [in] size The size of the payload.
+   */
+  void WriteEntry (uint8_t kind, const char *data, uint32_t size);
+  /**
+   * Write the ring buffer to the file and empty it.
+   *
+   * The records buffered by a child process are dropped instead.
+   */
+  void Flush (void);
+  /**
+   * \return \c true if the file was opened by this process, rather than
+   *         inherited from its parent.
+   */
+  bool IsOwner (void) const;
+  /**
+   * Copy bytes into the ring buffer.
+   * \param [in] offset The offset in the buffer, wrapped around its end.
+   * \param [in] data The bytes.
+   * \param [in] size The number of bytes.
+   */
+  void CopyIn (std::size_t offset, const void *data, std::size_t size);
+  /**
+   * Copy bytes out of the ring buffer.
+   * \param [in] offset The offset in the buffer, wrapped around its end.
+   * \param [out] data The bytes.
+   * \param [in] size The number of bytes.
+   */
+  void CopyOut (std::size_t offset, void *data, std::size_t size) const;
+
+  /** The definition of a call site. */
+  struct Site
+  {
+    std::string data;  //!< The payload of the entry defining the site.
+  };
+
+  std::mutex m_mutex;           //!< Mutex protecting the buffer and file.
+  std::ofstream m_file;         //!< The binary log file.
+  std::string m_filename;       //!< The name of the file.
+  pid_t m_pid;                  //!< The process which opened the file.
+  std::vector<char> m_ring;     //!< The ring buffer.
+  std::size_t m_head;           //!< The offset of the oldest record.
+  std::size_t m_size;           //!< The number of bytes in the buffer.
+  bool m_wrap;                  //!< Overwrite the oldest records when full?
+  std::vector<Site> m_sites;    //!< The call sites, indexed by identifier.
+};
+
+/**
+ * Append a value to a record, in host byte order.
+ * \param [in,out] data The record.
+ * \param [in] value The value.
+ */
+template <typename T>
+static void
+AppendRaw (std::string &data, T value)
+{
+  data.append (reinterpret_cast<const char *> (&value), sizeof (T));
+}
+
+/**
+ * Append a length-prefixed string to a record.
+ * \param [in,out] data The record.
+ * \param [in] s The string.
+ */
+static void
+AppendRawString (std::string &data, const std::string &s)
+{
+  AppendRaw<uint32_t> (data, s.size ());
+  data.append (s);
+}
+
+LogBinaryBuffer *
+LogBinaryBuffer::Get (void)
+{
+  static LogBinaryBuffer buffer;
+  return &buffer;
+}
+
+LogBinaryBuffer::LogBinaryBuffer ()
+  : m_pid (0),
+    m_head (0),
+    m_size (0),
+    m_wrap (false)
+{
+}
+
+LogBinaryBuffer::~LogBinaryBuffer ()
+{
+  Close ();
+}
+
+bool
+LogBinaryBuffer::Open (const std::string &filename, uint32_t size, bool wrap)
+{
+  Close ();
+  std::lock_guard<std::mutex> lock (m_mutex);
+  // the records are buffered by the ring only, so that a child process
+  // forked while the file is open has no data of its parent to write
+  m_file.rdbuf ()->pubsetbuf (0, 0);
+  m_file.open (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!m_file.is_open ())
+    {
+      return false;
+    }
+  m_filename = filename;
+  m_pid = getpid ();
+  m_file.write (LOG_BINARY_MAGIC, sizeof (LOG_BINARY_MAGIC));
+  m_file.write (reinterpret_cast<const char *> (&LOG_BINARY_VERSION), sizeof (uint32_t));
+  m_file.write (reinterpret_cast<const char *> (&LOG_BINARY_BYTE_ORDER), sizeof (uint32_t));
+  // the call sites registered while a previous file was open keep their
+  // identifiers
+  for (std::size_t i = 0; i < m_sites.size (); i++)
+    {
+      WriteEntry (LOG_BINARY_SITE, m_sites[i].data.data (), m_sites[i].data.size ());
+    }
+  m_ring.assign (std::max<uint32_t> (size, 1024), 0);
+  m_head = 0;
+  m_size = 0;
+  m_wrap = wrap;
+  g_logBinaryOpen = true;
+  return true;
+}
+
+void
+LogBinaryBuffer::Close (void)
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  g_logBinaryOpen = false;
+  if (m_file.is_open ())
+    {
+      Flush ();
+      m_file.close ();
+    }
+  m_ring.clear ();
+}
+
+void
+LogBinaryBuffer::Sync (void)
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  if (m_file.is_open ())
+    {
+      Flush ();
+    }
+}
+
+bool
+LogBinaryBuffer::Reopen (const std::string &suffix)
+{
+  std::string filename;
+  uint32_t size;
+  bool wrap;
+  {
+    std::lock_guard<std::mutex> lock (m_mutex);
+    if (!m_file.is_open ())
+      {
+        return false;
+      }
+    filename = m_filename + suffix;
+    size = m_ring.size ();
+    wrap = m_wrap;
+  }
+  return Open (filename, size, wrap);
+}
+
+uint32_t
+LogBinaryBuffer::RegisterSite (const char *component, const char *file,
+                               uint32_t line, const char *function)
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  uint32_t id = m_sites.size ();
+  Site site;
+  AppendRaw<uint32_t> (site.data, id);
+  AppendRaw<uint32_t> (site.data, line);
+  AppendRawString (site.data, component);
+  AppendRawString (site.data, file);
+  AppendRawString (site.data, function);
+  m_sites.push_back (site);
+  if (m_file.is_open ())
+    {
+      WriteEntry (LOG_BINARY_SITE, site.data.data (), site.data.size ());
+    }
+  return id;
+}
+
+void
+LogBinaryBuffer::Write (uint8_t kind, const std::string &data)
+{
+  std::lock_guard<std::mutex> lock (m_mutex);
+  if (!m_file.is_open ())
+    {
+      return;
+    }
+  uint32_t length = data.size ();
+  std::size_t entry = LOG_BINARY_ENTRY_HEADER + length;
+  if (entry > m_ring.size ())
+    {
+      if (!m_wrap)
+        {
+          Flush ();
+          WriteEntry (kind, data.data (), length);
+        }
+      return;
+    }
+  if (m_size + entry > m_ring.size ())
+    {
+      if (!m_wrap)
+        {
+          Flush ();
+        }
+      else
+        {
+          // drop the oldest records
+          while (m_size + entry > m_ring.size ())
+            {
+              uint32_t oldLength;
+              CopyOut (m_head + 1, &oldLength, sizeof (oldLength));
+              m_head = (m_head + LOG_BINARY_ENTRY_HEADER + oldLength) % m_ring.size ();
+              m_size -= LOG_BINARY_ENTRY_HEADER + oldLength;
+            }
+        }
+    }
+  std::size_t tail = m_head + m_size;
+  CopyIn (tail, &kind, 1);
+  CopyIn (tail + 1, &length, sizeof (length));
+  CopyIn (tail + LOG_BINARY_ENTRY_HEADER, data.data (), length);
+  m_size += entry;
+}
+
+void
+LogBinaryBuffer::WriteEntry (uint8_t kind, const char *data, uint32_t size)
+{
+  if (!IsOwner ())
+    {
+      return;
+    }
+  m_file.write (reinterpret_cast<const char *> (&kind), 1);
+  m_file.write (reinterpret_cast<const char *> (&size), sizeof (size));
+  m_file.write (data, size);
+}
+
+void
+LogBinaryBuffer::Flush (void)
+{
+  if (!IsOwner ())
+    {
+      m_head = 0;
+      m_size = 0;
+      return;
+    }
+  std::size_t first = std::min (m_size, m_ring.size () - m_head);
+  m_file.write (&m_ring[m_head], first);
+  m_file.write (&m_ring[0], m_size - first);
+  m_file.flush ();
+  m_head = 0;
+  m_size = 0;
+}
+
+bool
+LogBinaryBuffer::IsOwner (void) const
+{
+  return m_pid == getpid ();
+}
+
+void
+LogBinaryBuffer::CopyIn (std::size_t offset, const void *data, std::size_t size)
+{
+  offset %= m_ring.size ();
+  std::size_t first = std::min (size, m_ring.size () - offset);
+  std::memcpy (&m_ring[offset], data, first);
+  std::memcpy (&m_ring[0], static_cast<const char *> (data) + first, size - first);
+}
+
+void
+LogBinaryBuffer::CopyOut (std::size_t offset, void *data, std::size_t size) const
+{
+  offset %= m_ring.size ();
+  std::size_t first = std::min (size, m_ring.size () - offset);
+  std::memcpy (data, &m_ring[offset], first);
+  std::memcpy (static_cast<char *> (data) + first, &m_ring[0], size - first);
+}
+
+
+/**
+ * \ingroup logbinary
+ * Handler of the \c NS_LOG_BINARY environment variable, opening the
+ * binary backend at startup.
+ * This is private to the logging implementation.
+ */
+class LogBinaryEnvironment
+{
+public:
+  LogBinaryEnvironment ();  //!< Constructor, opens the backend.
+};
+
+/**
+ * Invoke the handler of the \c NS_LOG_BINARY environment variable.
+ * This is private to the logging implementation.
+ */
+static LogBinaryEnvironment g_logBinaryEnvironment;
+
+LogBinaryEnvironment::LogBinaryEnvironment ()
+{
+#ifdef HAVE_GETENV
+  char *envVar = getenv ("NS_LOG_BINARY");
+  if (envVar == 0 || std::strlen (envVar) == 0)
+    {
+      return;
+    }
+  std::string env = envVar;
+  std::string::size_type next = env.find (":");
+  std::string filename = env.substr (0, next);
+  uint32_t size = 4 << 20;
+  bool wrap = false;
+  while (next != std::string::npos)
+    {
+      std::string::size_type cur = next + 1;
+      next = env.find (":", cur);
+      std::string option = env.substr (cur, next == std::string::npos ? std::string::npos : next - cur);
+      if (option == "wrap")
+        {
+          wrap = true;
+        }
+      else if (option.substr (0, 5) == "size=")
+        {
+          size = std::atoi (option.substr (5).c_str ());
+        }
+      else
+        {
+          std::cerr << "Invalid option \"" << option
+                    << "\" in env variable NS_LOG_BINARY" << std::endl;
+          std::exit (1);
+        }
+    }
+  if (!LogBinaryOpen (filename, size, wrap))
+    {
+      std::cerr << "Could not open the binary log \"" << filename
+                << "\" of env variable NS_LOG_BINARY" << std::endl;
+      std::exit (1);
+    }
+#endif
+}
+
+
+void
+LogBinarySetStamper (LogBinaryStamper stamper)
+{
+  g_logBinaryStamper = stamper;
+}
+
+bool
+LogBinaryOpen (const std::string &filename, uint32_t size, bool wrap)
+{
+  return LogBinaryBuffer::Get ()->Open (filename, size, wrap);
+}
+
+void
+LogBinaryClose (void)
+{
+  LogBinaryBuffer::Get ()->Close ();
+}
+
+void
+LogBinaryFlush (void)
+{
+  LogBinaryBuffer::Get ()->Sync ();
+}
+
+bool
+LogBinaryReopen (const std::string &suffix)
+{
+  return LogBinaryBuffer::Get ()->Reopen (suffix);
+}
+
+bool
+LogBinaryIsOpen (void)
+{
+  return g_logBinaryOpen;
+}
+
+uint32_t
+LogBinaryRegisterSite (const char *component, const char *file,
+                       uint32_t line, const char *function)
+{
+  return LogBinaryBuffer::Get ()->RegisterSite (component, file, line, function);
+}
+
+
+LogBinaryRecord::LogBinaryRecord (uint32_t site, enum Kind kind, uint32_t level)
+  : m_kind (kind),
+    m_parameters (kind == FUNCTION),
+    m_first (true)
+{
+  if (g_recordDepth == g_recordBuffers.size ())
+    {
+      g_recordBuffers.push_back (std::string ());
+    }
+  m_data = &g_recordBuffers[g_recordDepth++];
+  m_data->clear ();
+  int64_t ts = 0;
+  uint32_t context = 0xffffffff;
+  if (g_logBinaryStamper != 0)
+    {
+      (*g_logBinaryStamper)(&ts, &context);
+    }
+  AppendRaw (*m_data, site);
+  AppendRaw (*m_data, level);
+  AppendRaw (*m_data, ts);
+  AppendRaw (*m_data, context);
+}
+
+LogBinaryRecord::~LogBinaryRecord ()
+{
+  LogBinaryBuffer::Get ()->Write (m_kind, *m_data);
+  g_recordDepth--;
+}
+
+void
+LogBinaryRecord::Separate (void)
+{
+  if (m_parameters)
+    {
+      if (!m_first)
+        {
+          AppendString (", ", 2);
+        }
+      m_first = false;
+    }
+}
+
+void
+LogBinaryRecord::Append (char tag, const void *data, uint32_t size)
+{
+  m_data->push_back (tag);
+  m_data->append (static_cast<const char *> (data), size);
+}
+
+void
+LogBinaryRecord::AppendString (const char *data, uint32_t size)
+{
+  m_data->push_back ('s');
+  AppendRaw (*m_data, size);
+  m_data->append (data, size);
+}
+
+void
+LogBinaryRecord::AppendPointer (const void *value)
+{
+  uint64_t address = reinterpret_cast<uintptr_t> (value);
+  Append ('p', &address, sizeof (address));
+}
+
+LogBinaryRecord &
+LogBinaryRecord::operator<< (bool value)
+{
+  Separate ();
+  Append ('b', &value, 1);
+  return *this;
+}
+
+LogBinaryRecord &
+LogBinaryRecord::operator<< (char value)
+{
+  Separate ();
+  Append ('c', &value, 1);
+  return *this;
+}
+
+LogBinaryRecord &
+LogBinaryRecord::operator<< (signed char value)
+{
+  // the parameters of NS_LOG_FUNCTION print the int8_t as numbers
+  if (m_parameters)
+    {
+      return *this << static_cast<int> (value);
+    }
+  return *this << static_cast<char> (value);
+}
+
+LogBinaryRecord &
+LogBinaryRecord::operator<< (unsigned char value)
+{
+  if (m_parameters)
+    {
+      return *this << static_cast<unsigned int> (value);
+    }
+  return *this << static_cast<char> (value);
+}
+
+LogBinaryRecord &
+LogBinaryRecord::operator<< (short value)
+{
+  return *this << static_cast<long long> (value);
+}
+
+LogBinaryRecord &
+LogBinaryRecord::operator<< (unsigned short value)
+{
+  return *this << static_cast<unsigned long long> (value);
+}
+
+LogBinaryRecord &
+LogBinaryRecord::operator<< (int value)
+{
+  return *this << static_cast<long long> (value);
+}
+
+LogBinaryRecord &
+LogBinaryRecord::operator<< (unsigned int value)
+{
+  return *this << static_cast<unsigned long long> (value);
+}
+
+LogBinaryRecord &
+LogBinaryRecord::operator<< (long value)
+{
+  return *this << static_cast<long long> (value);
+}
+
+LogBinaryRecord &
+LogBinaryRecord::operator<< (unsigned long value)
+{
+  return *this << static_cast<unsigned long long> (value);
+}
+
+LogBinaryRecord &
+LogBinaryRecord::operator<< (long long value)
+{
+  Separate ();
+  int64_t v = value;
+  Append ('i', &v, sizeof (v));
+  return *this;
+}
+
+LogBinaryRecord &
+LogBinaryRecord::operator<< (unsigned long long value)
+{
+  Separate ();
+  uint64_t v = value;
+  Append ('u', &v, sizeof (v));
+  return *this;
+}
+
+LogBinaryRecord &
+LogBinaryRecord::operator<< (float value)
+{
+  // a float is printed as the same double, with the default precision
+  return *this << static_cast<double> (value);
+}
+
+LogBinaryRecord &
+LogBinaryRecord::operator<< (double value)
+{
+  Separate ();
+  Append ('d', &value, sizeof (value));
+  return *this;
+}
+
+LogBinaryRecord &
+LogBinaryRecord::operator<< (const char *value)
+{
+  return *this << std::string (value);
+}
+
+LogBinaryRecord &
+LogBinaryRecord::operator<< (char *value)
+{
+  return *this << std::string (value);
+}
+
+LogBinaryRecord &
+LogBinaryRecord::operator<< (const std::string &value)
+{
+  Separate ();
+  if (m_parameters)
+    {
+      // the parameters of NS_LOG_FUNCTION quote the strings
+      std::string quoted = "\"" + value + "\"";
+      AppendString (quoted.data (), quoted.size ());
+    }
+  else
+    {
+      AppendString (value.data (), value.size ());
+    }
+  return *this;
+}
+
+LogBinaryRecord &
+LogBinaryRecord::operator<< (std::string &value)
+{
+  return *this << static_cast<const std::string &> (value);
+}
+
+LogBinaryRecord &
+LogBinaryRecord::operator<< (std::ostream & (*manipulator)(std::ostream &))
+{
+  std::ostringstream oss;
+  (*manipulator)(oss);
+  std::string s = oss.str ();
+  if (!s.empty ())
+    {
+      AppendString (s.data (), s.size ());
+    }
+  return *this;
+}
+
+
+/**
+ * \ingroup logbinary
+ * Read a value of a binary log entry.
+ * \param [in,out] data The next bytes of the entry.
+ * \param [in] end The end of the entry.
+ * \param [out] value The value.
+ * \return \c false if the entry is truncated.
+ */
+template <typename T>
+static bool
+ReadRaw (const char *&data, const char *end, T *value)
+{
+  if (end - data < static_cast<std::ptrdiff_t> (sizeof (T)))
+    {
+      return false;
+    }
+  std::memcpy (value, data, sizeof (T));
+  data += sizeof (T);
+  return true;
+}
+
+/**
+ * \ingroup logbinary
+ * Read a length-prefixed string of a binary log entry.
+ * \param [in,out] data The next bytes of the entry.
+ * \param [in] end The end of the entry.
+ * \param [out] s The string.
+ * \return \c false if the entry is truncated.
+ */
+static bool
+ReadRawString (const char *&data, const char *end, std::string *s)
+{
+  uint32_t size;
+  if (!ReadRaw (data, end, &size) || end - data < static_cast<std::ptrdiff_t> (size))
+    {
+      return false;
+    }
+  s->assign (data, size);
+  data += size;
+  return true;
+}
+
+/**
+ * \ingroup logbinary
+ * Render the arguments of a binary log record.
+ * \param [in] data The arguments.
+ * \param [in] end The end of the record.
+ * \param [in] os The output stream.
+ * \return \c false if the record is truncated or corrupted.
+ */
+static bool
+RenderArguments (const char *data, const char *end, std::ostream &os)
+{
+  while (data < end)
+    {
+      char tag = *data++;
+      switch (tag)
+        {
+        case 'b':
+          {
+            bool v;
+            if (!ReadRaw (data, end, &v))
+              {
+                return false;
+              }
+            os << v;
+            break;
+          }
+        case 'c':
+          {
+            char v;
+            if (!ReadRaw (data, end, &v))
+              {
+                return false;
+              }
+            os << v;
+            break;
+          }
+        case 'i':
+          {
+            int64_t v;
+            if (!ReadRaw (data, end, &v))
+              {
+                return false;
+              }
+            os << v;
+            break;
+          }
+        case 'u':
+          {
+            uint64_t v;
+            if (!ReadRaw (data, end, &v))
+              {
+                return false;
+              }
+            os << v;
+            break;
+          }
+        case 'd':
+          {
+            double v;
+            if (!ReadRaw (data, end, &v))
+              {
+                return false;
+              }
+            os << v;
+            break;
+          }
+        case 'p':
+          {
+            uint64_t v;
+            if (!ReadRaw (data, end, &v))
+              {
+                return false;
+              }
+            os << reinterpret_cast<const void *> (static_cast<uintptr_t> (v));
+            break;
+          }
+        case 's':
+          {
+            std::string v;
+            if (!ReadRawString (data, end, &v))
+              {
+                return false;
+              }
+            os << v;
+            break;
+          }
+        default:
+          return false;
+        }
+    }
+  return true;
+}
+
+bool
+LogBinaryDecode (std::istream &is, std::ostream &os,
+                 uint32_t prefixes, const std::string &component)
+{
+  char magic[sizeof (LOG_BINARY_MAGIC)];
+  uint32_t version;
+  uint32_t byteOrder;
+  is.read (magic, sizeof (magic));
+  is.read (reinterpret_cast<char *> (&version), sizeof (version));
+  is.read (reinterpret_cast<char *> (&byteOrder), sizeof (byteOrder));
+  if (!is || std::memcmp (magic, LOG_BINARY_MAGIC, sizeof (magic)) != 0
+      || version != LOG_BINARY_VERSION || byteOrder != LOG_BINARY_BYTE_ORDER)
+    {
+      return false;
+    }
+
+  /** A call site. */
+  struct Site
+  {
+    uint32_t line;          //!< The line.
+    std::string component;  //!< The log component.
+    std::string file;       //!< The file.
+    std::string function;   //!< The function.
+  };
+  std::map<uint32_t, Site> sites;
+  std::vector<char> entry;
+  while (true)
+    {
+      uint8_t kind;
+      uint32_t length;
+      is.read (reinterpret_cast<char *> (&kind), 1);
+      if (is.eof ())
+        {
+          return true;
+        }
+      is.read (reinterpret_cast<char *> (&length), sizeof (length));
+      entry.resize (std::max<uint32_t> (length, 1));
+      is.read (&entry[0], length);
+      if (!is)
+        {
+          return false;
+        }
+      const char *data = &entry[0];
+      const char *end = data + length;
+
+      if (kind == LOG_BINARY_SITE)
+        {
+          uint32_t id;
+          Site site;
+          if (!ReadRaw (data, end, &id) || !ReadRaw (data, end, &site.line)
+              || !ReadRawString (data, end, &site.component)
+              || !ReadRawString (data, end, &site.file)
+              || !ReadRawString (data, end, &site.function))
+            {
+              return false;
+            }
+          sites[id] = site;
+          continue;
+        }
+      if (kind != LogBinaryRecord::MESSAGE && kind != LogBinaryRecord::FUNCTION)
+        {
+          return false;
+        }
+
+      uint32_t id;
+      uint32_t level;
+      int64_t ts;
+      uint32_t context;
+      if (!ReadRaw (data, end, &id) || !ReadRaw (data, end, &level)
+          || !ReadRaw (data, end, &ts) || !ReadRaw (data, end, &context))
+        {
+          return false;
+        }
+      std::map<uint32_t, Site>::const_iterator site = sites.find (id);
+      if (site == sites.end ())
+        {
+          return false;
+        }
+      if (!component.empty () && site->second.component != component)
+        {
+          continue;
+        }
+
+      // same prefixes as the NS_LOG macros and the simulator printers
+      if (prefixes & LOG_PREFIX_TIME)
+        {
+          uint64_t abs = ts < 0 ? -static_cast<uint64_t> (ts) : ts;
+          os << (ts < 0 ? "-" : "+") << abs / 1000000000 << "."
+             << std::setfill ('0') << std::setw (9) << abs % 1000000000
+             << std::setfill (' ') << "s ";
+        }
+      if (prefixes & LOG_PREFIX_NODE)
+        {
+          if (context == 0xffffffff)
+            {
+              os << "-1 ";
+            }
+          else
+            {
+              os << context << " ";
+            }
+        }
+      if (kind == LogBinaryRecord::FUNCTION)
+        {
+          os << site->second.component << ":" << site->second.function << "(";
+        }
+      else
+        {
+          if (prefixes & LOG_PREFIX_FUNC)
+            {
+              os << site->second.component << ":" << site->second.function << "(): ";
+            }
+          if (prefixes & LOG_PREFIX_LEVEL)
+            {
+              os << "[" << LogComponent::GetLevelLabel (static_cast<enum LogLevel> (level)) << "] ";
+            }
+        }
+      if (!RenderArguments (data, end, os))
+        {
+          return false;
+        }
+      if (kind == LogBinaryRecord::FUNCTION)
+        {
+          os << ")";
+        }
+      os << std::endl;
+    }
+}
+
+} // namespace ns3
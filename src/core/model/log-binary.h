@@ -0,0 +1,383 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NS3_LOG_BINARY_H
+#define NS3_LOG_BINARY_H
+
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup logging
+ * Binary logging backend declarations.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup logging
+ * \defgroup logbinary Binary logging
+ *
+ * \brief Record the log messages in a binary file, and render them offline.
+ *
+ * Formatting the log messages on \c std::clog is often the main cost of
+ * a simulation with logging enabled.  When the binary backend is open,
+ * the NS_LOG macros record instead the call site, the level, the
+ * simulation time, the context and the raw arguments of each message
+ * in a ring buffer, which is written to a binary file when it is full
+ * and when the backend is closed.  Only the arguments without a binary
+ * representation, e.g., addresses or times, are formatted when logged.
+ * The \c log-decode program renders the file as the text the messages
+ * would have been logged as:
+ * \code
+ *   $ NS_LOG="WifiElements=info|prefix_all" NS_LOG_BINARY="run.nslog" ./waf --run ...
+ *   $ ./waf --run "log-decode --file=run.nslog"
+ * \endcode
+ *
+ * The backend is opened with LogBinaryOpen(), or by setting the
+ * \c NS_LOG_BINARY environment variable to
+ * <tt>file[:size=bytes][:wrap]</tt>.  In the \c wrap mode, the ring buffer
+ * is only written when the backend is closed, and keeps the most recent
+ * messages, like a flight recorder.
+ *
+ * A process forked while the backend is open never writes to the file
+ * of its parent, and LogBinaryReopen() gives it its own file.  The
+ * branches of WarmStart::Fork() are given one each.
+ *
+ * The binary records are rendered with all the prefixes, whatever the
+ * prefixes enabled for their components, but without the
+ * NS_LOG_APPEND_CONTEXT of the files logging them.  The stream
+ * manipulators changing the formatting of the following arguments,
+ * e.g., \c std::hex or \c std::setw, are ignored.  NS_LOG_UNCOND is
+ * always written to \c std::clog.
+ *
+ * The logging macros are only enabled in the debug builds, or in all
+ * builds configured with \c --enable-logs.
+ */
+
+/**
+ * \ingroup logbinary
+ * Function signature for getting the simulation time, in nanoseconds,
+ * and the context of a binary log record.
+ *
+ * \param [out] ts The simulation time.
+ * \param [out] context The context.
+ */
+typedef void (*LogBinaryStamper)(int64_t *ts, uint32_t *context);
+
+/**
+ * \ingroup logbinary
+ * Set the LogBinaryStamper function used to stamp the binary log records.
+ *
+ * \param [in] stamper The LogBinaryStamper function, or 0 to stamp the
+ *             records with time 0 and no context.
+ */
+void LogBinarySetStamper (LogBinaryStamper stamper);
+
+/**
+ * \ingroup logbinary
+ * Record the log messages in a binary file, rather than on \c std::clog.
+ *
+ * Any binary file open is closed first.
+ *
+ * \param [in] filename The name of the file.
+ * \param [in] size The size of the ring buffer, in bytes.
+ * \param [in] wrap If \c true, only write the most recent records to the
+ *             file when it is closed, rather than all of them.
+ * \return \c false if the file could not be opened.
+ */
+bool LogBinaryOpen (const std::string &filename, uint32_t size = 4 << 20, bool wrap = false);
+
+/**
+ * \ingroup logbinary
+ * Write the buffered records to the binary file and close it.
+ *
+ * The log messages are written on \c std::clog again.
+ */
+void LogBinaryClose (void);
+
+/**
+ * \ingroup logbinary
+ * Write the buffered records to the binary file.
+ *
+ * A process forked while the file is open inherits the buffered records,
+ * but never writes them, nor anything else, to the file of its parent:
+ * flush the records before forking, lest they be lost.
+ */
+void LogBinaryFlush (void);
+
+/**
+ * \ingroup logbinary
+ * Record the log messages of a forked process in its own binary file.
+ *
+ * The file of the parent process is left to it, and the records it
+ * buffered are dropped.  The new file is named after the file of the
+ * parent process, and has the same buffer size and mode.
+ *
+ * \param [in] suffix The suffix appended to the name of the file of
+ *             the parent process.
+ * \return \c false if the backend is not open, or if the new file could
+ *         not be opened.
+ */
+bool LogBinaryReopen (const std::string &suffix);
+
+/**
+ * \ingroup logbinary
+ * \return \c true if the log messages are recorded in a binary file.
+ */
+bool LogBinaryIsOpen (void);
+
+/**
+ * \ingroup logbinary
+ * Register a log call site with the binary backend.
+ *
+ * \internal
+ * Logging implementation function; should not be called directly.
+ *
+ * \param [in] component The name of the log component.
+ * \param [in] file The file of the call site.
+ * \param [in] line The line of the call site.
+ * \param [in] function The function of the call site.
+ * \return The identifier of the call site.
+ */
+uint32_t LogBinaryRegisterSite (const char *component, const char *file,
+                                uint32_t line, const char *function);
+
+/**
+ * \ingroup logbinary
+ * Render the records of a binary log file as text.
+ *
+ * \param [in] is The binary log.
+ * \param [in] os The output stream to render the records on.
+ * \param [in] prefixes The prefixes of the rendered messages, among
+ *             LOG_PREFIX_FUNC, LOG_PREFIX_TIME, LOG_PREFIX_NODE and
+ *             LOG_PREFIX_LEVEL.
+ * \param [in] component If not empty, only render the records of this
+ *             log component.
+ * \return \c false if \p is is not a binary log, or is truncated.
+ */
+bool LogBinaryDecode (std::istream &is, std::ostream &os,
+                      uint32_t prefixes, const std::string &component = "");
+
+/**
+ * \ingroup logbinary
+ * A binary log record, built by the logging macros from the arguments
+ * streamed into it, and written to the ring buffer when destroyed.
+ *
+ * \internal
+ * Logging implementation class; should not be used directly.
+ */
+class LogBinaryRecord
+{
+public:
+  /** The kinds of records. */
+  enum Kind
+  {
+    MESSAGE = 2,   //!< A message of NS_LOG.
+    FUNCTION = 3   //!< The parameters of NS_LOG_FUNCTION.
+  };
+
+  /**
+   * Start a record.
+   *
+   * \param [in] site The identifier of the call site.
+   * \param [in] kind The kind of record.
+   * \param [in] level The log level.
+   */
+  LogBinaryRecord (uint32_t site, enum Kind kind, uint32_t level);
+  /** Write the record to the ring buffer. */
+  ~LogBinaryRecord ();
+
+  /**
+   * Record an argument.
+   * \param [in] value The argument.
+   * \return This LogBinaryRecord, so it's chainable.
+   */
+  LogBinaryRecord & operator<< (bool value);
+  /** \copydoc operator<<(bool) */
+  LogBinaryRecord & operator<< (char value);
+  /** \copydoc operator<<(bool) */
+  LogBinaryRecord & operator<< (signed char value);
+  /** \copydoc operator<<(bool) */
+  LogBinaryRecord & operator<< (unsigned char value);
+  /** \copydoc operator<<(bool) */
+  LogBinaryRecord & operator<< (short value);
+  /** \copydoc operator<<(bool) */
+  LogBinaryRecord & operator<< (unsigned short value);
+  /** \copydoc operator<<(bool) */
+  LogBinaryRecord & operator<< (int value);
+  /** \copydoc operator<<(bool) */
+  LogBinaryRecord & operator<< (unsigned int value);
+  /** \copydoc operator<<(bool) */
+  LogBinaryRecord & operator<< (long value);
+  /** \copydoc operator<<(bool) */
+  LogBinaryRecord & operator<< (unsigned long value);
+  /** \copydoc operator<<(bool) */
+  LogBinaryRecord & operator<< (long long value);
+  /** \copydoc operator<<(bool) */
+  LogBinaryRecord & operator<< (unsigned long long value);
+  /** \copydoc operator<<(bool) */
+  LogBinaryRecord & operator<< (float value);
+  /** \copydoc operator<<(bool) */
+  LogBinaryRecord & operator<< (double value);
+  /** \copydoc operator<<(bool) */
+  LogBinaryRecord & operator<< (const char *value);
+  /** \copydoc operator<<(bool) */
+  LogBinaryRecord & operator<< (char *value);
+  /** \copydoc operator<<(bool) */
+  LogBinaryRecord & operator<< (const std::string &value);
+  /** \copydoc operator<<(bool) */
+  LogBinaryRecord & operator<< (std::string &value);
+  /**
+   * Record a stream manipulator, e.g. \c std::endl, as its output.
+   * \param [in] manipulator The manipulator.
+   * \return This LogBinaryRecord, so it's chainable.
+   */
+  LogBinaryRecord & operator<< (std::ostream & (*manipulator)(std::ostream &));
+  /**
+   * Record a pointer, as its address.
+   * \param [in] value The pointer.
+   * \return This LogBinaryRecord, so it's chainable.
+   */
+  template <typename T>
+  LogBinaryRecord & operator<< (T *value);
+  /**
+   * Record a function pointer, as its output, e.g., of a manipulator
+   * of \c std::ios_base.
+   * \param [in] value The function pointer.
+   * \return This LogBinaryRecord, so it's chainable.
+   */
+  template <typename R, typename... A>
+  LogBinaryRecord & operator<< (R (*value)(A...));
+  /**
+   * Record an argument without a binary representation, as the string
+   * its output operator formats.
+   * \param [in] value The argument.
+   * \return This LogBinaryRecord, so it's chainable.
+   */
+  template <typename T>
+  LogBinaryRecord & operator<< (const T &value);
+  /**
+   * \copydoc operator<<(const T&)
+   *
+   * Some output operators take a non-const reference to their argument.
+   */
+  template <typename T>
+  LogBinaryRecord & operator<< (T &value);
+  /**
+   * Record each element of a vector of parameters of NS_LOG_FUNCTION.
+   * \param [in] vector The vector.
+   * \return This LogBinaryRecord, so it's chainable.
+   */
+  template <typename T>
+  LogBinaryRecord & operator<< (std::vector<T> vector);
+
+private:
+  /** Insert the separator of the parameters of NS_LOG_FUNCTION. */
+  void Separate (void);
+  /**
+   * Append a tagged value to the record.
+   * \param [in] tag The type of the value.
+   * \param [in] data The bytes of the value.
+   * \param [in] size The number of bytes.
+   */
+  void Append (char tag, const void *data, uint32_t size);
+  /**
+   * Append a string to the record.
+   * \param [in] data The characters of the string.
+   * \param [in] size The number of characters.
+   */
+  void AppendString (const char *data, uint32_t size);
+  /**
+   * Append the string formatted by the output operator of a value.
+   * \param [in] value The value.
+   */
+  template <typename T>
+  void AppendFormatted (T &value);
+  /**
+   * Append a pointer to the record.
+   * \param [in] value The pointer.
+   */
+  void AppendPointer (const void *value);
+
+  std::string *m_data;   //!< The bytes of the record, reused by the thread.
+  enum Kind m_kind;      //!< The kind of record.
+  bool m_parameters;     //!< Are the arguments parameters of NS_LOG_FUNCTION?
+  bool m_first;          //!< Is the next parameter the first one?
+};
+
+template <typename T>
+LogBinaryRecord &
+LogBinaryRecord::operator<< (T *value)
+{
+  Separate ();
+  AppendPointer (value);
+  return *this;
+}
+
+template <typename T>
+void
+LogBinaryRecord::AppendFormatted (T &value)
+{
+  Separate ();
+  std::ostringstream oss;
+  oss << value;
+  std::string s = oss.str ();
+  AppendString (s.data (), s.size ());
+}
+
+template <typename R, typename... A>
+LogBinaryRecord &
+LogBinaryRecord::operator<< (R (*value)(A...))
+{
+  AppendFormatted (value);
+  return *this;
+}
+
+template <typename T>
+LogBinaryRecord &
+LogBinaryRecord::operator<< (const T &value)
+{
+  AppendFormatted (value);
+  return *this;
+}
+
+template <typename T>
+LogBinaryRecord &
+LogBinaryRecord::operator<< (T &value)
+{
+  AppendFormatted (value);
+  return *this;
+}
+
+template <typename T>
+LogBinaryRecord &
+LogBinaryRecord::operator<< (std::vector<T> vector)
+{
+  for (typename std::vector<T>::const_iterator i = vector.begin (); i != vector.end (); ++i)
+    {
+      *this << *i;
+    }
+  return *this;
+}
+
+} // namespace ns3
+
+#endif /* NS3_LOG_BINARY_H */
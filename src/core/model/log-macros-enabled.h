@@ -90,6 +90,32 @@
     }                                                           \
 
 
+/**
+ * \ingroup logging
+ * Record a log message with the binary backend.
+ *
+ * The call site is registered once, the first time it logs.
+ *
+ * \param [in] kind The kind of record.
+ * \param [in] level The log level.
+ * \param [in] args The arguments streamed into the record, e.g.,
+ *             <tt><< msg</tt>.
+ * \internal
+ * Logging implementation macro; should not be called directly.
+ */
+#define NS_LOG_BINARY_RECORD(kind, level, args)                 \
+  do                                                            \
+    {                                                           \
+      static const uint32_t ns3LogBinarySite =                  \
+        ns3::LogBinaryRegisterSite (g_log.Name (), __FILE__,    \
+                                    __LINE__, __FUNCTION__);    \
+      ns3::LogBinaryRecord (ns3LogBinarySite,                   \
+                            ns3::LogBinaryRecord::kind,         \
+                            level) args;                        \
+    }                                                           \
+  while (false)
+
+
 #ifndef NS_LOG_APPEND_CONTEXT
 /**
  * \ingroup logging
@@ -155,6 +181,11 @@
     {                                                           \
       if (g_log.IsEnabled (level))                              \
         {                                                       \
+          if (ns3::LogBinaryIsOpen ())                          \
+            {                                                   \
+              NS_LOG_BINARY_RECORD (MESSAGE, level, << msg);    \
+              break;                                            \
+            }                                                   \
           NS_LOG_APPEND_TIME_PREFIX;                            \
           NS_LOG_APPEND_NODE_PREFIX;                            \
           NS_LOG_APPEND_CONTEXT;                                \
@@ -179,6 +210,11 @@
     {                                                           \
       if (g_log.IsEnabled (ns3::LOG_FUNCTION))                  \
         {                                                       \
+          if (ns3::LogBinaryIsOpen ())                          \
+            {                                                   \
+              NS_LOG_BINARY_RECORD (FUNCTION, ns3::LOG_FUNCTION, ); \
+              break;                                            \
+            }                                                   \
           NS_LOG_APPEND_TIME_PREFIX;                            \
           NS_LOG_APPEND_NODE_PREFIX;                            \
           NS_LOG_APPEND_CONTEXT;                                \
@@ -216,6 +252,12 @@
     {                                                           \
       if (g_log.IsEnabled (ns3::LOG_FUNCTION))                  \
         {                                                       \
+          if (ns3::LogBinaryIsOpen ())                          \
+            {                                                   \
+              NS_LOG_BINARY_RECORD (FUNCTION, ns3::LOG_FUNCTION,  \
+                                    << parameters);             \
+              break;                                            \
+            }                                                   \
           NS_LOG_APPEND_TIME_PREFIX;                            \
           NS_LOG_APPEND_NODE_PREFIX;                            \
           NS_LOG_APPEND_CONTEXT;                                \
@@ -27,6 +27,7 @@
 #include <map>
 #include <vector>
 
+#include "log-binary.h"
 #include "log-macros-enabled.h"
 #include "log-macros-disabled.h"
 
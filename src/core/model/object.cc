@@ -46,6 +46,8 @@ NS_LOG_COMPONENT_DEFINE ("Object");
 
 NS_OBJECT_ENSURE_REGISTERED (Object);
 
+const uint32_t Object::CACHE_SIZE;
+
 Object::AggregateIterator::AggregateIterator ()
   : m_object (0),
     m_current (0)
@@ -97,11 +99,10 @@ Object::Object ()
   : m_tid (Object::GetTypeId ()),
     m_disposed (false),
     m_initialized (false),
-    m_aggregates ((struct Aggregates *) std::malloc (sizeof (struct Aggregates))),
+    m_aggregates (AllocateAggregates (1)),
     m_getObjectCount (0)
 {
   NS_LOG_FUNCTION (this);
-  m_aggregates->n = 1;
   m_aggregates->buffer[0] = this;
 }
 Object::~Object () 
@@ -120,6 +121,8 @@ Object::~Object ()
           m_aggregates->n--;
         }
     }
+  // the cache may point to this object
+  ClearCache (m_aggregates);
   // finally, if all objects have been removed from the list,
   // delete the aggregate list
   if (m_aggregates->n == 0)
@@ -132,10 +135,9 @@ Object::Object (const Object &o)
   : m_tid (o.m_tid),
     m_disposed (false),
     m_initialized (false),
-    m_aggregates ((struct Aggregates *) std::malloc (sizeof (struct Aggregates))),
+    m_aggregates (AllocateAggregates (1)),
     m_getObjectCount (0)
 {
-  m_aggregates->n = 1;
   m_aggregates->buffer[0] = this;
 }
 void
@@ -145,39 +147,63 @@ Object::Construct (const AttributeConstructionList &attributes)
   ConstructSelf (attributes);
 }
 
+Object::Aggregates *
+Object::AllocateAggregates (uint32_t n)
+{
+  NS_LOG_FUNCTION (n);
+  NS_ASSERT (n > 0);
+  struct Aggregates *aggregates = 
+    (struct Aggregates *)std::malloc (sizeof(struct Aggregates)+(n-1)*sizeof(Object*));
+  aggregates->n = n;
+  ClearCache (aggregates);
+  return aggregates;
+}
+void
+Object::ClearCache (struct Aggregates *aggregates)
+{
+  NS_LOG_FUNCTION (aggregates);
+  std::memset (aggregates->cachedTids, 0, sizeof (aggregates->cachedTids));
+}
+
 Ptr<Object>
 Object::DoGetObject (TypeId tid) const
 {
   NS_LOG_FUNCTION (this << tid);
   NS_ASSERT (CheckLoose ());
 
+  // The result of the lookups, including the failed ones, is cached
+  // until the aggregation changes: TypeIds are direct-mapped to the
+  // slots of the cache by their uid.
+  uint16_t uid = tid.GetUid ();
+  uint32_t slot = uid % CACHE_SIZE;
+  if (m_aggregates->cachedTids[slot] == uid && uid != 0)
+    {
+      return m_aggregates->cachedObjects[slot];
+    }
+
+  Object *found = 0;
   uint32_t n = m_aggregates->n;
-  TypeId objectTid = Object::GetTypeId ();
   for (uint32_t i = 0; i < n; i++)
     {
       Object *current = m_aggregates->buffer[i];
       TypeId cur = current->GetInstanceTypeId ();
-      while (cur != tid && cur != objectTid)
+      if (cur == tid || cur.IsChildOf (tid))
         {
-          cur = cur.GetParent ();
-        }
-      if (cur == tid)
-        {
-          // This is an attempt to 'cache' the result of this lookup.
-          // the idea is that if we perform a lookup for a TypeId on this object,
-          // we are likely to perform the same lookup later so, we make sure
-          // that the aggregate array is sorted by the number of accesses
-          // to each object.
+          // Sort the aggregate array by the number of accesses
+          // to each object, so that the misses of the cache find
+          // the most used objects first.
 
           // first, increment the access count
           current->m_getObjectCount++;
           // then, update the sort
           UpdateSortedArray (m_aggregates, i);
-          // finally, return the match
-          return const_cast<Object *> (current);
+          found = current;
+          break;
         }
     }
-  return 0;
+  m_aggregates->cachedTids[slot] = uid;
+  m_aggregates->cachedObjects[slot] = found;
+  return found;
 }
 void
 Object::Initialize (void)
@@ -260,9 +286,7 @@ Object::AggregateObject (Ptr<Object> o)
   Object *other = PeekPointer (o);
   // first create the new aggregate buffer.
   uint32_t total = m_aggregates->n + other->m_aggregates->n;
-  struct Aggregates *aggregates = 
-    (struct Aggregates *)std::malloc (sizeof(struct Aggregates)+(total-1)*sizeof(Object*));
-  aggregates->n = total;
+  struct Aggregates *aggregates = AllocateAggregates (total);
 
   // copy our buffer to the new buffer
   std::memcpy (&aggregates->buffer[0], 
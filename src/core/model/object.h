@@ -320,6 +320,9 @@ private:
   friend class AggregateIterator;
   friend struct ObjectDeleter;
 
+  /** The number of slots of the GetObject() cache of the aggregates. */
+  static const uint32_t CACHE_SIZE = 8;
+
   /**
    * The list of Objects aggregated to this one.
    *
@@ -331,14 +334,35 @@ private:
    * chunk of memory than the struct to allow space for a larger
    * variable sized buffer whose size is indicated by the element
    * \c n
+   *
+   * The result of the last GetObject() calls is cached, indexed by
+   * the uid of the TypeId looked up, until the aggregation changes.
    */
   struct Aggregates {
     /** The number of entries in \c buffer. */
     uint32_t n;
+    /** The uid of the TypeId cached in each slot, 0 if the slot is empty. */
+    uint16_t cachedTids[CACHE_SIZE];
+    /** The Object found for the TypeId cached in each slot, if any. */
+    Object *cachedObjects[CACHE_SIZE];
     /** The array of Objects. */
     Object *buffer[1];
   };
 
+  /**
+   * Allocate a list of aggregates, with an empty cache.
+   *
+   * \param [in] n The number of entries of the list.
+   * \return The list of aggregates, to be freed with std::free.
+   */
+  static struct Aggregates * AllocateAggregates (uint32_t n);
+  /**
+   * Empty the GetObject() cache of a list of aggregates.
+   *
+   * \param [in,out] aggregates The list of aggregated Objects.
+   */
+  static void ClearCache (struct Aggregates *aggregates);
+
   /**
    * Find an Object of TypeId tid in the aggregates of this Object.
    *
@@ -458,14 +482,8 @@ template <typename T>
 Ptr<T> 
 Object::GetObject () const
 {
-  // This is an optimization: if the cast works (which is likely),
-  // things will be pretty fast.
-  T *result = dynamic_cast<T *> (m_aggregates->buffer[0]);
-  if (result != 0)
-    {
-      return Ptr<T> (result);
-    }
-  // if the cast does not work, we try to do a full type check.
+  // The lookups are cached by DoGetObject, so that repeated calls
+  // are pretty fast.
   Ptr<Object> found = DoGetObject (T::GetTypeId ());
   if (found != 0)
     {
@@ -72,8 +72,11 @@ RandomVariableStream::GetTypeId (void)
   return tid;
 }
 
+const uint32_t RandomVariableStream::PREFETCH_SIZE;
+
 RandomVariableStream::RandomVariableStream()
-  : m_rng (0)
+  : m_rng (0),
+    m_nextPrefetched (PREFETCH_SIZE)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -122,6 +125,8 @@ RandomVariableStream::SetStream (int64_t stream)
                              target,
                              RngSeedManager::GetRun ());
     }
+  // the numbers prefetched from the previous RngStream are discarded
+  m_nextPrefetched = PREFETCH_SIZE;
   m_stream = stream;
 }
 int64_t
@@ -138,6 +143,16 @@ RandomVariableStream::Peek(void) const
   return m_rng;
 }
 
+void
+RandomVariableStream::GetValues (double *values, uint32_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      values[i] = GetValue ();
+    }
+}
+
 NS_OBJECT_ENSURE_REGISTERED(UniformRandomVariable);
 
 TypeId 
@@ -181,7 +196,7 @@ double
 UniformRandomVariable::GetValue (double min, double max)
 {
   NS_LOG_FUNCTION (this << min << max);
-  double v = min + Peek ()->RandU01 () * (max - min);
+  double v = min + RandU01 () * (max - min);
   if (IsAntithetic ())
     {
       v = min + (max - v);
@@ -202,6 +217,23 @@ UniformRandomVariable::GetValue (void)
   NS_LOG_FUNCTION (this);
   return GetValue (m_min, m_max);
 }
+void
+UniformRandomVariable::GetValues (double *values, uint32_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  double min = m_min;
+  double max = m_max;
+  bool isAntithetic = IsAntithetic ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      double v = min + RandU01 () * (max - min);
+      if (isAntithetic)
+        {
+          v = min + (max - v);
+        }
+      values[i] = v;
+    }
+}
 uint32_t 
 UniformRandomVariable::GetInteger (void)
 {
@@ -410,7 +442,7 @@ ExponentialRandomVariable::GetValue (double mean, double bound)
   while (1)
     {
       // Get a uniform random variable in [0,1].
-      double v = Peek ()->RandU01 ();
+      double v = RandU01 ();
       if (IsAntithetic ())
         {
           v = (1 - v);
@@ -439,6 +471,28 @@ ExponentialRandomVariable::GetValue (void)
   NS_LOG_FUNCTION (this);
   return GetValue (m_mean, m_bound);
 }
+void
+ExponentialRandomVariable::GetValues (double *values, uint32_t n)
+{
+  NS_LOG_FUNCTION (this << values << n);
+  double mean = m_mean;
+  double bound = m_bound;
+  bool isAntithetic = IsAntithetic ();
+  uint32_t i = 0;
+  while (i < n)
+    {
+      double v = RandU01 ();
+      if (isAntithetic)
+        {
+          v = (1 - v);
+        }
+      double r = -mean*std::log (v);
+      if (bound == 0 || r <= bound)
+        {
+          values[i++] = r;
+        }
+    }
+}
 uint32_t 
 ExponentialRandomVariable::GetInteger (void)
 {
@@ -529,7 +583,7 @@ ParetoRandomVariable::GetValue (double scale, double shape, double bound)
   while (1)
     {
       // Get a uniform random variable in [0,1].
-      double v = Peek ()->RandU01 ();
+      double v = RandU01 ();
       if (IsAntithetic ())
         {
           v = (1 - v);
@@ -623,7 +677,7 @@ WeibullRandomVariable::GetValue (double scale, double shape, double bound)
   while (1)
     {
       // Get a uniform random variable in [0,1].
-      double v = Peek ()->RandU01 ();
+      double v = RandU01 ();
       if (IsAntithetic ())
         {
           v = (1 - v);
@@ -726,8 +780,8 @@ NormalRandomVariable::GetValue (double mean, double variance, double bound)
     { // See Simulation Modeling and Analysis p. 466 (Averill Law)
       // for algorithm; basically a Box-Muller transform:
       // http://en.wikipedia.org/wiki/Box-Muller_transform
-      double u1 = Peek ()->RandU01 ();
-      double u2 = Peek ()->RandU01 ();
+      double u1 = RandU01 ();
+      double u2 = RandU01 ();
       if (IsAntithetic ())
         {
           u1 = (1 - u1);
@@ -856,8 +910,8 @@ LogNormalRandomVariable::GetValue (double mu, double sigma)
     {
       /* choose x,y in uniform square (-1,-1) to (+1,+1) */
 
-      double u1 = Peek ()->RandU01 ();
-      double u2 = Peek ()->RandU01 ();
+      double u1 = RandU01 ();
+      double u2 = RandU01 ();
       if (IsAntithetic ())
         {
           u1 = (1 - u1);
@@ -963,7 +1017,7 @@ GammaRandomVariable::GetValue (double alpha, double beta)
   NS_LOG_FUNCTION (this << alpha << beta);
   if (alpha < 1)
     {
-      double u = Peek ()->RandU01 ();
+      double u = RandU01 ();
       if (IsAntithetic ())
         {
           u = (1 - u);
@@ -991,7 +1045,7 @@ GammaRandomVariable::GetValue (double alpha, double beta)
       while (v <= 0);
 
       v = v * v * v;
-      u = Peek ()->RandU01 ();
+      u = RandU01 ();
       if (IsAntithetic ())
         {
           u = (1 - u);
@@ -1042,8 +1096,8 @@ GammaRandomVariable::GetNormalValue (double mean, double variance, double bound)
     { // See Simulation Modeling and Analysis p. 466 (Averill Law)
       // for algorithm; basically a Box-Muller transform:
       // http://en.wikipedia.org/wiki/Box-Muller_transform
-      double u1 = Peek ()->RandU01 ();
-      double u2 = Peek ()->RandU01 ();
+      double u1 = RandU01 ();
+      double u2 = RandU01 ();
       if (IsAntithetic ())
         {
           u1 = (1 - u1);
@@ -1170,7 +1224,7 @@ ErlangRandomVariable::GetExponentialValue (double mean, double bound)
   while (1)
     {
       // Get a uniform random variable in [0,1].
-      double v = Peek ()->RandU01 ();
+      double v = RandU01 ();
       if (IsAntithetic ())
         {
           v = (1 - v);
@@ -1245,7 +1299,7 @@ TriangularRandomVariable::GetValue (double mean, double min, double max)
   double mode = 3.0 * mean - min - max;
 
   // Get a uniform random variable in [0,1].
-  double u = Peek ()->RandU01 ();
+  double u = RandU01 ();
   if (IsAntithetic ())
     {
       u = (1 - u);
@@ -1334,7 +1388,7 @@ ZipfRandomVariable::GetValue (uint32_t n, double alpha)
   m_c = 1.0 / m_c;
 
   // Get a uniform random variable in [0,1].
-  double u = Peek ()->RandU01 ();
+  double u = RandU01 ();
   if (IsAntithetic ())
     {
       u = (1 - u);
@@ -1415,14 +1469,14 @@ ZetaRandomVariable::GetValue (double alpha)
   do
     {
       // Get a uniform random variable in [0,1].
-      u = Peek ()->RandU01 ();
+      u = RandU01 ();
       if (IsAntithetic ())
         {
           u = (1 - u);
         }
 
       // Get a uniform random variable in [0,1].
-      v = Peek ()->RandU01 ();
+      v = RandU01 ();
       if (IsAntithetic ())
         {
           v = (1 - v);
@@ -1582,7 +1636,7 @@ EmpiricalRandomVariable::GetValue (void)
     }
 
   // Get a uniform random variable in [0,1].
-  double r = Peek ()->RandU01 ();
+  double r = RandU01 ();
   if (IsAntithetic ())
     {
       r = (1 - r);
@@ -29,6 +29,7 @@
 #include "type-id.h"
 #include "object.h"
 #include "attribute-helper.h"
+#include "rng-stream.h"
 #include <stdint.h>
 
 /**
@@ -69,7 +70,6 @@ namespace ns3 {
  *   section on how to perform independent replications.
  */
   
-class RngStream;
 
 /**
  * \ingroup randomvariable
@@ -149,13 +149,40 @@ public:
    */
   virtual uint32_t GetInteger (void) = 0;
 
+  /**
+   * \brief Get the next random values drawn from the distribution.
+   *
+   * The values are the same as those returned by \p n calls to
+   * GetValue(), but the attributes of the distribution are read once
+   * for the whole batch.
+   *
+   * \param [out] values The array of values to fill.
+   * \param [in] n The number of values to draw.
+   */
+  virtual void GetValues (double *values, uint32_t n);
+
 protected:
   /**
    * \brief Get the pointer to the underlying RngStream.
+   *
+   * The numbers drawn directly from the RngStream skip those
+   * prefetched by RandU01(): use RandU01() instead.
+   *
    * \return The underlying RngStream
    */
   RngStream *Peek(void) const;
 
+  /**
+   * \brief Get the next uniform random number of the RngStream.
+   *
+   * The numbers are generated in batches and buffered, which is
+   * transparent as long as all the numbers are drawn with this method:
+   * the sequence of numbers of each stream and substream is unchanged.
+   *
+   * \return A uniform random number in [0,1).
+   */
+  double RandU01 (void);
+
 private:
   /**
    * Copy constructor.  These objects are not copyable.
@@ -178,9 +205,18 @@ private:
    */
   RandomVariableStream &operator = (const RandomVariableStream &o);
 
+  /** The number of uniform random numbers prefetched at once. */
+  static const uint32_t PREFETCH_SIZE = 16;
+
   /** Pointer to the underlying RngStream. */
   RngStream *m_rng;
 
+  /** The uniform random numbers prefetched from the RngStream. */
+  double m_prefetched[PREFETCH_SIZE];
+
+  /** The index of the next prefetched number to return. */
+  uint32_t m_nextPrefetched;
+
   /** Indicates if antithetic values should be generated by this RNG stream. */
   bool m_isAntithetic;
 
@@ -294,6 +330,7 @@ public:
    * \note The upper limit is included in the output range.
    */
   virtual uint32_t GetInteger (void);
+  virtual void GetValues (double *values, uint32_t n);
   
 private:
   /** The lower bound on values that can be returned by this RNG stream. */
@@ -586,6 +623,7 @@ public:
   // Inherited from RandomVariableStream
   virtual double GetValue (void);
   virtual uint32_t GetInteger (void);
+  virtual void GetValues (double *values, uint32_t n);
 
 private:
   /** The mean value of the unbounded exponential distribution. */
@@ -2546,6 +2584,17 @@ public:
 };  // class EmpiricalRandomVariable
   
 
+inline double
+RandomVariableStream::RandU01 (void)
+{
+  if (m_nextPrefetched == PREFETCH_SIZE)
+    {
+      m_rng->RandU01 (m_prefetched, PREFETCH_SIZE);
+      m_nextPrefetched = 0;
+    }
+  return m_prefetched[m_nextPrefetched++];
+}
+
 } // namespace ns3
 
 #endif /* RANDOM_VARIABLE_STREAM_H */
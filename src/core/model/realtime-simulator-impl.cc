@@ -31,9 +31,11 @@
 #include "system-mutex.h"
 #include "boolean.h"
 #include "enum.h"
+#include "uinteger.h"
 
 
 #include <cmath>
+#include <algorithm>
 
 
 /**
@@ -51,6 +53,8 @@ NS_LOG_COMPONENT_DEFINE ("RealtimeSimulatorImpl");
 
 NS_OBJECT_ENSURE_REGISTERED (RealtimeSimulatorImpl);
 
+const uint32_t RealtimeSimulatorImpl::LAG_BUCKETS;
+
 TypeId
 RealtimeSimulatorImpl::GetTypeId (void)
 {
@@ -69,6 +73,13 @@ RealtimeSimulatorImpl::GetTypeId (void)
                    TimeValue (Seconds (0.1)),
                    MakeTimeAccessor (&RealtimeSimulatorImpl::m_hardLimit),
                    MakeTimeChecker ())
+    .AddAttribute ("MaxCatchUpEvents",
+                   "Maximum number of events run in a row, without synchronizing "
+                   "again, while they are already due.  Values above 1 catch up "
+                   "faster with real time after falling behind.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&RealtimeSimulatorImpl::m_maxCatchUpEvents),
+                   MakeUintegerChecker<uint32_t> (1))
   ;
   return tid;
 }
@@ -87,9 +98,11 @@ RealtimeSimulatorImpl::RealtimeSimulatorImpl ()
   m_uid = 4; 
   // before ::Run is entered, the m_currentUid will be zero
   m_currentUid = 0;
+  m_eventCount = 0;
   m_currentTs = 0;
   m_currentContext = Simulator::NO_CONTEXT;
   m_unscheduledEvents = 0;
+  ResetLagHistogram ();
 
   m_main = SystemThread::Self();
 
@@ -316,6 +329,7 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
   // whatever event is at the head of this list if the list is in time order.
   //
   Scheduler::Event next;
+  uint64_t tsCatchUp;
 
   { 
     CriticalSection cs (m_mutex);
@@ -328,69 +342,118 @@ RealtimeSimulatorImpl::ProcessOneEvent (void)
     //
     NS_ASSERT_MSG (m_events->IsEmpty () == false, 
                    "RealtimeSimulatorImpl::ProcessOneEvent(): event queue is empty");
-    next = m_events->RemoveNext ();
-    m_unscheduledEvents--;
-
-    //
-    // We cannot make any assumption that "next" is the same event we originally waited 
-    // for.  We can only assume that only that it must be due and cannot cause time 
-    // to move backward.
-    //
-    NS_ASSERT_MSG (next.key.m_ts >= m_currentTs,
-                   "RealtimeSimulatorImpl::ProcessOneEvent(): "
-                   "next.GetTs() earlier than m_currentTs (list order error)");
-    NS_LOG_LOGIC ("handle " << next.key.m_ts);
+    tsCatchUp = m_synchronizer->GetCurrentRealtime ();
+    next = TakeNextEvent (tsCatchUp);
+  }
 
-    // 
-    // Update the current simulation time to be the timestamp of the event we're 
-    // executing.  From the rest of the simulation's point of view, simulation time
-    // is frozen until the next event is executed.
-    //
-    m_currentTs = next.key.m_ts;
-    m_currentContext = next.key.m_context;
-    m_currentUid = next.key.m_uid;
+  //
+  // We have got the event we're about to execute completely disentangled from the 
+  // event list so we can execute it outside a critical section without fear of someone
+  // changing things out from under us.
+  //
+  InvokeEvent (next);
 
-    // 
-    // We're about to run the event and we've done our best to synchronize this
-    // event execution time to real time.  Now, if we're in SYNC_HARD_LIMIT mode
-    // we have to decide if we've done a good enough job and if we haven't, we've
-    // been asked to commit ritual suicide.
-    //
-    // We check the simulation time against the current real time to make this
-    // judgement.
-    //
-    if (m_synchronizationMode == SYNC_HARD_LIMIT)
+  //
+  // If we have fallen behind, the events following this one may already be due.
+  // Going through the synchronizer for each of them costs a few clock reads and
+  // a round of the condition variable, only to learn there is nothing to wait
+  // for, so run up to m_maxCatchUpEvents of them in a row.  Only the events
+  // which were due when we took the first one are run: the events scheduled in
+  // real time meanwhile are later than these, so the events run in the same
+  // order as if we synchronized before each of them.
+  //
+  for (uint32_t i = 1; i < m_maxCatchUpEvents && !m_stop; i++)
+    {
       {
-        uint64_t tsFinal = m_synchronizer->GetCurrentRealtime ();
-        uint64_t tsJitter;
-
-        if (tsFinal >= m_currentTs)
-          {
-            tsJitter = tsFinal - m_currentTs;
-          }
-        else
-          {
-            tsJitter = m_currentTs - tsFinal;
-          }
+        CriticalSection cs (m_mutex);
 
-        if (tsJitter > static_cast<uint64_t> (m_hardLimit.GetTimeStep ()))
+        if (m_events->IsEmpty () || NextTs () > tsCatchUp)
           {
-            NS_FATAL_ERROR ("RealtimeSimulatorImpl::ProcessOneEvent (): "
-                            "Hard real-time limit exceeded (jitter = " << tsJitter << ")");
+            break;
           }
+        next = TakeNextEvent (m_synchronizer->GetCurrentRealtime ());
       }
-  }
+      InvokeEvent (next);
+    }
+}
+
+Scheduler::Event
+RealtimeSimulatorImpl::TakeNextEvent (uint64_t tsNow)
+{
+  Scheduler::Event next = m_events->RemoveNext ();
+  m_unscheduledEvents--;
 
   //
-  // We have got the event we're about to execute completely disentangled from the 
-  // event list so we can execute it outside a critical section without fear of someone
-  // changing things out from under us.
+  // We cannot make any assumption that "next" is the same event we originally waited 
+  // for.  We can only assume that only that it must be due and cannot cause time 
+  // to move backward.
+  //
+  NS_ASSERT_MSG (next.key.m_ts >= m_currentTs,
+                 "RealtimeSimulatorImpl::ProcessOneEvent(): "
+                 "next.GetTs() earlier than m_currentTs (list order error)");
+  NS_LOG_LOGIC ("handle " << next.key.m_ts);
+
+  // 
+  // Update the current simulation time to be the timestamp of the event we're 
+  // executing.  From the rest of the simulation's point of view, simulation time
+  // is frozen until the next event is executed.
+  //
+  m_currentTs = next.key.m_ts;
+  m_currentContext = next.key.m_context;
+  m_currentUid = next.key.m_uid;
+  m_eventCount++;
+
+  //
+  // Account for how late the event starts.  The events starting early are
+  // counted as on time, in the first bucket.
+  //
+  uint64_t lag = tsNow > m_currentTs ? (tsNow - m_currentTs) / 1000 : 0;
+  uint32_t bucket = 0;
+  while (lag != 0 && bucket < LAG_BUCKETS - 1)
+    {
+      lag >>= 1;
+      bucket++;
+    }
+  m_lagHistogram[bucket]++;
+
+  // 
+  // We're about to run the event and we've done our best to synchronize this
+  // event execution time to real time.  Now, if we're in SYNC_HARD_LIMIT mode
+  // we have to decide if we've done a good enough job and if we haven't, we've
+  // been asked to commit ritual suicide.
+  //
+  // We check the simulation time against the current real time to make this
+  // judgement.
+  //
+  if (m_synchronizationMode == SYNC_HARD_LIMIT)
+    {
+      uint64_t tsJitter;
 
-  EventImpl *event = next.impl;
+      if (tsNow >= m_currentTs)
+        {
+          tsJitter = tsNow - m_currentTs;
+        }
+      else
+        {
+          tsJitter = m_currentTs - tsNow;
+        }
+
+      if (tsJitter > static_cast<uint64_t> (m_hardLimit.GetTimeStep ()))
+        {
+          NS_FATAL_ERROR ("RealtimeSimulatorImpl::ProcessOneEvent (): "
+                          "Hard real-time limit exceeded (jitter = " << tsJitter << ")");
+        }
+    }
+  return next;
+}
+
+void
+RealtimeSimulatorImpl::InvokeEvent (const Scheduler::Event &event)
+{
   m_synchronizer->EventStart ();
-  event->Invoke ();
+  event.impl->Invoke ();
   m_synchronizer->EventEnd ();
-  event->Unref ();
+  event.impl->Unref ();
 }
 
 bool 
@@ -817,6 +880,12 @@ RealtimeSimulatorImpl::GetContext (void) const
   return m_currentContext;
 }
 
+uint64_t
+RealtimeSimulatorImpl::GetEventCount (void) const
+{
+  return m_eventCount;
+}
+
 void 
 RealtimeSimulatorImpl::SetSynchronizationMode (enum SynchronizationMode mode)
 {
@@ -845,4 +914,45 @@ RealtimeSimulatorImpl::GetHardLimit (void) const
   return m_hardLimit;
 }
 
+std::vector<uint64_t>
+RealtimeSimulatorImpl::GetLagHistogram (void) const
+{
+  CriticalSection cs (m_mutex);
+  return std::vector<uint64_t> (m_lagHistogram, m_lagHistogram + LAG_BUCKETS);
+}
+
+void
+RealtimeSimulatorImpl::ResetLagHistogram (void)
+{
+  NS_LOG_FUNCTION (this);
+  CriticalSection cs (m_mutex);
+  std::fill (m_lagHistogram, m_lagHistogram + LAG_BUCKETS, 0);
+}
+
+void
+RealtimeSimulatorImpl::PrintLagHistogram (std::ostream &os) const
+{
+  std::vector<uint64_t> histogram = GetLagHistogram ();
+  for (uint32_t i = 0; i < LAG_BUCKETS; i++)
+    {
+      if (histogram[i] == 0)
+        {
+          continue;
+        }
+      if (i == 0)
+        {
+          os << "< 1us";
+        }
+      else if (i == LAG_BUCKETS - 1)
+        {
+          os << ">= " << (1ULL << (i - 1)) << "us";
+        }
+      else
+        {
+          os << "[" << (1ULL << (i - 1)) << "us, " << (1ULL << i) << "us)";
+        }
+      os << ": " << histogram[i] << std::endl;
+    }
+}
+
 } // namespace ns3
@@ -32,6 +32,8 @@
 #include "system-mutex.h"
 
 #include <list>
+#include <ostream>
+#include <vector>
 
 /**
  * \file
@@ -107,6 +109,7 @@ public:
   virtual void SetScheduler (ObjectFactory schedulerFactory);
   virtual uint32_t GetSystemId (void) const; 
   virtual uint32_t GetContext (void) const;
+  virtual uint64_t GetEventCount (void) const;
 
   /** \copydoc ScheduleWithContext(uint32_t,const Time&,EventImpl*) */
   void ScheduleRealtimeWithContext (uint32_t context, const Time &delay, EventImpl *event);
@@ -154,6 +157,28 @@ public:
    */
   Time GetHardLimit (void) const;
 
+  /** Number of buckets of the histogram of the event lags. */
+  static const uint32_t LAG_BUCKETS = 32;
+  /**
+   * Get the histogram of how late the events started behind real time.
+   *
+   * Bucket 0 counts the events which started less than 1 us late, and
+   * bucket \c i the events which started between 2^(i-1) and 2^i us late.
+   * The last bucket also counts all the longer lags.
+   *
+   * \returns The number of events of each of the LAG_BUCKETS buckets.
+   */
+  std::vector<uint64_t> GetLagHistogram (void) const;
+  /** Clear the histogram of the event lags. */
+  void ResetLagHistogram (void);
+  /**
+   * Print the non-empty buckets of the histogram of the event lags,
+   * one per line.
+   *
+   * \param [in,out] os The output stream.
+   */
+  void PrintLagHistogram (std::ostream &os) const;
+
 private:
   /**
    * Is the simulator running?
@@ -170,8 +195,21 @@ private:
    * \returns The timestep of the next event.
    */
   uint64_t NextTs (void) const;
-  /** Process the next event. */
+  /** Process the next event, and the events already due after it. */
   void ProcessOneEvent (void);
+  /**
+   * Take the next event out of the event list, make it the current event
+   * and account for its lag behind real time.
+   * Should be called with the critical section locked.
+   * \param [in] tsNow The current real time.
+   * \returns The next event.
+   */
+  Scheduler::Event TakeNextEvent (uint64_t tsNow);
+  /**
+   * Run an event taken out of the event list.
+   * \param [in] event The event.
+   */
+  void InvokeEvent (const Scheduler::Event &event);
   /** Destructor implementation. */
   virtual void DoDispose (void);
 
@@ -198,10 +236,14 @@ private:
   uint32_t m_uid;
   /**< Unique id of the current event. */
   uint32_t m_currentUid;
+  /**< Number of events executed. */
+  uint64_t m_eventCount;
   /**< Timestep of the current event. */
   uint64_t m_currentTs;
   /**< Execution context. */
   uint32_t m_currentContext;  
+  /**< Histogram of the event lags. */
+  uint64_t m_lagHistogram[LAG_BUCKETS];
   /**@}*/
 
   /** Mutex to control access to key state. */  
@@ -216,6 +258,9 @@ private:
   /** The maximum allowable drift from real-time in SYNC_HARD_LIMIT mode. */
   Time m_hardLimit;
 
+  /** The maximum number of due events run without synchronizing again. */
+  uint32_t m_maxCatchUpEvents;
+
   /** Main SystemThread. */
   SystemThread::ThreadId m_main;
 };
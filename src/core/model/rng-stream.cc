@@ -360,6 +360,48 @@ double RngStream::RandU01 ()
   return u;
 }
 
+void RngStream::RandU01 (double *values, uint32_t n)
+{
+  // The recurrence of each component is serial, so that vector
+  // instructions can't compute several numbers of a stream at once.
+  // Instead, the batch is computed on 64-bit integers: the products
+  // are below 2^53 and the negative multipliers are applied to m - s,
+  // so that the sums can't overflow, and the reductions modulo the
+  // constant moduli are compiled to multiplications and shifts rather
+  // than divisions, without the unpredictable branches of RandU01().
+  // The states are integers below 2^32, exactly represented as doubles,
+  // so that the numbers are exactly those returned by RandU01().
+  const uint64_t im1 = static_cast<uint64_t> (m1);
+  const uint64_t im2 = static_cast<uint64_t> (m2);
+  const uint64_t ia12 = static_cast<uint64_t> (a12);
+  const uint64_t ia13n = static_cast<uint64_t> (a13n);
+  const uint64_t ia21 = static_cast<uint64_t> (a21);
+  const uint64_t ia23n = static_cast<uint64_t> (a23n);
+  uint64_t s0 = static_cast<uint64_t> (m_currentState[0]);
+  uint64_t s1 = static_cast<uint64_t> (m_currentState[1]);
+  uint64_t s2 = static_cast<uint64_t> (m_currentState[2]);
+  uint64_t s3 = static_cast<uint64_t> (m_currentState[3]);
+  uint64_t s4 = static_cast<uint64_t> (m_currentState[4]);
+  uint64_t s5 = static_cast<uint64_t> (m_currentState[5]);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      /* Component 1 */
+      uint64_t p1 = (ia12 * s1 + ia13n * (im1 - s0)) % im1;
+      s0 = s1; s1 = s2; s2 = p1;
+
+      /* Component 2 */
+      uint64_t p2 = (ia21 * s5 + ia23n * (im2 - s3)) % im2;
+      s3 = s4; s4 = s5; s5 = p2;
+
+      /* Combination */
+      int64_t d = static_cast<int64_t> (p1) - static_cast<int64_t> (p2);
+      d += (d <= 0) ? static_cast<int64_t> (im1) : 0;
+      values[i] = d * norm;
+    }
+  m_currentState[0] = s0; m_currentState[1] = s1; m_currentState[2] = s2;
+  m_currentState[3] = s3; m_currentState[4] = s4; m_currentState[5] = s5;
+}
+
 RngStream::RngStream (uint32_t seedNumber, uint64_t stream, uint64_t substream)
 {
   if (seedNumber >= m1 || seedNumber >= m2 || seedNumber == 0)
@@ -70,6 +70,17 @@ public:
    * \returns The next random.
    */
   double RandU01 (void);
+  /**
+   * Generate the next \p n random numbers for this stream.
+   * Uniformly distributed between 0 and 1.
+   *
+   * The numbers are the same as those returned by \p n calls to
+   * RandU01(), but they are generated faster.
+   *
+   * \param [out] values The array of random numbers to fill.
+   * \param [in] n The number of random numbers to generate.
+   */
+  void RandU01 (double *values, uint32_t n);
 
 private:
   /**
@@ -132,6 +132,20 @@ NodePrinter (std::ostream &os)
     }
 }
 
+/**
+ * \ingroup logbinary
+ * Default binary log record stamper implementation.
+ *
+ * \param [out] ts The simulation time, in nanoseconds.
+ * \param [out] context The context.
+ */
+static void
+BinaryStamper (int64_t *ts, uint32_t *context)
+{
+  *ts = Simulator::Now ().GetNanoSeconds ();
+  *context = Simulator::GetContext ();
+}
+
 /**
  * \ingroup simulator
  * \brief Get the static SimulatorImpl instance.
@@ -182,6 +196,7 @@ static SimulatorImpl * GetImpl (void)
 //
       LogSetTimePrinter (&TimePrinter);
       LogSetNodePrinter (&NodePrinter);
+      LogBinarySetStamper (&BinaryStamper);
     }
   return *pimpl;
 }
@@ -203,9 +218,11 @@ Simulator::Destroy (void)
    */
   LogSetTimePrinter (0);
   LogSetNodePrinter (0);
+  LogBinarySetStamper (0);
   (*pimpl)->Destroy ();
   (*pimpl)->Unref ();
   *pimpl = 0;
+  EventImpl::ReleasePool ();
 }
 
 void
@@ -380,6 +397,18 @@ Simulator::GetContext (void)
   return GetImpl ()->GetContext ();
 }
 
+uint64_t
+Simulator::GetEventCount (void)
+{
+  return GetImpl ()->GetEventCount ();
+}
+
+uint64_t
+Simulator::GetEventAllocationCount (void)
+{
+  return EventImpl::GetAllocationCount ();
+}
+
 uint32_t
 Simulator::GetSystemId (void)
 {
@@ -184,6 +184,27 @@ public:
    */
   static uint32_t GetContext (void);
 
+  /**
+   * Get the number of events executed so far.
+   *
+   * Together with the wall-clock time of the simulation, this gives the
+   * event rate of the simulator.
+   *
+   * \return The number of events executed.
+   */
+  static uint64_t GetEventCount (void);
+
+  /**
+   * Get the number of events whose storage was allocated from the
+   * system by the calling thread.
+   *
+   * The storage of the events is recycled, hence this counter stops
+   * increasing once the simulation reaches its steady state.
+   *
+   * \return The number of events allocated from the system.
+   */
+  static uint64_t GetEventAllocationCount (void);
+
   /**
    * Context enum values.
    *
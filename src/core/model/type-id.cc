@@ -143,6 +143,13 @@ public:
    * \returns The parent type id of the type id.
    */
   uint16_t GetParent (uint16_t uid) const;
+  /**
+   * Check if a type id is a descendant of another.
+   * \param [in] uid The id.
+   * \param [in] ancestor The id of the candidate ancestor.
+   * \returns \c true if \p ancestor is a strict ancestor of \p uid.
+   */
+  bool IsChildOf (uint16_t uid, uint16_t ancestor) const;
   /**
    * Get the group name of a type id.
    * \param [in] uid The id.
@@ -301,6 +308,8 @@ private:
     TypeId::hash_t hash;
     /** The parent type id. */
     uint16_t parent;
+    /** The ancestors of the type id, the root first. */
+    std::vector<uint16_t> ancestors;
     /** The group name. */
     std::string groupName;
     /** The size of the object represented by this type id. */
@@ -467,6 +476,15 @@ IidManager::SetParent (uint16_t uid, uint16_t parent)
   NS_ASSERT (parent <= m_information.size ());
   struct IidInformation *information = LookupInformation (uid);
   information->parent = parent;
+  // the ancestors of the parent are complete, since the parent was
+  // registered first: the ancestor at depth d of this type id is then
+  // the one of any other type id of depth d it derives from
+  information->ancestors.clear ();
+  if (parent != 0 && parent != uid)
+    {
+      information->ancestors = LookupInformation (parent)->ancestors;
+      information->ancestors.push_back (parent);
+    }
 }
 void 
 IidManager::SetGroupName (uint16_t uid, std::string groupName)
@@ -555,6 +573,14 @@ IidManager::GetParent (uint16_t uid) const
   NS_LOG_LOGIC (IIDL << pid);
   return pid;
 }
+bool
+IidManager::IsChildOf (uint16_t uid, uint16_t ancestor) const
+{
+  NS_LOG_FUNCTION (IID << uid << ancestor);
+  const std::vector<uint16_t> &ancestors = LookupInformation (uid)->ancestors;
+  std::size_t depth = LookupInformation (ancestor)->ancestors.size ();
+  return depth < ancestors.size () && ancestors[depth] == ancestor;
+}
 std::string 
 IidManager::GetGroupName (uint16_t uid) const
 {
@@ -950,12 +976,7 @@ bool
 TypeId::IsChildOf (TypeId other) const
 {
   NS_LOG_FUNCTION (this << other.GetUid ());
-  TypeId tmp = *this;
-  while (tmp != other && tmp != tmp.GetParent ())
-    {
-      tmp = tmp.GetParent ();
-    }
-  return tmp == other && *this != other;
+  return IidManager::Get ()->IsChildOf (m_tid, other.m_tid);
 }
 std::string 
 TypeId::GetGroupName (void) const
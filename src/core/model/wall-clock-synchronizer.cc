@@ -21,11 +21,27 @@
 #include <sys/time.h>  // gettimeofday
                        // clock_getres: glibc < 2.17, link with librt
 
+#include <cerrno>
+#include <cstring>     // strerror
+#include <sched.h>     // sched_yield, sched_setaffinity
+#include <unistd.h>    // read, write, close, sysconf
+
 #include "log.h"
 #include "system-condition.h"
+#include "enum.h"
+#include "integer.h"
+#include "ns3/core-config.h"
 
 #include "wall-clock-synchronizer.h"
 
+#if defined (HAVE_SYS_TIMERFD_H) && defined (HAVE_SYS_EVENTFD_H)
+/** Can we sleep on an absolute timer, woken by an event file descriptor? */
+#define HAVE_TIMERFD
+#include <sys/timerfd.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#endif
+
 /**
  * \file
  * \ingroup realtime
@@ -44,11 +60,35 @@ WallClockSynchronizer::GetTypeId (void)
   static TypeId tid = TypeId ("ns3::WallClockSynchronizer")
     .SetParent<Synchronizer> ()
     .SetGroupName ("Core")
+    .AddAttribute ("PacingMode",
+                   "How to wait until the time of the next event.",
+                   EnumValue (PACING_JIFFIES),
+                   MakeEnumAccessor (&WallClockSynchronizer::m_pacingMode),
+                   MakeEnumChecker (PACING_JIFFIES, "Jiffies",
+                                    PACING_ADAPTIVE, "Adaptive"))
+    .AddAttribute ("SpinThreshold",
+                   "Time busy-waited before each event in the Adaptive pacing "
+                   "mode, on top of the learned sleep overshoot.",
+                   TimeValue (MicroSeconds (20)),
+                   MakeTimeAccessor (&WallClockSynchronizer::m_spinThreshold),
+                   MakeTimeChecker (Time (0)))
+    .AddAttribute ("CpuAffinity",
+                   "Processor to bind the simulation thread to when the "
+                   "simulation starts in the Adaptive pacing mode, or -1 to "
+                   "leave its affinity unchanged.",
+                   IntegerValue (-1),
+                   MakeIntegerAccessor (&WallClockSynchronizer::m_cpu),
+                   MakeIntegerChecker<int32_t> (-1))
   ;
   return tid;
 }
 
 WallClockSynchronizer::WallClockSynchronizer ()
+  : m_yield (false),
+    m_overshootMean (0),
+    m_overshootDeviation (50000),
+    m_timerFd (-1),
+    m_eventFd (-1)
 {
   NS_LOG_FUNCTION (this);
 //
@@ -91,6 +131,14 @@ WallClockSynchronizer::WallClockSynchronizer ()
 WallClockSynchronizer::~WallClockSynchronizer ()
 {
   NS_LOG_FUNCTION (this);
+  CloseFds ();
+}
+
+uint64_t
+WallClockSynchronizer::GetSleepOvershoot (void) const
+{
+  int64_t overshoot = m_overshootMean + 4 * m_overshootDeviation;
+  return overshoot > 0 ? overshoot : 0;
 }
 
 bool
@@ -121,6 +169,16 @@ WallClockSynchronizer::DoSetOrigin (uint64_t ns)
 //
   m_realtimeOriginNano = GetRealtime ();
   NS_LOG_INFO ("origin = " << m_realtimeOriginNano);
+//
+// The origin is set by the thread about to run the simulation, which is the
+// thread doing the waits.  Only the adaptive mode pins that thread and
+// yields while spinning; the jiffies mode keeps its original behavior.
+//
+  if (m_pacingMode == PACING_ADAPTIVE)
+    {
+      SetAffinity ();
+      OpenFds ();
+    }
 }
 
 int64_t
@@ -167,6 +225,10 @@ bool
 WallClockSynchronizer::DoSynchronize (uint64_t nsCurrent, uint64_t nsDelay)
 {
   NS_LOG_FUNCTION (this << nsCurrent << nsDelay);
+  if (m_pacingMode == PACING_ADAPTIVE)
+    {
+      return AdaptiveSynchronize (nsCurrent + nsDelay);
+    }
 //
 // This is the belly of the beast.  We have received two parameters from the
 // simulator proper -- a current simulation time (nsCurrent) and a simulation
@@ -288,6 +350,16 @@ WallClockSynchronizer::DoSignal (void)
 
   m_condition.SetCondition (true);
   m_condition.Signal ();
+#ifdef HAVE_TIMERFD
+  if (m_eventFd >= 0)
+    {
+      uint64_t one = 1;
+      if (write (m_eventFd, &one, sizeof (one)) < 0 && errno != EAGAIN)
+        {
+          NS_LOG_WARN ("Could not signal the event file descriptor: " << std::strerror (errno));
+        }
+    }
+#endif
 }
 
 void
@@ -327,6 +399,14 @@ WallClockSynchronizer::SpinWait (uint64_t ns)
         {
           return false;
         }
+//
+// Let the threads sharing our processor, e.g., the readers of the devices
+// scheduling the external events, run while we wait.
+//
+      if (m_yield)
+        {
+          sched_yield ();
+        }
     }
 // Quiet compiler
   return true;
@@ -339,6 +419,183 @@ WallClockSynchronizer::SleepWait (uint64_t ns)
   return m_condition.TimedWait (ns);
 }
 
+bool
+WallClockSynchronizer::SleepUntil (uint64_t ns)
+{
+  NS_LOG_FUNCTION (this << ns);
+#ifdef HAVE_TIMERFD
+  if (m_timerFd >= 0)
+    {
+      uint64_t nsAbsolute = m_realtimeOriginNano + ns;
+      struct itimerspec timeout;
+      timeout.it_interval.tv_sec = 0;
+      timeout.it_interval.tv_nsec = 0;
+      timeout.it_value.tv_sec = nsAbsolute / NS_PER_SEC;
+      timeout.it_value.tv_nsec = nsAbsolute % NS_PER_SEC;
+      if (timerfd_settime (m_timerFd, TFD_TIMER_ABSTIME, &timeout, 0) != 0)
+        {
+          NS_FATAL_ERROR ("WallClockSynchronizer::SleepUntil(): timerfd_settime failed: "
+                          << std::strerror (errno));
+        }
+
+      struct pollfd fds[2];
+      fds[0].fd = m_timerFd;
+      fds[0].events = POLLIN;
+      fds[1].fd = m_eventFd;
+      fds[1].events = POLLIN;
+      for (;;)
+        {
+//
+// DoSignal sets the condition before writing to the event file descriptor,
+// so a signal coming after this test wakes up the poll below.
+//
+          if (m_condition.GetCondition ())
+            {
+              return false;
+            }
+          if (poll (fds, 2, -1) < 0)
+            {
+              if (errno == EINTR)
+                {
+                  continue;
+                }
+              NS_FATAL_ERROR ("WallClockSynchronizer::SleepUntil(): poll failed: "
+                              << std::strerror (errno));
+            }
+          uint64_t count;
+          if (fds[1].revents & POLLIN)
+            {
+              // the writes of the signals handled earlier may wake us up
+              // again, so drain them and look at the condition
+              if (read (m_eventFd, &count, sizeof (count)) < 0)
+                {
+                  NS_LOG_WARN ("Could not read the event file descriptor: " << std::strerror (errno));
+                }
+            }
+          if ((fds[0].revents & POLLIN) && read (m_timerFd, &count, sizeof (count)) > 0)
+            {
+              break;
+            }
+        }
+    }
+  else
+#endif
+    {
+      uint64_t nsNow = GetNormalizedRealtime ();
+      if (nsNow < ns && SleepWait (ns - nsNow) == false)
+        {
+          return false;
+        }
+    }
+  LearnOvershoot ((int64_t)GetNormalizedRealtime () - (int64_t)ns);
+  return true;
+}
+
+void
+WallClockSynchronizer::LearnOvershoot (int64_t ns)
+{
+  NS_LOG_FUNCTION (this << ns);
+//
+// The estimator of the TCP retransmission timeout (RFC 6298): a mean with a
+// gain of 1/8 and a mean deviation with a gain of 1/4.  Sleeping until four
+// deviations above the mean wakes us up early almost every time, and the
+// estimate follows the load of the machine.
+//
+  int64_t error = ns - m_overshootMean;
+  m_overshootMean += error / 8;
+  m_overshootDeviation += ((error < 0 ? -error : error) - m_overshootDeviation) / 4;
+  NS_LOG_INFO ("Sleep overshoot " << ns << " ns, estimate " << GetSleepOvershoot () << " ns");
+}
+
+bool
+WallClockSynchronizer::AdaptiveSynchronize (uint64_t ns)
+{
+  NS_LOG_FUNCTION (this << ns);
+//
+// Rather than sleeping for a number of jiffies fixed once and for all, sleep
+// until the time of the event minus the overshoot of the recent sleeps,
+// leaving some spin threshold to absorb their variance.  The sleep is on an
+// absolute timer, so the time spent getting here is already accounted for.
+//
+  uint64_t guard = GetSleepOvershoot () + m_spinThreshold.GetNanoSeconds ();
+  if (GetNormalizedRealtime () + guard < ns)
+    {
+      if (SleepUntil (ns - guard) == false)
+        {
+          NS_LOG_INFO ("SleepUntil interrupted");
+          return false;
+        }
+    }
+  return SpinWait (ns);
+}
+
+void
+WallClockSynchronizer::SetAffinity (void)
+{
+  NS_LOG_FUNCTION (this);
+#ifdef CPU_SET
+  cpu_set_t cpus;
+  if (m_cpu >= 0)
+    {
+      CPU_ZERO (&cpus);
+      CPU_SET (m_cpu, &cpus);
+      if (sched_setaffinity (0, sizeof (cpus), &cpus) != 0)
+        {
+          NS_LOG_WARN ("Could not bind to processor " << m_cpu << ": " << std::strerror (errno));
+        }
+    }
+//
+// A busy-wait starves the threads which can only run on the same processor,
+// and these are typically the threads scheduling the external events.  The
+// simulation thread shares its processor if it can only run on one while the
+// process was bound to it as a whole, or if there is only one processor.
+// When the CpuAffinity attribute binds it to a processor, the threads
+// created beforehand are assumed to run elsewhere.
+//
+  bool single = sched_getaffinity (0, sizeof (cpus), &cpus) == 0 && CPU_COUNT (&cpus) == 1;
+  m_yield = (single && m_cpu < 0) || sysconf (_SC_NPROCESSORS_ONLN) == 1;
+#else
+  m_yield = false;
+#endif
+  NS_LOG_INFO ("Yield while spinning: " << m_yield);
+}
+
+void
+WallClockSynchronizer::OpenFds (void)
+{
+  NS_LOG_FUNCTION (this);
+#ifdef HAVE_TIMERFD
+  if (m_timerFd >= 0)
+    {
+      return;
+    }
+  m_timerFd = timerfd_create (CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+  m_eventFd = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (m_timerFd < 0 || m_eventFd < 0)
+    {
+      NS_LOG_WARN ("Could not create the timer file descriptors, falling back to SleepWait: "
+                   << std::strerror (errno));
+      CloseFds ();
+    }
+#endif
+}
+
+void
+WallClockSynchronizer::CloseFds (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_timerFd >= 0)
+    {
+      close (m_timerFd);
+      m_timerFd = -1;
+    }
+  if (m_eventFd >= 0)
+    {
+      close (m_eventFd);
+      m_eventFd = -1;
+    }
+}
+
 uint64_t
 WallClockSynchronizer::DriftCorrect (uint64_t nsNow, uint64_t nsDelay)
 {
@@ -374,9 +631,19 @@ uint64_t
 WallClockSynchronizer::GetRealtime (void)
 {
   NS_LOG_FUNCTION (this);
+//
+// A monotonic clock neither jumps when the time of day is set nor rounds
+// to microseconds, and it is the clock of the timers of SleepUntil.
+//
+#ifdef CLOCK_MONOTONIC
+  struct timespec tsNow;
+  clock_gettime (CLOCK_MONOTONIC, &tsNow);
+  return tsNow.tv_sec * NS_PER_SEC + tsNow.tv_nsec;
+#else
   struct timeval tvNow;
   gettimeofday (&tvNow, NULL);
   return TimevalToNs (&tvNow);
+#endif
 }
 
 uint64_t
@@ -21,6 +21,7 @@
 
 #include "system-condition.h"
 #include "synchronizer.h"
+#include "nstime.h"
 
 /**
  * @file
@@ -88,6 +89,27 @@ public:
   /** Conversion constant between ns and s. */
   static const uint64_t NS_PER_SEC = (uint64_t)1000000000;
 
+  /** How to wait until the time of the next event. */
+  enum PacingMode {
+    /**
+     * Sleep for a whole number of jiffies, leaving the last three jiffies
+     * to a busy-wait.
+     */
+    PACING_JIFFIES,
+    /**
+     * Sleep until the learned sleep overshoot plus the spin threshold
+     * before the time of the event, then busy-wait.
+     */
+    PACING_ADAPTIVE
+  };
+
+  /**
+   * Get the current estimate of how late a sleep wakes up, as learned by
+   * the adaptive pacing mode.
+   * @returns The estimated sleep overshoot, in ns.
+   */
+  uint64_t GetSleepOvershoot (void) const;
+
 protected:
   /**
    * @brief Do a busy-wait until the normalized realtime equals the argument
@@ -126,6 +148,40 @@ protected:
    *          @c false if we returned because the condition was set.
    */
   bool SleepWait (uint64_t ns);
+  /**
+   * @brief Sleep until the normalized realtime reaches the argument, and
+   * learn how late the sleep woke up.
+   *
+   * On Linux the sleep is an absolute @c timerfd timeout, polled along with
+   * an @c eventfd written by DoSignal(), so that neither the conversion to a
+   * relative timeout nor the condition variable add to the wake-up latency.
+   * Elsewhere this falls back to SleepWait().
+   * @param [in] ns The target normalized real time we should wait for.
+   * @returns @c true if we reached the target time,
+   *          @c false if we returned because the condition was set.
+   */
+  bool SleepUntil (uint64_t ns);
+  /**
+   * Update the estimate of the sleep overshoot with a new sample.
+   * @param [in] ns How late the last sleep woke up, in ns.
+   */
+  void LearnOvershoot (int64_t ns);
+  /**
+   * Synchronize in the PACING_ADAPTIVE mode.
+   * @param [in] ns The target normalized real time we should wait for.
+   * @returns @c true if we reached the target time,
+   *          @c false if we returned because the condition was set.
+   */
+  bool AdaptiveSynchronize (uint64_t ns);
+  /**
+   * Apply the CpuAffinity attribute to the calling thread, and find out
+   * whether it shares its processor with the other threads.
+   */
+  void SetAffinity (void);
+  /** Open the timer and event file descriptors of the adaptive mode. */
+  void OpenFds (void);
+  /** Close the timer and event file descriptors of the adaptive mode. */
+  void CloseFds (void);
 
   // Inherited from Synchronizer
   virtual void DoSetOrigin (uint64_t ns);
@@ -150,7 +206,8 @@ protected:
   uint64_t DriftCorrect (uint64_t nsNow, uint64_t nsDelay);
 
   /**
-   * @brief Get the current absolute real time (in ns since the epoch).
+   * @brief Get the current absolute real time (in ns since some unspecified
+   * starting point of a monotonic clock).
    *
    * @returns The current real time, in ns.
    */
@@ -196,6 +253,23 @@ protected:
 
   /** Thread synchronizer. */
   SystemCondition m_condition;
+
+  /** How to wait until the time of the next event. */
+  PacingMode m_pacingMode;
+  /** Time spent busy-waiting before an event in the adaptive mode. */
+  Time m_spinThreshold;
+  /** Processor the simulation thread is bound to, or -1. */
+  int32_t m_cpu;
+  /** Whether busy-waits yield the processor to the other threads. */
+  bool m_yield;
+  /** Smoothed sleep overshoot, in ns. */
+  int64_t m_overshootMean;
+  /** Smoothed deviation of the sleep overshoot, in ns. */
+  int64_t m_overshootDeviation;
+  /** Timer file descriptor of the adaptive mode, or -1. */
+  int m_timerFd;
+  /** Event file descriptor written by DoSignal, or -1. */
+  int m_eventFd;
 };
 
 } // namespace ns3
@@ -0,0 +1,172 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "warm-start.h"
+#include "simulator.h"
+#include "simulator-impl.h"
+#include "fatal-error.h"
+#include "log.h"
+#include "log-binary.h"
+
+#include <set>
+#include <iostream>
+#include <sstream>
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::WarmStart implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("WarmStart");
+
+const uint32_t WarmStart::SNAPSHOT;
+
+namespace {
+
+/** Whether this process is a branch. */
+bool g_isBranch = false;
+/** The index of the branch run by this process. */
+uint32_t g_branch = 0;
+/** The number of branches of the last fork which failed. */
+uint32_t g_nFailed = 0;
+
+/**
+ * Wait for a branch to exit, and record whether it failed.
+ *
+ * \param [in,out] running The process identifiers of the running branches.
+ */
+void
+WaitBranch (std::set<pid_t> &running)
+{
+  NS_LOG_FUNCTION (running.size ());
+  int status;
+  pid_t pid = waitpid (-1, &status, 0);
+  if (pid < 0)
+    {
+      if (errno == EINTR)
+        {
+          return;
+        }
+      NS_FATAL_ERROR ("WarmStart::Fork(): waitpid() failed: " << std::strerror (errno));
+    }
+  if (running.erase (pid) == 0)
+    {
+      // a child process not created by Fork()
+      return;
+    }
+  if (!WIFEXITED (status) || WEXITSTATUS (status) != 0)
+    {
+      NS_LOG_WARN ("Branch process " << pid << " failed with status " << status);
+      g_nFailed++;
+    }
+  else
+    {
+      NS_LOG_LOGIC ("Branch process " << pid << " exited");
+    }
+}
+
+} // unnamed namespace
+
+uint32_t
+WarmStart::Fork (uint32_t nBranches, uint32_t maxRunning)
+{
+  NS_LOG_FUNCTION (nBranches << maxRunning);
+  NS_ASSERT_MSG (nBranches > 0, "WarmStart::Fork(): no branch");
+
+  std::string impl = Simulator::GetImplementation ()->GetInstanceTypeId ().GetName ();
+  if (impl != "ns3::DefaultSimulatorImpl")
+    {
+      NS_FATAL_ERROR ("WarmStart::Fork(): " << impl << " can't be forked");
+    }
+
+  // the buffered outputs would otherwise be written by every branch
+  std::cout.flush ();
+  std::cerr.flush ();
+  std::clog.flush ();
+  std::fflush (0);
+  LogBinaryFlush ();
+
+  g_nFailed = 0;
+  std::set<pid_t> running;
+  for (uint32_t branch = 0; branch < nBranches; branch++)
+    {
+      while (maxRunning != 0 && running.size () >= maxRunning)
+        {
+          WaitBranch (running);
+        }
+      pid_t pid = fork ();
+      if (pid < 0)
+        {
+          NS_FATAL_ERROR ("WarmStart::Fork(): fork() failed: " << std::strerror (errno));
+        }
+      if (pid == 0)
+        {
+          g_isBranch = true;
+          g_branch = branch;
+          if (LogBinaryIsOpen ())
+            {
+              std::ostringstream suffix;
+              suffix << "." << branch;
+              if (!LogBinaryReopen (suffix.str ()))
+                {
+                  NS_FATAL_ERROR ("WarmStart::Fork(): could not open the binary log of branch " << branch);
+                }
+            }
+          NS_LOG_LOGIC ("Branch " << branch << " resumes at " << Simulator::Now ().GetSeconds () << "s");
+          return branch;
+        }
+      NS_LOG_LOGIC ("Branch " << branch << " runs in process " << pid);
+      running.insert (pid);
+    }
+  while (!running.empty ())
+    {
+      WaitBranch (running);
+    }
+  NS_LOG_LOGIC (nBranches << " branches exited, " << g_nFailed << " failed");
+  return SNAPSHOT;
+}
+
+bool
+WarmStart::IsBranch (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return g_isBranch;
+}
+
+uint32_t
+WarmStart::GetBranch (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return g_branch;
+}
+
+uint32_t
+WarmStart::GetNFailedBranches (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  return g_nFailed;
+}
+
+} // namespace ns3
@@ -0,0 +1,119 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef WARM_START_H
+#define WARM_START_H
+
+#include <stdint.h>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::WarmStart declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup simulator
+ *
+ * \brief Fork a warmed-up simulation into several branches.
+ *
+ * Scenarios often spend much of their wall time on a warm-up phase
+ * (association, address resolution, controller handshakes) before the
+ * measurements start. When several variants of a scenario share the
+ * same warm-up, e.g. in a parameter sweep, the warm-up can be run once
+ * and its state forked into one process per variant:
+ *
+ * \code
+ *   Simulator::Stop (Seconds (warmUp));
+ *   Simulator::Run ();
+ *   uint32_t branch = WarmStart::Fork (policies.size ());
+ *   if (branch == WarmStart::SNAPSHOT)
+ *     {
+ *       // all the branches exited
+ *       Simulator::Destroy ();
+ *       return WarmStart::GetNFailedBranches () == 0 ? 0 : 1;
+ *     }
+ *   ConfigurePolicy (policies[branch]);
+ *   Simulator::Stop (Seconds (duration));
+ *   Simulator::Run ();
+ *   Simulator::Destroy ();
+ * \endcode
+ *
+ * Each branch is a child process, created with fork(), which resumes from
+ * a copy-on-write copy of the whole state of the calling process: the
+ * event list, the nodes, their devices and protocols, the controllers and
+ * the random number generators. The calling process keeps the snapshot
+ * and waits for the branches to exit.
+ *
+ * Every random variable stream is in the same state in every branch, so
+ * that the branches draw the same numbers as long as they draw them in
+ * the same order, and the streams created after the fork are given the
+ * same stream numbers in every branch. The results of a branch therefore
+ * only depend on its index, whatever the order in which the branches run.
+ * Use GetBranch() to give the branches different streams or outputs.
+ *
+ * Forking is only supported by the default (sequential) simulator, since
+ * the threads of the other implementations are not copied. Buffered
+ * outputs, e.g. trace files, should be flushed before the fork, lest each
+ * branch write the buffered data again; the C and C++ standard streams
+ * and the binary log are flushed by Fork(). Each branch then records its
+ * binary log messages in its own file, named after the file of the
+ * snapshot with the suffix <tt>.branch</tt> (see LogBinaryReopen()).
+ */
+class WarmStart
+{
+public:
+  /** The value returned by Fork() to the process holding the snapshot. */
+  static const uint32_t SNAPSHOT = 0xffffffff;
+
+  /**
+   * Fork the simulation into branches resuming from the current state.
+   *
+   * This must be called outside of Simulator::Run(), e.g., after the
+   * simulation of the warm-up was stopped.
+   *
+   * \param [in] nBranches The number of branches.
+   * \param [in] maxRunning The maximum number of branches running at
+   *             once, or 0 to run all the branches at once.
+   * \return In a branch, the index of the branch, between 0 and
+   *         \p nBranches - 1. In the calling process, SNAPSHOT, once
+   *         all the branches exited.
+   */
+  static uint32_t Fork (uint32_t nBranches, uint32_t maxRunning = 0);
+
+  /**
+   * \return \c true if this process is a branch created by Fork().
+   */
+  static bool IsBranch (void);
+
+  /**
+   * \return The index of the branch run by this process, as returned by
+   *         the last call to Fork(), or 0 if this is not a branch.
+   */
+  static uint32_t GetBranch (void);
+
+  /**
+   * \return The number of branches of the last call to Fork() which
+   *         did not exit successfully.
+   */
+  static uint32_t GetNFailedBranches (void);
+};
+
+} // namespace ns3
+
+#endif /* WARM_START_H */
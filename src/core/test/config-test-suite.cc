@@ -34,6 +34,7 @@
 
 
 #include <sstream>
+#include <map>
 
 /**
  * \file
@@ -830,6 +831,175 @@ SearchAttributesOfParentObjectsTestCase::DoRun (void)
 
 }
 
+/**
+ * \ingroup config-tests
+ * Test for the batched resolution of Config paths.
+ */
+class PathBatchConfigTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  PathBatchConfigTestCase ();
+  /** Destructor. */
+  virtual ~PathBatchConfigTestCase () {}
+
+  /**
+   * Trace callback without context.
+   * \param oldValue The old value.
+   * \param newValue The new value.
+   */
+  void Trace (int16_t oldValue, int16_t newValue)
+  {
+    NS_UNUSED (oldValue);
+    m_newValue = newValue;
+  }
+  /**
+   * Trace callback with context path.
+   * \param path The context path.
+   * \param old The old value.
+   * \param newValue The new value.
+   */
+  void TraceWithPath (std::string path, int16_t old, int16_t newValue)
+  {
+    NS_UNUSED (old);
+    m_newValue = newValue;
+    m_path = path;
+  }
+  /**
+   * Trace callback counting the calls of each context path.
+   * \param path The context path.
+   * \param old The old value.
+   * \param newValue The new value.
+   */
+  void Count (std::string path, int16_t old, int16_t newValue)
+  {
+    NS_UNUSED (old);
+    NS_UNUSED (newValue);
+    m_counts[path]++;
+  }
+
+private:
+  virtual void DoRun (void);
+
+  int16_t m_newValue; //!< Flag to detect tracing result.
+  std::string m_path; //!< The context path.
+  std::map<std::string, uint32_t> m_counts; //!< Number of calls of each context path.
+};
+
+PathBatchConfigTestCase::PathBatchConfigTestCase ()
+  : TestCase ("Check that a batch of paths is resolved as each path alone")
+{
+}
+
+void
+PathBatchConfigTestCase::DoRun (void)
+{
+  IntegerValue iv;
+
+  //
+  // Create a root namespace object, with two levels of vectors of objects
+  // under it.
+  //
+  Ptr<ConfigTestObject> root = CreateObject<ConfigTestObject> ();
+  Config::RegisterRootNamespaceObject (root);
+  Ptr<ConfigTestObject> objects[3][2];
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      Ptr<ConfigTestObject> a = CreateObject<ConfigTestObject> ();
+      root->AddNodeA (a);
+      for (uint32_t j = 0; j < 2; j++)
+        {
+          objects[i][j] = CreateObject<ConfigTestObject> ();
+          a->AddNodeB (objects[i][j]);
+        }
+    }
+
+  //
+  // The batch must match the same objects as the paths resolved one at a
+  // time, including the paths sharing a prefix.  The older roots may match
+  // the paths too, so only count our objects.
+  //
+  std::vector<std::string> paths;
+  paths.push_back ("/NodesA/*/NodesB/*");
+  paths.push_back ("/NodesA/[0-1]/NodesB/1");
+  paths.push_back ("/NodesA/2|0/NodesB/0");
+  paths.push_back ("/NodesA/*/NodesB");
+  paths.push_back ("/NodesA/5/NodesB/*");
+  paths.push_back ("/NodesA/0/*/*");
+  std::map<std::string, uint32_t> expected;
+  Config::PathBatch counters;
+  for (uint32_t i = 0; i < paths.size (); i++)
+    {
+      Config::MatchContainer matches = Config::LookupMatches (paths[i]);
+      for (uint32_t j = 0; j < matches.GetN (); j++)
+        {
+          for (uint32_t k = 0; k < 6; k++)
+            {
+              if (matches.Get (j) == objects[k / 2][k % 2])
+                {
+                  expected[matches.GetMatchedPath (j) + "Source"]++;
+                }
+            }
+        }
+      counters.Connect (paths[i] + "/Source", MakeCallback (&PathBatchConfigTestCase::Count, this));
+    }
+  NS_TEST_ASSERT_MSG_EQ (counters.GetN (), paths.size (), "Operations missing from the batch");
+  counters.Apply ();
+  for (uint32_t k = 0; k < 6; k++)
+    {
+      objects[k / 2][k % 2]->SetAttribute ("Source", IntegerValue (k + 1));
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_counts.size (), expected.size (), "Different objects matched by the batch");
+  for (std::map<std::string, uint32_t>::const_iterator it = expected.begin (); it != expected.end (); ++it)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_counts[it->first], it->second, "Different matches of " << it->first);
+    }
+
+  //
+  // Set the attributes and connect the traces in one batch.  The later Set
+  // overrides the earlier one.
+  //
+  Config::PathBatch batch;
+  batch.Set ("/NodesA/*/NodesB/*/A", IntegerValue (5));
+  batch.Set ("/NodesA/1/NodesB/0/A", IntegerValue (7));
+  batch.Set ("/NodesA/2/NodesB/[0-1]/B", IntegerValue (3));
+  batch.Connect ("/NodesA/[0-1]/NodesB/1/Source",
+                 MakeCallback (&PathBatchConfigTestCase::TraceWithPath, this));
+  batch.ConnectWithoutContext ("/NodesA/2/NodesB/0/Source",
+                               MakeCallback (&PathBatchConfigTestCase::Trace, this));
+  batch.Apply ();
+  NS_TEST_ASSERT_MSG_EQ (batch.GetN (), 0, "The batch was not emptied");
+
+  for (uint32_t i = 0; i < 3; i++)
+    {
+      for (uint32_t j = 0; j < 2; j++)
+        {
+          objects[i][j]->GetAttribute ("A", iv);
+          NS_TEST_ASSERT_MSG_EQ (iv.Get (), ((i == 1 && j == 0) ? 7 : 5), "Attribute \"A\" of " << i << "/" << j << " not set as expected");
+          objects[i][j]->GetAttribute ("B", iv);
+          NS_TEST_ASSERT_MSG_EQ (iv.Get (), (i == 2 ? 3 : 9), "Attribute \"B\" of " << i << "/" << j << " not set as expected");
+        }
+    }
+
+  m_newValue = 0;
+  m_path = "";
+  objects[1][1]->SetAttribute ("Source", IntegerValue (-2));
+  NS_TEST_ASSERT_MSG_EQ (m_newValue, -2, "Trace 1/1 did not fire as expected");
+  NS_TEST_ASSERT_MSG_EQ (m_path, "/NodesA/1/NodesB/1/Source", "Trace 1/1 did not provide expected context");
+
+  m_newValue = 0;
+  objects[1][0]->SetAttribute ("Source", IntegerValue (-3));
+  NS_TEST_ASSERT_MSG_EQ (m_newValue, 0, "Trace 1/0 fired unexpectedly");
+
+  m_newValue = 0;
+  m_path = "";
+  objects[2][0]->SetAttribute ("Source", IntegerValue (-4));
+  NS_TEST_ASSERT_MSG_EQ (m_newValue, -4, "Trace 2/0 did not fire as expected");
+  NS_TEST_ASSERT_MSG_EQ (m_path, "", "Trace 2/0 provided a context");
+
+  Config::UnregisterRootNamespaceObject (root);
+}
+
 /**
  * \ingroup config-tests
  * The Test Suite that glues all of the Test Cases together.
@@ -848,6 +1018,7 @@ ConfigTestSuite::ConfigTestSuite ()
   AddTestCase (new UnderRootNamespaceConfigTestCase);
   AddTestCase (new ObjectVectorConfigTestCase);
   AddTestCase (new SearchAttributesOfParentObjectsTestCase);
+  AddTestCase (new PathBatchConfigTestCase);
 }
 
 /**
@@ -0,0 +1,270 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/log.h"
+#include "ns3/log-binary.h"
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup logbinary
+ * \ingroup logbinary-tests
+ * Binary logging backend test suite.
+ */
+
+/**
+ * \ingroup core-tests
+ * \defgroup logbinary-tests Binary logging backend test suite
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LogBinaryTestSuite");
+
+  namespace tests {
+
+
+/**
+ * \ingroup logbinary-tests
+ * Decode a binary log file.
+ * \param [in] filename The name of the file.
+ * \param [in] prefixes The prefixes of the rendered messages.
+ * \param [out] ok Was the file decoded successfully?
+ * \return The rendered messages.
+ */
+static std::string
+Decode (std::string filename, uint32_t prefixes, bool *ok)
+{
+  std::ifstream is (filename.c_str (), std::ios::in | std::ios::binary);
+  std::ostringstream os;
+  *ok = LogBinaryDecode (is, os, prefixes);
+  return os.str ();
+}
+
+/**
+ * \ingroup logbinary-tests
+ * Check that the binary records render as the text messages.
+ */
+class LogBinaryRenderTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  LogBinaryRenderTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /** Log messages of all levels, with arguments of all types. */
+  void LogMessages (void);
+  /**
+   * Log a message while the argument of another one is being streamed.
+   * \return An argument.
+   */
+  int Nested (void);
+};
+
+LogBinaryRenderTestCase::LogBinaryRenderTestCase ()
+  : TestCase ("Check that the binary records render as the text messages")
+{
+}
+
+void
+LogBinaryRenderTestCase::LogMessages (void)
+{
+  std::string name ("name");
+  NS_LOG_FUNCTION (this << 7 << "text" << std::string ("string") << name << static_cast<uint8_t> (65));
+  NS_LOG_FUNCTION_NOARGS ();
+  NS_LOG_INFO ("int " << 42 << " negative " << -7 << " unsigned " << 4000000000U
+               << " long " << -123456789012LL << " short " << static_cast<int16_t> (-3));
+  NS_LOG_WARN ("double " << 1.5 << " float " << 0.1f << " large " << 1e300
+               << " char " << 'x' << " uint8 " << static_cast<uint8_t> (65)
+               << " bool " << true);
+  NS_LOG_DEBUG ("time " << Seconds (1.5) << " pointer " << this
+                << " null " << static_cast<void *> (0));
+  char buffer[] = "array";
+  NS_LOG_LOGIC ("buffer " << buffer << " size " << std::vector<int> (3).size ()
+                << std::endl << "second line");
+  NS_LOG_ERROR ("error");
+}
+
+int
+LogBinaryRenderTestCase::Nested (void)
+{
+  NS_LOG_INFO ("inner");
+  return 3;
+}
+
+void
+LogBinaryRenderTestCase::DoRun (void)
+{
+  LogComponentEnable ("LogBinaryTestSuite", LogLevel (LOG_LEVEL_ALL | LOG_PREFIX_FUNC | LOG_PREFIX_LEVEL));
+
+  std::ostringstream text;
+  std::streambuf *clog = std::clog.rdbuf (text.rdbuf ());
+  LogMessages ();
+  std::clog.rdbuf (clog);
+
+  std::string filename = CreateTempDirFilename ("render.nslog");
+  NS_TEST_ASSERT_MSG_EQ (LogBinaryOpen (filename), true, "Could not open " << filename);
+  NS_TEST_ASSERT_MSG_EQ (LogBinaryIsOpen (), true, "The binary backend is not open");
+  LogMessages ();
+  LogBinaryClose ();
+  NS_TEST_ASSERT_MSG_EQ (LogBinaryIsOpen (), false, "The binary backend is still open");
+
+  bool ok;
+  std::string decoded = Decode (filename, LOG_PREFIX_FUNC | LOG_PREFIX_LEVEL, &ok);
+  NS_TEST_ASSERT_MSG_EQ (ok, true, "Could not decode " << filename);
+  NS_TEST_EXPECT_MSG_EQ (decoded, text.str (), "The binary records render differently");
+
+  // the inner message is recorded before the outer one
+  NS_TEST_ASSERT_MSG_EQ (LogBinaryOpen (filename), true, "Could not open " << filename);
+  NS_LOG_ERROR ("outer " << Nested ());
+  LogBinaryClose ();
+  decoded = Decode (filename, LOG_PREFIX_LEVEL, &ok);
+  NS_TEST_ASSERT_MSG_EQ (ok, true, "Could not decode " << filename);
+  NS_TEST_EXPECT_MSG_EQ (decoded, "[INFO ] inner\n[ERROR] outer 3\n", "Wrong nested records");
+
+  LogComponentDisable ("LogBinaryTestSuite", LogLevel (LOG_LEVEL_ALL | LOG_PREFIX_ALL));
+}
+
+
+/**
+ * \ingroup logbinary-tests
+ * Check the ring buffer, its stamps and its modes.
+ */
+class LogBinaryBufferTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  LogBinaryBufferTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Log a message in an event.
+   * \param [in] i The index of the message.
+   */
+  void Log (uint32_t i);
+};
+
+LogBinaryBufferTestCase::LogBinaryBufferTestCase ()
+  : TestCase ("Check the ring buffer of the binary log")
+{
+}
+
+void
+LogBinaryBufferTestCase::Log (uint32_t i)
+{
+  NS_LOG_INFO ("event " << i);
+}
+
+void
+LogBinaryBufferTestCase::DoRun (void)
+{
+  LogComponentEnable ("LogBinaryTestSuite", LOG_LEVEL_INFO);
+  std::string filename = CreateTempDirFilename ("buffer.nslog");
+  const uint32_t n = 1000;
+
+  // the smallest buffer is flushed many times, without losing records
+  NS_TEST_ASSERT_MSG_EQ (LogBinaryOpen (filename, 1024), true, "Could not open " << filename);
+  std::ostringstream expected;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      NS_LOG_INFO ("message " << i);
+      expected << "message " << i << std::endl;
+    }
+  LogBinaryClose ();
+  bool ok;
+  std::string decoded = Decode (filename, 0, &ok);
+  NS_TEST_ASSERT_MSG_EQ (ok, true, "Could not decode " << filename);
+  NS_TEST_EXPECT_MSG_EQ (decoded, expected.str (), "Records lost while flushing");
+
+  // in the wrap mode, only the most recent records are kept
+  NS_TEST_ASSERT_MSG_EQ (LogBinaryOpen (filename, 1024, true), true, "Could not open " << filename);
+  for (uint32_t i = 0; i < n; i++)
+    {
+      NS_LOG_INFO ("message " << i);
+    }
+  LogBinaryClose ();
+  decoded = Decode (filename, 0, &ok);
+  NS_TEST_ASSERT_MSG_EQ (ok, true, "Could not decode " << filename);
+  std::istringstream lines (decoded);
+  std::string line;
+  std::vector<std::string> kept;
+  while (std::getline (lines, line))
+    {
+      kept.push_back (line);
+    }
+  NS_TEST_ASSERT_MSG_GT (kept.size (), 10, "Too few records kept");
+  NS_TEST_ASSERT_MSG_LT (kept.size (), n, "The oldest records were not dropped");
+  for (uint32_t i = 0; i < kept.size (); i++)
+    {
+      std::ostringstream oss;
+      oss << "message " << n - kept.size () + i;
+      NS_TEST_EXPECT_MSG_EQ (kept[i], oss.str (), "Wrong record kept");
+    }
+
+  // the records are stamped with the time and context of the events
+  NS_TEST_ASSERT_MSG_EQ (LogBinaryOpen (filename), true, "Could not open " << filename);
+  Simulator::ScheduleWithContext (5, MilliSeconds (1500), &LogBinaryBufferTestCase::Log, this, 1);
+  Simulator::Schedule (Seconds (2), &LogBinaryBufferTestCase::Log, this, 2);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  LogBinaryClose ();
+  decoded = Decode (filename, LOG_PREFIX_TIME | LOG_PREFIX_NODE, &ok);
+  NS_TEST_ASSERT_MSG_EQ (ok, true, "Could not decode " << filename);
+  NS_TEST_EXPECT_MSG_EQ (decoded, "+1.500000000s 5 event 1\n+2.000000000s -1 event 2\n",
+                         "Wrong stamps");
+
+  LogComponentDisable ("LogBinaryTestSuite", LOG_LEVEL_ALL);
+}
+
+
+/**
+ * \ingroup logbinary-tests
+ * Binary logging backend test suite.
+ */
+class LogBinaryTestSuite : public TestSuite
+{
+public:
+  /** Constructor. */
+  LogBinaryTestSuite ()
+    : TestSuite ("log-binary")
+  {
+    // the logging macros are compiled out of the other builds
+#ifdef NS3_LOG_ENABLE
+    AddTestCase (new LogBinaryRenderTestCase (), TestCase::QUICK);
+    AddTestCase (new LogBinaryBufferTestCase (), TestCase::QUICK);
+#endif
+  }
+};
+
+/**
+ * \ingroup logbinary-tests
+ * LogBinaryTestSuite instance variable.
+ */
+static LogBinaryTestSuite g_logBinaryTestSuite;
+
+
+  }  // namespace tests
+
+}  // namespace ns3
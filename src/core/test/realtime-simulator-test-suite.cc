@@ -0,0 +1,273 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/realtime-simulator-impl.h"
+#include "ns3/config.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/system-thread.h"
+#include <chrono>  // milliseconds
+#include <thread>  // sleep_for
+#include <vector>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup realtime
+ * \ingroup realtime-tests
+ * RealtimeSimulatorImpl test suite.
+ */
+
+/**
+ * \ingroup core-tests
+ * \defgroup realtime-tests RealtimeSimulatorImpl test suite
+ */
+
+namespace ns3 {
+
+  namespace tests {
+
+
+/**
+ * \ingroup realtime-tests
+ * Check that the events already due are caught up with in order, and
+ * accounted for in the lag histogram.
+ */
+class RealtimeCatchUpTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  RealtimeCatchUpTestCase ();
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+  /** Block the simulation for longer than the following events. */
+  void Block (void);
+  /**
+   * Record the run of an event.
+   * \param [in] i The index of the event.
+   */
+  void Event (uint32_t i);
+
+  std::vector<uint32_t> m_events;  //!< Indices of the events run.
+};
+
+RealtimeCatchUpTestCase::RealtimeCatchUpTestCase ()
+  : TestCase ("Check the catch-up of the late events")
+{
+}
+
+void
+RealtimeCatchUpTestCase::DoSetup (void)
+{
+  Config::SetDefault ("ns3::RealtimeSimulatorImpl::MaxCatchUpEvents", UintegerValue (4));
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::RealtimeSimulatorImpl"));
+}
+
+void
+RealtimeCatchUpTestCase::DoTeardown (void)
+{
+  Config::SetDefault ("ns3::RealtimeSimulatorImpl::MaxCatchUpEvents", UintegerValue (1));
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+}
+
+void
+RealtimeCatchUpTestCase::Block (void)
+{
+  std::this_thread::sleep_for (std::chrono::milliseconds (40));
+}
+
+void
+RealtimeCatchUpTestCase::Event (uint32_t i)
+{
+  m_events.push_back (i);
+}
+
+void
+RealtimeCatchUpTestCase::DoRun (void)
+{
+  Simulator::Schedule (MilliSeconds (1), &RealtimeCatchUpTestCase::Block, this);
+  const uint32_t nEvents = 10;
+  for (uint32_t i = 0; i < nEvents; i++)
+    {
+      Simulator::Schedule (MilliSeconds (2 + i), &RealtimeCatchUpTestCase::Event, this, i);
+    }
+  // the realtime simulation does not end with the last event
+  Simulator::Stop (MilliSeconds (12));
+  Simulator::Run ();
+
+  Ptr<RealtimeSimulatorImpl> impl = DynamicCast<RealtimeSimulatorImpl> (Simulator::GetImplementation ());
+  NS_TEST_ASSERT_MSG_EQ ((impl != 0), true, "Not a realtime simulation");
+  std::vector<uint64_t> histogram = impl->GetLagHistogram ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_events.size (), nEvents, "Missing events");
+  for (uint32_t i = 0; i < nEvents; i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_events[i], i, "Event run out of order");
+    }
+
+  uint64_t total = 0;
+  uint64_t late = 0;
+  for (uint32_t i = 0; i < histogram.size (); i++)
+    {
+      total += histogram[i];
+      // the events after the blocking one, and the stop event, are at
+      // least 28 ms late
+      if (i >= 15)
+        {
+          late += histogram[i];
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (histogram.size (), RealtimeSimulatorImpl::LAG_BUCKETS, "Wrong number of buckets");
+  NS_TEST_EXPECT_MSG_EQ (total, nEvents + 2, "Events missing from the lag histogram");
+  NS_TEST_EXPECT_MSG_EQ (late, nEvents + 1, "Late events missing from the lag histogram");
+}
+
+
+/**
+ * \ingroup realtime-tests
+ * Check the adaptive pacing: the events must not run early, and the waits
+ * must be interrupted by the events scheduled from other threads.
+ */
+class RealtimeAdaptivePacingTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  RealtimeAdaptivePacingTestCase ();
+
+private:
+  virtual void DoSetup (void);
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+  /** Check that an event does not run before its time. */
+  void Event (void);
+  /** Schedule an event from another thread. */
+  void ScheduleFromThread (void);
+  /**
+   * Record the real time of the event scheduled from another thread, and
+   * stop the simulation.
+   */
+  void External (void);
+
+  uint32_t m_events;    //!< Number of paced events run.
+  bool m_early;         //!< Did an event run before its time?
+  Time m_external;      //!< Real time of the event of the other thread.
+};
+
+RealtimeAdaptivePacingTestCase::RealtimeAdaptivePacingTestCase ()
+  : TestCase ("Check the adaptive pacing")
+{
+}
+
+void
+RealtimeAdaptivePacingTestCase::DoSetup (void)
+{
+  Config::SetDefault ("ns3::WallClockSynchronizer::PacingMode", StringValue ("Adaptive"));
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::RealtimeSimulatorImpl"));
+}
+
+void
+RealtimeAdaptivePacingTestCase::DoTeardown (void)
+{
+  Config::SetDefault ("ns3::WallClockSynchronizer::PacingMode", StringValue ("Jiffies"));
+  Config::SetGlobal ("SimulatorImplementationType", StringValue ("ns3::DefaultSimulatorImpl"));
+}
+
+void
+RealtimeAdaptivePacingTestCase::Event (void)
+{
+  Ptr<RealtimeSimulatorImpl> impl = DynamicCast<RealtimeSimulatorImpl> (Simulator::GetImplementation ());
+  if (impl->RealtimeNow () < Simulator::Now ())
+    {
+      m_early = true;
+    }
+  m_events++;
+}
+
+void
+RealtimeAdaptivePacingTestCase::ScheduleFromThread (void)
+{
+  std::this_thread::sleep_for (std::chrono::milliseconds (60));
+  Simulator::ScheduleWithContext (Simulator::NO_CONTEXT, Time (0), &RealtimeAdaptivePacingTestCase::External, this);
+}
+
+void
+RealtimeAdaptivePacingTestCase::External (void)
+{
+  Ptr<RealtimeSimulatorImpl> impl = DynamicCast<RealtimeSimulatorImpl> (Simulator::GetImplementation ());
+  m_external = impl->RealtimeNow ();
+  Simulator::Stop ();
+}
+
+void
+RealtimeAdaptivePacingTestCase::DoRun (void)
+{
+  m_events = 0;
+  m_early = false;
+  m_external = Time (0);
+  const uint32_t nEvents = 20;
+  for (uint32_t i = 1; i <= nEvents; i++)
+    {
+      Simulator::Schedule (MicroSeconds (1500 * i), &RealtimeAdaptivePacingTestCase::Event, this);
+    }
+  // after the paced events, the simulation sleeps until the next event,
+  // one second later, while another thread schedules an event after 60 ms
+  Simulator::Schedule (Seconds (1), &RealtimeAdaptivePacingTestCase::Event, this);
+  Ptr<SystemThread> thread =
+    Create<SystemThread> (MakeCallback (&RealtimeAdaptivePacingTestCase::ScheduleFromThread, this));
+  thread->Start ();
+  Simulator::Run ();
+  thread->Join ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_early, false, "An event ran early");
+  NS_TEST_EXPECT_MSG_GT (m_external, MicroSeconds (1500 * nEvents), "The event of the other thread did not run");
+  NS_TEST_EXPECT_MSG_LT (m_external, MilliSeconds (500), "The sleep was not interrupted");
+  NS_TEST_EXPECT_MSG_EQ (m_events, nEvents, "Missing events, or the event after the sleep ran");
+}
+
+
+/**
+ * \ingroup realtime-tests
+ * RealtimeSimulatorImpl test suite.
+ */
+class RealtimeSimulatorTestSuite : public TestSuite
+{
+public:
+  /** Constructor. */
+  RealtimeSimulatorTestSuite ()
+    : TestSuite ("realtime-simulator")
+  {
+    AddTestCase (new RealtimeCatchUpTestCase (), TestCase::QUICK);
+    AddTestCase (new RealtimeAdaptivePacingTestCase (), TestCase::QUICK);
+  }
+};
+
+/**
+ * \ingroup realtime-tests
+ * RealtimeSimulatorTestSuite instance variable.
+ */
+static RealtimeSimulatorTestSuite g_realtimeSimulatorTestSuite;
+
+
+  }  // namespace tests
+
+}  // namespace ns3
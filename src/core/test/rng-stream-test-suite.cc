@@ -0,0 +1,159 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/rng-stream.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/random-variable-stream.h"
+#include <vector>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup randomvariable
+ * \ingroup randomvariable-tests
+ * Tests of the batched generation of random numbers.
+ */
+
+namespace ns3 {
+
+  namespace tests {
+
+
+/**
+ * \ingroup randomvariable-tests
+ * Check that the batches of RngStream are the numbers of RandU01().
+ */
+class RngStreamBatchTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  RngStreamBatchTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+RngStreamBatchTestCase::RngStreamBatchTestCase ()
+  : TestCase ("Check the batches of RngStream")
+{
+}
+
+void
+RngStreamBatchTestCase::DoRun (void)
+{
+  RngStream single (12345, 3, 7);
+  RngStream batched (12345, 3, 7);
+  std::vector<double> values (1000);
+  for (uint32_t n = 1; n <= values.size (); n *= 10)
+    {
+      batched.RandU01 (&values[0], n);
+      for (uint32_t i = 0; i < n; i++)
+        {
+          // the numbers must be the same, not just close
+          NS_TEST_ASSERT_MSG_EQ (values[i], single.RandU01 (), "Batch of " << n << " differs at " << i);
+        }
+    }
+}
+
+/**
+ * \ingroup randomvariable-tests
+ * Check that the prefetched numbers keep the sequences of the streams.
+ */
+class RandomVariableStreamPrefetchTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  RandomVariableStreamPrefetchTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+RandomVariableStreamPrefetchTestCase::RandomVariableStreamPrefetchTestCase ()
+  : TestCase ("Check the prefetched numbers of RandomVariableStream")
+{
+}
+
+void
+RandomVariableStreamPrefetchTestCase::DoRun (void)
+{
+  Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+  uniform->SetStream (5);
+  // the streams set explicitly are the last 2^63 streams
+  RngStream rng (RngSeedManager::GetSeed (), (1ULL << 63) + 5, RngSeedManager::GetRun ());
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (uniform->GetValue (), rng.RandU01 (), "Uniform value " << i << " differs");
+    }
+
+  // the numbers prefetched from the previous stream are discarded
+  uniform->SetStream (6);
+  RngStream other (RngSeedManager::GetSeed (), (1ULL << 63) + 6, RngSeedManager::GetRun ());
+  NS_TEST_ASSERT_MSG_EQ (uniform->GetValue (), other.RandU01 (), "Prefetched numbers were not discarded");
+
+  // the batches of values are the values of GetValue
+  Ptr<RandomVariableStream> variables[3];
+  variables[0] = CreateObject<UniformRandomVariable> ();
+  variables[1] = CreateObject<ExponentialRandomVariable> ();
+  variables[2] = CreateObject<NormalRandomVariable> ();
+  for (uint32_t v = 0; v < 3; v++)
+    {
+      std::vector<double> single;
+      variables[v]->SetStream (7);
+      for (uint32_t i = 0; i < 50; i++)
+        {
+          single.push_back (variables[v]->GetValue ());
+        }
+      std::vector<double> batched (50);
+      variables[v]->SetStream (7);
+      variables[v]->GetValues (&batched[0], 13);
+      variables[v]->GetValues (&batched[13], 37);
+      for (uint32_t i = 0; i < 50; i++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (batched[i], single[i], "Variable " << v << " value " << i << " differs");
+        }
+    }
+}
+
+/**
+ * \ingroup randomvariable-tests
+ * Test suite of the batched generation of random numbers.
+ */
+class RngStreamTestSuite : public TestSuite
+{
+public:
+  /** Constructor. */
+  RngStreamTestSuite ();
+};
+
+RngStreamTestSuite::RngStreamTestSuite ()
+  : TestSuite ("rng-stream", UNIT)
+{
+  AddTestCase (new RngStreamBatchTestCase, TestCase::QUICK);
+  AddTestCase (new RandomVariableStreamPrefetchTestCase, TestCase::QUICK);
+}
+
+/**
+ * \ingroup randomvariable-tests
+ * RngStreamTestSuite instance variable.
+ */
+static RngStreamTestSuite g_rngStreamTestSuite;
+
+
+  }  // namespace tests
+
+}  // namespace ns3
@@ -23,6 +23,8 @@
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+#include "ns3/random-variable-stream.h"
 
 using namespace ns3;
 
@@ -461,6 +463,130 @@ SimulatorTemplateTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+class SchedulerOrderTestCase : public TestCase
+{
+public:
+  SchedulerOrderTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+  ObjectFactory m_schedulerFactory;
+};
+
+SchedulerOrderTestCase::SchedulerOrderTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check that " + schedulerFactory.GetTypeId ().GetName () +
+              " orders clustered events like the MapScheduler"),
+    m_schedulerFactory (schedulerFactory)
+{
+}
+
+void
+SchedulerOrderTestCase::DoRun (void)
+{
+  Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler> ();
+  Ptr<Scheduler> reference = CreateObject<MapScheduler> ();
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+  // offsets of slot boundaries and SIFS/DIFS in ns, and a beacon interval
+  uint64_t offsets[] = {0, 9000, 16000, 34000, 102400000};
+  std::vector<Scheduler::Event> pending;
+  uint64_t now = 0;
+  uint32_t uid = 0;
+  for (uint32_t n = 0; n < 100000; n++)
+    {
+      uint32_t action = rng->GetInteger (0, 9);
+      if (action < 5 || pending.empty ())
+        {
+          Scheduler::Event ev;
+          ev.impl = 0;
+          ev.key.m_ts = now + offsets[rng->GetInteger (0, 4)] + 9000 * rng->GetInteger (0, 3);
+          ev.key.m_uid = uid++;
+          ev.key.m_context = 0;
+          scheduler->Insert (ev);
+          reference->Insert (ev);
+          pending.push_back (ev);
+        }
+      else if (action < 9)
+        {
+          Scheduler::Event next = reference->RemoveNext ();
+          NS_TEST_ASSERT_MSG_EQ (scheduler->PeekNext ().key.m_uid, next.key.m_uid, "Unexpected next event");
+          NS_TEST_ASSERT_MSG_EQ (scheduler->RemoveNext ().key.m_uid, next.key.m_uid, "Unexpected next event");
+          now = next.key.m_ts;
+          for (std::vector<Scheduler::Event>::iterator i = pending.begin (); i != pending.end (); i++)
+            {
+              if (i->key.m_uid == next.key.m_uid)
+                {
+                  *i = pending.back ();
+                  pending.pop_back ();
+                  break;
+                }
+            }
+        }
+      else
+        {
+          uint32_t i = rng->GetInteger (0, pending.size () - 1);
+          scheduler->Remove (pending[i]);
+          reference->Remove (pending[i]);
+          pending[i] = pending.back ();
+          pending.pop_back ();
+        }
+      NS_TEST_ASSERT_MSG_EQ (scheduler->IsEmpty (), pending.empty (), "Unexpected scheduler state");
+    }
+  while (!reference->IsEmpty ())
+    {
+      NS_TEST_ASSERT_MSG_EQ (scheduler->RemoveNext ().key.m_uid, reference->RemoveNext ().key.m_uid, "Unexpected next event");
+    }
+  NS_TEST_ASSERT_MSG_EQ (scheduler->IsEmpty (), true, "Scheduler should be empty");
+}
+
+/**
+ * \ingroup core-tests
+ *
+ * \brief Check that a self-rescheduling event chain stops allocating
+ * event storage from the system after warm-up.
+ */
+class SimulatorEventPoolTestCase : public TestCase
+{
+public:
+  SimulatorEventPoolTestCase ();
+  virtual void DoRun (void);
+  /**
+   * Reschedule itself until no step remains.
+   * \param remaining the number of steps left
+   * \param value an argument making the event larger
+   */
+  void Step (uint32_t remaining, double value);
+  uint64_t m_allocations; //!< the event allocations after warm-up
+  uint64_t m_events;      //!< the executed events after warm-up
+};
+
+SimulatorEventPoolTestCase::SimulatorEventPoolTestCase ()
+  : TestCase ("Check that the storage of the events is recycled")
+{
+}
+
+void
+SimulatorEventPoolTestCase::Step (uint32_t remaining, double value)
+{
+  if (remaining == 1000)
+    {
+      m_allocations = Simulator::GetEventAllocationCount ();
+      m_events = Simulator::GetEventCount ();
+    }
+  if (remaining > 0)
+    {
+      Simulator::Schedule (MicroSeconds (1), &SimulatorEventPoolTestCase::Step, this, remaining - 1, value);
+    }
+}
+
+void
+SimulatorEventPoolTestCase::DoRun (void)
+{
+  Simulator::Schedule (MicroSeconds (1), &SimulatorEventPoolTestCase::Step, this, 1010, 1.0);
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetEventAllocationCount (), m_allocations, "Events allocated in steady state");
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetEventCount () - m_events, 1000, "Unexpected number of events executed");
+  Simulator::Destroy ();
+}
+
 class SimulatorTestSuite : public TestSuite
 {
 public:
@@ -477,5 +603,14 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (HeapScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (CalendarScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory), TestCase::QUICK);
+    AddTestCase (new SimulatorEventPoolTestCase (), TestCase::QUICK);
   }
 } g_simulatorTestSuite;
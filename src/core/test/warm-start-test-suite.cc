@@ -0,0 +1,257 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/warm-start.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+#include "ns3/log-binary.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/test.h"
+
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup simulator
+ * \ingroup simulator-tests
+ * WarmStart test suite.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("WarmStartTestSuite");
+
+  namespace tests {
+
+
+/**
+ * \ingroup simulator-tests
+ * Check that the branches forked from a simulation resume from its state.
+ */
+class WarmStartTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  WarmStartTestCase ();
+  virtual void DoRun (void);
+  /** Record the time of an event. */
+  void Event (void);
+
+private:
+  /** The result of a branch, sent to the test process. */
+  struct Result
+  {
+    uint32_t branch;  //!< the index of the branch
+    uint32_t events;  //!< the number of events run
+    double value;     //!< the value drawn after the fork
+  };
+
+  uint32_t m_events;  //!< number of events run
+  Time m_last;        //!< time of the last event
+};
+
+WarmStartTestCase::WarmStartTestCase ()
+  : TestCase ("Check that forked branches resume from the simulation state")
+{
+}
+
+void
+WarmStartTestCase::Event (void)
+{
+  m_events++;
+  m_last = Simulator::Now ();
+}
+
+void
+WarmStartTestCase::DoRun (void)
+{
+  m_events = 0;
+  Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+  uniform->SetStream (1);
+  uniform->GetValue ();
+
+  Simulator::Schedule (Seconds (0.5), &WarmStartTestCase::Event, this);
+  Simulator::Schedule (Seconds (1.5), &WarmStartTestCase::Event, this);
+  Simulator::Schedule (Seconds (2.5), &WarmStartTestCase::Event, this);
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_events, 1, "Warm-up did not run");
+
+  int fds[2];
+  NS_TEST_ASSERT_MSG_EQ (pipe (fds), 0, "Could not create a pipe");
+
+  const uint32_t nBranches = 3;
+  uint32_t branch = WarmStart::Fork (nBranches, 2);
+  if (branch != WarmStart::SNAPSHOT)
+    {
+      // the test framework can't be used in a branch: report the
+      // results to the test process, and exit without running the
+      // other tests
+      close (fds[0]);
+      Simulator::Stop (Seconds (2));
+      Simulator::Run ();
+      Result result;
+      result.branch = branch;
+      result.events = m_events;
+      result.value = uniform->GetValue ();
+      bool ok = WarmStart::IsBranch () && WarmStart::GetBranch () == branch
+        && m_last == Seconds (2.5)
+        && write (fds[1], &result, sizeof (result)) == sizeof (result);
+      _exit (ok ? 0 : 1);
+    }
+
+  close (fds[1]);
+  NS_TEST_ASSERT_MSG_EQ (WarmStart::IsBranch (), false, "The snapshot is not a branch");
+  NS_TEST_ASSERT_MSG_EQ (WarmStart::GetNFailedBranches (), 0, "A branch failed");
+  NS_TEST_ASSERT_MSG_EQ (Simulator::Now (), Seconds (1), "The snapshot was modified");
+  double expected = uniform->GetValue ();
+  std::set<uint32_t> branches;
+  Result result;
+  while (read (fds[0], &result, sizeof (result)) == sizeof (result))
+    {
+      branches.insert (result.branch);
+      NS_TEST_EXPECT_MSG_EQ (result.events, 3, "Branch " << result.branch << " did not resume the events");
+      NS_TEST_EXPECT_MSG_EQ (result.value, expected, "Branch " << result.branch << " drew a different value");
+    }
+  close (fds[0]);
+  NS_TEST_ASSERT_MSG_EQ (branches.size (), nBranches, "Missing branches");
+  NS_TEST_ASSERT_MSG_EQ (m_events, 1, "The snapshot ran the events of the branches");
+
+  Simulator::Destroy ();
+}
+
+
+/**
+ * \ingroup simulator-tests
+ * Check that the branches record their binary log messages in their own
+ * files, and never write to the file of the snapshot.
+ */
+class WarmStartLogBinaryTestCase : public TestCase
+{
+public:
+  /** Constructor. */
+  WarmStartLogBinaryTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Decode a binary log file.
+   * \param [in] filename The name of the file.
+   * \return The rendered messages, or an empty string if the file could
+   *         not be decoded.
+   */
+  static std::string Decode (std::string filename);
+};
+
+WarmStartLogBinaryTestCase::WarmStartLogBinaryTestCase ()
+  : TestCase ("Check that the branches record their binary log in their own files")
+{
+}
+
+std::string
+WarmStartLogBinaryTestCase::Decode (std::string filename)
+{
+  std::ifstream is (filename.c_str (), std::ios::in | std::ios::binary);
+  std::ostringstream os;
+  if (!LogBinaryDecode (is, os, 0))
+    {
+      return "";
+    }
+  return os.str ();
+}
+
+void
+WarmStartLogBinaryTestCase::DoRun (void)
+{
+  LogComponentEnable ("WarmStartTestSuite", LOG_LEVEL_INFO);
+  std::string filename = CreateTempDirFilename ("warm-start.nslog");
+  NS_TEST_ASSERT_MSG_EQ (LogBinaryOpen (filename), true, "Could not open " << filename);
+  NS_LOG_INFO ("before the fork");
+
+  const uint32_t nBranches = 2;
+  uint32_t branch = WarmStart::Fork (nBranches);
+  if (branch != WarmStart::SNAPSHOT)
+    {
+      NS_LOG_INFO ("branch " << branch);
+      LogBinaryClose ();
+      _exit (0);
+    }
+  NS_TEST_ASSERT_MSG_EQ (WarmStart::GetNFailedBranches (), 0, "A branch failed");
+
+  // a process forked without reopening the binary log drops its records
+  pid_t pid = fork ();
+  if (pid == 0)
+    {
+      NS_LOG_INFO ("child");
+      LogBinaryClose ();
+      _exit (0);
+    }
+  NS_TEST_ASSERT_MSG_GT (pid, 0, "Could not fork");
+  int status;
+  NS_TEST_ASSERT_MSG_EQ (waitpid (pid, &status, 0), pid, "Could not wait for the child");
+
+  NS_LOG_INFO ("after the fork");
+  LogBinaryClose ();
+  LogComponentDisable ("WarmStartTestSuite", LOG_LEVEL_ALL);
+
+  NS_TEST_EXPECT_MSG_EQ (Decode (filename), "before the fork\nafter the fork\n",
+                         "Wrong records in the binary log of the snapshot");
+  for (uint32_t i = 0; i < nBranches; i++)
+    {
+      std::ostringstream branchFilename;
+      branchFilename << filename << "." << i;
+      std::ostringstream expected;
+      expected << "branch " << i << std::endl;
+      NS_TEST_EXPECT_MSG_EQ (Decode (branchFilename.str ()), expected.str (),
+                             "Wrong records in the binary log of branch " << i);
+    }
+}
+
+
+/**
+ * \ingroup simulator-tests
+ *  WarmStart test suite
+ */
+class WarmStartTestSuite : public TestSuite
+{
+public:
+  /** Constructor. */
+  WarmStartTestSuite ()
+    : TestSuite ("warm-start")
+  {
+    AddTestCase (new WarmStartTestCase ());
+    // the logging macros are compiled out of the other builds
+#ifdef NS3_LOG_ENABLE
+    AddTestCase (new WarmStartLogBinaryTestCase ());
+#endif
+  }
+};
+
+/**
+ * \ingroup simulator-tests
+ * WarmStartTestSuite instance variable.
+ */
+static WarmStartTestSuite g_warmStartTestSuite;
+
+
+  }  // namespace tests
+
+}  // namespace ns3
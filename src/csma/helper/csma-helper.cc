@@ -25,9 +25,12 @@
 #include "ns3/queue.h"
 #include "ns3/csma-net-device.h"
 #include "ns3/csma-channel.h"
+#include "ns3/csma-remote-channel.h"
 #include "ns3/config.h"
 #include "ns3/packet.h"
 #include "ns3/names.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/mpi-receiver.h"
 
 #include "ns3/trace-helper.h"
 #include "csma-helper.h"
@@ -43,6 +46,7 @@ CsmaHelper::CsmaHelper ()
   m_queueFactory.SetTypeId ("ns3::DropTailQueue<Packet>");
   m_deviceFactory.SetTypeId ("ns3::CsmaNetDevice");
   m_channelFactory.SetTypeId ("ns3::CsmaChannel");
+  m_remoteChannelFactory.SetTypeId ("ns3::CsmaRemoteChannel");
 }
 
 void 
@@ -71,6 +75,7 @@ void
 CsmaHelper::SetChannelAttribute (std::string n1, const AttributeValue &v1)
 {
   m_channelFactory.Set (n1, v1);
+  m_remoteChannelFactory.Set (n1, v1);
 }
 
 void 
@@ -258,7 +263,22 @@ CsmaHelper::Install (std::string nodeName, std::string channelName) const
 NetDeviceContainer 
 CsmaHelper::Install (const NodeContainer &c) const
 {
-  Ptr<CsmaChannel> channel = m_channelFactory.Create ()->GetObject<CsmaChannel> ();
+  // If MPI is enabled, we need to see if all the nodes have the same system
+  // id (rank) as this instance. If so, use a normal csma channel, otherwise
+  // use a remote channel
+  bool useNormalChannel = true;
+  if (MpiInterface::IsEnabled ())
+    {
+      for (NodeContainer::Iterator i = c.Begin (); i != c.End (); i++)
+        {
+          if ((*i)->GetSystemId () != MpiInterface::GetSystemId ())
+            {
+              useNormalChannel = false;
+            }
+        }
+    }
+  Ptr<CsmaChannel> channel = useNormalChannel ? m_channelFactory.Create<CsmaChannel> ()
+    : m_remoteChannelFactory.Create<CsmaChannel> ();
 
   return Install (c, channel);
 }
@@ -308,6 +328,13 @@ CsmaHelper::InstallPriv (Ptr<Node> node, Ptr<CsmaChannel> channel) const
   node->AddDevice (device);
   Ptr<Queue<Packet> > queue = m_queueFactory.Create<Queue<Packet> > ();
   device->SetQueue (queue);
+  Ptr<CsmaRemoteChannel> remoteChannel = DynamicCast<CsmaRemoteChannel> (channel);
+  if (remoteChannel != 0)
+    {
+      Ptr<MpiReceiver> mpiRec = CreateObject<MpiReceiver> ();
+      mpiRec->SetReceiveCallback (MakeCallback (&CsmaRemoteChannel::RemoteTransmitStart, remoteChannel));
+      device->AggregateObject (mpiRec);
+    }
   device->Attach (channel);
 
   return device;
@@ -163,6 +163,10 @@ public:
    * configured by CsmaHelper::SetDeviceAttribute); adds the device to the 
    * node; and attaches the channel to the device.
    *
+   * If MPI is enabled and some of the nodes belong to other ranks, the
+   * channel is an ns3::CsmaRemoteChannel, and an ns3::MpiReceiver is
+   * aggregated to each device.
+   *
    * \param c The NodeContainer holding the nodes to be changed.
    * \returns A container holding the added net devices.
    */
@@ -250,6 +254,7 @@ private:
   ObjectFactory m_queueFactory;   //!< factory for the queues
   ObjectFactory m_deviceFactory;  //!< factory for the NetDevices
   ObjectFactory m_channelFactory; //!< factory for the channel
+  ObjectFactory m_remoteChannelFactory; //!< factory for the channel spanning several ranks
 };
 
 } // namespace ns3
@@ -306,7 +306,7 @@ CsmaChannel::GetDeviceNum (Ptr<CsmaNetDevice> device)
 bool
 CsmaChannel::IsBusy (void)
 {
-  if (m_state == IDLE) 
+  if (GetState () == IDLE) 
     {
       return false;
     } 
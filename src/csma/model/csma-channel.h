@@ -184,7 +184,7 @@ public:
    * \return True if the channel is not busy and the transmitting net
    * device is currently active.
    */
-  bool TransmitStart (Ptr<const Packet> p, uint32_t srcId);
+  virtual bool TransmitStart (Ptr<const Packet> p, uint32_t srcId);
 
   /**
    * \brief Indicates that the net device has finished transmitting
@@ -200,7 +200,7 @@ public:
    * \return Returns true unless the source was detached before it
    * completed its transmission.
    */
-  bool TransmitEnd ();
+  virtual bool TransmitEnd ();
 
   /**
    * \brief Indicates that the channel has finished propagating the
@@ -224,7 +224,7 @@ public:
    * \return Returns the state of the channel (IDLE -- free,
    * TRANSMITTING -- busy, PROPAGATING - busy )
    */
-  WireState GetState ();
+  virtual WireState GetState ();
 
   /**
    * \brief Indicates if the channel is busy. The channel will only
@@ -308,6 +308,7 @@ private:
    */
   CsmaChannel &operator = (CsmaChannel const &o);
 
+protected:
   /**
    * The assigned data rate of the channel
    */
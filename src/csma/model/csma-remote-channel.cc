@@ -0,0 +1,176 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "csma-remote-channel.h"
+#include "csma-net-device.h"
+#include "ns3/packet.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+#include "ns3/mpi-interface.h"
+
+#include <set>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("CsmaRemoteChannel");
+
+NS_OBJECT_ENSURE_REGISTERED (CsmaRemoteChannel);
+
+TypeId
+CsmaRemoteChannel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CsmaRemoteChannel")
+    .SetParent<CsmaChannel> ()
+    .SetGroupName ("Csma")
+    .AddConstructor<CsmaRemoteChannel> ()
+  ;
+  return tid;
+}
+
+CsmaRemoteChannel::CsmaRemoteChannel ()
+  : CsmaChannel (),
+    m_remoteTransmissions (0)
+{
+}
+
+CsmaRemoteChannel::~CsmaRemoteChannel ()
+{
+}
+
+bool
+CsmaRemoteChannel::IsLocal (Ptr<CsmaNetDevice> device)
+{
+  return device->GetNode ()->GetSystemId () == MpiInterface::GetSystemId ();
+}
+
+WireState
+CsmaRemoteChannel::GetState ()
+{
+  WireState state = CsmaChannel::GetState ();
+  if (state == IDLE && m_remoteTransmissions > 0)
+    {
+      return TRANSMITTING;
+    }
+  return state;
+}
+
+bool
+CsmaRemoteChannel::TransmitStart (Ptr<const Packet> p, uint32_t srcId)
+{
+  NS_LOG_FUNCTION (this << p << srcId);
+
+  if (m_remoteTransmissions > 0)
+    {
+      NS_LOG_WARN ("CsmaRemoteChannel::TransmitStart(): A packet from another rank is being received");
+      return false;
+    }
+  if (!CsmaChannel::TransmitStart (p, srcId))
+    {
+      return false;
+    }
+
+  std::set<uint32_t> ranks;
+  for (std::vector<CsmaDeviceRec>::const_iterator it = m_deviceList.begin (); it != m_deviceList.end (); it++)
+    {
+      Ptr<Node> node = it->devicePtr->GetNode ();
+      if (IsLocal (it->devicePtr) || !ranks.insert (node->GetSystemId ()).second)
+        {
+          continue;
+        }
+#ifdef NS3_MPI
+      NS_ASSERT_MSG (m_delay.IsStrictlyPositive (), "The delay of a remote csma channel must be positive");
+      // the first bit reaches the devices of the other ranks after the delay
+      MpiInterface::SendPacket (p->Copy (), Simulator::Now () + m_delay, node->GetId (), it->devicePtr->GetIfIndex ());
+#else
+      NS_FATAL_ERROR ("Can't use distributed simulator without MPI compiled in");
+#endif
+    }
+  return true;
+}
+
+bool
+CsmaRemoteChannel::TransmitEnd ()
+{
+  NS_LOG_FUNCTION (this << m_currentPkt << m_currentSrc);
+  NS_LOG_INFO ("UID is " << m_currentPkt->GetUid () << ")");
+
+  NS_ASSERT (m_state == TRANSMITTING);
+  m_state = PROPAGATING;
+
+  bool retVal = true;
+
+  if (!IsActive (m_currentSrc))
+    {
+      NS_LOG_ERROR ("CsmaRemoteChannel::TransmitEnd(): Seclected source was detached before the end of the transmission");
+      retVal = false;
+    }
+
+  for (std::vector<CsmaDeviceRec>::iterator it = m_deviceList.begin (); it < m_deviceList.end (); it++)
+    {
+      // the other ranks deliver the packet to their own devices
+      if (it->IsActive () && IsLocal (it->devicePtr))
+        {
+          Simulator::ScheduleWithContext (it->devicePtr->GetNode ()->GetId (),
+                                          m_delay,
+                                          &CsmaNetDevice::Receive, it->devicePtr,
+                                          m_currentPkt->Copy (), m_deviceList[m_currentSrc].devicePtr);
+        }
+    }
+
+  // also schedule for the tx side to go back to IDLE
+  Simulator::Schedule (m_delay, &CsmaChannel::PropagationCompleteEvent,
+                       this);
+  return retVal;
+}
+
+void
+CsmaRemoteChannel::RemoteTransmitStart (Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION (this << p);
+  NS_LOG_INFO ("UID is " << p->GetUid () << ")");
+
+  if (CsmaChannel::GetState () == TRANSMITTING)
+    {
+      NS_LOG_WARN ("CsmaRemoteChannel::RemoteTransmitStart(): A local device is transmitting");
+    }
+  m_remoteTransmissions++;
+  Simulator::Schedule (m_bps.CalculateBytesTxTime (p->GetSize ()), &CsmaRemoteChannel::RemoteTransmitEnd,
+                       this, p);
+}
+
+void
+CsmaRemoteChannel::RemoteTransmitEnd (Ptr<Packet> p)
+{
+  NS_LOG_FUNCTION (this << p);
+
+  NS_ASSERT (m_remoteTransmissions > 0);
+  m_remoteTransmissions--;
+
+  for (std::vector<CsmaDeviceRec>::iterator it = m_deviceList.begin (); it < m_deviceList.end (); it++)
+    {
+      if (it->IsActive () && IsLocal (it->devicePtr))
+        {
+          // the sender is not local
+          Simulator::ScheduleWithContext (it->devicePtr->GetNode ()->GetId (),
+                                          Seconds (0),
+                                          &CsmaNetDevice::Receive, it->devicePtr,
+                                          p->Copy (), Ptr<CsmaNetDevice> (0));
+        }
+    }
+}
+
+} // namespace ns3
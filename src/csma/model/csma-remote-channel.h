@@ -0,0 +1,132 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This object connects csma net devices of which some are not local to this
+// simulator object. Packets sent by the local devices are sent to the other
+// simulator objects with MPI, which mark the channel busy while they arrive.
+
+#ifndef CSMA_REMOTE_CHANNEL_H
+#define CSMA_REMOTE_CHANNEL_H
+
+#include "csma-channel.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup csma
+ *
+ * \brief A Remote Csma Channel
+ *
+ * This object connects csma net devices of which some are not local to
+ * this simulator object, i.e., belong to nodes of other MPI ranks. Each
+ * rank holds a copy of the channel, which delivers packets to the local
+ * devices only.
+ *
+ * When a local device starts transmitting, the packet is sent with MPI to
+ * one device of every other rank attached to the channel, to be received
+ * when its first bit reaches the remote devices, i.e., after the delay of
+ * the channel. The copy of the channel of the receiving rank is then busy
+ * for the transmission time of the packet, so that its local devices defer
+ * their transmissions as they would for a local one, and the packet is
+ * delivered to its local devices at the end of the transmission. The delay
+ * of the channel is therefore the lookahead of the link between the ranks,
+ * and it must be positive.
+ *
+ * As with CsmaChannel, collisions are not modeled: a packet arriving from
+ * another rank while a local device is transmitting is delivered as well.
+ *
+ * Without MPI compiled in, the channel can only be used as long as all of
+ * its devices are local.
+ */
+class CsmaRemoteChannel : public CsmaChannel
+{
+public:
+  /**
+   * \brief Get the TypeId
+   *
+   * \return The TypeId for this class
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief Constructor
+   */
+  CsmaRemoteChannel ();
+
+  /**
+   * \brief Deconstructor
+   */
+  ~CsmaRemoteChannel ();
+
+  /**
+   * \brief Start transmitting a packet over the channel, and send it to
+   * the other ranks attached to the channel
+   *
+   * \param p A reference to the packet that will be transmitted over
+   * the channel
+   * \param srcId The device Id of the net device that wants to
+   * transmit on the channel.
+   * \return True if the channel is not busy and the transmitting net
+   * device is currently active.
+   */
+  virtual bool TransmitStart (Ptr<const Packet> p, uint32_t srcId);
+
+  /**
+   * \brief Indicates that the net device has finished transmitting
+   * the packet over the channel, and deliver it to the local devices
+   *
+   * \return Returns true unless the source was detached before it
+   * completed its transmission.
+   */
+  virtual bool TransmitEnd ();
+
+  /**
+   * \return Returns the state of the channel, which is busy while
+   * packets from other ranks arrive
+   */
+  virtual WireState GetState ();
+
+  /**
+   * \brief Indicates that the first bit of a packet sent by another rank
+   * reached the local devices.
+   *
+   * This is the receive callback of the MpiReceiver of the local devices.
+   *
+   * \param p The packet
+   */
+  void RemoteTransmitStart (Ptr<Packet> p);
+
+private:
+  /**
+   * \brief Deliver a packet sent by another rank to the local devices
+   * once its last bit reached them.
+   *
+   * \param p The packet
+   */
+  void RemoteTransmitEnd (Ptr<Packet> p);
+
+  /**
+   * \param device A device attached to the channel
+   * \return Whether the node of the device belongs to this rank
+   */
+  static bool IsLocal (Ptr<CsmaNetDevice> device);
+
+  uint32_t m_remoteTransmissions;  //!< number of packets from other ranks being received
+};
+
+} // namespace ns3
+
+#endif /* CSMA_REMOTE_CHANNEL_H */
@@ -0,0 +1,273 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/data-rate.h"
+#include "ns3/ethernet-header.h"
+#include "ns3/ethernet-trailer.h"
+#include "ns3/mpi-receiver.h"
+#include "ns3/csma-helper.h"
+#include "ns3/csma-net-device.h"
+#include "ns3/csma-remote-channel.h"
+
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup csma
+ * \defgroup csma-test csma module tests
+ */
+
+/**
+ * \ingroup csma-test
+ * \ingroup tests
+ *
+ * \brief Base class of the CsmaRemoteChannel tests, recording the time at
+ * which each local node receives packets.
+ */
+class CsmaRemoteChannelTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param name the name of the test case
+   */
+  CsmaRemoteChannelTestCase (std::string name);
+
+protected:
+  /**
+   * Create a remote channel (8 Mbps, 10 us) with a device for each node,
+   * and record the packets received by the nodes.
+   * \param nodes the nodes
+   */
+  void Setup (NodeContainer nodes);
+  /**
+   * \param size the size of the payload
+   * \return an Ethernet frame as sent by a device of another rank
+   */
+  static Ptr<Packet> CreateFrame (uint32_t size);
+  /**
+   * Send a broadcast packet from a device
+   * \param device the device
+   * \param size the size of the payload
+   */
+  void Send (Ptr<NetDevice> device, uint32_t size);
+  /**
+   * Record the reception of a packet by a node
+   * \param device the receiving device
+   * \param packet the packet
+   * \param protocol the protocol
+   * \param from the sender address
+   * \param to the destination address
+   * \param packetType the packet type
+   */
+  void Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                const Address &from, const Address &to, NetDevice::PacketType packetType);
+  /**
+   * Record the state of the channel
+   */
+  void CheckState (void);
+
+  Ptr<CsmaRemoteChannel> m_channel;              //!< the channel
+  NetDeviceContainer m_devices;                  //!< the devices
+  std::vector<std::vector<Time> > m_rxTimes;     //!< reception times, per device
+  std::vector<WireState> m_states;               //!< recorded channel states
+};
+
+CsmaRemoteChannelTestCase::CsmaRemoteChannelTestCase (std::string name)
+  : TestCase (name)
+{
+}
+
+void
+CsmaRemoteChannelTestCase::Setup (NodeContainer nodes)
+{
+  m_channel = CreateObject<CsmaRemoteChannel> ();
+  m_channel->SetAttribute ("DataRate", DataRateValue (DataRate ("8Mbps")));
+  m_channel->SetAttribute ("Delay", TimeValue (MicroSeconds (10)));
+  CsmaHelper csma;
+  m_devices = csma.Install (nodes, m_channel);
+  m_rxTimes.resize (nodes.GetN ());
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      nodes.Get (i)->RegisterProtocolHandler (MakeCallback (&CsmaRemoteChannelTestCase::Receive, this),
+                                              0x800, m_devices.Get (i));
+    }
+}
+
+Ptr<Packet>
+CsmaRemoteChannelTestCase::CreateFrame (uint32_t size)
+{
+  Ptr<Packet> p = Create<Packet> (size);
+  EthernetHeader header (false);
+  header.SetSource (Mac48Address ("00:00:00:00:00:99"));
+  header.SetDestination (Mac48Address::GetBroadcast ());
+  header.SetLengthType (0x800);
+  p->AddHeader (header);
+  EthernetTrailer trailer;
+  p->AddTrailer (trailer);
+  return p;
+}
+
+void
+CsmaRemoteChannelTestCase::Send (Ptr<NetDevice> device, uint32_t size)
+{
+  device->Send (Create<Packet> (size), device->GetBroadcast (), 0x800);
+}
+
+void
+CsmaRemoteChannelTestCase::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                                    const Address &from, const Address &to, NetDevice::PacketType packetType)
+{
+  for (uint32_t i = 0; i < m_devices.GetN (); i++)
+    {
+      if (m_devices.Get (i) == device)
+        {
+          m_rxTimes[i].push_back (Simulator::Now ());
+        }
+    }
+}
+
+void
+CsmaRemoteChannelTestCase::CheckState (void)
+{
+  m_states.push_back (m_channel->GetState ());
+}
+
+/**
+ * \ingroup csma-test
+ * \ingroup tests
+ *
+ * \brief Check that a packet received through the MpiReceiver of a device
+ * keeps the channel busy for its transmission time, and is then delivered
+ * to all the local devices.
+ */
+class CsmaRemoteChannelReceiveTestCase : public CsmaRemoteChannelTestCase
+{
+public:
+  CsmaRemoteChannelReceiveTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+CsmaRemoteChannelReceiveTestCase::CsmaRemoteChannelReceiveTestCase ()
+  : CsmaRemoteChannelTestCase ("Receive a packet from another rank")
+{
+}
+
+void
+CsmaRemoteChannelReceiveTestCase::DoRun (void)
+{
+  // the third node belongs to another rank
+  NodeContainer nodes;
+  nodes.Create (2);
+  nodes.Add (CreateObject<Node> (1));
+  Setup (nodes);
+
+  // 100 bytes of payload, plus 14 bytes of header and 4 bytes of trailer
+  Time txTime = DataRate ("8Mbps").CalculateBytesTxTime (118);
+  Ptr<MpiReceiver> receiver = m_devices.Get (0)->GetObject<MpiReceiver> ();
+  NS_TEST_ASSERT_MSG_NE (receiver, 0, "No MpiReceiver aggregated to the device");
+  Simulator::ScheduleWithContext (nodes.Get (0)->GetId (), Seconds (1), &MpiReceiver::Receive, receiver, CreateFrame (100));
+  Simulator::Schedule (Seconds (1) + MicroSeconds (59), &CsmaRemoteChannelReceiveTestCase::CheckState, this);
+  Simulator::Schedule (Seconds (1) + MicroSeconds (119), &CsmaRemoteChannelReceiveTestCase::CheckState, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_rxTimes[i].size (), 1, "Packet not delivered to local node " << i);
+      NS_TEST_EXPECT_MSG_EQ (m_rxTimes[i][0], Seconds (1) + txTime, "Wrong reception time at node " << i);
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_rxTimes[2].size (), 0, "Packet delivered to a node of another rank");
+  NS_TEST_ASSERT_MSG_EQ (m_states.size (), 2, "Channel state not checked");
+  NS_TEST_EXPECT_MSG_EQ (m_states[0], TRANSMITTING, "Channel idle while receiving from another rank");
+  NS_TEST_EXPECT_MSG_EQ (m_states[1], IDLE, "Channel busy after the reception");
+}
+
+/**
+ * \ingroup csma-test
+ * \ingroup tests
+ *
+ * \brief Check that the packets sent by the local devices are delivered
+ * after their transmission time and the delay of the channel, and that the
+ * local devices defer their transmissions while a packet from another rank
+ * is being received.
+ */
+class CsmaRemoteChannelDeferTestCase : public CsmaRemoteChannelTestCase
+{
+public:
+  CsmaRemoteChannelDeferTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+CsmaRemoteChannelDeferTestCase::CsmaRemoteChannelDeferTestCase ()
+  : CsmaRemoteChannelTestCase ("Defer the local transmissions to the packets of another rank")
+{
+}
+
+void
+CsmaRemoteChannelDeferTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+  Setup (nodes);
+  Time txTime = DataRate ("8Mbps").CalculateBytesTxTime (118);
+
+  // a packet from another rank, while the first node starts sending
+  Simulator::Schedule (Seconds (1), &CsmaRemoteChannel::RemoteTransmitStart, m_channel, CreateFrame (100));
+  Simulator::Schedule (Seconds (1) + MicroSeconds (10), &CsmaRemoteChannelDeferTestCase::Send, this, m_devices.Get (0), 100);
+  // a packet on an idle channel
+  Simulator::Schedule (Seconds (2), &CsmaRemoteChannelDeferTestCase::Send, this, m_devices.Get (1), 100);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_rxTimes[0].size (), 2, "Wrong number of packets received by node 0");
+  NS_TEST_ASSERT_MSG_EQ (m_rxTimes[1].size (), 2, "Wrong number of packets received by node 1");
+  NS_TEST_EXPECT_MSG_EQ (m_rxTimes[0][0], Seconds (1) + txTime, "Wrong reception time of the remote packet");
+  NS_TEST_EXPECT_MSG_EQ (m_rxTimes[1][0], Seconds (1) + txTime, "Wrong reception time of the remote packet");
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (m_rxTimes[1][1], Seconds (1) + txTime + txTime + MicroSeconds (10), "Local packet not deferred");
+  NS_TEST_EXPECT_MSG_LT (m_rxTimes[1][1], Seconds (2), "Local packet not sent after the deferral");
+  NS_TEST_EXPECT_MSG_EQ (m_rxTimes[0][1], Seconds (2) + txTime + MicroSeconds (10), "Wrong reception time of the local packet");
+}
+
+/**
+ * \ingroup csma-test
+ * \ingroup tests
+ *
+ * \brief CsmaRemoteChannel test suite
+ */
+class CsmaRemoteChannelTestSuite : public TestSuite
+{
+public:
+  CsmaRemoteChannelTestSuite ();
+};
+
+CsmaRemoteChannelTestSuite::CsmaRemoteChannelTestSuite ()
+  : TestSuite ("csma-remote-channel", UNIT)
+{
+  AddTestCase (new CsmaRemoteChannelReceiveTestCase, TestCase::QUICK);
+  AddTestCase (new CsmaRemoteChannelDeferTestCase, TestCase::QUICK);
+}
+
+static CsmaRemoteChannelTestSuite g_csmaRemoteChannelTestSuite; //!< Static variable for test initialization
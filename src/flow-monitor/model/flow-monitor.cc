@@ -26,6 +26,8 @@
 #include <sstream>
 
 #define PERIODIC_CHECK_INTERVAL (Seconds (1))
+// Largest gap between the FlowPacketIds of a flow kept in its ring
+#define MAX_RING_GAP 1024
 
 namespace ns3 {
 
@@ -80,7 +82,8 @@ FlowMonitor::GetInstanceTypeId (void) const
 }
 
 FlowMonitor::FlowMonitor ()
-  : m_enabled (false)
+  : m_firstLossBucket (0),
+    m_enabled (false)
 {
   // m_histogramBinWidth=DEFAULT_BIN_WIDTH;
 }
@@ -99,6 +102,9 @@ FlowMonitor::DoDispose (void)
       m_flowProbes[i]->Dispose ();
       m_flowProbes[i] = 0;
     }
+  m_exportStream.close ();
+  m_trackedFlows.clear ();
+  m_lossBuckets.clear ();
   Object::DoDispose ();
 }
 
@@ -132,6 +138,118 @@ FlowMonitor::GetStatsForFlow (FlowId flowId)
 }
 
 
+/**
+ * Get the index of the loss bucket of a time.
+ * \param time the time
+ * \returns the index of the loss bucket
+ */
+static inline int64_t
+LossBucketIndex (Time time)
+{
+  return time.GetTimeStep () / PERIODIC_CHECK_INTERVAL.GetTimeStep ();
+}
+
+FlowMonitor::TrackedFlow&
+FlowMonitor::GetTrackedFlow (FlowId flowId)
+{
+  TrackedFlowMap::iterator iter = m_trackedFlows.find (flowId);
+  if (iter != m_trackedFlows.end ())
+    {
+      return iter->second;
+    }
+  TrackedFlow &flow = m_trackedFlows[flowId];
+  flow.stats = &GetStatsForFlow (flowId);
+  flow.firstPacketId = 0;
+  flow.exported.txBytes = 0;
+  flow.exported.rxBytes = 0;
+  flow.exported.txPackets = 0;
+  flow.exported.rxPackets = 0;
+  flow.exported.lostPackets = 0;
+  return flow;
+}
+
+FlowMonitor::TrackedPacket*
+FlowMonitor::FindTrackedPacket (TrackedFlow &flow, FlowPacketId packetId)
+{
+  FlowPacketId offset = packetId - flow.firstPacketId;
+  if (offset < flow.ring.size () && !flow.ring[offset].firstSeenTime.IsStrictlyNegative ())
+    {
+      return &flow.ring[offset];
+    }
+  // the ring may have been rebased over packets tracked in the others map
+  if (!flow.others.empty ())
+    {
+      std::map<FlowPacketId, TrackedPacket>::iterator iter = flow.others.find (packetId);
+      if (iter != flow.others.end ())
+        {
+          return &iter->second;
+        }
+    }
+  return 0;
+}
+
+FlowMonitor::TrackedPacket&
+FlowMonitor::InsertTrackedPacket (TrackedFlow &flow, FlowPacketId packetId)
+{
+  if (flow.ring.empty ())
+    {
+      flow.firstPacketId = packetId;
+    }
+  FlowPacketId offset = packetId - flow.firstPacketId;
+  if (offset < flow.ring.size () + MAX_RING_GAP)
+    {
+      if (offset >= flow.ring.size ())
+        {
+          TrackedPacket untracked;
+          untracked.firstSeenTime = Seconds (-1);
+          flow.ring.resize (offset + 1, untracked);
+        }
+      return flow.ring[offset];
+    }
+  // the packets identifiers of this flow are not sequential
+  return flow.others[packetId];
+}
+
+void
+FlowMonitor::EraseTrackedPacket (TrackedFlow &flow, FlowPacketId packetId)
+{
+  FlowPacketId offset = packetId - flow.firstPacketId;
+  if (offset < flow.ring.size () && !flow.ring[offset].firstSeenTime.IsStrictlyNegative ())
+    {
+      flow.ring[offset].firstSeenTime = Seconds (-1);
+      while (!flow.ring.empty () && flow.ring.front ().firstSeenTime.IsStrictlyNegative ())
+        {
+          flow.ring.pop_front ();
+          flow.firstPacketId++;
+        }
+    }
+  else
+    {
+      flow.others.erase (packetId);
+    }
+}
+
+void
+FlowMonitor::AddToLossBucket (FlowId flowId, FlowPacketId packetId, Time lastSeenTime)
+{
+  int64_t index = LossBucketIndex (lastSeenTime);
+  if (m_lossBuckets.empty ())
+    {
+      m_firstLossBucket = index;
+    }
+  while (index < m_firstLossBucket)
+    {
+      m_lossBuckets.push_front (LossBucket ());
+      m_firstLossBucket--;
+    }
+  if (index - m_firstLossBucket >= static_cast<int64_t> (m_lossBuckets.size ()))
+    {
+      m_lossBuckets.resize (index - m_firstLossBucket + 1);
+    }
+  m_lossBuckets[index - m_firstLossBucket].push_back (std::make_pair (flowId, packetId));
+}
+
+
 void
 FlowMonitor::ReportFirstTx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packetId, uint32_t packetSize)
 {
@@ -140,16 +258,18 @@ FlowMonitor::ReportFirstTx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t pack
       return;
     }
   Time now = Simulator::Now ();
-  TrackedPacket &tracked = m_trackedPackets[std::make_pair (flowId, packetId)];
+  TrackedFlow &flow = GetTrackedFlow (flowId);
+  TrackedPacket &tracked = InsertTrackedPacket (flow, packetId);
   tracked.firstSeenTime = now;
   tracked.lastSeenTime = tracked.firstSeenTime;
   tracked.timesForwarded = 0;
+  AddToLossBucket (flowId, packetId, now);
   NS_LOG_DEBUG ("ReportFirstTx: adding tracked packet (flowId=" << flowId << ", packetId=" << packetId
                                                                 << ").");
 
   probe->AddPacketStats (flowId, packetSize, Seconds (0));
 
-  FlowStats &stats = GetStatsForFlow (flowId);
+  FlowStats &stats = *flow.stats;
   stats.txBytes += packetSize;
   stats.txPackets++;
   if (stats.txPackets == 1)
@@ -167,19 +287,28 @@ FlowMonitor::ReportForwarding (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t p
     {
       return;
     }
-  std::pair<FlowId, FlowPacketId> key (flowId, packetId);
-  TrackedPacketMap::iterator tracked = m_trackedPackets.find (key);
-  if (tracked == m_trackedPackets.end ())
+  TrackedFlowMap::iterator flow = m_trackedFlows.find (flowId);
+  TrackedPacket *tracked = 0;
+  if (flow != m_trackedFlows.end ())
+    {
+      tracked = FindTrackedPacket (flow->second, packetId);
+    }
+  if (tracked == 0)
     {
       NS_LOG_WARN ("Received packet forward report (flowId=" << flowId << ", packetId=" << packetId
                                                              << ") but not known to be transmitted.");
       return;
     }
 
-  tracked->second.timesForwarded++;
-  tracked->second.lastSeenTime = Simulator::Now ();
+  Time now = Simulator::Now ();
+  tracked->timesForwarded++;
+  if (LossBucketIndex (tracked->lastSeenTime) != LossBucketIndex (now))
+    {
+      AddToLossBucket (flowId, packetId, now);
+    }
+  tracked->lastSeenTime = now;
 
-  Time delay = (Simulator::Now () - tracked->second.firstSeenTime);
+  Time delay = (now - tracked->firstSeenTime);
   probe->AddPacketStats (flowId, packetSize, delay);
 }
 
@@ -191,8 +320,13 @@ FlowMonitor::ReportLastRx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packe
     {
       return;
     }
-  TrackedPacketMap::iterator tracked = m_trackedPackets.find (std::make_pair (flowId, packetId));
-  if (tracked == m_trackedPackets.end ())
+  TrackedFlowMap::iterator flow = m_trackedFlows.find (flowId);
+  TrackedPacket *tracked = 0;
+  if (flow != m_trackedFlows.end ())
+    {
+      tracked = FindTrackedPacket (flow->second, packetId);
+    }
+  if (tracked == 0)
     {
       NS_LOG_WARN ("Received packet last-tx report (flowId=" << flowId << ", packetId=" << packetId
                                                              << ") but not known to be transmitted.");
@@ -200,10 +334,10 @@ FlowMonitor::ReportLastRx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packe
     }
 
   Time now = Simulator::Now ();
-  Time delay = (now - tracked->second.firstSeenTime);
+  Time delay = (now - tracked->firstSeenTime);
   probe->AddPacketStats (flowId, packetSize, delay);
 
-  FlowStats &stats = GetStatsForFlow (flowId);
+  FlowStats &stats = *flow->second.stats;
   stats.delaySum += delay;
   stats.delayHistogram.AddValue (delay.GetSeconds ());
   if (stats.rxPackets > 0 )
@@ -239,12 +373,12 @@ FlowMonitor::ReportLastRx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packe
         }
     }
   stats.timeLastRxPacket = now;
-  stats.timesForwarded += tracked->second.timesForwarded;
+  stats.timesForwarded += tracked->timesForwarded;
 
   NS_LOG_DEBUG ("ReportLastTx: removing tracked packet (flowId="
                 << flowId << ", packetId=" << packetId << ").");
 
-  m_trackedPackets.erase (tracked); // we don't need to track this packet anymore
+  EraseTrackedPacket (flow->second, packetId); // we don't need to track this packet anymore
 }
 
 void
@@ -258,7 +392,8 @@ FlowMonitor::ReportDrop (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packetI
 
   probe->AddPacketDropStats (flowId, packetSize, reasonCode);
 
-  FlowStats &stats = GetStatsForFlow (flowId);
+  TrackedFlow &flow = GetTrackedFlow (flowId);
+  FlowStats &stats = *flow.stats;
   stats.lostPackets++;
   if (stats.packetsDropped.size () < reasonCode + 1)
     {
@@ -269,14 +404,13 @@ FlowMonitor::ReportDrop (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packetI
   stats.bytesDropped[reasonCode] += packetSize;
   NS_LOG_DEBUG ("++stats.packetsDropped[" << reasonCode<< "]; // becomes: " << stats.packetsDropped[reasonCode]);
 
-  TrackedPacketMap::iterator tracked = m_trackedPackets.find (std::make_pair (flowId, packetId));
-  if (tracked != m_trackedPackets.end ())
+  if (FindTrackedPacket (flow, packetId) != 0)
     {
       // we don't need to track this packet anymore
       // FIXME: this will not necessarily be true with broadcast/multicast
       NS_LOG_DEBUG ("ReportDrop: removing tracked packet (flowId="
                     << flowId << ", packetId=" << packetId << ").");
-      m_trackedPackets.erase (tracked);
+      EraseTrackedPacket (flow, packetId);
     }
 }
 
@@ -290,25 +424,44 @@ FlowMonitor::GetFlowStats () const
 void
 FlowMonitor::CheckForLostPackets (Time maxDelay)
 {
-  Time now = Simulator::Now ();
+  Time threshold = Simulator::Now () - maxDelay;
 
-  for (TrackedPacketMap::iterator iter = m_trackedPackets.begin ();
-       iter != m_trackedPackets.end (); )
+  // only the buckets of the packets last seen before the threshold are
+  // checked; their entries are stale if the packets were seen again since
+  while (!m_lossBuckets.empty ()
+         && m_firstLossBucket * PERIODIC_CHECK_INTERVAL.GetTimeStep () <= threshold.GetTimeStep ())
     {
-      if (now - iter->second.lastSeenTime >= maxDelay)
+      LossBucket &bucket = m_lossBuckets.front ();
+      LossBucket kept;
+      for (LossBucket::const_iterator iter = bucket.begin (); iter != bucket.end (); iter++)
         {
-          // packet is considered lost, add it to the loss statistics
-          FlowStatsContainerI flow = m_flowStats.find (iter->first.first);
-          NS_ASSERT (flow != m_flowStats.end ());
-          flow->second.lostPackets++;
-
-          // we won't track it anymore
-          m_trackedPackets.erase (iter++);
+          TrackedFlowMap::iterator flow = m_trackedFlows.find (iter->first);
+          NS_ASSERT (flow != m_trackedFlows.end ());
+          TrackedPacket *tracked = FindTrackedPacket (flow->second, iter->second);
+          if (tracked == 0 || LossBucketIndex (tracked->lastSeenTime) != m_firstLossBucket)
+            {
+              continue;
+            }
+          if (tracked->lastSeenTime <= threshold)
+            {
+              // packet is considered lost, add it to the loss statistics
+              flow->second.stats->lostPackets++;
+
+              // we won't track it anymore
+              EraseTrackedPacket (flow->second, iter->second);
+            }
+          else
+            {
+              kept.push_back (*iter);
+            }
         }
-      else
+      if (!kept.empty ())
         {
-          iter++;
+          bucket.swap (kept);
+          break;
         }
+      m_lossBuckets.pop_front ();
+      m_firstLossBucket++;
     }
 }
 
@@ -332,6 +485,74 @@ FlowMonitor::NotifyConstructionCompleted ()
   Simulator::Schedule (PERIODIC_CHECK_INTERVAL, &FlowMonitor::PeriodicCheckForLostPackets, this);
 }
 
+void
+FlowMonitor::StartPeriodicExport (std::string fileName, Time interval)
+{
+  StopPeriodicExport ();
+  m_exportStream.open (fileName.c_str (), std::ios::out);
+  if (!m_exportStream.is_open ())
+    {
+      NS_FATAL_ERROR ("Could not open " << fileName);
+    }
+  m_exportStream << "time,flowId,txPackets,txBytes,rxPackets,rxBytes,lostPackets,delaySum,jitterSum\n";
+  m_exportInterval = interval;
+  m_exportEvent = Simulator::Schedule (m_exportInterval, &FlowMonitor::PeriodicExport, this);
+}
+
+void
+FlowMonitor::StopPeriodicExport ()
+{
+  if (!m_exportStream.is_open ())
+    {
+      return;
+    }
+  Simulator::Cancel (m_exportEvent);
+  ExportFlows ();
+  m_exportStream.close ();
+}
+
+void
+FlowMonitor::ExportFlows ()
+{
+  double now = Simulator::Now ().GetSeconds ();
+  for (FlowStatsContainerCI flowI = m_flowStats.begin (); flowI != m_flowStats.end (); flowI++)
+    {
+      const FlowStats &stats = flowI->second;
+      TrackedFlowMap::iterator flow = m_trackedFlows.find (flowI->first);
+      NS_ASSERT (flow != m_trackedFlows.end ());
+      ExportedStats &exported = flow->second.exported;
+      if (stats.txPackets == exported.txPackets && stats.rxPackets == exported.rxPackets
+          && stats.lostPackets == exported.lostPackets)
+        {
+          continue;
+        }
+      m_exportStream << now << "," << flowI->first
+                     << "," << stats.txPackets - exported.txPackets
+                     << "," << stats.txBytes - exported.txBytes
+                     << "," << stats.rxPackets - exported.rxPackets
+                     << "," << stats.rxBytes - exported.rxBytes
+                     << "," << stats.lostPackets - exported.lostPackets
+                     << "," << (stats.delaySum - exported.delaySum).GetSeconds ()
+                     << "," << (stats.jitterSum - exported.jitterSum).GetSeconds ()
+                     << "\n";
+      exported.txPackets = stats.txPackets;
+      exported.txBytes = stats.txBytes;
+      exported.rxPackets = stats.rxPackets;
+      exported.rxBytes = stats.rxBytes;
+      exported.lostPackets = stats.lostPackets;
+      exported.delaySum = stats.delaySum;
+      exported.jitterSum = stats.jitterSum;
+    }
+  m_exportStream.flush ();
+}
+
+void
+FlowMonitor::PeriodicExport ()
+{
+  ExportFlows ();
+  m_exportEvent = Simulator::Schedule (m_exportInterval, &FlowMonitor::PeriodicExport, this);
+}
+
 void
 FlowMonitor::AddProbe (Ptr<FlowProbe> probe)
 {
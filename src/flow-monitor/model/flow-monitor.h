@@ -23,6 +23,9 @@
 
 #include <vector>
 #include <map>
+#include <deque>
+#include <unordered_map>
+#include <fstream>
 
 #include "ns3/ptr.h"
 #include "ns3/object.h"
@@ -256,6 +259,20 @@ public:
   /// \param enableProbes if true, include also the per-probe/flow pair statistics in the output
   void SerializeToXmlFile (std::string fileName, bool enableHistograms, bool enableProbes);
 
+  /// Periodically append the statistics of the flows active during the
+  /// last interval to a CSV file, rather than waiting for the end of the
+  /// simulation to serialize them.  Each line holds the time, the flow
+  /// identifier, and the number of packets and bytes transmitted,
+  /// received and lost, and the sum of the delays and jitters (in
+  /// seconds) of the flow during the interval.
+  /// \param fileName name or path of the output file that will be created
+  /// \param interval the interval between two exports
+  void StartPeriodicExport (std::string fileName, Time interval);
+  /// Export the last interval and close the file of the periodic export.
+  /// Should be called after Simulator::Run, as the last interval is
+  /// otherwise not exported.
+  void StopPeriodicExport ();
+
 
 protected:
 
@@ -272,12 +289,42 @@ private:
     uint32_t timesForwarded; //!< number of times the packet was reportedly forwarded
   };
 
+  /// Structure to represent the counters of a flow at the last periodic export
+  struct ExportedStats
+  {
+    uint64_t txBytes;     //!< number of transmitted bytes
+    uint64_t rxBytes;     //!< number of received bytes
+    uint32_t txPackets;   //!< number of transmitted packets
+    uint32_t rxPackets;   //!< number of received packets
+    uint32_t lostPackets; //!< number of lost packets
+    Time delaySum;        //!< sum of the delays
+    Time jitterSum;       //!< sum of the jitters
+  };
+
+  /// Structure to represent the packets of a flow being tracked
+  struct TrackedFlow
+  {
+    FlowStats *stats; //!< the statistics of the flow
+    /// Packets of the flow, indexed by their FlowPacketId minus
+    /// firstPacketId.  Packets no longer tracked have a negative
+    /// firstSeenTime, until they reach the front of the ring.
+    std::deque<TrackedPacket> ring;
+    FlowPacketId firstPacketId; //!< FlowPacketId of the front of the ring
+    /// Packets whose FlowPacketId does not fit in the ring
+    std::map<FlowPacketId, TrackedPacket> others;
+    ExportedStats exported; //!< the counters at the last periodic export
+  };
+
   /// FlowId --> FlowStats
   FlowStatsContainer m_flowStats;
 
-  /// (FlowId,PacketId) --> TrackedPacket
-  typedef std::map< std::pair<FlowId, FlowPacketId>, TrackedPacket> TrackedPacketMap;
-  TrackedPacketMap m_trackedPackets; //!< Tracked packets
+  /// FlowId --> TrackedFlow
+  typedef std::unordered_map<FlowId, TrackedFlow> TrackedFlowMap;
+  TrackedFlowMap m_trackedFlows; //!< Tracked flows
+  /// The packets last seen in a bucket of time, to be checked for losses
+  typedef std::vector<std::pair<FlowId, FlowPacketId> > LossBucket;
+  std::deque<LossBucket> m_lossBuckets; //!< Loss buckets, from the oldest one
+  int64_t m_firstLossBucket; //!< Index of the oldest loss bucket
   Time m_maxPerHopDelay; //!< Minimum per-hop delay
   FlowProbeContainer m_flowProbes; //!< all the FlowProbes
 
@@ -293,11 +340,49 @@ private:
   double m_flowInterruptionsBinWidth; //!< Flow interruptions bin width (for histograms)
   Time m_flowInterruptionsMinTime; //!< Flow interruptions minimum time
 
+  std::ofstream m_exportStream; //!< Stream of the periodic export
+  Time m_exportInterval;        //!< Interval of the periodic export
+  EventId m_exportEvent;        //!< Next periodic export event
+
+  /// Get the tracked packets and stats for a given flow
+  /// \param flowId the Flow identification
+  /// \returns the tracked flow
+  TrackedFlow& GetTrackedFlow (FlowId flowId);
+
   /// Get the stats for a given flow
   /// \param flowId the Flow identification
   /// \returns the stats of the flow
   FlowStats& GetStatsForFlow (FlowId flowId);
 
+  /// Find a tracked packet
+  /// \param flow the tracked flow
+  /// \param packetId the Packet ID
+  /// \returns the tracked packet, or 0 if it is not tracked
+  TrackedPacket* FindTrackedPacket (TrackedFlow &flow, FlowPacketId packetId);
+
+  /// Start tracking a packet
+  /// \param flow the tracked flow
+  /// \param packetId the Packet ID
+  /// \returns the tracked packet
+  TrackedPacket& InsertTrackedPacket (TrackedFlow &flow, FlowPacketId packetId);
+
+  /// Stop tracking a packet
+  /// \param flow the tracked flow
+  /// \param packetId the Packet ID
+  void EraseTrackedPacket (TrackedFlow &flow, FlowPacketId packetId);
+
+  /// Add a packet to the loss bucket of the time it was last seen
+  /// \param flowId the Flow identification
+  /// \param packetId the Packet ID
+  /// \param lastSeenTime the time the packet was last seen
+  void AddToLossBucket (FlowId flowId, FlowPacketId packetId, Time lastSeenTime);
+
+  /// Export the statistics of the flows changed since the last export
+  void ExportFlows ();
+
+  /// Periodic function to export the statistics of the last interval
+  void PeriodicExport ();
+
   /// Periodic function to check for lost packets and prune statistics
   void PeriodicCheckForLostPackets ();
 };
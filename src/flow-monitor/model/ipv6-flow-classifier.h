@@ -23,7 +23,8 @@
 #define IPV6_FLOW_CLASSIFIER_H
 
 #include <stdint.h>
-#include <map>
+#include <unordered_map>
+#include <vector>
 
 #include "ns3/ipv6-header.h"
 #include "ns3/flow-classifier.h"
@@ -50,6 +51,16 @@ public:
     uint16_t destinationPort;       //!< Destination port
   };
 
+  /// Hash function of the FiveTuple
+  class FiveTupleHash
+  {
+  public:
+    /// Hash function
+    /// \param tuple the FiveTuple
+    /// \return the hash of the FiveTuple
+    size_t operator() (const FiveTuple &tuple) const;
+  };
+
   Ipv6FlowClassifier ();
 
   /// \brief try to classify the packet into flow-id and packet-id
@@ -93,12 +104,19 @@ public:
 
 private:
 
+  /// Structure to store the state of a flow
+  struct Flow
+  {
+    FiveTuple tuple;            //!< Flow identifier
+    FlowPacketId lastPacketId;  //!< Identifier of the last packet of the flow
+    /// (DSCP value, packet count) pairs, sorted by DSCP value
+    std::vector<std::pair<Ipv6Header::DscpType, uint32_t> > dscpCounts;
+  };
+
   /// Map to Flows Identifiers to FlowIds
-  std::map<FiveTuple, FlowId> m_flowMap;
-  /// Map to FlowIds to FlowPacketId
-  std::map<FlowId, FlowPacketId> m_flowPktIdMap;
-  /// Map FlowIds to (DSCP value, packet count) pairs
-  std::map<FlowId, std::map<Ipv6Header::DscpType, uint32_t> > m_flowDscpMap;
+  std::unordered_map<FiveTuple, FlowId, FiveTupleHash> m_flowMap;
+  /// The flows, indexed by their FlowId minus one
+  std::vector<Flow> m_flows;
 
 };
 
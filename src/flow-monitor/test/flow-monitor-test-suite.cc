@@ -0,0 +1,305 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License version 2 as
+// published by the Free Software Foundation;
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+
+#include "ns3/flow-monitor.h"
+#include "ns3/flow-probe.h"
+#include "ns3/ipv4-flow-classifier.h"
+#include "ns3/udp-header.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+#include <fstream>
+#include <sstream>
+
+using namespace ns3;
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief FlowProbe reporting the packet events of the tests
+ */
+class FlowMonitorTestProbe : public FlowProbe
+{
+public:
+  /**
+   * Constructor
+   * \param monitor the FlowMonitor
+   */
+  FlowMonitorTestProbe (Ptr<FlowMonitor> monitor)
+    : FlowProbe (monitor)
+  {
+  }
+};
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief FlowMonitor tracked packets and losses Test
+ */
+class FlowMonitorLossTestCase : public TestCase
+{
+public:
+  FlowMonitorLossTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Report the first transmission of packets
+   * \param flowId the flow
+   * \param first the first packet
+   * \param last the last packet
+   */
+  void FirstTx (FlowId flowId, FlowPacketId first, FlowPacketId last);
+  /**
+   * Report the reception of packets
+   * \param flowId the flow
+   * \param first the first packet
+   * \param last the last packet
+   */
+  void LastRx (FlowId flowId, FlowPacketId first, FlowPacketId last);
+  /**
+   * Check the statistics of a flow
+   * \param flowId the flow
+   * \param rxPackets the expected number of received packets
+   * \param lostPackets the expected number of lost packets
+   */
+  void CheckStats (FlowId flowId, uint32_t rxPackets, uint32_t lostPackets);
+
+  Ptr<FlowMonitor> m_monitor; //!< the FlowMonitor
+  Ptr<FlowProbe> m_probe;     //!< the FlowProbe
+};
+
+FlowMonitorLossTestCase::FlowMonitorLossTestCase ()
+  : TestCase ("FlowMonitor tracked packets and losses")
+{
+}
+
+void
+FlowMonitorLossTestCase::FirstTx (FlowId flowId, FlowPacketId first, FlowPacketId last)
+{
+  for (FlowPacketId packetId = first; packetId <= last; packetId++)
+    {
+      m_monitor->ReportFirstTx (m_probe, flowId, packetId, 100);
+    }
+}
+
+void
+FlowMonitorLossTestCase::LastRx (FlowId flowId, FlowPacketId first, FlowPacketId last)
+{
+  for (FlowPacketId packetId = first; packetId <= last; packetId++)
+    {
+      m_monitor->ReportLastRx (m_probe, flowId, packetId, 100);
+    }
+}
+
+void
+FlowMonitorLossTestCase::CheckStats (FlowId flowId, uint32_t rxPackets, uint32_t lostPackets)
+{
+  FlowMonitor::FlowStatsContainerCI flow = m_monitor->GetFlowStats ().find (flowId);
+  NS_TEST_ASSERT_MSG_EQ ((flow != m_monitor->GetFlowStats ().end ()), true, "Unknown flow " << flowId);
+  NS_TEST_EXPECT_MSG_EQ (flow->second.rxPackets, rxPackets,
+                         "Wrong received packets at " << Simulator::Now ().GetSeconds ());
+  NS_TEST_EXPECT_MSG_EQ (flow->second.lostPackets, lostPackets,
+                         "Wrong lost packets at " << Simulator::Now ().GetSeconds ());
+}
+
+void
+FlowMonitorLossTestCase::DoRun (void)
+{
+  m_monitor = CreateObject<FlowMonitor> ();
+  m_probe = CreateObject<FlowMonitorTestProbe> (m_monitor);
+  m_monitor->StartRightNow ();
+
+  // packets 7 to 9, and the packet with a non-sequential identifier,
+  // are lost after 10 seconds, and packet 5, last seen at 5 seconds,
+  // after 15 seconds; packet 6 is dropped
+  Simulator::Schedule (Seconds (0), &FlowMonitorLossTestCase::FirstTx, this, 1, 0, 9);
+  Simulator::Schedule (Seconds (0), &FlowMonitorLossTestCase::FirstTx, this, 1, 100000, 100000);
+  Simulator::Schedule (Seconds (0.5), &FlowMonitorLossTestCase::LastRx, this, 1, 0, 4);
+  Simulator::Schedule (Seconds (5), &FlowMonitor::ReportForwarding, m_monitor, m_probe, 1, 5, 100);
+  Simulator::Schedule (Seconds (5), &FlowMonitor::ReportDrop, m_monitor, m_probe, 1, 6, 100, 0);
+  Simulator::Schedule (Seconds (9.5), &FlowMonitorLossTestCase::CheckStats, this, 1, 5, 1);
+  Simulator::Schedule (Seconds (10.5), &FlowMonitorLossTestCase::CheckStats, this, 1, 5, 5);
+  Simulator::Schedule (Seconds (14.5), &FlowMonitorLossTestCase::CheckStats, this, 1, 5, 5);
+  Simulator::Schedule (Seconds (15.5), &FlowMonitorLossTestCase::CheckStats, this, 1, 5, 6);
+  // a lost packet is not known anymore
+  Simulator::Schedule (Seconds (16), &FlowMonitorLossTestCase::LastRx, this, 1, 9, 9);
+  Simulator::Schedule (Seconds (16.5), &FlowMonitorLossTestCase::CheckStats, this, 1, 5, 6);
+
+  // only the packets not seen for the given delay are lost
+  Simulator::Schedule (Seconds (20), &FlowMonitorLossTestCase::FirstTx, this, 2, 0, 0);
+  Simulator::Schedule (Seconds (20.4), &FlowMonitorLossTestCase::FirstTx, this, 2, 1, 1);
+  void (FlowMonitor::*check) (Time) = &FlowMonitor::CheckForLostPackets;
+  Simulator::Schedule (Seconds (20.45), check, m_monitor, Seconds (0.3));
+  Simulator::Schedule (Seconds (20.5), &FlowMonitorLossTestCase::LastRx, this, 2, 0, 1);
+  Simulator::Schedule (Seconds (20.6), &FlowMonitorLossTestCase::CheckStats, this, 2, 1, 1);
+
+  // a packet with a non-sequential identifier is still known once the
+  // ring has grown over it
+  Simulator::Schedule (Seconds (25), &FlowMonitorLossTestCase::FirstTx, this, 3, 0, 0);
+  Simulator::Schedule (Seconds (25), &FlowMonitorLossTestCase::FirstTx, this, 3, 2000, 2000);
+  Simulator::Schedule (Seconds (25), &FlowMonitorLossTestCase::FirstTx, this, 3, 1, 1999);
+  Simulator::Schedule (Seconds (25), &FlowMonitorLossTestCase::FirstTx, this, 3, 2001, 2001);
+  Simulator::Schedule (Seconds (25.5), &FlowMonitorLossTestCase::LastRx, this, 3, 0, 2001);
+  Simulator::Schedule (Seconds (25.6), &FlowMonitorLossTestCase::CheckStats, this, 3, 2002, 0);
+
+  Simulator::Stop (Seconds (26));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  m_monitor->Dispose ();
+  m_monitor = 0;
+  m_probe = 0;
+}
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief FlowMonitor periodic export Test
+ */
+class FlowMonitorExportTestCase : public TestCase
+{
+public:
+  FlowMonitorExportTestCase ();
+  virtual void DoRun (void);
+};
+
+FlowMonitorExportTestCase::FlowMonitorExportTestCase ()
+  : TestCase ("FlowMonitor periodic export")
+{
+}
+
+void
+FlowMonitorExportTestCase::DoRun (void)
+{
+  Ptr<FlowMonitor> monitor = CreateObject<FlowMonitor> ();
+  Ptr<FlowProbe> probe = CreateObject<FlowMonitorTestProbe> (monitor);
+  monitor->StartRightNow ();
+  std::string fileName = CreateTempDirFilename ("flow-monitor-export.csv");
+  monitor->StartPeriodicExport (fileName, Seconds (1));
+
+  Simulator::Schedule (Seconds (0.2), &FlowMonitor::ReportFirstTx, monitor, probe, 1, 0, 100);
+  Simulator::Schedule (Seconds (0.3), &FlowMonitor::ReportLastRx, monitor, probe, 1, 0, 100);
+  Simulator::Schedule (Seconds (1.5), &FlowMonitor::ReportFirstTx, monitor, probe, 2, 0, 200);
+  Simulator::Schedule (Seconds (1.7), &FlowMonitor::ReportLastRx, monitor, probe, 2, 0, 200);
+  Simulator::Schedule (Seconds (2.5), &FlowMonitor::ReportFirstTx, monitor, probe, 1, 1, 100);
+  Simulator::Stop (Seconds (3.5));
+  Simulator::Run ();
+  monitor->StopPeriodicExport ();
+  Simulator::Destroy ();
+
+  std::ifstream is (fileName.c_str ());
+  std::ostringstream contents;
+  contents << is.rdbuf ();
+  NS_TEST_EXPECT_MSG_EQ (contents.str (),
+                         "time,flowId,txPackets,txBytes,rxPackets,rxBytes,lostPackets,delaySum,jitterSum\n"
+                         "1,1,1,100,1,100,0,0.1,0\n"
+                         "2,2,1,200,1,200,0,0.2,0\n"
+                         "3,1,1,100,0,0,0,0,0\n",
+                         "Wrong periodic export");
+
+  monitor->Dispose ();
+}
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief Ipv4FlowClassifier Test
+ */
+class Ipv4FlowClassifierTestCase : public TestCase
+{
+public:
+  Ipv4FlowClassifierTestCase ();
+  virtual void DoRun (void);
+};
+
+Ipv4FlowClassifierTestCase::Ipv4FlowClassifierTestCase ()
+  : TestCase ("Ipv4FlowClassifier")
+{
+}
+
+void
+Ipv4FlowClassifierTestCase::DoRun (void)
+{
+  Ptr<Ipv4FlowClassifier> classifier = Create<Ipv4FlowClassifier> ();
+
+  const char *sources[] = { "10.0.0.1", "10.0.0.1", "10.0.0.1", "10.0.0.2", "10.0.0.1" };
+  const char *destinations[] = { "10.0.0.2", "10.0.0.2", "10.0.0.2", "10.0.0.1", "10.0.0.2" };
+  uint16_t sourcePorts[] = { 1000, 1000, 1000, 2000, 1000 };
+  uint16_t destinationPorts[] = { 2000, 2000, 2000, 1000, 2000 };
+  Ipv4Header::DscpType dscps[] = { Ipv4Header::DscpDefault, Ipv4Header::DSCP_EF,
+                                   Ipv4Header::DSCP_EF, Ipv4Header::DscpDefault,
+                                   Ipv4Header::DSCP_EF };
+  FlowId flowIds[] = { 1, 1, 1, 2, 1 };
+  FlowPacketId packetIds[] = { 0, 1, 2, 0, 3 };
+
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      Ipv4Header ipHeader;
+      ipHeader.SetSource (Ipv4Address (sources[i]));
+      ipHeader.SetDestination (Ipv4Address (destinations[i]));
+      ipHeader.SetProtocol (17);
+      ipHeader.SetDscp (dscps[i]);
+      UdpHeader udpHeader;
+      udpHeader.SetSourcePort (sourcePorts[i]);
+      udpHeader.SetDestinationPort (destinationPorts[i]);
+      Ptr<Packet> packet = Create<Packet> (100);
+      packet->AddHeader (udpHeader);
+
+      uint32_t flowId;
+      uint32_t packetId;
+      NS_TEST_ASSERT_MSG_EQ (classifier->Classify (ipHeader, packet, &flowId, &packetId), true,
+                             "Packet " << i << " not classified");
+      NS_TEST_EXPECT_MSG_EQ (flowId, flowIds[i], "Wrong flow of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (packetId, packetIds[i], "Wrong identifier of packet " << i);
+    }
+
+  Ipv4FlowClassifier::FiveTuple tuple = classifier->FindFlow (2);
+  NS_TEST_EXPECT_MSG_EQ (tuple.sourceAddress, Ipv4Address ("10.0.0.2"), "Wrong source of flow 2");
+  NS_TEST_EXPECT_MSG_EQ (tuple.sourcePort, 2000, "Wrong source port of flow 2");
+
+  std::vector<std::pair<Ipv4Header::DscpType, uint32_t> > dscpCounts = classifier->GetDscpCounts (1);
+  NS_TEST_ASSERT_MSG_EQ (dscpCounts.size (), 2, "Wrong number of DSCP values of flow 1");
+  NS_TEST_EXPECT_MSG_EQ (dscpCounts[0].first, Ipv4Header::DSCP_EF, "Wrong most frequent DSCP value");
+  NS_TEST_EXPECT_MSG_EQ (dscpCounts[0].second, 3, "Wrong count of the most frequent DSCP value");
+  NS_TEST_EXPECT_MSG_EQ (dscpCounts[1].second, 1, "Wrong count of the least frequent DSCP value");
+}
+
+/**
+ * \ingroup flow-monitor-test
+ * \ingroup tests
+ *
+ * \brief FlowMonitor TestSuite
+ */
+class FlowMonitorTestSuite : public TestSuite
+{
+public:
+  FlowMonitorTestSuite ();
+};
+
+FlowMonitorTestSuite::FlowMonitorTestSuite ()
+  : TestSuite ("flow-monitor", UNIT)
+{
+  AddTestCase (new FlowMonitorLossTestCase, TestCase::QUICK);
+  AddTestCase (new FlowMonitorExportTestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4FlowClassifierTestCase, TestCase::QUICK);
+}
+
+static FlowMonitorTestSuite g_FlowMonitorTestSuite; //!< Static variable for test initialization
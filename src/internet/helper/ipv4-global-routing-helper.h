@@ -82,6 +82,9 @@ public:
    * Users must first call PopulateRoutingTables() and then may subsequently
    * call RecomputeRoutingTables() at any later time in the simulation.
    *
+   * If the GlobalRoutingIncremental global value is true, only the routes
+   * of the routers that the changes of the topology may affect are
+   * removed and added again.
    */
   static void RecomputeRoutingTables (void);
 private:
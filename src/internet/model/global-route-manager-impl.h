@@ -23,9 +23,11 @@
 #define GLOBAL_ROUTE_MANAGER_IMPL_H
 
 #include <stdint.h>
+#include <atomic>
 #include <list>
 #include <queue>
 #include <map>
+#include <set>
 #include <vector>
 #include "ns3/object.h"
 #include "ns3/ptr.h"
@@ -674,6 +676,39 @@ public:
    */
   uint32_t GetNumExtLSAs () const;
 
+  /**
+   * @brief Copy the database, with copies of its Link State Advertisements.
+   *
+   * The SPF calculations mark the status of the LSAs they visit, so each
+   * calculation running in parallel needs its own copy of the database.
+   *
+   * @returns a new database, owned by the caller
+   */
+  GlobalRouteManagerLSDB* Copy () const;
+
+  /**
+   * @brief Find the Link State Advertisements that differ between two
+   * databases, ignoring their SPF status.
+   *
+   * @param other the other database
+   * @param changed [out] the link state IDs of the router and network LSAs
+   * found in only one of the databases, or different in each
+   * @returns true if the External LSAs differ as well
+   */
+  bool Compare (const GlobalRouteManagerLSDB* other,
+                std::set<Ipv4Address>& changed) const;
+
+  /**
+   * @brief Group the Link State Advertisements connected to each other.
+   *
+   * Two router or network LSAs are connected if one has a link to the
+   * other, as the SPF calculation follows it.  The SPF tree of a router
+   * is made of the LSAs of its group.
+   *
+   * @param groups [out] the group of each link state ID, as the link
+   * state ID of an LSA of the group
+   */
+  void GetConnectedGroups (std::map<Ipv4Address, Ipv4Address>& groups) const;
 
 private:
   typedef std::map<Ipv4Address, GlobalRoutingLSA*> LSDBMap_t; //!< container of IPv4 addresses / Link State Advertisements
@@ -681,6 +716,7 @@ private:
 
   LSDBMap_t m_database; //!< database of IPv4 addresses / Link State Advertisements
   std::vector<GlobalRoutingLSA*> m_extdatabase; //!< database of External Link State Advertisements
+  LSDBMap_t m_linkDataIndex; //!< Link State Advertisements by the link data of their transit network links
 
 /**
  * @brief GlobalRouteManagerLSDB copy construction is disallowed.  There's no 
@@ -732,9 +768,26 @@ public:
 /**
  * @brief Compute routes using a Dijkstra SPF computation and populate
  * per-node forwarding tables
+ *
+ * The SPF calculations of the routers run on as many threads as the
+ * GlobalRoutingThreads global value, and the routes are then installed
+ * in the order of the routers, on the calling thread.
  */
   virtual void InitializeRoutes ();
 
+/**
+ * @brief Recompute the routes after a change of the topology.
+ *
+ * Unless the GlobalRoutingIncremental global value is true, this deletes
+ * the routes, builds the routing database and initializes the routes
+ * anew.  Otherwise, this builds the new database and compares it with the
+ * database the routes were computed from; the routes of a router are only
+ * deleted and computed again if they depend on Link State Advertisements
+ * that changed, which are those of its neighbor for a stub router, and
+ * those of the routers and networks connected to it otherwise.
+ */
+  virtual void RecomputeGlobalRoutes ();
+
 /**
  * @brief Debugging routine; allow client code to supply a pre-built LSDB
  */
@@ -766,8 +819,92 @@ private:
  */
   GlobalRouteManagerImpl& operator= (GlobalRouteManagerImpl& srmi);
 
+  /**
+   * \brief A route found by the SPF calculation of a root.
+   */
+  struct SPFRoute
+  {
+    /// The kinds of routes
+    enum Type
+    {
+      RouteHost,      //!< a host route
+      RouteNetwork,   //!< a network route
+      RouteExternal   //!< an AS external route
+    };
+    Type type;           //!< the kind of route
+    Ipv4Address dest;    //!< the destination
+    Ipv4Mask mask;       //!< the destination mask, for network routes
+    Ipv4Address nextHop; //!< the next hop
+    uint32_t outIf;      //!< the outgoing interface
+  };
+
+  /**
+   * \brief The router at the root of an SPF calculation, and the routes
+   * the calculation finds for it.
+   *
+   * The calculation only reads the database and this table, so that the
+   * calculations of several roots can run in parallel; the routes are
+   * installed in the routing protocol of the root afterwards.
+   */
+  struct SPFRootTable
+  {
+    Ipv4Address routerId;                  //!< the router ID of the root
+    Ptr<Ipv4GlobalRouting> routing;        //!< the routing protocol of the root, if any
+    std::vector<std::pair<Ipv4Address, int32_t> > addresses; //!< the local addresses of the root, and their interfaces
+    bool stub;                             //!< whether the root is a stub, with a default route only
+    std::vector<SPFRoute> routes;          //!< the routes found
+  };
+
   SPFVertex* m_spfroot; //!< the root node
+  SPFRootTable* m_spftable; //!< the table of the root node
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+  std::map<Ipv4Address, SPFRootTable> m_roots; //!< the roots whose routes were computed from m_lsdb, without their routes
+
+  /**
+   * \brief Prepare the table of a root, with the addresses of its node.
+   *
+   * \param node the node of the root, or 0 if the root has no node
+   * \param root the router ID of the root
+   * \param table the table
+   */
+  void SPFInitializeTable (Ptr<Node> node, Ipv4Address root, SPFRootTable& table);
+
+  /**
+   * \brief Calculate the routes of several roots, on the threads
+   * requested, and install them.
+   *
+   * \param tables the tables of the roots
+   */
+  void SPFCalculateTables (std::vector<SPFRootTable>& tables);
+
+  /**
+   * \brief Calculate the routes of the roots not taken by another worker
+   * yet, on a worker with its own copy of the database.
+   *
+   * \param tables the tables of the roots
+   * \param next the index of the next root not taken yet
+   */
+  void SPFCalculateWorker (std::vector<SPFRootTable>* tables,
+                           std::atomic<uint32_t>* next);
+
+  /**
+   * \brief Install the routes found for a root in its routing protocol.
+   *
+   * \param table the table of the root
+   */
+  void SPFInstallRoutes (const SPFRootTable& table);
+
+  /**
+   * \brief Add a route to the table of the root.
+   *
+   * \param type the kind of route
+   * \param dest the destination
+   * \param mask the destination mask
+   * \param nextHop the next hop
+   * \param outIf the outgoing interface
+   */
+  void SPFAddRoute (SPFRoute::Type type, Ipv4Address dest, Ipv4Mask mask,
+                    Ipv4Address nextHop, uint32_t outIf);
 
   /**
    * \brief Test if a node is a stub, from an OSPF sense.
@@ -785,9 +922,9 @@ private:
    * \brief Calculate the shortest path first (SPF) tree
    *
    * Equivalent to quagga ospf_spf_calculate
-   * \param root the root node
+   * \param table the table of the root node, where the routes are added
    */
-  void SPFCalculate (Ipv4Address root);
+  void SPFCalculate (SPFRootTable& table);
 
   /**
    * \brief Process Stub nodes
@@ -65,6 +65,16 @@ public:
  */
   static void InitializeRoutes ();
 
+/**
+ * @brief Recompute the routes after a change of the topology.
+ *
+ * This deletes the routes, builds the routing database and initializes
+ * the routes anew, or, if the GlobalRoutingIncremental global value is
+ * true, only recomputes the routes of the routers that the change may
+ * affect.
+ */
+  static void RecomputeGlobalRoutes ();
+
 private:
 /**
  * @brief Global Route Manager copy construction is disallowed.  There's no 
@@ -18,6 +18,7 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 
+#include <algorithm>
 #include "ipv4-end-point-demux.h"
 #include "ipv4-end-point.h"
 #include "ipv4-interface-address.h"
@@ -28,6 +29,23 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("Ipv4EndPointDemux");
 
+bool
+Ipv4EndPointDemux::FourTuple::operator== (const FourTuple &other) const
+{
+  return localAddress == other.localAddress && localPort == other.localPort
+         && peerAddress == other.peerAddress && peerPort == other.peerPort;
+}
+
+size_t
+Ipv4EndPointDemux::FourTupleHash::operator() (const FourTuple &tuple) const
+{
+  size_t hash = Ipv4AddressHash () (tuple.localAddress);
+  hash = hash * 31 + tuple.localPort;
+  hash = hash * 31 + Ipv4AddressHash () (tuple.peerAddress);
+  hash = hash * 31 + tuple.peerPort;
+  return hash;
+}
+
 Ipv4EndPointDemux::Ipv4EndPointDemux ()
   : m_ephemeral (49152), m_portLast (65535), m_portFirst (49152)
 {
@@ -40,33 +58,81 @@ Ipv4EndPointDemux::~Ipv4EndPointDemux ()
   for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
     {
       Ipv4EndPoint *endPoint = *i;
+      endPoint->m_demux = 0;
       delete endPoint;
     }
   m_endPoints.clear ();
+  m_tuples.clear ();
+  m_ports.clear ();
+}
+
+void
+Ipv4EndPointDemux::Index (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  endPoint->m_demux = this;
+  m_ports[endPoint->m_localPort].push_back (endPoint);
+  IndexTuple (endPoint);
+}
+
+void
+Ipv4EndPointDemux::Unindex (Ipv4EndPoint *endPoint)
+{
+  NS_LOG_FUNCTION (this << endPoint);
+  UnindexTuple (endPoint);
+  std::unordered_map<uint16_t, Bucket>::iterator port = m_ports.find (endPoint->m_localPort);
+  NS_ASSERT (port != m_ports.end ());
+  Bucket &bucket = port->second;
+  bucket.erase (std::find (bucket.begin (), bucket.end (), endPoint));
+  if (bucket.empty ())
+    {
+      m_ports.erase (port);
+    }
+  endPoint->m_demux = 0;
+}
+
+void
+Ipv4EndPointDemux::IndexTuple (Ipv4EndPoint *endPoint)
+{
+  FourTuple tuple = {endPoint->m_localAddr, endPoint->m_localPort,
+                     endPoint->m_peerAddr, endPoint->m_peerPort};
+  m_tuples[tuple].push_back (endPoint);
+}
+
+void
+Ipv4EndPointDemux::UnindexTuple (Ipv4EndPoint *endPoint)
+{
+  FourTuple tuple = {endPoint->m_localAddr, endPoint->m_localPort,
+                     endPoint->m_peerAddr, endPoint->m_peerPort};
+  std::unordered_map<FourTuple, Bucket, FourTupleHash>::iterator it = m_tuples.find (tuple);
+  NS_ASSERT (it != m_tuples.end ());
+  Bucket &bucket = it->second;
+  bucket.erase (std::find (bucket.begin (), bucket.end (), endPoint));
+  if (bucket.empty ())
+    {
+      m_tuples.erase (it);
+    }
 }
 
 bool
 Ipv4EndPointDemux::LookupPortLocal (uint16_t port)
 {
   NS_LOG_FUNCTION (this << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
-    {
-      if ((*i)->GetLocalPort  () == port) 
-        {
-          return true;
-        }
-    }
-  return false;
+  return m_ports.find (port) != m_ports.end ();
 }
 
 bool
 Ipv4EndPointDemux::LookupLocal (Ptr<NetDevice> boundNetDevice, Ipv4Address addr, uint16_t port)
 {
   NS_LOG_FUNCTION (this << addr << port);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  std::unordered_map<uint16_t, Bucket>::iterator it = m_ports.find (port);
+  if (it == m_ports.end ())
+    {
+      return false;
+    }
+  for (Bucket::iterator i = it->second.begin (); i != it->second.end (); i++)
     {
-      if ((*i)->GetLocalPort () == port &&
-          (*i)->GetLocalAddress () == addr &&
+      if ((*i)->GetLocalAddress () == addr &&
           (*i)->GetBoundNetDevice () == boundNetDevice)
         {
           return true;
@@ -87,6 +153,7 @@ Ipv4EndPointDemux::Allocate (void)
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (Ipv4Address::GetAny (), port);
   m_endPoints.push_back (endPoint);
+  Index (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -103,6 +170,7 @@ Ipv4EndPointDemux::Allocate (Ipv4Address address)
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
   m_endPoints.push_back (endPoint);
+  Index (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -126,6 +194,7 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice, Ipv4Address address,
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (address, port);
   m_endPoints.push_back (endPoint);
+  Index (endPoint);
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
   return endPoint;
 }
@@ -136,21 +205,23 @@ Ipv4EndPointDemux::Allocate (Ptr<NetDevice> boundNetDevice,
                              Ipv4Address peerAddress, uint16_t peerPort)
 {
   NS_LOG_FUNCTION (this << localAddress << localPort << peerAddress << peerPort << boundNetDevice);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  FourTuple tuple = {localAddress, localPort, peerAddress, peerPort};
+  std::unordered_map<FourTuple, Bucket, FourTupleHash>::iterator it = m_tuples.find (tuple);
+  if (it != m_tuples.end ())
     {
-      if ((*i)->GetLocalPort () == localPort &&
-          (*i)->GetLocalAddress () == localAddress &&
-          (*i)->GetPeerPort () == peerPort &&
-          (*i)->GetPeerAddress () == peerAddress &&
-          ((*i)->GetBoundNetDevice () == boundNetDevice || (*i)->GetBoundNetDevice () == 0))
+      for (Bucket::iterator i = it->second.begin (); i != it->second.end (); i++)
         {
-          NS_LOG_WARN ("Duplicated endpoint.");
-          return 0;
+          if ((*i)->GetBoundNetDevice () == boundNetDevice || (*i)->GetBoundNetDevice () == 0)
+            {
+              NS_LOG_WARN ("Duplicated endpoint.");
+              return 0;
+            }
         }
     }
   Ipv4EndPoint *endPoint = new Ipv4EndPoint (localAddress, localPort);
   endPoint->SetPeer (peerAddress, peerPort);
   m_endPoints.push_back (endPoint);
+  Index (endPoint);
 
   NS_LOG_DEBUG ("Now have >>" << m_endPoints.size () << "<< endpoints.");
 
@@ -165,6 +236,7 @@ Ipv4EndPointDemux::DeAllocate (Ipv4EndPoint *endPoint)
     {
       if (*i == endPoint)
         {
+          Unindex (endPoint);
           delete endPoint;
           m_endPoints.erase (i);
           break;
@@ -189,150 +261,141 @@ Ipv4EndPointDemux::GetAllEndPoints (void)
   return ret;
 }
 
-
-/*
- * If we have an exact match, we return it.
- * Otherwise, if we find a generic match, we return it.
- * Otherwise, we return 0.
- */
-Ipv4EndPointDemux::EndPoints
-Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport, 
-                           Ipv4Address saddr, uint16_t sport,
-                           Ptr<Ipv4Interface> incomingInterface)
+void
+Ipv4EndPointDemux::Match (const FourTuple &tuple, Ptr<NetDevice> device,
+                          uint32_t *count, Ipv4EndPoint **found)
 {
-  NS_LOG_FUNCTION (this << daddr << dport << saddr << sport << incomingInterface);
-  
-  EndPoints retval1; // Matches exact on local port, wildcards on others
-  EndPoints retval2; // Matches exact on local port/adder, wildcards on others
-  EndPoints retval3; // Matches all but local address
-  EndPoints retval4; // Exact match on all 4
-
-  NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr << ":" << dport);
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  std::unordered_map<FourTuple, Bucket, FourTupleHash>::iterator it = m_tuples.find (tuple);
+  if (it == m_tuples.end ())
+    {
+      return;
+    }
+  for (Bucket::iterator i = it->second.begin (); i != it->second.end (); i++)
     {
       Ipv4EndPoint* endP = *i;
 
-      NS_LOG_DEBUG ("Looking at endpoint dport=" << endP->GetLocalPort ()
-                                                 << " daddr=" << endP->GetLocalAddress ()
-                                                 << " sport=" << endP->GetPeerPort ()
-                                                 << " saddr=" << endP->GetPeerAddress ());
-
       if (!endP->IsRxEnabled ())
         {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
+          NS_LOG_LOGIC ("Skipping endpoint " << endP
                         << " because endpoint can not receive packets");
           continue;
         }
-
-      if (endP->GetLocalPort () != dport) 
+      if (endP->GetBoundNetDevice () && endP->GetBoundNetDevice () != device)
         {
-          NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                             << " because endpoint dport "
-                                             << endP->GetLocalPort ()
-                                             << " does not match packet dport " << dport);
+          NS_LOG_LOGIC ("Skipping endpoint " << endP
+                                             << " because endpoint is bound to specific device and"
+                                             << endP->GetBoundNetDevice ()
+                                             << " does not match packet device " << device);
           continue;
         }
-      if (endP->GetBoundNetDevice ())
+      NS_LOG_LOGIC ("Found an endpoint " << endP->GetLocalAddress () << ":" << endP->GetLocalPort ());
+      if ((*count)++ == 0)
         {
-          if (endP->GetBoundNetDevice () != incomingInterface->GetDevice ())
-            {
-              NS_LOG_LOGIC ("Skipping endpoint " << &endP
-                                                 << " because endpoint is bound to specific device and"
-                                                 << endP->GetBoundNetDevice ()
-                                                 << " does not match packet device " << incomingInterface->GetDevice ());
-              continue;
-            }
+          *found = endP;
         }
+    }
+}
 
-      bool localAddressMatchesExact = false;
-      bool localAddressIsAny = false;
-      bool localAddressIsSubnetAny = false;
+void
+Ipv4EndPointDemux::MatchWildcard (Ipv4Address daddr, FourTuple tuple,
+                                  Ptr<Ipv4Interface> incomingInterface,
+                                  uint32_t *count, Ipv4EndPoint **found)
+{
+  Ptr<NetDevice> device = incomingInterface != 0 ? incomingInterface->GetDevice () : 0;
 
-      // We have 3 cases:
-      // 1) Exact local / destination address match
-      // 2) Local endpoint bound to Any -> matches anything
-      // 3) Local endpoint bound to x.y.z.0 -> matches Subnet-directed broadcast packet (e.g., x.y.z.255 in a /24 net) and direct destination match.
+  // Local endpoint bound to Any -> matches anything
+  if (daddr != Ipv4Address::GetAny ())
+    {
+      tuple.localAddress = Ipv4Address::GetAny ();
+      Match (tuple, device, count, found);
+    }
 
-      if (endP->GetLocalAddress () == daddr)
+  // Local endpoint bound to x.y.z.0 -> matches Subnet-directed broadcast
+  // packet (e.g., x.y.z.255 in a /24 net) and direct destination match.
+  if (incomingInterface == 0)
+    {
+      return;
+    }
+  for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
+    {
+      Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
+      Ipv4Address addrNetpart = addr.GetLocal ().CombineMask (addr.GetMask ());
+      if (addrNetpart == daddr || addrNetpart == Ipv4Address::GetAny ()
+          || daddr.CombineMask (addr.GetMask ()) != addrNetpart)
         {
-          // Case 1:
-          localAddressMatchesExact = true;
+          continue;
         }
-      else if (endP->GetLocalAddress () == Ipv4Address::GetAny ())
+      // skip the subnets already looked up for a previous address
+      bool seen = false;
+      for (uint32_t j = 0; j < i && !seen; j++)
         {
-          // Case 2:
-          localAddressIsAny = true;
+          Ipv4InterfaceAddress other = incomingInterface->GetAddress (j);
+          seen = other.GetLocal ().CombineMask (other.GetMask ()) == addrNetpart
+            && daddr.CombineMask (other.GetMask ()) == addrNetpart;
         }
-      else
+      if (!seen)
         {
-          // Case 3:
-          for (uint32_t i = 0; i < incomingInterface->GetNAddresses (); i++)
-            {
-              Ipv4InterfaceAddress addr = incomingInterface->GetAddress (i);
-
-              Ipv4Address addrNetpart = addr.GetLocal ().CombineMask (addr.GetMask ());
-              if (endP->GetLocalAddress () == addrNetpart)
-                {
-                  NS_LOG_LOGIC ("Endpoint is SubnetDirectedAny " << endP->GetLocalAddress () << "/" << addr.GetMask ().GetPrefixLength ());
-
-                  Ipv4Address daddrNetPart = daddr.CombineMask (addr.GetMask ());
-                  if (addrNetpart == daddrNetPart)
-                    {
-                      localAddressIsSubnetAny = true;
-                    }
-                }
-            }
-
-          // if no match here, keep looking
-          if (!localAddressIsSubnetAny)
-            continue;
+          NS_LOG_LOGIC ("Looking up SubnetDirectedAny " << addrNetpart << "/" << addr.GetMask ().GetPrefixLength ());
+          tuple.localAddress = addrNetpart;
+          Match (tuple, device, count, found);
         }
+    }
+}
 
-      bool remotePortMatchesExact = endP->GetPeerPort () == sport;
-      bool remotePortMatchesWildCard = endP->GetPeerPort () == 0;
-      bool remoteAddressMatchesExact = endP->GetPeerAddress () == saddr;
-      bool remoteAddressMatchesWildCard = endP->GetPeerAddress () == Ipv4Address::GetAny ();
+/*
+ * If we have an exact match, we return it.
+ * Otherwise, if we find a generic match, we return it.
+ * Otherwise, we return 0.
+ */
+Ipv4EndPointDemux::EndPoints
+Ipv4EndPointDemux::Lookup (Ipv4Address daddr, uint16_t dport, 
+                           Ipv4Address saddr, uint16_t sport,
+                           Ptr<Ipv4Interface> incomingInterface)
+{
+  NS_LOG_FUNCTION (this << daddr << dport << saddr << sport << incomingInterface);
 
-      // If remote does not match either with exact or wildcard,
-      // skip this one
-      if (!(remotePortMatchesExact || remotePortMatchesWildCard))
-        continue;
-      if (!(remoteAddressMatchesExact || remoteAddressMatchesWildCard))
-        continue;
+  EndPoints retval;
+  Ipv4EndPoint *endPoint = LookupBest (daddr, dport, saddr, sport, incomingInterface);
+  if (endPoint != 0)
+    {
+      retval.push_back (endPoint);
+    }
+  return retval;  // might be empty if no matches
+}
 
-      bool localAddressMatchesWildCard = localAddressIsAny || localAddressIsSubnetAny;
+Ipv4EndPoint *
+Ipv4EndPointDemux::LookupBest (Ipv4Address daddr, uint16_t dport,
+                               Ipv4Address saddr, uint16_t sport,
+                               Ptr<Ipv4Interface> incomingInterface)
+{
+  NS_LOG_FUNCTION (this << daddr << dport << saddr << sport << incomingInterface);
+  NS_LOG_DEBUG ("Looking up endpoint for destination address " << daddr << ":" << dport);
 
-      if (localAddressMatchesExact && remoteAddressMatchesExact && remotePortMatchesExact)
-        { // All 4 match - this is the case of an open TCP connection, for example.
-          NS_LOG_LOGIC ("Found an endpoint for case 4, adding " << endP->GetLocalAddress () << ":" << endP->GetLocalPort ());
-          retval4.push_back (endP);
-        }
-      if (localAddressMatchesWildCard && remoteAddressMatchesExact && remotePortMatchesExact)
-        { // All but local address - no idea what this case could be.
-          NS_LOG_LOGIC ("Found an endpoint for case 3, adding " << endP->GetLocalAddress () << ":" << endP->GetLocalPort ());
-          retval3.push_back (endP);
-        }
-      if (localAddressMatchesExact && remoteAddressMatchesWildCard && remotePortMatchesWildCard)
-        { // Only local port and local address matches exactly - Not yet opened connection
-          NS_LOG_LOGIC ("Found an endpoint for case 2, adding " << endP->GetLocalAddress () << ":" << endP->GetLocalPort ());
-          retval2.push_back (endP);
-        }
-      if (localAddressMatchesWildCard && remoteAddressMatchesWildCard && remotePortMatchesWildCard)
-        { // Only local port matches exactly - Endpoint open to "any" connection
-          NS_LOG_LOGIC ("Found an endpoint for case 1, adding " << endP->GetLocalAddress () << ":" << endP->GetLocalPort ());
-          retval1.push_back (endP);
-        }
+  Ptr<NetDevice> device = incomingInterface != 0 ? incomingInterface->GetDevice () : 0;
+  uint32_t count = 0;
+  Ipv4EndPoint *found = 0;
+
+  // Here we look for the most exact match, in this order
+  FourTuple tuple = {daddr, dport, saddr, sport};
+  // All 4 match - this is the case of an open TCP connection, for example.
+  Match (tuple, device, &count, &found);
+  if (count == 0)
+    { // All but local address - no idea what this case could be.
+      MatchWildcard (daddr, tuple, incomingInterface, &count, &found);
+    }
+  tuple.peerAddress = Ipv4Address::GetAny ();
+  tuple.peerPort = 0;
+  if (count == 0)
+    { // Only local port and local address matches exactly - Not yet opened connection
+      Match (tuple, device, &count, &found);
+    }
+  if (count == 0)
+    { // Only local port matches exactly - Endpoint open to "any" connection
+      MatchWildcard (daddr, tuple, incomingInterface, &count, &found);
     }
 
-  // Here we find the most exact match
-  EndPoints retval;
-  if (!retval4.empty ()) retval = retval4;
-  else if (!retval3.empty ()) retval = retval3;
-  else if (!retval2.empty ()) retval = retval2;
-  else retval = retval1;
-
-  NS_ABORT_MSG_IF (retval.size () > 1, "Too many endpoints - perhaps you created too many sockets without binding them to different NetDevices.");
-  return retval;  // might be empty if no matches
+  NS_ABORT_MSG_IF (count > 1, "Too many endpoints - perhaps you created too many sockets without binding them to different NetDevices.");
+  return found;  // might be 0 if no matches
 }
 
 Ipv4EndPoint *
@@ -347,12 +410,13 @@ Ipv4EndPointDemux::SimpleLookup (Ipv4Address daddr,
   // function.
   uint32_t genericity = 3;
   Ipv4EndPoint *generic = 0;
-  for (EndPointsI i = m_endPoints.begin (); i != m_endPoints.end (); i++) 
+  std::unordered_map<uint16_t, Bucket>::iterator it = m_ports.find (dport);
+  if (it == m_ports.end ())
+    {
+      return 0;
+    }
+  for (Bucket::iterator i = it->second.begin (); i != it->second.end (); i++) 
     {
-      if ((*i)->GetLocalPort () != dport) 
-        {
-          continue;
-        }
       if ((*i)->GetLocalAddress () == daddr &&
           (*i)->GetPeerPort () == sport &&
           (*i)->GetPeerAddress () == saddr) 
@@ -23,6 +23,8 @@
 
 #include <stdint.h>
 #include <list>
+#include <unordered_map>
+#include <vector>
 #include "ns3/ipv4-address.h"
 #include "ipv4-interface.h"
 
@@ -40,6 +42,13 @@ class Ipv4EndPoint;
  * of endpoints, and has APIs to add and find endpoints in this demux.  This
  * code is shared in common to TCP and UDP protocols in ns3.  This demux
  * sits between ns3's layer four and the socket layer
+ *
+ * Besides the list, the endpoints are hashed by their four-tuple, where
+ * the unset fields are wildcards, and by their local port.  A lookup
+ * probes the four-tuple table once for each kind of match, from the
+ * exact match to the listeners on the local port, so that its cost does
+ * not grow with the number of endpoints, and it does not allocate memory.
+ * The endpoints tell the demux when their four-tuple changes.
  */
 
 class Ipv4EndPointDemux {
@@ -103,6 +112,25 @@ public:
                     uint16_t sport,
                     Ptr<Ipv4Interface> incomingInterface);
 
+  /**
+   * \brief lookup for the most-matching endpoint.
+   *
+   * Same as Lookup, for the transport protocols which use a single
+   * endpoint, without building a list.
+   *
+   * \param daddr destination address to test
+   * \param dport destination port to test
+   * \param saddr source address to test
+   * \param sport source port to test
+   * \param incomingInterface the incoming interface
+   * \return the IPv4EndPoint (0 if not found)
+   */
+  Ipv4EndPoint *LookupBest (Ipv4Address daddr,
+                            uint16_t dport,
+                            Ipv4Address saddr,
+                            uint16_t sport,
+                            Ptr<Ipv4Interface> incomingInterface);
+
   /**
    * \brief simple lookup for a match with all the parameters.
    * \param daddr destination address to test
@@ -166,6 +194,84 @@ public:
   void DeAllocate (Ipv4EndPoint *endPoint);
 
 private:
+  friend class Ipv4EndPoint;
+
+  /// The four-tuple of an endpoint, where the unset fields are wildcards.
+  struct FourTuple
+  {
+    Ipv4Address localAddress;  //!< Local address, or any
+    uint16_t localPort;        //!< Local port
+    Ipv4Address peerAddress;   //!< Peer address, or any
+    uint16_t peerPort;         //!< Peer port, or 0
+
+    /**
+     * \brief Equality operator.
+     * \param other the other four-tuple
+     * \return true if the four-tuples are equal
+     */
+    bool operator== (const FourTuple &other) const;
+  };
+
+  /// Hash function for the four-tuples.
+  struct FourTupleHash
+  {
+    /**
+     * \brief Hash a four-tuple.
+     * \param tuple the four-tuple
+     * \return the hash
+     */
+    size_t operator() (const FourTuple &tuple) const;
+  };
+
+  /// The endpoints of a key, in the order they were allocated.
+  typedef std::vector<Ipv4EndPoint *> Bucket;
+
+  /**
+   * \brief Add an endpoint to the tables.
+   * \param endPoint the endpoint
+   */
+  void Index (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Remove an endpoint from the tables.
+   * \param endPoint the endpoint
+   */
+  void Unindex (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Add an endpoint to the four-tuple table.
+   * \param endPoint the endpoint
+   */
+  void IndexTuple (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Remove an endpoint from the four-tuple table.
+   * \param endPoint the endpoint
+   */
+  void UnindexTuple (Ipv4EndPoint *endPoint);
+
+  /**
+   * \brief Find the endpoints of a four-tuple able to receive a packet.
+   * \param tuple the four-tuple
+   * \param device the device the packet was received on
+   * \param count [in,out] the number of endpoints found so far
+   * \param found [in,out] the first endpoint found so far
+   */
+  void Match (const FourTuple &tuple, Ptr<NetDevice> device,
+              uint32_t *count, Ipv4EndPoint **found);
+
+  /**
+   * \brief Find the endpoints of a local address wildcard able to receive
+   * a packet, i.e. bound to any address or to the subnet of the destination.
+   * \param daddr destination address of the packet
+   * \param tuple the four-tuple, whose local address is ignored
+   * \param incomingInterface the interface the packet was received on
+   * \param count [in,out] the number of endpoints found so far
+   * \param found [in,out] the first endpoint found so far
+   */
+  void MatchWildcard (Ipv4Address daddr, FourTuple tuple,
+                      Ptr<Ipv4Interface> incomingInterface,
+                      uint32_t *count, Ipv4EndPoint **found);
 
   /**
    * \brief Allocate an ephemeral port.
@@ -192,6 +298,16 @@ private:
    * \brief A list of IPv4 end points.
    */
   EndPoints m_endPoints;
+
+  /**
+   * \brief The end points, by four-tuple.
+   */
+  std::unordered_map<FourTuple, Bucket, FourTupleHash> m_tuples;
+
+  /**
+   * \brief The end points, by local port.
+   */
+  std::unordered_map<uint16_t, Bucket> m_ports;
 };
 
 } // namespace ns3
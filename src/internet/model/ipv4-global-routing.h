@@ -28,6 +28,7 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/random-variable-stream.h"
+#include "ipv4-route-trie.h"
 
 namespace ns3 {
 
@@ -267,10 +268,20 @@ private:
    * \return Ipv4Route to route the packet to reach dest address
    */
   Ptr<Ipv4Route> LookupGlobal (Ipv4Address dest, Ptr<NetDevice> oif = 0);
+  /**
+   * \brief Compare the order two routes were added in.
+   * \param a the first route
+   * \param b the second route
+   * \return true if the first route was added before the second one
+   */
+  static bool IsAddedBefore (const Ipv4RouteTrie::Entry *a, const Ipv4RouteTrie::Entry *b);
 
   HostRoutes m_hostRoutes;             //!< Routes to hosts
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
   ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
+  Ipv4RouteTrie m_hostIndex;           //!< Index of the routes to hosts
+  Ipv4RouteTrie m_networkIndex;        //!< Index of the routes to networks
+  Ipv4RouteTrie m_externalIndex;       //!< Index of the external routes
 
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
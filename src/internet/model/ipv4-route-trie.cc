@@ -0,0 +1,266 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/net-device.h"
+#include "ipv4-route-trie.h"
+#include "ipv4-routing-table-entry.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4RouteTrie");
+
+namespace {
+
+/**
+ * Get the mask of a prefix length.
+ * \param length the prefix length
+ * \return the mask
+ */
+uint32_t
+Mask (uint8_t length)
+{
+  return length == 0 ? 0 : 0xffffffff << (32 - length);
+}
+
+/**
+ * Get a bit of an address.
+ * \param address the address
+ * \param index the index of the bit, from the most significant one
+ * \return the bit
+ */
+uint32_t
+Bit (uint32_t address, uint8_t index)
+{
+  return (address >> (31 - index)) & 1;
+}
+
+/**
+ * Get the length of the prefix common to two addresses.
+ * \param a the first address
+ * \param b the second address
+ * \param max the maximum length
+ * \return the length of the common prefix, no more than max
+ */
+uint8_t
+CommonLength (uint32_t a, uint32_t b, uint8_t max)
+{
+  uint8_t length = 0;
+  while (length < max && Bit (a, length) == Bit (b, length))
+    {
+      length++;
+    }
+  return length;
+}
+
+} // unnamed namespace
+
+Ipv4RouteTrie::Ipv4RouteTrie ()
+  : m_root (new Node ()),
+    m_order (0)
+{
+  NS_LOG_FUNCTION (this);
+  m_root->prefix = 0;
+  m_root->length = 0;
+  m_root->parent = 0;
+  m_root->child[0] = 0;
+  m_root->child[1] = 0;
+}
+
+Ipv4RouteTrie::~Ipv4RouteTrie ()
+{
+  NS_LOG_FUNCTION (this);
+  Delete (m_root);
+}
+
+void
+Ipv4RouteTrie::Delete (Node *node)
+{
+  if (node != 0)
+    {
+      Delete (node->child[0]);
+      Delete (node->child[1]);
+      delete node;
+    }
+}
+
+Ipv4RouteTrie::Node *
+Ipv4RouteTrie::Find (uint32_t prefix, uint8_t length, bool create)
+{
+  Node *node = m_root;
+  while (node->length < length)
+    {
+      uint32_t bit = Bit (prefix, node->length);
+      Node *child = node->child[bit];
+      uint8_t common = length;
+      if (child != 0)
+        {
+          common = CommonLength (child->prefix, prefix, std::min (child->length, length));
+          if (common == child->length)
+            {
+              node = child;
+              continue;
+            }
+        }
+      if (!create)
+        {
+          return 0;
+        }
+      // the new node goes between the node and its child, if any,
+      // under a new node for their common prefix if need be
+      Node *parent = node;
+      if (common < length)
+        {
+          Node *split = new Node ();
+          split->prefix = prefix & Mask (common);
+          split->length = common;
+          split->parent = node;
+          split->child[0] = 0;
+          split->child[1] = 0;
+          node->child[bit] = split;
+          split->child[Bit (child->prefix, common)] = child;
+          child->parent = split;
+          parent = split;
+          bit = Bit (prefix, common);
+          child = 0;
+        }
+      Node *leaf = new Node ();
+      leaf->prefix = prefix;
+      leaf->length = length;
+      leaf->parent = parent;
+      leaf->child[0] = 0;
+      leaf->child[1] = 0;
+      parent->child[bit] = leaf;
+      if (child != 0)
+        {
+          leaf->child[Bit (child->prefix, length)] = child;
+          child->parent = leaf;
+        }
+      return leaf;
+    }
+  return node;
+}
+
+void
+Ipv4RouteTrie::Prune (Node *node)
+{
+  while (node != m_root && node->entries.empty ()
+         && (node->child[0] == 0 || node->child[1] == 0))
+    {
+      Node *child = node->child[0] != 0 ? node->child[0] : node->child[1];
+      Node *parent = node->parent;
+      parent->child[parent->child[0] == node ? 0 : 1] = child;
+      if (child != 0)
+        {
+          child->parent = parent;
+        }
+      delete node;
+      node = parent;
+    }
+}
+
+void
+Ipv4RouteTrie::Add (Ipv4RoutingTableEntry *route, uint32_t metric)
+{
+  NS_LOG_FUNCTION (this << route << metric);
+  uint8_t length = route->GetDestNetworkMask ().GetPrefixLength ();
+  uint32_t prefix = route->GetDestNetwork ().Get () & Mask (length);
+  Entry entry;
+  entry.route = route;
+  entry.metric = metric;
+  entry.order = m_order++;
+  Find (prefix, length, true)->entries.push_back (entry);
+}
+
+void
+Ipv4RouteTrie::Remove (Ipv4RoutingTableEntry *route)
+{
+  NS_LOG_FUNCTION (this << route);
+  uint8_t length = route->GetDestNetworkMask ().GetPrefixLength ();
+  uint32_t prefix = route->GetDestNetwork ().Get () & Mask (length);
+  Node *node = Find (prefix, length, false);
+  NS_ASSERT_MSG (node != 0, "Route not in the index");
+  for (Entries::iterator i = node->entries.begin (); i != node->entries.end (); ++i)
+    {
+      if (i->route == route)
+        {
+          node->entries.erase (i);
+          Prune (node);
+          return;
+        }
+    }
+  NS_ASSERT_MSG (false, "Route not in the index");
+}
+
+void
+Ipv4RouteTrie::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  Delete (m_root->child[0]);
+  Delete (m_root->child[1]);
+  m_root->child[0] = 0;
+  m_root->child[1] = 0;
+  m_root->entries.clear ();
+}
+
+void
+Ipv4RouteTrie::FlushCache (void)
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<Node *> nodes (1, m_root);
+  while (!nodes.empty ())
+    {
+      Node *node = nodes.back ();
+      nodes.pop_back ();
+      for (Entries::iterator i = node->entries.begin (); i != node->entries.end (); ++i)
+        {
+          i->cache = 0;
+        }
+      for (uint32_t i = 0; i < 2; i++)
+        {
+          if (node->child[i] != 0)
+            {
+              nodes.push_back (node->child[i]);
+            }
+        }
+    }
+}
+
+uint32_t
+Ipv4RouteTrie::Lookup (Ipv4Address dest, Entries *matches[33])
+{
+  uint32_t address = dest.Get ();
+  uint32_t n = 0;
+  Node *node = m_root;
+  while (node != 0 && (address & Mask (node->length)) == node->prefix)
+    {
+      if (!node->entries.empty ())
+        {
+          matches[n++] = &node->entries;
+        }
+      if (node->length == 32)
+        {
+          break;
+        }
+      node = node->child[Bit (address, node->length)];
+    }
+  std::reverse (matches, matches + n);
+  return n;
+}
+
+} // namespace ns3
@@ -0,0 +1,138 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IPV4_ROUTE_TRIE_H
+#define IPV4_ROUTE_TRIE_H
+
+#include <vector>
+#include <stdint.h>
+#include "ns3/ptr.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv4-route.h"
+
+namespace ns3 {
+
+class Ipv4RoutingTableEntry;
+
+/**
+ * \ingroup ipv4Routing
+ *
+ * \brief Longest prefix match index of the unicast routes of a routing table.
+ *
+ * The routes are kept in a path-compressed binary trie (a Patricia trie),
+ * with a node per prefix holding the routes to that prefix, in the order
+ * they were added.  A lookup walks down the bits of the destination, and
+ * visits one node per prefix length matching it at most, whatever the
+ * number of routes.
+ *
+ * The index does not own the routes: the routing protocols keep them in
+ * their lists, which define the route indexes, and add and remove them
+ * to and from the index as well.  Each route of the index has a cache of
+ * the Ipv4Route built for it, for the routing protocols to return without
+ * building it for each packet; the caches must be flushed when the
+ * addresses or the state of the interfaces change.
+ */
+class Ipv4RouteTrie
+{
+public:
+  /// A route of the index.
+  struct Entry
+  {
+    Ipv4RoutingTableEntry *route; //!< The route.
+    uint32_t metric;              //!< The metric of the route.
+    uint64_t order;               //!< The order the route was added in.
+    Ptr<Ipv4Route> cache;         //!< The Ipv4Route of the route, if built.
+  };
+  /// The routes to a prefix, in the order they were added.
+  typedef std::vector<Entry> Entries;
+
+  Ipv4RouteTrie ();
+  ~Ipv4RouteTrie ();
+
+  /**
+   * \brief Add a route.
+   * \param route the route, to a network or a host
+   * \param metric the metric of the route
+   */
+  void Add (Ipv4RoutingTableEntry *route, uint32_t metric = 0);
+  /**
+   * \brief Remove a route.
+   * \param route the route, which must have been added
+   */
+  void Remove (Ipv4RoutingTableEntry *route);
+  /**
+   * \brief Remove all the routes.
+   */
+  void Clear (void);
+  /**
+   * \brief Drop the Ipv4Route cached for each route.
+   */
+  void FlushCache (void);
+
+  /**
+   * \brief Find the routes matching a destination.
+   *
+   * \param dest the destination
+   * \param matches [out] the routes of each prefix matching the
+   *        destination, from the longest prefix to the shortest
+   * \return the number of prefixes matching the destination
+   */
+  uint32_t Lookup (Ipv4Address dest, Entries *matches[33]);
+
+private:
+  /// A prefix of the trie.
+  struct Node
+  {
+    uint32_t prefix;    //!< The prefix, masked.
+    uint8_t length;     //!< The length of the prefix.
+    Node *parent;       //!< The parent node, 0 for the root.
+    Node *child[2];     //!< The children, by the bit following the prefix.
+    Entries entries;    //!< The routes to the prefix.
+  };
+
+  /**
+   * Find the node of a prefix, optionally creating it.
+   * \param prefix the prefix, masked
+   * \param length the length of the prefix
+   * \param create whether the node is created if missing
+   * \return the node, or 0 if missing and not created
+   */
+  Node *Find (uint32_t prefix, uint8_t length, bool create);
+  /**
+   * Remove a node left without routes, and its parent if it is left
+   * with a single child and no routes.
+   * \param node the node
+   */
+  void Prune (Node *node);
+  /**
+   * Delete a node and its descendants.
+   * \param node the node
+   */
+  static void Delete (Node *node);
+
+  /// Disable copy constructor.
+  Ipv4RouteTrie (const Ipv4RouteTrie &);
+  /// Disable assignment operator.
+  /// \returns the trie
+  Ipv4RouteTrie &operator= (const Ipv4RouteTrie &);
+
+  Node *m_root;       //!< The root node, for the prefix of length 0.
+  uint64_t m_order;   //!< The order of the next route added.
+};
+
+} // namespace ns3
+
+#endif /* IPV4_ROUTE_TRIE_H */
@@ -73,6 +73,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  m_networkIndex.Add (route, metric);
 }
 
 void 
@@ -87,6 +88,7 @@ Ipv4StaticRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (make_pair (route,metric));
+  m_networkIndex.Add (route, metric);
 }
 
 void 
@@ -144,6 +146,7 @@ Ipv4StaticRouting::SetDefaultMulticastRoute (uint32_t outputInterface)
                                                         networkMask,
                                                         outputInterface);
   m_networkRoutes.push_back (make_pair (route,0));
+  m_networkIndex.Add (route, 0);
 }
 
 uint32_t 
@@ -224,8 +227,6 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
 {
   NS_LOG_FUNCTION (this << dest << " " << oif);
   Ptr<Ipv4Route> rtentry = 0;
-  uint16_t longest_mask = 0;
-  uint32_t shortest_metric = 0xffffffff;
   /* when sending on local multicast, there have to be interface specified */
   if (dest.IsLocalMulticast ())
     {
@@ -240,55 +241,50 @@ Ipv4StaticRouting::LookupStatic (Ipv4Address dest, Ptr<NetDevice> oif)
     }
 
 
-  for (NetworkRoutesI i = m_networkRoutes.begin (); 
-       i != m_networkRoutes.end (); 
-       i++) 
+  // Only the routes of the longest prefix matching on the requested
+  // interface count: that with the lowest metric, or the last one added
+  // of those with the same metric, except for host routes, where the
+  // first one added is used.
+  Ipv4RouteTrie::Entries *matches[33];
+  uint32_t n = m_networkIndex.Lookup (dest, matches);
+  for (uint32_t m = 0; m < n && rtentry == 0; m++)
     {
-      Ipv4RoutingTableEntry *j=i->first;
-      uint32_t metric =i->second;
-      Ipv4Mask mask = (j)->GetDestNetworkMask ();
-      uint16_t masklen = mask.GetPrefixLength ();
-      Ipv4Address entry = (j)->GetDestNetwork ();
-      NS_LOG_LOGIC ("Searching for route to " << dest << ", checking against route to " << entry << "/" << masklen);
-      if (mask.IsMatch (dest, entry)) 
+      Ipv4RouteTrie::Entry *best = 0;
+      for (Ipv4RouteTrie::Entries::iterator i = matches[m]->begin (); i != matches[m]->end (); i++)
         {
-          NS_LOG_LOGIC ("Found global network route " << j << ", mask length " << masklen << ", metric " << metric);
-          if (oif != 0)
-            {
-              if (oif != m_ipv4->GetNetDevice (j->GetInterface ()))
-                {
-                  NS_LOG_LOGIC ("Not on requested interface, skipping");
-                  continue;
-                }
-            }
-          if (masklen < longest_mask) // Not interested if got shorter mask
+          Ipv4RoutingTableEntry *j = i->route;
+          NS_LOG_LOGIC ("Found global network route " << j << ", mask length " <<
+                        j->GetDestNetworkMask ().GetPrefixLength () << ", metric " << i->metric);
+          if (oif != 0 && oif != m_ipv4->GetNetDevice (j->GetInterface ()))
             {
-              NS_LOG_LOGIC ("Previous match longer, skipping");
+              NS_LOG_LOGIC ("Not on requested interface, skipping");
               continue;
             }
-          if (masklen > longest_mask) // Reset metric if longer masklen
-            {
-              shortest_metric = 0xffffffff;
-            }
-          longest_mask = masklen;
-          if (metric > shortest_metric)
+          if (best != 0 && i->metric > best->metric)
             {
               NS_LOG_LOGIC ("Equal mask length, but previous metric shorter, skipping");
               continue;
             }
-          shortest_metric = metric;
-          Ipv4RoutingTableEntry* route = (j);
-          uint32_t interfaceIdx = route->GetInterface ();
-          rtentry = Create<Ipv4Route> ();
-          rtentry->SetDestination (route->GetDest ());
-          rtentry->SetSource (m_ipv4->SourceAddressSelection (interfaceIdx, route->GetDest ()));
-          rtentry->SetGateway (route->GetGateway ());
-          rtentry->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
-          if (masklen == 32)
+          best = &*i;
+          if (j->IsHost ())
             {
               break;
             }
         }
+      if (best != 0)
+        {
+          if (best->cache == 0)
+            {
+              Ipv4RoutingTableEntry* route = best->route;
+              uint32_t interfaceIdx = route->GetInterface ();
+              best->cache = Create<Ipv4Route> ();
+              best->cache->SetDestination (route->GetDest ());
+              best->cache->SetSource (m_ipv4->SourceAddressSelection (interfaceIdx, route->GetDest ()));
+              best->cache->SetGateway (route->GetGateway ());
+              best->cache->SetOutputDevice (m_ipv4->GetNetDevice (interfaceIdx));
+            }
+          rtentry = best->cache;
+        }
     }
   if (rtentry != 0)
     {
@@ -447,6 +443,7 @@ Ipv4StaticRouting::RemoveRoute (uint32_t index)
     {
       if (tmp == index)
         {
+          m_networkIndex.Remove (j->first);
           delete j->first;
           m_networkRoutes.erase (j);
           return;
@@ -569,6 +566,7 @@ void
 Ipv4StaticRouting::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  m_networkIndex.Clear ();
   for (NetworkRoutesI j = m_networkRoutes.begin (); 
        j != m_networkRoutes.end (); 
        j = m_networkRoutes.erase (j)) 
@@ -589,6 +587,7 @@ void
 Ipv4StaticRouting::NotifyInterfaceUp (uint32_t i)
 {
   NS_LOG_FUNCTION (this << i);
+  m_networkIndex.FlushCache ();
   // If interface address and network mask have been set, add a route
   // to the network of the interface (like e.g. ifconfig does on a
   // Linux box)
@@ -608,11 +607,13 @@ void
 Ipv4StaticRouting::NotifyInterfaceDown (uint32_t i)
 {
   NS_LOG_FUNCTION (this << i);
+  m_networkIndex.FlushCache ();
   // Remove all static routes that are going through this interface
   for (NetworkRoutesI it = m_networkRoutes.begin (); it != m_networkRoutes.end (); )
     {
       if (it->first->GetInterface () == i)
         {
+          m_networkIndex.Remove (it->first);
           delete it->first;
           it = m_networkRoutes.erase (it);
         }
@@ -627,6 +628,7 @@ void
 Ipv4StaticRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
   NS_LOG_FUNCTION (this << interface << " " << address.GetLocal ());
+  m_networkIndex.FlushCache ();
   if (!m_ipv4->IsUp (interface))
     {
       return;
@@ -645,6 +647,7 @@ void
 Ipv4StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
   NS_LOG_FUNCTION (this << interface << " " << address.GetLocal ());
+  m_networkIndex.FlushCache ();
   if (!m_ipv4->IsUp (interface))
     {
       return;
@@ -660,6 +663,7 @@ Ipv4StaticRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress
           && it->first->GetDestNetwork () == networkAddress
           && it->first->GetDestNetworkMask () == networkMask)
         {
+          m_networkIndex.Remove (it->first);
           delete it->first;
           it = m_networkRoutes.erase (it);
         }
@@ -449,14 +449,14 @@ TcpL4Protocol::Receive (Ptr<Packet> packet,
       return checksumControl;
     }
 
-  Ipv4EndPointDemux::EndPoints endPoints;
-  endPoints = m_endPoints->Lookup (incomingIpHeader.GetDestination (),
-                                   incomingTcpHeader.GetDestinationPort (),
-                                   incomingIpHeader.GetSource (),
-                                   incomingTcpHeader.GetSourcePort (),
-                                   incomingInterface);
-
-  if (endPoints.empty ())
+  Ipv4EndPoint *endPoint;
+  endPoint = m_endPoints->LookupBest (incomingIpHeader.GetDestination (),
+                                      incomingTcpHeader.GetDestinationPort (),
+                                      incomingIpHeader.GetSource (),
+                                      incomingTcpHeader.GetSourcePort (),
+                                      incomingInterface);
+
+  if (endPoint == 0)
     {
       if (this->GetObject<Ipv6L3Protocol> () != 0)
         {
@@ -486,13 +486,12 @@ TcpL4Protocol::Receive (Ptr<Packet> packet,
 
     }
 
-  NS_ASSERT_MSG (endPoints.size () == 1, "Demux returned more than one endpoint");
   NS_LOG_LOGIC ("TcpL4Protocol " << this << " received a packet and"
                 " now forwarding it up to endpoint/socket");
 
-  (*endPoints.begin ())->ForwardUp (packet, incomingIpHeader,
-                                    incomingTcpHeader.GetSourcePort (),
-                                    incomingInterface);
+  endPoint->ForwardUp (packet, incomingIpHeader,
+                       incomingTcpHeader.GetSourcePort (),
+                       incomingInterface);
 
   return IpL4Protocol::RX_OK;
 }
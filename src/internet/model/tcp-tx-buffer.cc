@@ -96,7 +96,8 @@ TcpTxBuffer::GetTypeId (void)
  * initialized below is insignificant.
  */
 TcpTxBuffer::TcpTxBuffer (uint32_t n)
-  : m_maxBuffer (32768), m_size (0), m_sentSize (0), m_firstByteSeq (n)
+  : m_maxBuffer (32768), m_size (0), m_sentSize (0), m_firstByteSeq (n),
+    m_lostMark (n), m_lostHigh (n), m_retransHint (n), m_rescueHint (n)
 {
 }
 
@@ -169,6 +170,10 @@ TcpTxBuffer::SetHeadSequence (const SequenceNumber32& seq)
   // if you change the head with data already sent, something bad will happen
   NS_ASSERT (m_sentList.size () == 0);
   m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_lostMark = seq;
+  m_lostHigh = seq;
+  m_retransHint = seq;
+  m_rescueHint = seq;
 }
 
 bool
@@ -294,9 +299,15 @@ TcpTxBuffer::GetNewSegment (uint32_t numBytes)
   NS_ASSERT (it != m_appList.end ());
 
   m_appList.erase (it);
-  m_sentList.insert (m_sentList.end (), item);
+  m_sentIndex[item->m_startSeq] = m_sentList.insert (m_sentList.end (), item);
   m_sentSize += item->m_packet->GetSize ();
 
+  if (item->m_lost)
+    {
+      // put back by ResetLastSegmentSent
+      m_lostHigh = std::max (m_lostHigh, item->m_startSeq + item->m_packet->GetSize ());
+    }
+
   return item;
 }
 
@@ -308,36 +319,33 @@ TcpTxBuffer::GetTransmittedSegment (uint32_t numBytes, const SequenceNumber32 &s
   NS_ASSERT (numBytes <= m_sentSize);
   NS_ASSERT (m_sentList.size () >= 1);
 
-  auto it = m_sentList.begin ();
+  SentIndex::iterator index = m_sentIndex.find (seq);
   bool listEdited = false;
   uint32_t s = numBytes;
 
   // Avoid to merge different packet for this retransmission if flags are
   // different.
-  for (; it != m_sentList.end(); ++it)
+  if (index != m_sentIndex.end ())
     {
-      if ((*it)->m_startSeq == seq)
+      PacketList::iterator it = index->second;
+      auto next = it;
+      next++;
+      if (next != m_sentList.end ())
         {
-          auto next = it;
-          next++;
-          if (next != m_sentList.end ())
+          // Next is not sacked... there is the possibility to merge
+          if (! (*next)->m_sacked)
             {
-              // Next is not sacked... there is the possibility to merge
-              if (! (*next)->m_sacked)
-                {
-                  s = std::min(s, (*it)->m_packet->GetSize () + (*next)->m_packet->GetSize ());
-                }
-              else
-                {
-                  // Next is sacked... better to retransmit only the first segment
-                  s = std::min(s, (*it)->m_packet->GetSize ());
-                }
+              s = std::min(s, (*it)->m_packet->GetSize () + (*next)->m_packet->GetSize ());
             }
           else
             {
+              // Next is sacked... better to retransmit only the first segment
               s = std::min(s, (*it)->m_packet->GetSize ());
             }
-          break;
+        }
+      else
+        {
+          s = std::min(s, (*it)->m_packet->GetSize ());
         }
     }
 
@@ -398,7 +406,7 @@ TcpTxBuffer::SplitItems (TcpTxItem *t1, TcpTxItem *t2, uint32_t size) const
 TcpTxItem*
 TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listStartFrom,
                                 uint32_t numBytes, const SequenceNumber32 &seq,
-                                bool *listEdited) const
+                                bool *listEdited)
 {
   NS_LOG_FUNCTION (this << numBytes << seq);
 
@@ -434,12 +442,21 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
   TcpTxItem *outItem = nullptr;
   PacketList::iterator it = list.begin ();
   SequenceNumber32 beginOfCurrentPacket = listStartFrom;
+  bool isSentList = &list == &m_sentList;
+
+  if (isSentList)
+    {
+      // Start from the packet holding seq rather than the head
+      it = FindSentItem (seq);
+      NS_ASSERT (it != list.end ());
+      beginOfCurrentPacket = (*it)->m_startSeq;
+    }
 
   while (it != list.end ())
     {
       currentItem = *it;
       currentPacket = currentItem->m_packet;
-      NS_ASSERT_MSG (list != m_sentList || currentItem->m_startSeq >= m_firstByteSeq,
+      NS_ASSERT_MSG (!isSentList || currentItem->m_startSeq >= m_firstByteSeq,
                      "start: " << m_firstByteSeq << " currentItem start: " <<
                      currentItem->m_startSeq);
 
@@ -469,7 +486,12 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
               SplitItems (firstPart, currentItem, seq - beginOfCurrentPacket);
 
               // insert firstPart before currentItem
-              list.insert (it, firstPart);
+              PacketList::iterator first = list.insert (it, firstPart);
+              if (isSentList)
+                {
+                  m_sentIndex[firstPart->m_startSeq] = first;
+                  m_sentIndex[currentItem->m_startSeq] = it;
+                }
               if (listEdited)
                 {
                   *listEdited = true;
@@ -535,7 +557,12 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
               SplitItems (firstPart, currentItem, numBytes);
 
               // insert firstPart before currentItem
-              list.insert (it, firstPart);
+              PacketList::iterator first = list.insert (it, firstPart);
+              if (isSentList)
+                {
+                  m_sentIndex[firstPart->m_startSeq] = first;
+                  m_sentIndex[currentItem->m_startSeq] = it;
+                }
               if (listEdited)
                 {
                   *listEdited = true;
@@ -564,6 +591,10 @@ TcpTxBuffer::GetPacketFromList (PacketList &list, const SequenceNumber32 &listSt
                                    // in the previous if
 
           MergeItems (currentItem, next);
+          if (isSentList)
+            {
+              m_sentIndex.erase (next->m_startSeq);
+            }
           list.erase (it);
 
           delete next;
@@ -602,6 +633,7 @@ TcpTxBuffer::MergeItems (TcpTxItem *t1, TcpTxItem *t2) const
   // be updated in GetTransmittedSegment.
   if (! AreEquals (t1->m_retrans, t2->m_retrans))
     {
+      RewindNextSeg (t1->m_startSeq);
       if (t1->m_retrans)
         {
           TcpTxBuffer *self = const_cast<TcpTxBuffer*> (this);
@@ -693,6 +725,7 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
 
           RemoveFromCounts (item, pktSize);
 
+          m_sentIndex.erase (item->m_startSeq);
           i = m_sentList.erase (i);
           NS_LOG_INFO ("Removed " << *item << " lost: " << m_lostOut <<
                        " retrans: " << m_retrans << " sacked: " << m_sackedOut <<
@@ -705,7 +738,9 @@ TcpTxBuffer::DiscardUpTo (const SequenceNumber32& seq)
           NS_LOG_INFO (*item);
           // PacketTags are preserved when fragmenting
           item->m_packet = item->m_packet->CreateFragment (offset, pktSize);
+          m_sentIndex.erase (item->m_startSeq);
           item->m_startSeq += offset;
+          m_sentIndex[item->m_startSeq] = i;
           m_size -= offset;
           m_sentSize -= offset;
           m_firstByteSeq += offset;
@@ -768,18 +803,25 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
 
   for (auto option_it = list.begin (); option_it != list.end (); ++option_it)
     {
-      PacketList::iterator item_it = m_sentList.begin ();
-      SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-
       if (m_firstByteSeq + m_sentSize < (*option_it).first && !modified)
         {
           NS_LOG_INFO ("Not updating scoreboard, the option block is outside the sent list");
           return false;
         }
 
+      // Only the packets starting in the block can be sacked: start from
+      // the first of them rather than the head
+      SentIndex::iterator index = m_sentIndex.lower_bound ((*option_it).first);
+      PacketList::iterator item_it = m_sentList.end ();
+      if (index != m_sentIndex.end ())
+        {
+          item_it = index->second;
+        }
+
       while (item_it != m_sentList.end ())
         {
           uint32_t pktSize = (*item_it)->m_packet->GetSize ();
+          SequenceNumber32 beginOfCurrentPacket = (*item_it)->m_startSeq;
 
           // Check the boundary of this packet ... only mark as sacked if
           // it is precisely mapped over the option. It means that if the receiver
@@ -829,7 +871,6 @@ TcpTxBuffer::Update (const TcpOptionSack::SackList &list)
               break;
             }
 
-          beginOfCurrentPacket += pktSize;
           ++item_it;
         }
     }
@@ -853,7 +894,6 @@ TcpTxBuffer::UpdateLostCount ()
 {
   NS_LOG_FUNCTION (this);
   uint32_t sacked = 0;
-  SequenceNumber32 beginOfCurrentPacket = m_highestSack.second;
   if (m_highestSack.first == m_sentList.end ())
     {
       NS_LOG_INFO ("Status before the update: " << *this <<
@@ -865,32 +905,44 @@ TcpTxBuffer::UpdateLostCount ()
                    ", will start from item " << *(*m_highestSack.first));
     }
 
-  for (auto it = m_highestSack.first; it != m_sentList.begin(); --it)
+  // Find the dupAckThresh-th sacked item, counting down from the highest
+  // sacked one: the items below it which are not sacked are lost
+  PacketList::const_iterator it = m_highestSack.first;
+  for (; it != m_sentList.begin (); --it)
     {
-      TcpTxItem *item = *it;
-      if (item->m_sacked)
+      if ((*it)->m_sacked && ++sacked >= m_dupAckThresh)
         {
-          sacked++;
+          break;
         }
+    }
 
-      if (sacked >= m_dupAckThresh)
+  if (sacked >= m_dupAckThresh)
+    {
+      SequenceNumber32 threshold = (*it)->m_startSeq;
+      // The items below m_lostMark are already sacked or lost
+      while (it != m_sentList.begin ())
         {
-          if (!item->m_sacked && !item->m_lost)
+          TcpTxItem *item = *(--it);
+          if (item->m_startSeq < m_lostMark)
+            {
+              break;
+            }
+          if (it != m_sentList.begin () && !item->m_sacked && !item->m_lost)
             {
               item->m_lost = true;
               m_lostOut += item->m_packet->GetSize ();
+              RewindNextSeg (item->m_startSeq);
             }
         }
-      beginOfCurrentPacket -= item->m_packet->GetSize ();
-    }
+      m_lostMark = std::max (m_lostMark, threshold);
+      m_lostHigh = std::max (m_lostHigh, threshold);
 
-  if (sacked >= m_dupAckThresh)
-    {
       TcpTxItem *item = *m_sentList.begin ();
       if (!item->m_lost)
         {
           item->m_lost = true;
           m_lostOut += item->m_packet->GetSize ();
+          RewindNextSeg (item->m_startSeq);
         }
     }
   NS_LOG_INFO ("Status after the update: " << *this);
@@ -902,35 +954,31 @@ TcpTxBuffer::IsLost (const SequenceNumber32 &seq) const
 {
   NS_LOG_FUNCTION (this << seq);
 
-  SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-  PacketList::const_iterator it;
-
   if (seq >= m_highestSack.second)
     {
       return false;
     }
 
-  // In theory, using a map and hints when inserting elements can improve
-  // performance
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  // Start from the first packet starting at or after seq
+  SentIndex::const_iterator index = m_sentIndex.lower_bound (seq);
+  if (index == m_sentIndex.end ())
     {
-      // Search for the right iterator before calling IsLost()
-      if (beginOfCurrentPacket >= seq)
-        {
-          if ((*it)->m_lost == true)
-            {
-              NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
-              return true;
-            }
+      return false;
+    }
 
-          if ((*it)->m_sacked == true)
-            {
-              NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
-              return false;
-            }
+  for (PacketList::const_iterator it = index->second; it != m_sentList.end (); ++it)
+    {
+      if ((*it)->m_lost == true)
+        {
+          NS_LOG_INFO ("seq=" << seq << " is lost because of lost flag");
+          return true;
         }
 
-      beginOfCurrentPacket += (*it)->m_packet->GetSize ();
+      if ((*it)->m_sacked == true)
+        {
+          NS_LOG_INFO ("seq=" << seq << " is not lost because of sacked flag");
+          return false;
+        }
     }
 
   return false;
@@ -953,36 +1001,33 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, bool isRecovery) const
    *           received SACK.
    *
    *     (1.c) IsLost (S2) returns true.
+   *
+   * The search starts from m_retransHint, below which no segment meets
+   * these criteria, and stops at m_lostHigh, after which no segment is lost.
    */
   PacketList::const_iterator it;
   TcpTxItem *item;
-  SequenceNumber32 seqPerRule3;
-  bool isSeqPerRule3Valid = false;
-  SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq;
 
-  for (it = m_sentList.begin (); it != m_sentList.end (); ++it)
+  if (m_lostOut > 0)
     {
-      item = *it;
-
-      // Condition 1.a , 1.b , and 1.c
-      if (item->m_retrans == false && item->m_sacked == false)
+      for (it = FindSentItem (m_retransHint); it != m_sentList.end (); ++it)
         {
-          if (item->m_lost)
+          item = *it;
+          if (item->m_startSeq >= m_lostHigh)
             {
-              NS_LOG_INFO("IsLost, returning" << beginOfCurrentPkt);
-              *seq = beginOfCurrentPkt;
-              return true;
+              break;
             }
-          else if (seqPerRule3.GetValue () == 0 && isRecovery)
+
+          // Condition 1.a , 1.b , and 1.c
+          if (item->m_retrans == false && item->m_sacked == false && item->m_lost)
             {
-              NS_LOG_INFO ("Saving for rule 3 the seq " << beginOfCurrentPkt);
-              isSeqPerRule3Valid = true;
-              seqPerRule3 = beginOfCurrentPkt;
+              NS_LOG_INFO("IsLost, returning" << item->m_startSeq);
+              m_retransHint = item->m_startSeq;
+              *seq = item->m_startSeq;
+              return true;
             }
         }
-
-      // Nothing found, iterate
-      beginOfCurrentPkt += item->m_packet->GetSize ();
+      m_retransHint = it == m_sentList.end () ? m_firstByteSeq.Get () + m_sentSize : (*it)->m_startSeq;
     }
 
   /* (2) If no sequence number 'S2' per rule (1) exists but there
@@ -1008,11 +1053,20 @@ TcpTxBuffer::NextSeg (SequenceNumber32 *seq, bool isRecovery) const
    *     (specifically excluding step (1.c)), then one segment of up to
    *     SMSS octets starting with S3 SHOULD be returned.
    */
-  if (isSeqPerRule3Valid)
+  if (isRecovery)
     {
-      NS_LOG_INFO ("Rule3 valid. " << seqPerRule3);
-      *seq = seqPerRule3;
-      return true;
+      for (it = FindSentItem (m_rescueHint); it != m_sentList.end (); ++it)
+        {
+          item = *it;
+          if (item->m_retrans == false && item->m_sacked == false)
+            {
+              NS_LOG_INFO ("Rule3 valid. " << item->m_startSeq);
+              m_rescueHint = item->m_startSeq;
+              *seq = item->m_startSeq;
+              return true;
+            }
+        }
+      m_rescueHint = m_firstByteSeq + m_sentSize;
     }
 
   /* (4) If the conditions for (1), (2), and (3) fail, but there exists
@@ -1186,6 +1240,8 @@ TcpTxBuffer::ResetRenoSack ()
     }
 
   m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_lostMark = m_firstByteSeq;
+  RewindNextSeg (m_firstByteSeq);
 }
 
 void
@@ -1203,11 +1259,15 @@ TcpTxBuffer::ResetSentList ()
       m_sentList.pop_back ();
     }
 
+  m_sentIndex.clear ();
   m_sentSize = 0;
   m_lostOut = 0;
   m_retrans = 0;
   m_sackedOut = 0;
   m_highestSack = std::make_pair (m_sentList.end (), SequenceNumber32 (0));
+  m_lostMark = m_firstByteSeq;
+  m_lostHigh = m_firstByteSeq;
+  RewindNextSeg (m_firstByteSeq);
 }
 
 void
@@ -1218,8 +1278,11 @@ TcpTxBuffer::ResetLastSegmentSent ()
     {
       TcpTxItem *item = m_sentList.back ();
 
+      m_sentIndex.erase (item->m_startSeq);
       m_sentList.pop_back ();
       m_sentSize -= item->m_packet->GetSize ();
+      m_lostMark = std::min (m_lostMark, item->m_startSeq);
+      RewindNextSeg (item->m_startSeq);
       if (item->m_retrans)
         {
           m_retrans -= item->m_packet->GetSize ();
@@ -1271,6 +1334,10 @@ TcpTxBuffer::SetSentListLost (bool resetSack)
       (*it)->m_retrans = false;
     }
 
+  m_lostMark = m_firstByteSeq + m_sentSize;
+  m_lostHigh = std::max (m_lostHigh, m_lostMark);
+  RewindNextSeg (m_firstByteSeq);
+
   NS_LOG_INFO ("Set sent list lost, status: " << *this);
   NS_ASSERT_MSG (m_sentSize >= m_sackedOut + m_lostOut, *this);
   ConsistencyCheck ();
@@ -1303,6 +1370,7 @@ TcpTxBuffer::DeleteRetransmittedFlagFromHead ()
     {
       m_sentList.front ()->m_retrans = false;
       m_retrans -= m_sentList.front ()->m_packet->GetSize ();
+      RewindNextSeg (m_firstByteSeq);
     }
   ConsistencyCheck ();
 }
@@ -1332,6 +1400,9 @@ TcpTxBuffer::MarkHeadAsLost ()
           m_sentList.front()->m_lost = true;
           m_lostOut += m_sentList.front ()->m_packet->GetSize ();
         }
+
+      m_lostHigh = std::max (m_lostHigh, m_firstByteSeq.Get () + m_sentList.front ()->m_packet->GetSize ());
+      RewindNextSeg (m_firstByteSeq);
     }
   ConsistencyCheck ();
 }
@@ -1370,6 +1441,36 @@ TcpTxBuffer::AddRenoSack (void)
   ConsistencyCheck ();
 }
 
+TcpTxBuffer::PacketList::iterator
+TcpTxBuffer::FindSentItem (const SequenceNumber32 &seq) const
+{
+  // The last packet starting at or before seq holds it, if any
+  SentIndex::const_iterator index = m_sentIndex.upper_bound (seq);
+  if (index == m_sentIndex.begin ())
+    {
+      // seq is before the head, or nothing has been sent
+      if (index == m_sentIndex.end ())
+        {
+          return const_cast<PacketList &> (m_sentList).end ();
+        }
+      return index->second;
+    }
+  --index;
+  PacketList::iterator it = index->second;
+  if (seq < (*it)->m_startSeq + (*it)->m_packet->GetSize ())
+    {
+      return it;
+    }
+  return ++it;
+}
+
+void
+TcpTxBuffer::RewindNextSeg (const SequenceNumber32 &seq) const
+{
+  m_retransHint = std::min (m_retransHint, seq);
+  m_rescueHint = std::min (m_rescueHint, seq);
+}
+
 void
 TcpTxBuffer::ConsistencyCheck () const
 {
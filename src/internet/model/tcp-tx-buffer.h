@@ -28,6 +28,8 @@
 #include "ns3/nstime.h"
 #include "ns3/tcp-option-sack.h"
 #include "ns3/packet.h"
+#include <list>
+#include <map>
 
 namespace ns3 {
 class Packet;
@@ -105,6 +107,15 @@ public:
  * documentation) and maintaining the scoreboard is a matter of travelling the
  * list and set the SACK flag on the corresponding segment sent.
  *
+ * With large windows, an ACK carrying SACK blocks would walk the whole list
+ * from its head, several times. The sent items are therefore also indexed
+ * by their first sequence number, in a map, so that a SACK block, a lookup
+ * by IsLost or a retransmission finds its items in O(log n). As in Linux,
+ * the scoreboard keeps cursors into the list as well: UpdateLostCount
+ * remembers up to where it has marked segments as lost, and NextSeg where
+ * it stopped finding segments to retransmit, so that they do not walk the
+ * part of the list they already went through.
+ *
  * Item properties
  * ---------------
  *
@@ -410,6 +421,8 @@ private:
   friend std::ostream & operator<< (std::ostream & os, TcpTxBuffer const & tcpTxBuf);
 
   typedef std::list<TcpTxItem*> PacketList; //!< container for data stored in the buffer
+  /// Index of the sent list, by the first sequence number of the items
+  typedef std::map<SequenceNumber32, PacketList::iterator> SentIndex;
 
   /**
    * \brief Update the lost count
@@ -426,12 +439,28 @@ private:
    * The {New}Reno cases, for now, are managed in TcpSocketBase through the
    * call to MarkHeadAsLost.
    * This function is, therefore, called after a SACK option has been received,
-   * and updates the lost count. It can be probably optimized by not walking
-   * the entire list, but a subset.
+   * and updates the lost count. The segments below m_lostMark that are not
+   * sacked are already marked as lost, so the list is walked from the
+   * highest sacked segment down to m_lostMark only.
    *
    */
   void UpdateLostCount ();
 
+  /**
+   * \brief Find the item of the sent list holding a sequence number
+   * \param seq the sequence number
+   * \return the item holding seq, the head of the sent list if seq is
+   * before it, or the end of the sent list if seq is after it
+   */
+  PacketList::iterator FindSentItem (const SequenceNumber32 &seq) const;
+
+  /**
+   * \brief Move the NextSeg cursors back, when a segment starting at or
+   * after a sequence number may have to be retransmitted again
+   * \param seq the sequence number
+   */
+  void RewindNextSeg (const SequenceNumber32 &seq) const;
+
   /**
    * \brief Remove the size specified from the lostOut, retrans, sacked count
    *
@@ -560,7 +589,7 @@ private:
    */
   TcpTxItem* GetPacketFromList (PacketList &list, const SequenceNumber32 &startingSeq,
                                 uint32_t numBytes, const SequenceNumber32 &requestedSeq,
-                                bool *listEdited = nullptr) const;
+                                bool *listEdited = nullptr);
 
   /**
    * \brief Merge two TcpTxItem
@@ -601,6 +630,7 @@ private:
 
   PacketList m_appList;  //!< Buffer for application data
   PacketList m_sentList; //!< Buffer for sent (but not acked) data
+  SentIndex m_sentIndex; //!< Items of the sent list, by sequence number
   uint32_t m_maxBuffer;  //!< Max number of data bytes in buffer (SND.WND)
   uint32_t m_size;       //!< Size of all data in this buffer
   uint32_t m_sentSize;   //!< Size of sent (and not discarded) segments
@@ -608,6 +638,11 @@ private:
   TracedValue<SequenceNumber32> m_firstByteSeq; //!< Sequence number of the first byte in data (SND.UNA)
   std::pair <PacketList::const_iterator, SequenceNumber32> m_highestSack; //!< Highest SACK byte
 
+  SequenceNumber32 m_lostMark; //!< The segments below are either sacked or lost
+  SequenceNumber32 m_lostHigh; //!< No segment at or after it is lost
+  mutable SequenceNumber32 m_retransHint; //!< NextSeg rule 1 finds no segment below
+  mutable SequenceNumber32 m_rescueHint;  //!< NextSeg rule 3 finds no segment below
+
   uint32_t m_lostOut   {0}; //!< Number of lost bytes
   uint32_t m_sackedOut {0}; //!< Number of sacked bytes
   uint32_t m_retrans   {0}; //!< Number of retransmitted bytes
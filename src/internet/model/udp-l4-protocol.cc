@@ -342,10 +342,10 @@ UdpL4Protocol::Receive (Ptr<Packet> packet,
     }
 
   NS_LOG_DEBUG ("Looking up dst " << header.GetDestination () << " port " << udpHeader.GetDestinationPort ()); 
-  Ipv4EndPointDemux::EndPoints endPoints =
-    m_endPoints->Lookup (header.GetDestination (), udpHeader.GetDestinationPort (),
-                         header.GetSource (), udpHeader.GetSourcePort (), interface);
-  if (endPoints.empty ())
+  Ipv4EndPoint *endPoint =
+    m_endPoints->LookupBest (header.GetDestination (), udpHeader.GetDestinationPort (),
+                             header.GetSource (), udpHeader.GetSourcePort (), interface);
+  if (endPoint == 0)
     {
       if (this->GetObject<Ipv6L3Protocol> () != 0)
         {
@@ -364,12 +364,8 @@ UdpL4Protocol::Receive (Ptr<Packet> packet,
     }
 
   packet->RemoveHeader(udpHeader);
-  for (Ipv4EndPointDemux::EndPointsI endPoint = endPoints.begin ();
-       endPoint != endPoints.end (); endPoint++)
-    {
-      (*endPoint)->ForwardUp (packet->Copy (), header, udpHeader.GetSourcePort (), 
-                              interface);
-    }
+  endPoint->ForwardUp (packet->Copy (), header, udpHeader.GetSourcePort (), 
+                       interface);
   return IpL4Protocol::RX_OK;
 }
 
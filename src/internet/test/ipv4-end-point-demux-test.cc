@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "ns3/test.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv4-interface-address.h"
+#include "../model/ipv4-end-point.h"
+#include "../model/ipv4-end-point-demux.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4EndPointDemux lookup test.
+ *
+ * Checks that the most-matching endpoint is found, from the connections
+ * to the listeners on any address, and that the endpoints are found again
+ * after their four-tuple changes.
+ */
+class Ipv4EndPointDemuxLookupTest : public TestCase
+{
+public:
+  Ipv4EndPointDemuxLookupTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+Ipv4EndPointDemuxLookupTest::Ipv4EndPointDemuxLookupTest ()
+  : TestCase ("Ipv4EndPointDemux lookup of the most-matching endpoint")
+{
+}
+
+void
+Ipv4EndPointDemuxLookupTest::DoRun (void)
+{
+  Ipv4EndPointDemux demux;
+  Ptr<Ipv4Interface> iface = CreateObject<Ipv4Interface> ();
+  iface->AddAddress (Ipv4InterfaceAddress (Ipv4Address ("10.0.0.1"), Ipv4Mask ("255.255.255.0")));
+  Ipv4Address local ("10.0.0.1");
+  Ipv4Address peer ("10.0.0.2");
+
+  Ipv4EndPoint *listener = demux.Allocate (Ptr<NetDevice> (), Ipv4Address::GetAny (), 80);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupBest (local, 80, peer, 1234, iface), listener,
+                         "The listener on any address is not found");
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupBest (local, 81, peer, 1234, iface), 0,
+                         "An endpoint is found on another port");
+
+  Ipv4EndPoint *connection = demux.Allocate (Ptr<NetDevice> (), local, 80, peer, 1234);
+  NS_TEST_ASSERT_MSG_EQ (demux.Allocate (Ptr<NetDevice> (), local, 80, peer, 1234), 0,
+                         "A duplicated connection is allocated");
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupBest (local, 80, peer, 1234, iface), connection,
+                         "The connection is not preferred to the listener");
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupBest (local, 80, peer, 1235, iface), listener,
+                         "The listener is not found for another peer port");
+  NS_TEST_ASSERT_MSG_EQ (demux.Lookup (local, 80, peer, 1234, iface).size (), 1,
+                         "Lookup does not return a single endpoint");
+  NS_TEST_ASSERT_MSG_EQ (demux.SimpleLookup (local, 80, peer, 1234), connection,
+                         "SimpleLookup does not find the connection");
+
+  // the local address and port of a connection can not be bound again
+  Ipv4EndPoint *bound = demux.Allocate (Ptr<NetDevice> (), local, 8080);
+  Ipv4EndPoint *other = demux.Allocate (Ptr<NetDevice> (), Ipv4Address::GetAny (), 8080);
+  Ipv4EndPoint *accepted = demux.Allocate (Ptr<NetDevice> (), local, 8080, peer, 1234);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupBest (local, 8080, Ipv4Address ("10.0.0.3"), 1, iface), bound,
+                         "The listener on the address is not preferred to the one on any address");
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupBest (local, 8080, peer, 1234, iface), accepted,
+                         "The connection is not preferred to the listener on the address");
+  accepted->SetRxEnabled (false);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupBest (local, 8080, peer, 1234, iface), bound,
+                         "A connection which can not receive is found");
+  demux.DeAllocate (bound);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupBest (local, 8080, peer, 1234, iface), other,
+                         "The listener on any address is not found after a deallocation");
+
+  Ipv4EndPoint *subnet = demux.Allocate (Ptr<NetDevice> (), Ipv4Address ("10.0.0.0"), 90);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupBest (Ipv4Address ("10.0.0.255"), 90, peer, 1234, iface), subnet,
+                         "The listener on the subnet does not receive its broadcasts");
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupBest (Ipv4Address ("10.0.1.255"), 90, peer, 1234, iface), 0,
+                         "The listener on the subnet receives the broadcasts of another subnet");
+
+  Ipv4EndPoint *client = demux.Allocate ();
+  uint16_t port = client->GetLocalPort ();
+  client->SetLocalAddress (local);
+  client->SetPeer (peer, 5000);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupBest (local, port, peer, 5000, iface), client,
+                         "The endpoint is not found after its four-tuple changed");
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupBest (local, port, Ipv4Address ("10.0.0.5"), 5000, iface), 0,
+                         "The endpoint is found for another peer");
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (port), true,
+                         "The local port of the endpoint is not in use");
+  demux.DeAllocate (client);
+  NS_TEST_ASSERT_MSG_EQ (demux.LookupPortLocal (port), false,
+                         "The local port of the endpoint is still in use");
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Ipv4EndPointDemux TestSuite
+ */
+class Ipv4EndPointDemuxTestSuite : public TestSuite
+{
+public:
+  Ipv4EndPointDemuxTestSuite ()
+    : TestSuite ("ipv4-end-point-demux", UNIT)
+  {
+    AddTestCase (new Ipv4EndPointDemuxLookupTest, TestCase::QUICK);
+  }
+};
+
+static Ipv4EndPointDemuxTestSuite g_ipv4EndPointDemuxTestSuite; //!< Static variable for test initialization
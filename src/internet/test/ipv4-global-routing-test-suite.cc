@@ -14,7 +14,9 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
 #include <vector>
+#include <sstream>
 #include "ns3/boolean.h"
 #include "ns3/config.h"
 #include "ns3/inet-socket-address.h"
@@ -1244,6 +1246,174 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Global routing computed on several threads and recomputed
+ * incrementally, compared with the routes computed serially.
+ *
+ * A ring of six routers with unequal metrics has a host on routers 0, 2
+ * and 4, and a LAN between routers 3 and 5 and a fourth host; two more
+ * routers are linked to each other only.  A link of the ring goes down
+ * and up again.
+ */
+class Ipv4GlobalRoutingRecomputeTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingRecomputeTestCase ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Print the global routes of all the nodes.
+   * \returns the routes
+   */
+  std::string GetRoutes (void);
+  /**
+   * Get the global routing of a node.
+   * \param i the index of the node
+   * \returns the global routing
+   */
+  Ptr<Ipv4GlobalRouting> GetRouting (uint32_t i);
+  /**
+   * Recompute the routes.
+   * \param threads the number of threads
+   * \param incremental whether the recomputation is incremental
+   */
+  void Recompute (uint32_t threads, bool incremental);
+
+  NodeContainer m_nodes; //!< Nodes used in the test.
+};
+
+Ipv4GlobalRoutingRecomputeTestCase::Ipv4GlobalRoutingRecomputeTestCase ()
+  : TestCase ("Global routing computed on several threads and recomputed incrementally")
+{
+}
+
+std::string
+Ipv4GlobalRoutingRecomputeTestCase::GetRoutes (void)
+{
+  std::ostringstream oss;
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> routing = GetRouting (i);
+      oss << "node " << i << ":";
+      for (uint32_t j = 0; j < routing->GetNRoutes (); j++)
+        {
+          Ipv4RoutingTableEntry* route = routing->GetRoute (j);
+          oss << " " << route->GetDest () << "/" << route->GetDestNetworkMask ().GetPrefixLength ()
+              << " gw " << route->GetGateway () << " if " << route->GetInterface () << ";";
+        }
+      oss << std::endl;
+    }
+  return oss.str ();
+}
+
+Ptr<Ipv4GlobalRouting>
+Ipv4GlobalRoutingRecomputeTestCase::GetRouting (uint32_t i)
+{
+  Ptr<Ipv4L3Protocol> ip = m_nodes.Get (i)->GetObject<Ipv4L3Protocol> ();
+  return ip->GetRoutingProtocol ()->GetObject<Ipv4GlobalRouting> ();
+}
+
+void
+Ipv4GlobalRoutingRecomputeTestCase::Recompute (uint32_t threads, bool incremental)
+{
+  Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (threads));
+  Config::SetGlobal ("GlobalRoutingIncremental", BooleanValue (incremental));
+  Ipv4GlobalRoutingHelper::RecomputeRoutingTables ();
+}
+
+void
+Ipv4GlobalRoutingRecomputeTestCase::DoRun (void)
+{
+  // routers 0 to 5 on the ring, hosts 6 to 8 on routers 0, 2 and 4,
+  // host 9 on the LAN, routers 10 and 11 apart
+  m_nodes.Create (12);
+  InternetStackHelper internet;
+  Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+  internet.SetRoutingHelper (ipv4RoutingHelper);
+  internet.Install (m_nodes);
+
+  SimpleNetDeviceHelper simpleHelper;
+  simpleHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.0.0", "255.255.255.252");
+  uint32_t links[][2] = { {0, 1}, {1, 2}, {2, 3}, {3, 4}, {4, 5}, {5, 0},
+                          {0, 6}, {2, 7}, {4, 8}, {10, 11} };
+  for (uint32_t i = 0; i < sizeof (links) / sizeof (links[0]); i++)
+    {
+      NetDeviceContainer net = simpleHelper.Install (NodeContainer (m_nodes.Get (links[i][0]), m_nodes.Get (links[i][1])));
+      Ipv4InterfaceContainer interfaces = ipv4.Assign (net);
+      // make the short way round the ring from 0 to 3 more expensive
+      if (i < 2)
+        {
+          interfaces.Get (0).first->SetMetric (interfaces.Get (0).second, 3);
+          interfaces.Get (1).first->SetMetric (interfaces.Get (1).second, 3);
+        }
+      ipv4.NewNetwork ();
+    }
+  simpleHelper.SetNetDevicePointToPointMode (false);
+  NetDeviceContainer lan = simpleHelper.Install (NodeContainer (m_nodes.Get (3), m_nodes.Get (5), m_nodes.Get (9)));
+  ipv4.SetBase ("10.2.0.0", "255.255.255.0");
+  Ipv4InterfaceContainer lanInterfaces = ipv4.Assign (lan);
+  // the global routing supports a single path from a router to a LAN
+  lanInterfaces.Get (0).first->SetMetric (lanInterfaces.Get (0).second, 2);
+
+  Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (1));
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
+  std::string up = GetRoutes ();
+  NS_TEST_ASSERT_MSG_NE (GetRouting (6)->GetNRoutes (), 0, "No routes computed");
+
+  Recompute (4, false);
+  NS_TEST_EXPECT_MSG_EQ (GetRoutes (), up, "Routes computed on several threads differ");
+
+  // the link between routers 0 and 1 goes down
+  Ptr<Ipv4> ipv41 = m_nodes.Get (1)->GetObject<Ipv4> ();
+  uint32_t ifIndex1 = ipv41->GetInterfaceForDevice (m_nodes.Get (1)->GetDevice (1));
+  ipv41->SetDown (ifIndex1);
+  Recompute (1, false);
+  std::string down = GetRoutes ();
+  NS_TEST_EXPECT_MSG_NE (down, up, "Routes did not change with the link down");
+  ipv41->SetUp (ifIndex1);
+  Recompute (1, false);
+  NS_TEST_EXPECT_MSG_EQ (GetRoutes (), up, "Routes did not come back with the link up");
+
+  // a route added by hand is only deleted with the routes recomputed:
+  // the apart routers and the hosts of routers 2 and 4 keep theirs
+  uint32_t kept[] = { 7, 8, 10, 11 };
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      GetRouting (i)->AddHostRouteTo ("192.168.0.1", 1);
+    }
+  ipv41->SetDown (ifIndex1);
+  Recompute (4, true);
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> routing = GetRouting (i);
+      bool found = false;
+      for (uint32_t j = 0; j < routing->GetNRoutes (); j++)
+        {
+          if (routing->GetRoute (j)->GetDest () == Ipv4Address ("192.168.0.1"))
+            {
+              routing->RemoveRoute (j);
+              found = true;
+              break;
+            }
+        }
+      bool isKept = std::find (kept, kept + sizeof (kept) / sizeof (kept[0]), i) != kept + sizeof (kept) / sizeof (kept[0]);
+      NS_TEST_EXPECT_MSG_EQ (found, isKept, "Routes of node " << i << " kept or recomputed by mistake");
+    }
+  NS_TEST_EXPECT_MSG_EQ (GetRoutes (), down, "Routes recomputed incrementally differ with the link down");
+  ipv41->SetUp (ifIndex1);
+  Recompute (1, true);
+  NS_TEST_EXPECT_MSG_EQ (GetRoutes (), up, "Routes recomputed incrementally differ with the link up");
+
+  Config::SetGlobal ("GlobalRoutingThreads", UintegerValue (1));
+  Config::SetGlobal ("GlobalRoutingIncremental", BooleanValue (false));
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -1267,6 +1437,7 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
     AddTestCase (new TwoBridgeTest, TestCase::QUICK);
     AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase (new Ipv4GlobalRoutingRecomputeTestCase, TestCase::QUICK);
   }
 
 static Ipv4GlobalRoutingTestSuite g_globalRoutingTestSuite; //!< Static variable for test initialization
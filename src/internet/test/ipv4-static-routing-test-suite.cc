@@ -35,6 +35,8 @@
 #include "ns3/simple-net-device-helper.h"
 #include "ns3/socket-factory.h"
 #include "ns3/udp-socket-factory.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/ipv4-routing-table-entry.h"
 
 using namespace ns3;
 
@@ -201,6 +203,146 @@ Ipv4StaticRoutingSlash32TestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 StaticRouting lookup Test, comparing the routes found with
+ * those of a linear search of the routing table, as routes are added and
+ * removed.
+ */
+class Ipv4StaticRoutingLookupTestCase : public TestCase
+{
+public:
+  Ipv4StaticRoutingLookupTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Find the route to a destination with a linear search.
+   * \param routing The routing protocol.
+   * \param ipv4 The IPv4 stack.
+   * \param dest The destination.
+   * \param oif The output device, if any.
+   * \return The index of the route, or the number of routes if none.
+   */
+  static uint32_t LinearLookup (Ptr<Ipv4StaticRouting> routing, Ptr<Ipv4> ipv4,
+                                Ipv4Address dest, Ptr<NetDevice> oif);
+};
+
+Ipv4StaticRoutingLookupTestCase::Ipv4StaticRoutingLookupTestCase ()
+  : TestCase ("Static routing lookup of the longest prefix match")
+{
+}
+
+uint32_t
+Ipv4StaticRoutingLookupTestCase::LinearLookup (Ptr<Ipv4StaticRouting> routing, Ptr<Ipv4> ipv4,
+                                               Ipv4Address dest, Ptr<NetDevice> oif)
+{
+  uint32_t found = routing->GetNRoutes ();
+  uint16_t longestMask = 0;
+  uint32_t shortestMetric = 0xffffffff;
+  for (uint32_t i = 0; i < routing->GetNRoutes (); i++)
+    {
+      Ipv4RoutingTableEntry route = routing->GetRoute (i);
+      uint32_t metric = routing->GetMetric (i);
+      Ipv4Mask mask = route.GetDestNetworkMask ();
+      uint16_t maskLength = mask.GetPrefixLength ();
+      if (!mask.IsMatch (dest, route.GetDestNetwork ())
+          || (oif != 0 && oif != ipv4->GetNetDevice (route.GetInterface ()))
+          || maskLength < longestMask)
+        {
+          continue;
+        }
+      if (maskLength > longestMask)
+        {
+          shortestMetric = 0xffffffff;
+        }
+      longestMask = maskLength;
+      if (metric > shortestMetric)
+        {
+          continue;
+        }
+      shortestMetric = metric;
+      found = i;
+      if (maskLength == 32)
+        {
+          break;
+        }
+    }
+  return found;
+}
+
+void
+Ipv4StaticRoutingLookupTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (node);
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  Ptr<NetDevice> devices[2];
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      node->AddDevice (device);
+      int32_t ifIndex = ipv4->AddInterface (device);
+      std::ostringstream address;
+      address << "192.168." << i + 1 << ".1";
+      ipv4->AddAddress (ifIndex, Ipv4InterfaceAddress (Ipv4Address (address.str ().c_str ()), Ipv4Mask ("/24")));
+      ipv4->SetUp (ifIndex);
+      devices[i] = device;
+    }
+  Ipv4StaticRoutingHelper ipv4RoutingHelper;
+  Ptr<Ipv4StaticRouting> routing = ipv4RoutingHelper.GetStaticRouting (ipv4);
+
+  // random routes within 10.0.0.0/12, each with its own gateway, some
+  // of them removed as others are added
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+  const uint32_t lengths[] = { 0, 8, 12, 14, 16, 16, 20, 24, 24, 28, 32, 32 };
+  uint32_t gateway = Ipv4Address ("172.16.0.0").Get ();
+  for (uint32_t round = 0; round < 20; round++)
+    {
+      for (uint32_t i = 0; i < 30; i++)
+        {
+          uint32_t length = lengths[rng->GetInteger (0, 11)];
+          Ipv4Mask mask (length == 0 ? 0 : 0xffffffff << (32 - length));
+          Ipv4Address network = Ipv4Address (0x0a000000 | rng->GetInteger (0, 0xfffff)).CombineMask (mask);
+          routing->AddNetworkRouteTo (network, mask, Ipv4Address (gateway++), rng->GetInteger (1, 2),
+                                      rng->GetInteger (0, 3));
+        }
+      for (uint32_t i = 0; i < 10; i++)
+        {
+          routing->RemoveRoute (rng->GetInteger (0, routing->GetNRoutes () - 1));
+        }
+      for (uint32_t i = 0; i < 100; i++)
+        {
+          Ipv4Header header;
+          header.SetDestination (Ipv4Address (0x0a000000 | rng->GetInteger (0, 0xfffff)));
+          Ptr<NetDevice> oif = rng->GetInteger (0, 2) == 0 ? devices[rng->GetInteger (0, 1)] : 0;
+          Socket::SocketErrno sockerr;
+          Ptr<Ipv4Route> route = routing->RouteOutput (Create<Packet> (), header, oif, sockerr);
+          uint32_t expected = LinearLookup (routing, ipv4, header.GetDestination (), oif);
+          if (expected == routing->GetNRoutes ())
+            {
+              NS_TEST_EXPECT_MSG_EQ (route, 0, "Route found to " << header.GetDestination ());
+            }
+          else
+            {
+              NS_TEST_ASSERT_MSG_NE (route, 0, "No route found to " << header.GetDestination ());
+              Ipv4RoutingTableEntry entry = routing->GetRoute (expected);
+              NS_TEST_EXPECT_MSG_EQ (route->GetGateway (), entry.GetGateway (),
+                                     "Wrong route to " << header.GetDestination ());
+              NS_TEST_EXPECT_MSG_EQ (route->GetOutputDevice (), ipv4->GetNetDevice (entry.GetInterface ()),
+                                     "Wrong device to " << header.GetDestination ());
+            }
+        }
+    }
+
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -217,6 +359,7 @@ Ipv4StaticRoutingTestSuite::Ipv4StaticRoutingTestSuite ()
   : TestSuite ("ipv4-static-routing", UNIT)
 {
   AddTestCase (new Ipv4StaticRoutingSlash32TestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4StaticRoutingLookupTestCase, TestCase::QUICK);
 }
 
 static Ipv4StaticRoutingTestSuite ipv4StaticRoutingTestSuite; //!< Static variable for test initialization
@@ -49,6 +49,8 @@ private:
   void TestTransmittedBlock ();
   /** \brief Test the generation of the "next" block */
   void TestNextSeg ();
+  /** \brief Test the lost segments of a large, sparsely SACKed window */
+  void TestLargeWindow ();
 };
 
 TcpTxBufferTestCase::TcpTxBufferTestCase ()
@@ -81,6 +83,8 @@ TcpTxBufferTestCase::DoRun ()
                        &TcpTxBufferTestCase::TestTransmittedBlock, this);
   Simulator::Schedule (Seconds (0.0),
                        &TcpTxBufferTestCase::TestNextSeg, this);
+  Simulator::Schedule (Seconds (0.0),
+                       &TcpTxBufferTestCase::TestLargeWindow, this);
 
   Simulator::Run ();
   Simulator::Destroy ();
@@ -267,6 +271,70 @@ TcpTxBufferTestCase::TestNextSeg ()
                          "Data inside the buffer");
 }
 
+void
+TcpTxBufferTestCase::TestLargeWindow ()
+{
+  TcpTxBuffer txBuf;
+  SequenceNumber32 head (1);
+  SequenceNumber32 ret;
+  uint32_t segmentSize = 100;
+  uint32_t segments = 2000;
+  txBuf.SetHeadSequence (head);
+  txBuf.SetSegmentSize (segmentSize);
+  txBuf.SetDupAckThresh (3);
+  txBuf.SetMaxBufferSize (segmentSize * (segments + 1));
+  Ptr<TcpOptionSack> sack = CreateObject<TcpOptionSack> ();
+
+  // Send a window of 2000 segments, and one more segment is left to send
+  txBuf.Add (Create<Packet> (segmentSize * (segments + 1)));
+  for (uint32_t i = 0; i < segments; ++i)
+    {
+      txBuf.CopyFromSequence (segmentSize, head + (segmentSize * i));
+    }
+
+  // Every tenth segment is lost, the others are SACKed one by one
+  for (uint32_t i = 0; i < segments; ++i)
+    {
+      if (i % 10 != 0)
+        {
+          SequenceNumber32 begin = head + (segmentSize * i);
+          sack->AddSackBlock (TcpOptionSack::SackBlock (begin, begin + segmentSize));
+          txBuf.Update (sack->GetSackList ());
+          sack->ClearSackList ();
+        }
+    }
+
+  // Each lost segment has more than dupThresh segments SACKed after it
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetLost (), segmentSize * segments / 10,
+                         "Different lost bytes than expected");
+  NS_TEST_ASSERT_MSG_EQ (txBuf.GetSacked (), segmentSize * segments / 10 * 9,
+                         "Different SACKed bytes than expected");
+  for (uint32_t i = 0; i < segments; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (txBuf.IsLost (head + (segmentSize * i)), (i % 10 == 0),
+                             "Different lost state than expected for segment " << i);
+    }
+
+  // NextSeg returns the lost segments in order, then the new data
+  for (uint32_t i = 0; i < segments; i += 10)
+    {
+      NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&ret, true), true,
+                             "No NextSeq with lost segments");
+      NS_TEST_ASSERT_MSG_EQ (ret, head + (segmentSize * i),
+                             "Different NextSeq than expected for lost segments");
+      txBuf.CopyFromSequence (segmentSize, ret);
+    }
+  NS_TEST_ASSERT_MSG_EQ (txBuf.NextSeg (&ret, true), true,
+                         "No NextSeq with new data");
+  NS_TEST_ASSERT_MSG_EQ (ret, head + (segmentSize * segments),
+                         "Different NextSeq than expected for new data");
+  txBuf.CopyFromSequence (segmentSize, ret);
+
+  txBuf.DiscardUpTo (ret + segmentSize);
+  NS_TEST_ASSERT_MSG_EQ (txBuf.Size (), 0,
+                         "Data inside the buffer");
+}
+
 void
 TcpTxBufferTestCase::TestNewBlock ()
 {
@@ -114,6 +114,7 @@ DistributedSimulatorImpl::DistributedSimulatorImpl ()
   m_uid = 4;
   // before ::Run is entered, the m_currentUid will be zero
   m_currentUid = 0;
+  m_eventCount = 0;
   m_currentTs = 0;
   m_currentContext = Simulator::NO_CONTEXT;
   m_unscheduledEvents = 0;
@@ -189,43 +190,38 @@ DistributedSimulatorImpl::CalculateLookAhead (void)
           for (uint32_t i = 0; i < (*iter)->GetNDevices (); ++i)
             {
               Ptr<NetDevice> localNetDevice = (*iter)->GetDevice (i);
-              // only works for p2p links currently
-              if (!localNetDevice->IsPointToPoint ())
-                {
-                  continue;
-                }
               Ptr<Channel> channel = localNetDevice->GetChannel ();
               if (channel == 0)
                 {
                   continue;
                 }
 
-              // grab the adjacent node
-              Ptr<Node> remoteNode;
-              if (channel->GetDevice (0) == localNetDevice)
-                {
-                  remoteNode = (channel->GetDevice (1))->GetNode ();
-                }
-              else
-                {
-                  remoteNode = (channel->GetDevice (0))->GetNode ();
-                }
-
-              // if it's not remote, don't consider it
-              if (remoteNode->GetSystemId () == MpiInterface::GetSystemId ())
+              // only links with a propagation delay (e.g., point-to-point
+              // or csma) may join different ranks
+              TimeValue delay;
+              if (!channel->GetAttributeFailSafe ("Delay", delay))
                 {
                   continue;
                 }
 
-              // compare delay on the channel with current value of
-              // m_lookAhead.  if delay on channel is smaller, make
-              // it the new lookAhead.
-              TimeValue delay;
-              channel->GetAttribute ("Delay", delay);
-
-              if (delay.Get () < m_lookAhead)
+              for (std::size_t j = 0; j < channel->GetNDevices (); ++j)
                 {
-                  m_lookAhead = delay.Get ();
+                  // grab the adjacent nodes
+                  Ptr<Node> remoteNode = channel->GetDevice (j)->GetNode ();
+
+                  // if it's not remote, don't consider it
+                  if (remoteNode->GetSystemId () == MpiInterface::GetSystemId ())
+                    {
+                      continue;
+                    }
+
+                  // compare delay on the channel with current value of
+                  // m_lookAhead.  if delay on channel is smaller, make
+                  // it the new lookAhead.
+                  if (delay.Get () < m_lookAhead)
+                    {
+                      m_lookAhead = delay.Get ();
+                    }
                 }
             }
         }
@@ -327,6 +323,7 @@ DistributedSimulatorImpl::ProcessOneEvent (void)
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
   m_currentUid = next.key.m_uid;
+  m_eventCount++;
   next.impl->Invoke ();
   next.impl->Unref ();
 }
@@ -644,4 +641,10 @@ DistributedSimulatorImpl::GetContext (void) const
   return m_currentContext;
 }
 
+uint64_t
+DistributedSimulatorImpl::GetEventCount (void) const
+{
+  return m_eventCount;
+}
+
 } // namespace ns3
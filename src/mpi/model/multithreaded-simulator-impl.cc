@@ -0,0 +1,852 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "multithreaded-simulator-impl.h"
+
+#include <ns3/simulator.h>
+#include <ns3/scheduler.h>
+#include <ns3/event-impl.h>
+#include <ns3/system-thread.h>
+#include <ns3/channel.h>
+#include <ns3/channel-list.h>
+#include <ns3/net-device.h>
+#include <ns3/node.h>
+#include <ns3/node-list.h>
+#include <ns3/uinteger.h>
+#include <ns3/boolean.h>
+#include <ns3/ptr.h>
+#include <ns3/assert.h>
+#include <ns3/log.h>
+
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+namespace ns3 {
+
+// Note:  Logging in this file is largely avoided due to the
+// number of calls that are made to these functions and the possibility
+// of causing recursions leading to stack overflow
+NS_LOG_COMPONENT_DEFINE ("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED (MultithreadedSimulatorImpl);
+
+namespace {
+
+/// Index of the LP run by the calling thread, if any
+thread_local uint32_t g_currentLp = std::numeric_limits<uint32_t>::max ();
+
+/// Timestamp of an LP without pending events
+const uint64_t NO_EVENT = std::numeric_limits<uint64_t>::max ();
+
+/**
+ * Find the representative of a node in a union-find forest.
+ *
+ * \param parent the parent of each node
+ * \param node the node
+ * \return the representative of the node
+ */
+uint32_t
+FindRoot (std::vector<uint32_t> &parent, uint32_t node)
+{
+  while (parent[node] != node)
+    {
+      parent[node] = parent[parent[node]];
+      node = parent[node];
+    }
+  return node;
+}
+
+} // unnamed namespace
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultithreadedSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .SetGroupName ("Mpi")
+    .AddConstructor<MultithreadedSimulatorImpl> ()
+    .AddAttribute ("MaxThreads",
+                   "The maximum number of threads running the logical processes, "
+                   "including the main thread (0 for the number of hardware threads, "
+                   "or 1 unless ns-3 is configured with --enable-mtp).",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&MultithreadedSimulatorImpl::m_maxThreads),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("WorkStealing",
+                   "Whether idle threads run the logical processes not run yet "
+                   "by the other threads in a window.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&MultithreadedSimulatorImpl::m_workStealing),
+                   MakeBooleanChecker ())
+    .AddAttribute ("Lookahead",
+                   "The minimum delay of the events scheduled by a logical process "
+                   "for another one (0 to use the smallest delay of the channels "
+                   "joining different logical processes).",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&MultithreadedSimulatorImpl::m_lookaheadAttribute),
+                   MakeTimeChecker ())
+  ;
+  return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl ()
+  : m_partitioned (false),
+    m_currentTs (0),
+    m_lookahead (NO_EVENT),
+    m_maxThreads (0),
+    m_workStealing (true),
+    m_stop (false),
+    m_nThreads (1),
+    m_windowEnd (0),
+    m_nextLp (0),
+    m_nextThread (0),
+    m_window (0),
+    m_nDone (0),
+    m_exit (false)
+{
+  NS_LOG_FUNCTION (this);
+  // the global LP
+  LogicalProcess *lp = new LogicalProcess;
+  lp->currentTs = 0;
+  // before ::Run is entered, the currentUid will be zero
+  lp->currentUid = 0;
+  lp->currentContext = Simulator::NO_CONTEXT;
+  // uids are allocated from 4.
+  // uid 0 is "invalid" events
+  // uid 1 is "now" events
+  // uid 2 is "destroy" events
+  lp->uid = 4;
+  lp->eventCount = 0;
+  lp->sent = 0;
+  lp->unscheduledEvents = 0;
+  lp->inbox = 0;
+  m_lps.push_back (lp);
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (std::vector<LogicalProcess *>::iterator i = m_lps.begin (); i != m_lps.end (); i++)
+    {
+      LogicalProcess *lp = *i;
+      ReceiveMessages (lp);
+      while (!lp->events->IsEmpty ())
+        {
+          Scheduler::Event next = lp->events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      lp->events = 0;
+      delete lp;
+    }
+  m_lps.clear ();
+  SimulatorImpl::DoDispose ();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  while (!m_destroyEvents.empty ())
+    {
+      Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
+      m_destroyEvents.pop_front ();
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  m_schedulerFactory = schedulerFactory;
+  for (std::vector<LogicalProcess *>::iterator i = m_lps.begin (); i != m_lps.end (); i++)
+    {
+      Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler> ();
+      if ((*i)->events != 0)
+        {
+          while (!(*i)->events->IsEmpty ())
+            {
+              scheduler->Insert ((*i)->events->RemoveNext ());
+            }
+        }
+      (*i)->events = scheduler;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetPartition (uint32_t nodeId, uint32_t partition)
+{
+  NS_LOG_FUNCTION (this << nodeId << partition);
+  NS_ASSERT_MSG (!m_partitioned, "The nodes have already been partitioned");
+  m_partitions[nodeId] = partition;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetNPartitions (void) const
+{
+  return m_lps.size () - 1;
+}
+
+Time
+MultithreadedSimulatorImpl::GetLookahead (void) const
+{
+  return TimeStep (m_lookahead);
+}
+
+void
+MultithreadedSimulatorImpl::Partition (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t nNodes = NodeList::GetNNodes ();
+  std::vector<uint32_t> parent (nNodes);
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      parent[i] = i;
+    }
+
+  // join the nodes of the channels which cannot separate partitions: only
+  // point-to-point links keep no medium state shared by their ends (e.g., a
+  // CSMA channel tracks the state of the medium for all of its devices)
+  TypeId pointToPoint;
+  bool havePointToPoint = TypeId::LookupByNameFailSafe ("ns3::PointToPointChannel", &pointToPoint);
+  std::vector<std::pair<Ptr<Channel>, uint64_t> > links;
+  for (ChannelList::Iterator i = ChannelList::Begin (); i != ChannelList::End (); i++)
+    {
+      Ptr<Channel> channel = *i;
+      TypeId tid = channel->GetInstanceTypeId ();
+      TimeValue delay;
+      if (havePointToPoint && (tid == pointToPoint || tid.IsChildOf (pointToPoint))
+          && channel->GetAttributeFailSafe ("Delay", delay) && delay.Get ().IsStrictlyPositive ())
+        {
+          links.push_back (std::make_pair (channel, delay.Get ().GetTimeStep ()));
+          continue;
+        }
+      uint32_t root = std::numeric_limits<uint32_t>::max ();
+      for (uint32_t j = 0; j < channel->GetNDevices (); j++)
+        {
+          Ptr<Node> node = channel->GetDevice (j)->GetNode ();
+          if (node == 0 || m_partitions.find (node->GetId ()) != m_partitions.end ())
+            {
+              continue;
+            }
+          uint32_t other = FindRoot (parent, node->GetId ());
+          if (root == std::numeric_limits<uint32_t>::max ())
+            {
+              root = other;
+            }
+          parent[other] = root;
+        }
+    }
+
+  // number the partitions in the order of their first node, the partitions
+  // set explicitly first
+  std::map<uint64_t, uint32_t> lpOfKey;
+  m_nodeLp.resize (nNodes);
+  for (uint32_t i = 0; i < nNodes; i++)
+    {
+      std::map<uint32_t, uint32_t>::const_iterator it = m_partitions.find (i);
+      uint64_t key = (it != m_partitions.end ()) ? it->second : (static_cast<uint64_t> (1) << 32) + FindRoot (parent, i);
+      std::map<uint64_t, uint32_t>::const_iterator lp = lpOfKey.find (key);
+      if (lp == lpOfKey.end ())
+        {
+          lp = lpOfKey.insert (std::make_pair (key, lpOfKey.size () + 1)).first;
+        }
+      m_nodeLp[i] = lp->second;
+    }
+
+  // the lookahead is the smallest delay of the links joining partitions
+  m_lookahead = NO_EVENT;
+  for (std::vector<std::pair<Ptr<Channel>, uint64_t> >::const_iterator i = links.begin (); i != links.end (); i++)
+    {
+      std::vector<uint32_t> lps;
+      for (uint32_t j = 0; j < i->first->GetNDevices (); j++)
+        {
+          Ptr<Node> node = i->first->GetDevice (j)->GetNode ();
+          if (node != 0)
+            {
+              lps.push_back (m_nodeLp[node->GetId ()]);
+            }
+        }
+      if (!lps.empty () && std::count (lps.begin (), lps.end (), lps.front ()) != static_cast<int> (lps.size ()))
+        {
+          m_lookahead = std::min (m_lookahead, i->second);
+        }
+    }
+  if (m_lookaheadAttribute.IsStrictlyPositive ())
+    {
+      m_lookahead = m_lookaheadAttribute.GetTimeStep ();
+    }
+
+  LogicalProcess *global = m_lps[0];
+  for (uint32_t i = 0; i < lpOfKey.size (); i++)
+    {
+      LogicalProcess *lp = new LogicalProcess;
+      lp->events = m_schedulerFactory.Create<Scheduler> ();
+      lp->currentTs = global->currentTs;
+      lp->currentUid = 0;
+      lp->currentContext = Simulator::NO_CONTEXT;
+      // the events already scheduled keep their uid
+      lp->uid = global->uid;
+      lp->eventCount = 0;
+      lp->sent = 0;
+      lp->unscheduledEvents = 0;
+      lp->inbox = 0;
+      m_lps.push_back (lp);
+    }
+  m_partitioned = true;
+
+  // move the events scheduled so far to their LP
+  std::vector<Scheduler::Event> globalEvents;
+  while (!global->events->IsEmpty ())
+    {
+      Scheduler::Event ev = global->events->RemoveNext ();
+      LogicalProcess *lp = GetLp (ev.key.m_context);
+      if (lp == global)
+        {
+          globalEvents.push_back (ev);
+          continue;
+        }
+      global->unscheduledEvents--;
+      lp->unscheduledEvents++;
+      lp->events->Insert (ev);
+    }
+  for (std::vector<Scheduler::Event>::const_iterator i = globalEvents.begin (); i != globalEvents.end (); i++)
+    {
+      global->events->Insert (*i);
+    }
+  NS_LOG_INFO (nNodes << " nodes in " << GetNPartitions () << " partitions, lookahead " << GetLookahead ());
+}
+
+MultithreadedSimulatorImpl::LogicalProcess *
+MultithreadedSimulatorImpl::GetLp (uint32_t context) const
+{
+  if (context < m_nodeLp.size ())
+    {
+      return m_lps[m_nodeLp[context]];
+    }
+  return m_lps[0];
+}
+
+MultithreadedSimulatorImpl::LogicalProcess *
+MultithreadedSimulatorImpl::GetCurrentLp (void) const
+{
+  if (g_currentLp < m_lps.size ())
+    {
+      return m_lps[g_currentLp];
+    }
+  return 0;
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetNextTs (const LogicalProcess *lp)
+{
+  if (lp->events->IsEmpty ())
+    {
+      return NO_EVENT;
+    }
+  return lp->events->PeekNext ().key.m_ts;
+}
+
+Scheduler::Event
+MultithreadedSimulatorImpl::Insert (LogicalProcess *lp, uint64_t ts, uint32_t context, EventImpl *event)
+{
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = ts;
+  ev.key.m_context = context;
+  ev.key.m_uid = lp->uid;
+  lp->uid++;
+  lp->unscheduledEvents++;
+  lp->events->Insert (ev);
+  return ev;
+}
+
+/**
+ * Order the messages received by an LP independently of the order in which
+ * they were sent by the threads.
+ *
+ * \param a a message
+ * \param b another message
+ * \return true if a must be merged before b
+ */
+template <typename MESSAGE>
+static bool
+MessageLess (const MESSAGE *a, const MESSAGE *b)
+{
+  if (a->ev.key.m_ts != b->ev.key.m_ts)
+    {
+      return a->ev.key.m_ts < b->ev.key.m_ts;
+    }
+  if (a->sender != b->sender)
+    {
+      return a->sender < b->sender;
+    }
+  return a->sequence < b->sequence;
+}
+
+void
+MultithreadedSimulatorImpl::ReceiveMessages (LogicalProcess *lp)
+{
+  Message *msg = lp->inbox.exchange (0, std::memory_order_acquire);
+  if (msg == 0)
+    {
+      return;
+    }
+  std::vector<Message *> messages;
+  for (; msg != 0; msg = msg->next)
+    {
+      messages.push_back (msg);
+    }
+  std::sort (messages.begin (), messages.end (), &MessageLess<Message>);
+  for (std::vector<Message *>::const_iterator i = messages.begin (); i != messages.end (); i++)
+    {
+      Insert (lp, (*i)->ev.key.m_ts, (*i)->ev.key.m_context, (*i)->ev.impl);
+      delete *i;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::ProcessOneEvent (LogicalProcess *lp)
+{
+  Scheduler::Event next = lp->events->RemoveNext ();
+
+  NS_ASSERT (next.key.m_ts >= lp->currentTs);
+  lp->unscheduledEvents--;
+
+  NS_LOG_LOGIC ("handle " << next.key.m_ts);
+  lp->currentTs = next.key.m_ts;
+  lp->currentContext = next.key.m_context;
+  lp->currentUid = next.key.m_uid;
+  lp->eventCount++;
+  next.impl->Invoke ();
+  next.impl->Unref ();
+}
+
+void
+MultithreadedSimulatorImpl::ProcessWindow (uint32_t thread)
+{
+  uint32_t nLps = m_lps.size ();
+  uint32_t step = m_nThreads;
+  uint32_t i = thread + 1;
+  if (m_workStealing)
+    {
+      i = m_nextLp++;
+      step = 0;
+    }
+  while (i < nLps)
+    {
+      LogicalProcess *lp = m_lps[i];
+      g_currentLp = i;
+      while (GetNextTs (lp) < m_windowEnd)
+        {
+          ProcessOneEvent (lp);
+        }
+      g_currentLp = std::numeric_limits<uint32_t>::max ();
+      i = (step == 0) ? m_nextLp++ : i + step;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Worker (void)
+{
+  uint32_t thread = m_nextThread++;
+  uint64_t window = 0;
+  while (true)
+    {
+      {
+        std::unique_lock<std::mutex> lock (m_mutex);
+        while (m_window == window)
+          {
+            m_windowStarted.wait (lock);
+          }
+        window = m_window;
+        if (m_exit)
+          {
+            return;
+          }
+      }
+      ProcessWindow (thread);
+      EndWindow ();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::EndWindow (void)
+{
+  std::unique_lock<std::mutex> lock (m_mutex);
+  if (++m_nDone == m_nThreads)
+    {
+      m_windowDone.notify_one ();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished (void) const
+{
+  if (m_stop)
+    {
+      return true;
+    }
+  for (std::vector<LogicalProcess *>::const_iterator i = m_lps.begin (); i != m_lps.end (); i++)
+    {
+      if (!(*i)->events->IsEmpty () || (*i)->inbox.load () != 0)
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+MultithreadedSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (GetCurrentLp () == 0, "Simulator::Run called from an event");
+  if (!m_partitioned)
+    {
+      Partition ();
+    }
+  m_stop = false;
+
+  uint32_t maxThreads = m_maxThreads;
+  if (maxThreads == 0)
+    {
+#ifdef NS3_MTP
+      maxThreads = std::max<uint32_t> (1, std::thread::hardware_concurrency ());
+#else
+      // packets are not safe to share between threads
+      maxThreads = 1;
+#endif
+    }
+  m_nThreads = std::max<uint32_t> (1, std::min<uint32_t> (maxThreads, GetNPartitions ()));
+#ifndef NS3_MTP
+  if (m_nThreads > 1)
+    {
+      NS_FATAL_ERROR ("Running " << GetNPartitions () << " logical processes on " << m_nThreads
+                      << " threads requires ns-3 to be configured with --enable-mtp");
+    }
+#endif
+  m_exit = false;
+  m_window = 0;
+  m_nextThread = 1;
+  for (uint32_t i = 1; i < m_nThreads; i++)
+    {
+      Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&MultithreadedSimulatorImpl::Worker, this));
+      thread->Start ();
+      m_threads.push_back (thread);
+    }
+
+  LogicalProcess *global = m_lps[0];
+  while (!m_stop)
+    {
+      uint64_t next = NO_EVENT;
+      for (uint32_t i = 1; i < m_lps.size (); i++)
+        {
+          ReceiveMessages (m_lps[i]);
+          next = std::min (next, GetNextTs (m_lps[i]));
+        }
+      ReceiveMessages (global);
+      uint64_t nextGlobal = GetNextTs (global);
+      if (next == NO_EVENT && nextGlobal == NO_EVENT)
+        {
+          break;
+        }
+      if (nextGlobal <= next)
+        {
+          // global events run alone
+          m_currentTs = nextGlobal;
+          g_currentLp = 0;
+          ProcessOneEvent (global);
+          g_currentLp = std::numeric_limits<uint32_t>::max ();
+          continue;
+        }
+      m_currentTs = next;
+      {
+        std::unique_lock<std::mutex> lock (m_mutex);
+        m_windowEnd = (m_lookahead >= NO_EVENT - next) ? NO_EVENT : next + m_lookahead;
+        m_windowEnd = std::min (m_windowEnd, nextGlobal);
+        m_nextLp = 1;
+        m_nDone = 0;
+        m_window++;
+      }
+      m_windowStarted.notify_all ();
+      ProcessWindow (0);
+      EndWindow ();
+      std::unique_lock<std::mutex> lock (m_mutex);
+      while (m_nDone < m_nThreads)
+        {
+          m_windowDone.wait (lock);
+        }
+    }
+
+  {
+    std::unique_lock<std::mutex> lock (m_mutex);
+    m_exit = true;
+    m_window++;
+  }
+  m_windowStarted.notify_all ();
+  for (std::vector<Ptr<SystemThread> >::iterator i = m_threads.begin (); i != m_threads.end (); i++)
+    {
+      (*i)->Join ();
+    }
+  m_threads.clear ();
+
+  for (std::vector<LogicalProcess *>::const_iterator i = m_lps.begin (); i != m_lps.end (); i++)
+    {
+      m_currentTs = std::max (m_currentTs, (*i)->currentTs);
+      // If the simulator stopped naturally by lack of events, make a
+      // consistency test to check that we didn't lose any events along the way.
+      NS_ASSERT (m_stop || (*i)->unscheduledEvents == 0);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_stop = true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop (Time const &delay)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep ());
+  Simulator::Schedule (delay, &Simulator::Stop);
+}
+
+EventId
+MultithreadedSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
+{
+  NS_ASSERT_MSG (delay.IsPositive (), "MultithreadedSimulatorImpl::Schedule(): Negative delay");
+  LogicalProcess *lp = GetCurrentLp ();
+  uint64_t ts;
+  uint32_t context;
+  if (lp == 0)
+    {
+      NS_ASSERT_MSG (m_threads.empty (), "Simulator::Schedule Thread-unsafe invocation!");
+      lp = m_lps[0];
+      ts = m_currentTs + delay.GetTimeStep ();
+      context = Simulator::NO_CONTEXT;
+    }
+  else
+    {
+      ts = lp->currentTs + delay.GetTimeStep ();
+      context = lp->currentContext;
+    }
+  Scheduler::Event ev = Insert (lp, ts, context, event);
+  return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << context << delay.GetTimeStep () << event);
+  LogicalProcess *from = GetCurrentLp ();
+  LogicalProcess *to = GetLp (context);
+  if (from == 0)
+    {
+      NS_ASSERT_MSG (m_threads.empty (), "Simulator::ScheduleWithContext Thread-unsafe invocation!");
+      Insert (to, m_currentTs + delay.GetTimeStep (), context, event);
+      return;
+    }
+  uint64_t ts = from->currentTs + delay.GetTimeStep ();
+  if (from == to || from == m_lps[0])
+    {
+      // global events run alone
+      Insert (to, ts, context, event);
+      return;
+    }
+  NS_ASSERT_MSG (to == m_lps[0] || ts >= m_windowEnd,
+                 "Event scheduled for another partition within the lookahead: "
+                 "delay " << delay << ", lookahead " << GetLookahead ());
+  if (ts < m_windowEnd)
+    {
+      // the global LP only runs between windows: its events scheduled
+      // within the window are delayed until the window ends
+      NS_LOG_WARN ("Event for context " << context << " delayed from " << TimeStep (ts)
+                   << " to the end of the window at " << TimeStep (m_windowEnd));
+      ts = m_windowEnd;
+    }
+  Message *msg = new Message;
+  msg->ev.impl = event;
+  msg->ev.key.m_ts = ts;
+  msg->ev.key.m_context = context;
+  msg->ev.key.m_uid = 0;
+  msg->sender = g_currentLp;
+  msg->sequence = from->sent++;
+  msg->next = to->inbox.load (std::memory_order_relaxed);
+  while (!to->inbox.compare_exchange_weak (msg->next, msg, std::memory_order_release, std::memory_order_relaxed))
+    {
+    }
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  return Schedule (Seconds (0), event);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  NS_ASSERT_MSG (m_threads.empty (), "Simulator::ScheduleDestroy Thread-unsafe invocation!");
+
+  EventId id (Ptr<EventImpl> (event, false), m_currentTs, 0xffffffff, 2);
+  m_destroyEvents.push_back (id);
+  return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now (void) const
+{
+  // Do not add function logging here, to avoid stack overflow
+  LogicalProcess *lp = GetCurrentLp ();
+  return TimeStep (lp != 0 ? lp->currentTs : m_currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  else
+    {
+      return TimeStep (id.GetTs ()) - Now ();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (IsExpired (id))
+    {
+      return;
+    }
+  LogicalProcess *lp = GetLp (id.GetContext ());
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  lp->events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+
+  lp->unscheduledEvents--;
+}
+
+void
+MultithreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired (const EventId &id) const
+{
+  if (id.GetUid () == 2)
+    {
+      if (id.PeekEventImpl () == 0 ||
+          id.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  LogicalProcess *lp = GetLp (id.GetContext ());
+  if (id.PeekEventImpl () == 0 ||
+      id.GetTs () < lp->currentTs ||
+      (id.GetTs () == lp->currentTs &&
+       id.GetUid () <= lp->currentUid) ||
+      id.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  else
+    {
+      return false;
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return TimeStep (0x7fffffffffffffffLL);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId (void) const
+{
+  return 0;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext (void) const
+{
+  LogicalProcess *lp = GetCurrentLp ();
+  return lp != 0 ? lp->currentContext : Simulator::NO_CONTEXT;
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetEventCount (void) const
+{
+  uint64_t count = 0;
+  for (std::vector<LogicalProcess *>::const_iterator i = m_lps.begin (); i != m_lps.end (); i++)
+    {
+      count += (*i)->eventCount;
+    }
+  return count;
+}
+
+} // namespace ns3
@@ -0,0 +1,241 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MULTITHREADED_SIMULATOR_IMPL_H
+#define MULTITHREADED_SIMULATOR_IMPL_H
+
+#include <ns3/simulator-impl.h>
+#include <ns3/scheduler.h>
+#include <ns3/event-impl.h>
+#include <ns3/object-factory.h>
+#include <ns3/nstime.h>
+#include <ns3/ptr.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <list>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace ns3 {
+
+class SystemThread;
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Conservative parallel simulator running logical processes on
+ * threads of a single process.
+ *
+ * The nodes are partitioned into logical processes (LPs), each with its own
+ * event list and clock. The LPs are run by a pool of threads in windows of
+ * simulation time: within a window, an LP only executes events that are
+ * earlier than the earliest pending event of all LPs plus the lookahead,
+ * i.e., the smallest delay of the links joining different LPs. Hence an
+ * event scheduled by an LP for another LP always falls after the current
+ * window. Such events are pushed to lock-free queues, one per receiving
+ * LP, and merged into the event list of the receiving LP between two
+ * windows, in a deterministic order.
+ *
+ * Unless the partitions are set explicitly with SetPartition(), the nodes
+ * joined by any channel but a point-to-point link with a positive delay
+ * (e.g., a CSMA or a wireless channel) are put in the same LP, since these
+ * channels keep the state of the medium shared by all of their devices.
+ * The lookahead is the smallest delay of the point-to-point links joining
+ * different LPs, unless set with the Lookahead attribute.
+ *
+ * Events without context, or with a context which is not the identifier of
+ * a node, belong to a global LP. Its events are executed alone, by the main
+ * thread, between windows, so that they may touch any node. Hence an event
+ * scheduled by an LP for the global LP earlier than the end of the current
+ * window is delayed until the end of the window (and a warning is logged).
+ *
+ * The LPs are assigned to threads dynamically in each window, so that idle
+ * threads steal the LPs not processed yet, unless the WorkStealing
+ * attribute is false, in which case each thread processes a fixed set of
+ * LPs.
+ *
+ * Channels joining different LPs must not share mutable state between
+ * their ends while packets are in flight, and the objects passed from an
+ * LP to another (e.g., packets) must be safe to use from different
+ * threads: running more than one thread requires to configure with
+ * --enable-mtp, which makes reference counts atomic.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  MultithreadedSimulatorImpl ();
+  ~MultithreadedSimulatorImpl ();
+
+  // virtual from SimulatorImpl
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (Time const &delay);
+  virtual EventId Schedule (Time const &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+  virtual uint64_t GetEventCount (void) const;
+
+  /**
+   * Put a node in the given partition, before the simulation starts.
+   * Nodes in the same partition are run by the same LP.
+   *
+   * \param nodeId the identifier of the node
+   * \param partition the partition of the node
+   */
+  void SetPartition (uint32_t nodeId, uint32_t partition);
+  /**
+   * \return the number of LPs running nodes, once the simulation started
+   */
+  uint32_t GetNPartitions (void) const;
+  /**
+   * \return the lookahead, once the simulation started
+   */
+  Time GetLookahead (void) const;
+
+private:
+  virtual void DoDispose (void);
+
+  /// An event sent by an LP to another one
+  struct Message
+  {
+    Message *next;          //!< next message in the queue
+    Scheduler::Event ev;    //!< the event, without uid
+    uint32_t sender;        //!< index of the sending LP
+    uint64_t sequence;      //!< sequence number of the message for the sending LP
+  };
+
+  /// A logical process
+  struct LogicalProcess
+  {
+    Ptr<Scheduler> events;          //!< the event list
+    uint64_t currentTs;             //!< timestamp of the current event
+    uint32_t currentUid;            //!< uid of the current event
+    uint32_t currentContext;        //!< context of the current event
+    uint32_t uid;                   //!< next event uid
+    uint64_t eventCount;            //!< number of events executed
+    uint64_t sent;                  //!< number of messages sent to other LPs
+    int unscheduledEvents;          //!< number of events in the event list
+    std::atomic<Message *> inbox;   //!< messages received from other LPs, last first
+  };
+
+  /**
+   * Partition the nodes into LPs, compute the lookahead and move the events
+   * scheduled so far to their LP.
+   */
+  void Partition (void);
+  /**
+   * \param context a context
+   * \return the LP running the events of the given context
+   */
+  LogicalProcess * GetLp (uint32_t context) const;
+  /**
+   * \return the LP run by the calling thread, if any
+   */
+  LogicalProcess * GetCurrentLp (void) const;
+  /**
+   * Insert an event in the event list of an LP.
+   *
+   * \param lp the LP
+   * \param ts the timestamp of the event
+   * \param context the context of the event
+   * \param event the event
+   * \return the scheduler event
+   */
+  Scheduler::Event Insert (LogicalProcess *lp, uint64_t ts, uint32_t context, EventImpl *event);
+  /**
+   * Merge the messages received by an LP into its event list.
+   *
+   * \param lp the LP
+   */
+  void ReceiveMessages (LogicalProcess *lp);
+  /**
+   * Execute the next event of an LP.
+   *
+   * \param lp the LP
+   */
+  void ProcessOneEvent (LogicalProcess *lp);
+  /**
+   * Execute the events of the LPs assigned to a thread in the current window.
+   *
+   * \param thread the index of the thread
+   */
+  void ProcessWindow (uint32_t thread);
+  /**
+   * The loop of the worker threads.
+   */
+  void Worker (void);
+  /**
+   * Count the calling thread as done with the current window.
+   */
+  void EndWindow (void);
+  /**
+   * \param lp an LP
+   * \return the timestamp of the next event of the LP
+   */
+  static uint64_t GetNextTs (const LogicalProcess *lp);
+
+  /// Container type for the events to run at Simulator::Destroy()
+  typedef std::list<EventId> DestroyEvents;
+
+  DestroyEvents m_destroyEvents;              //!< events to run at Simulator::Destroy()
+  ObjectFactory m_schedulerFactory;           //!< factory of the event lists
+  std::vector<LogicalProcess *> m_lps;        //!< the LPs, the global LP first
+  std::vector<uint32_t> m_nodeLp;             //!< index of the LP of each node
+  std::map<uint32_t, uint32_t> m_partitions;  //!< partitions set explicitly, per node
+  bool m_partitioned;                         //!< whether the nodes have been partitioned
+  uint64_t m_currentTs;                       //!< time of the last window, seen from outside the LPs
+  uint64_t m_lookahead;                       //!< the lookahead, in time steps
+  Time m_lookaheadAttribute;                  //!< the lookahead set by the user, if not zero
+  uint32_t m_maxThreads;                      //!< maximum number of threads
+  bool m_workStealing;                        //!< whether threads steal the LPs of other threads
+  std::atomic<bool> m_stop;                   //!< whether the simulation has been stopped
+
+  std::vector<Ptr<SystemThread> > m_threads;  //!< the worker threads, besides the main thread
+  uint32_t m_nThreads;                        //!< number of threads, including the main thread
+  uint64_t m_windowEnd;                       //!< end of the current window
+  std::atomic<uint32_t> m_nextLp;             //!< next LP to process, when stealing work
+  std::atomic<uint32_t> m_nextThread;         //!< index of the next worker thread to start
+  std::mutex m_mutex;                         //!< mutex protecting the window state below
+  std::condition_variable m_windowStarted;    //!< signaled when a window starts
+  std::condition_variable m_windowDone;       //!< signaled when all the threads are done with the window
+  uint64_t m_window;                          //!< number of windows started
+  uint32_t m_nDone;                           //!< number of threads done with the current window
+  bool m_exit;                                //!< whether the worker threads must exit
+};
+
+} // namespace ns3
+
+#endif /* MULTITHREADED_SIMULATOR_IMPL_H */
@@ -81,6 +81,7 @@ NullMessageSimulatorImpl::NullMessageSimulatorImpl ()
   m_uid = 4;
   // before ::Run is entered, the m_currentUid will be zero
   m_currentUid = 0;
+  m_eventCount = 0;
   m_currentTs = 0;
   m_currentContext = Simulator::NO_CONTEXT;
   m_unscheduledEvents = 0;
@@ -157,46 +158,42 @@ NullMessageSimulatorImpl::CalculateLookAhead (void)
           for (uint32_t i = 0; i < (*iter)->GetNDevices (); ++i)
             {
               Ptr<NetDevice> localNetDevice = (*iter)->GetDevice (i);
-              // only works for p2p links currently
-              if (!localNetDevice->IsPointToPoint ())
-                {
-                  continue;
-                }
               Ptr<Channel> channel = localNetDevice->GetChannel ();
               if (channel == 0)
                 {
                   continue;
                 }
 
-              // grab the adjacent node
-              Ptr<Node> remoteNode;
-              if (channel->GetDevice (0) == localNetDevice)
-                {
-                  remoteNode = (channel->GetDevice (1))->GetNode ();
-                }
-              else
-                {
-                  remoteNode = (channel->GetDevice (0))->GetNode ();
-                }
-
-              // if it's not remote, don't consider it
-              if (remoteNode->GetSystemId () == MpiInterface::GetSystemId ())
+              // only links with a propagation delay (e.g., point-to-point
+              // or csma) may join different ranks
+              TimeValue delay;
+              if (!channel->GetAttributeFailSafe ("Delay", delay))
                 {
                   continue;
                 }
 
-              /**
-               * Add this channel to the remote channel bundle from this task to MPI task on other side of the channel.
-               */
-              Ptr<RemoteChannelBundle> remoteChannelBundle = RemoteChannelBundleManager::Find (remoteNode->GetSystemId ());
-              if (!remoteChannelBundle)
+              for (std::size_t j = 0; j < channel->GetNDevices (); ++j)
                 {
-                  remoteChannelBundle = RemoteChannelBundleManager::Add (remoteNode->GetSystemId ());
+                  // grab the adjacent nodes
+                  Ptr<Node> remoteNode = channel->GetDevice (j)->GetNode ();
+
+                  // if it's not remote, don't consider it
+                  if (remoteNode->GetSystemId () == MpiInterface::GetSystemId ())
+                    {
+                      continue;
+                    }
+
+                  /**
+                   * Add this channel to the remote channel bundle from this task to MPI task on other side of the channel.
+                   */
+                  Ptr<RemoteChannelBundle> remoteChannelBundle = RemoteChannelBundleManager::Find (remoteNode->GetSystemId ());
+                  if (!remoteChannelBundle)
+                    {
+                      remoteChannelBundle = RemoteChannelBundleManager::Add (remoteNode->GetSystemId ());
+                    }
+
+                  remoteChannelBundle->AddChannel (channel, delay.Get ());
                 }
-
-              TimeValue delay;
-              channel->GetAttribute ("Delay", delay);
-              remoteChannelBundle->AddChannel (channel, delay.Get () );
             }
         }
     }
@@ -240,6 +237,7 @@ NullMessageSimulatorImpl::ProcessOneEvent (void)
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
   m_currentUid = next.key.m_uid;
+  m_eventCount++;
   next.impl->Invoke ();
   next.impl->Unref ();
 }
@@ -575,6 +573,12 @@ NullMessageSimulatorImpl::GetContext (void) const
   return m_currentContext;
 }
 
+uint64_t
+NullMessageSimulatorImpl::GetEventCount (void) const
+{
+  return m_eventCount;
+}
+
 Time NullMessageSimulatorImpl::CalculateGuaranteeTime (uint32_t nodeSysId)
 {
   Ptr<RemoteChannelBundle> bundle = RemoteChannelBundleManager::Find (nodeSysId);
@@ -50,7 +50,11 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("Buffer");
 
 
+#ifdef NS3_MTP
+thread_local uint32_t Buffer::g_recommendedStart = 0;
+#else
 uint32_t Buffer::g_recommendedStart = 0;
+#endif
 #ifdef BUFFER_FREE_LIST
 /* The following macros are pretty evil but they are needed to allow us to
  * keep track of 3 possible states for the g_freeList variable:
@@ -186,18 +190,21 @@ Buffer::Deallocate (struct Buffer::Data *data)
 }
 
 Buffer::Buffer ()
+  : m_fragments (0)
 {
   NS_LOG_FUNCTION (this);
   Initialize (0);
 }
 
 Buffer::Buffer (uint32_t dataSize)
+  : m_fragments (0)
 {
   NS_LOG_FUNCTION (this << dataSize);
   Initialize (dataSize);
 }
 
 Buffer::Buffer (uint32_t dataSize, bool initialize)
+  : m_fragments (0)
 {
   NS_LOG_FUNCTION (this << dataSize << initialize);
   if (initialize == true)
@@ -245,6 +252,9 @@ Buffer::Initialize (uint32_t zeroSize)
 {
   NS_LOG_FUNCTION (this << zeroSize);
   m_data = Buffer::Create (0);
+  // Deserialize may reuse a Buffer that still holds fragments
+  delete m_fragments;
+  m_fragments = 0;
   m_start = std::min (m_data->m_size, g_recommendedStart);
   m_maxZeroAreaStart = m_start;
   m_zeroAreaStart = m_start;
@@ -259,11 +269,16 @@ Buffer &
 Buffer::operator = (Buffer const&o)
 {
   NS_ASSERT (CheckInternalState ());
+  o.Flatten ();
+  if (m_fragments != 0)
+    {
+      delete m_fragments;
+      m_fragments = 0;
+    }
   if (m_data != o.m_data) 
     {
       // not assignment to self.
-      m_data->m_count--;
-      if (m_data->m_count == 0) 
+      if (--m_data->m_count == 0) 
         {
           Recycle (m_data);
         }
@@ -285,8 +300,8 @@ Buffer::~Buffer ()
   NS_LOG_FUNCTION (this);
   NS_ASSERT (CheckInternalState ());
   g_recommendedStart = std::max (g_recommendedStart, m_maxZeroAreaStart);
-  m_data->m_count--;
-  if (m_data->m_count == 0) 
+  delete m_fragments;
+  if (--m_data->m_count == 0) 
     {
       Recycle (m_data);
     }
@@ -310,7 +325,14 @@ Buffer::AddAtStart (uint32_t start)
 {
   NS_LOG_FUNCTION (this << start);
   NS_ASSERT (CheckInternalState ());
+#ifdef NS3_MTP
+  // the buffers sharing the data may belong to other threads, which may
+  // check and move the dirty area concurrently: only write in place when
+  // the data is not shared
+  bool isDirty = m_data->m_count > 1;
+#else
   bool isDirty = m_data->m_count > 1 && m_start > m_data->m_dirtyStart;
+#endif
   if (m_start >= start && !isDirty)
     {
       /* enough space in the buffer and not dirty. 
@@ -328,8 +350,7 @@ Buffer::AddAtStart (uint32_t start)
       uint32_t newSize = GetInternalSize () + start;
       struct Buffer::Data *newData = Buffer::Create (newSize);
       memcpy (newData->m_data + start, m_data->m_data + m_start, GetInternalSize ());
-      m_data->m_count--;
-      if (m_data->m_count == 0)
+      if (--m_data->m_count == 0)
         {
           Buffer::Recycle (m_data);
         }
@@ -355,7 +376,13 @@ Buffer::AddAtEnd (uint32_t end)
 {
   NS_LOG_FUNCTION (this << end);
   NS_ASSERT (CheckInternalState ());
+  Flatten ();
+#ifdef NS3_MTP
+  // see AddAtStart
+  bool isDirty = m_data->m_count > 1;
+#else
   bool isDirty = m_data->m_count > 1 && m_end < m_data->m_dirtyEnd;
+#endif
   if (GetInternalEnd () + end <= m_data->m_size && !isDirty)
     {
       /* enough space in buffer and not dirty
@@ -373,8 +400,7 @@ Buffer::AddAtEnd (uint32_t end)
       uint32_t newSize = GetInternalSize () + end;
       struct Buffer::Data *newData = Buffer::Create (newSize);
       memcpy (newData->m_data, m_data->m_data + m_start, GetInternalSize ());
-      m_data->m_count--;
-      if (m_data->m_count == 0) 
+      if (--m_data->m_count == 0) 
         {
           Buffer::Recycle (m_data);
         }
@@ -400,7 +426,13 @@ void
 Buffer::AddAtEnd (const Buffer &o)
 {
   NS_LOG_FUNCTION (this << &o);
-  if (m_data->m_count == 1 &&
+  o.Flatten ();
+  if (o.GetSize () == 0)
+    {
+      return;
+    }
+  if (m_fragments == 0 &&
+      m_data->m_count == 1 &&
       m_end == m_zeroAreaEnd &&
       m_end == m_data->m_dirtyEnd &&
       o.m_start == o.m_zeroAreaStart &&
@@ -426,6 +458,36 @@ Buffer::AddAtEnd (const Buffer &o)
       return;
     }
 
+#ifndef NS3_MTP
+  // The fragments are flattened by the first operation needing
+  // contiguous bytes, including copies from a const Buffer, hence not
+  // with parallel simulations, where packets may be shared by threads.
+  bool isDirty = m_data->m_count > 1 && m_end < m_data->m_dirtyEnd;
+  if (m_fragments != 0 ||
+      m_zeroAreaEnd != m_zeroAreaStart ||
+      m_data == o.m_data ||
+      isDirty ||
+      GetInternalEnd () + o.GetSize () > m_data->m_size)
+    {
+      if (m_fragments == 0 && GetSize () == 0)
+        {
+          /* share the bytes of o */
+          *this = o;
+          return;
+        }
+      /* append o by reference rather than reallocating */
+      if (m_fragments == 0)
+        {
+          m_fragments = new Fragments ();
+          m_fragments->size = 0;
+        }
+      m_fragments->buffers.push_back (o);
+      m_fragments->size += o.GetSize ();
+      NS_ASSERT (CheckInternalState ());
+      return;
+    }
+#endif /* NS3_MTP */
+
   *this = CreateFullCopy ();
   AddAtEnd (o.GetSize ());
   Buffer::Iterator destStart = End ();
@@ -434,11 +496,50 @@ Buffer::AddAtEnd (const Buffer &o)
   NS_ASSERT (CheckInternalState ());
 }
 
+void
+Buffer::DoFlatten (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_fragments != 0);
+  Buffer *self = const_cast<Buffer *> (this);
+  // The zero area of the first fragment is kept, such that the synthetic
+  // payload of a packet stays virtual when bytes are added after it.
+  uint32_t size = GetSize ();
+  uint32_t zeroStart = m_zeroAreaStart - m_start;
+  uint32_t zeroSize = m_zeroAreaEnd - m_zeroAreaStart;
+  uint32_t endData = m_end - m_zeroAreaEnd;
+  struct Buffer::Data *data = Buffer::Create (size - zeroSize);
+  memcpy (data->m_data, m_data->m_data + m_start, zeroStart);
+  memcpy (data->m_data + zeroStart, m_data->m_data + m_zeroAreaStart, endData);
+  uint8_t *buffer = data->m_data + zeroStart + endData;
+  for (std::vector<Buffer>::const_iterator i = m_fragments->buffers.begin ();
+       i != m_fragments->buffers.end (); ++i)
+    {
+      buffer += i->CopyData (buffer, i->GetSize ());
+    }
+  delete m_fragments;
+  self->m_fragments = 0;
+  if (--m_data->m_count == 0)
+    {
+      Buffer::Recycle (m_data);
+    }
+  self->m_data = data;
+  self->m_start = 0;
+  self->m_zeroAreaStart = zeroStart;
+  self->m_zeroAreaEnd = zeroStart + zeroSize;
+  self->m_end = size;
+  data->m_dirtyStart = 0;
+  data->m_dirtyEnd = size;
+  LOG_INTERNAL_STATE ("flatten ");
+  NS_ASSERT (CheckInternalState ());
+}
+
 void 
 Buffer::RemoveAtStart (uint32_t start)
 {
   NS_LOG_FUNCTION (this << start);
   NS_ASSERT (CheckInternalState ());
+  Flatten ();
   uint32_t newStart = m_start + start;
   if (newStart <= m_zeroAreaStart)
     {
@@ -484,6 +585,7 @@ Buffer::RemoveAtEnd (uint32_t end)
 {
   NS_LOG_FUNCTION (this << end);
   NS_ASSERT (CheckInternalState ());
+  Flatten ();
   uint32_t newEnd = m_end - std::min (end, m_end - m_start);
   if (newEnd > m_zeroAreaEnd)
     {
@@ -532,6 +634,7 @@ Buffer::CreateFullCopy (void) const
 {
   NS_LOG_FUNCTION (this);
   NS_ASSERT (CheckInternalState ());
+  Flatten ();
   if (m_zeroAreaEnd - m_zeroAreaStart != 0) 
     {
       Buffer tmp;
@@ -556,6 +659,7 @@ uint32_t
 Buffer::GetSerializedSize (void) const
 {
   NS_LOG_FUNCTION (this);
+  Flatten ();
   uint32_t dataStart = (m_zeroAreaStart - m_start + 3) & (~0x3);
   uint32_t dataEnd = (m_end - m_zeroAreaEnd + 3) & (~0x3);
 
@@ -576,6 +680,7 @@ uint32_t
 Buffer::Serialize (uint8_t* buffer, uint32_t maxSize) const
 {
   NS_LOG_FUNCTION (this << &buffer << maxSize);
+  Flatten ();
   uint32_t* p = reinterpret_cast<uint32_t *> (buffer);
   uint32_t size = 0;
 
@@ -738,6 +843,35 @@ Buffer::CopyData (std::ostream *os, uint32_t size) const
             }
         }
     }
+  if (m_fragments != 0 && size > m_end - m_start)
+    {
+      size -= m_end - m_start;
+      for (std::vector<Buffer>::const_iterator i = m_fragments->buffers.begin ();
+           i != m_fragments->buffers.end () && size > 0; ++i)
+        {
+          uint32_t tmpsize = std::min (i->GetSize (), size);
+          i->CopyData (os, tmpsize);
+          size -= tmpsize;
+        }
+    }
+}
+
+uint32_t
+Buffer::GetSyntheticPayloadOffset (void) const
+{
+  NS_LOG_FUNCTION (this);
+  if (m_zeroAreaEnd == m_zeroAreaStart)
+    {
+      return GetSize ();
+    }
+  return m_zeroAreaStart - m_start;
+}
+
+uint32_t
+Buffer::GetSyntheticPayloadSize (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_zeroAreaEnd - m_zeroAreaStart;
 }
 
 uint32_t 
@@ -754,23 +888,28 @@ Buffer::CopyData (uint8_t *buffer, uint32_t size) const
       if (size > 0) 
         { 
           tmpsize = std::min (m_zeroAreaEnd - m_zeroAreaStart, size);
-          uint32_t left = tmpsize;
-          while (left > 0)
-            {
-              uint32_t toWrite = std::min (left, g_zeroes.size);
-              memcpy (buffer, g_zeroes.buffer, toWrite);
-              left -= toWrite;
-              buffer += toWrite;
-            }
+          memset (buffer, 0, tmpsize);
+          buffer += tmpsize;
           size -= tmpsize;
           if (size > 0)
             {
               tmpsize = std::min (m_end - m_zeroAreaEnd, size);
               memcpy (buffer, (const char*)(m_data->m_data + m_zeroAreaStart), tmpsize);
+              buffer += tmpsize;
               size -= tmpsize;
             }
         }
     }
+  if (m_fragments != 0)
+    {
+      for (std::vector<Buffer>::const_iterator i = m_fragments->buffers.begin ();
+           i != m_fragments->buffers.end () && size > 0; ++i)
+        {
+          uint32_t tmpsize = i->CopyData (buffer, size);
+          buffer += tmpsize;
+          size -= tmpsize;
+        }
+    }
   return originalSize - size;
 }
 
@@ -843,25 +982,36 @@ Buffer::Iterator::Write (Iterator start, Iterator end)
   uint32_t size = end.m_current - start.m_current;
   NS_ASSERT_MSG (CheckNoZero (m_current, m_current + size),
                  GetWriteErrorMessage ());
+  // the destination may be after the zero area of this buffer too
+  uint8_t *to;
+  if (m_current <= m_zeroStart)
+    {
+      to = &m_data[m_current];
+    }
+  else
+    {
+      to = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
+    }
   if (start.m_current <= start.m_zeroStart)
     {
       uint32_t toCopy = std::min (size, start.m_zeroStart - start.m_current);
-      memcpy (&m_data[m_current], &start.m_data[start.m_current], toCopy);
+      memcpy (to, &start.m_data[start.m_current], toCopy);
       start.m_current += toCopy;
       m_current += toCopy;
+      to += toCopy;
       size -= toCopy;
     }
   if (start.m_current <= start.m_zeroEnd)
     {
       uint32_t toCopy = std::min (size, start.m_zeroEnd - start.m_current);
-      memset (&m_data[m_current], 0, toCopy);
+      memset (to, 0, toCopy);
       start.m_current += toCopy;
       m_current += toCopy;
+      to += toCopy;
       size -= toCopy;
     }
   uint32_t toCopy = std::min (size, start.m_dataEnd - start.m_current);
   uint8_t *from = &start.m_data[start.m_current - (start.m_zeroEnd-start.m_zeroStart)];
-  uint8_t *to = &m_data[m_current];
   memcpy (to, from, toCopy);
   m_current += toCopy;
 }
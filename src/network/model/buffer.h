@@ -24,8 +24,15 @@
 #include <vector>
 #include <ostream>
 #include "ns3/assert.h"
+#ifdef NS3_MTP
+#include <atomic>
+#endif
 
+// the free list is shared by all the buffers, hence it is disabled when
+// buffers may be created by several threads
+#ifndef NS3_MTP
 #define BUFFER_FREE_LIST 1
+#endif
 
 namespace ns3 {
 
@@ -88,6 +95,17 @@ namespace ns3 {
  * \endverbatim
  *
  * A simple state invariant is that m_start <= m_zeroStart <= m_zeroEnd <= m_end
+ *
+ * A Buffer may also hold a list of fragments: other Buffer instances
+ * appended by reference with AddAtEnd (const Buffer &) when copying
+ * them into the byte buffer would reallocate it. This makes the
+ * aggregation of many small buffers, such as the subframes of an
+ * A-MSDU or an A-MPDU, linear in the number of bytes copied. The
+ * fragments are copied, once, into a single byte buffer as soon
+ * as contiguous bytes are needed: by Begin, End, PeekData, a copy
+ * of the Buffer or any operation other than GetSize, AddAtStart,
+ * AddAtEnd (const Buffer &) and CopyData, which work across the
+ * fragments.
  */
 class Buffer 
 {
@@ -489,6 +507,23 @@ private:
    */
   inline uint32_t GetSize (void) const;
 
+  /**
+   * \brief Get the offset of the synthetic payload of the buffer.
+   *
+   * The synthetic payload is the zero-filled area of a buffer created
+   * with Buffer (uint32_t), which is not stored in memory.  With
+   * fragments, this is the payload of the first fragment.
+   *
+   * \return the offset of the synthetic payload from the start of the
+   * buffer, or the size of the buffer if it has none.
+   */
+  uint32_t GetSyntheticPayloadOffset (void) const;
+  /**
+   * \return the size of the synthetic payload of the buffer, zero if it
+   * has none.
+   */
+  uint32_t GetSyntheticPayloadSize (void) const;
+
   /**
    * \return a pointer to the start of the internal 
    * byte buffer.
@@ -524,7 +559,9 @@ private:
   /**
    * \param o the buffer to append to the end of this buffer.
    *
-   * Add bytes at the end of the Buffer.
+   * Add bytes at the end of the Buffer. If they do not fit in the
+   * byte buffer of this Buffer, o is appended by reference, as a
+   * fragment, instead of reallocating the byte buffer.
    * Any call to this method invalidates any Iterator
    * pointing to this Buffer.
    */
@@ -663,7 +700,11 @@ private:
      * The reference count of an instance of this data structure.
      * Each buffer which references an instance holds a count.
      */
+#ifdef NS3_MTP
+    std::atomic<uint32_t> m_count;
+#else
     uint32_t m_count;
+#endif
     /**
      * the size of the m_data field below.
      */
@@ -697,6 +738,16 @@ private:
    * \brief Transform a "Virtual byte buffer" into a "Real byte buffer"
    */
   void TransformIntoRealBuffer (void) const;
+  /**
+   * \brief Copy the fragments appended by reference, if any, into a
+   * single byte buffer, with the bytes of this Buffer.
+   */
+  inline void Flatten (void) const;
+  /**
+   * \brief Copy the fragments appended by reference into a single
+   * byte buffer, with the bytes of this Buffer.
+   */
+  void DoFlatten (void) const;
   /**
    * \brief Checks the internal buffer structures consistency
    *
@@ -765,9 +816,14 @@ private:
   /**
    * location in a newly-allocated buffer where you should start
    * writing data. i.e., m_start should be initialized to this 
-   * value.
+   * value. It is updated by every buffer destroyed, hence kept per
+   * thread when buffers may be used by several threads.
    */
+#ifdef NS3_MTP
+  static thread_local uint32_t g_recommendedStart;
+#else
   static uint32_t g_recommendedStart;
+#endif
 
   /**
    * offset to the start of the virtual zero area from the start
@@ -790,6 +846,21 @@ private:
    */
   uint32_t m_end;
 
+  /**
+   * The Buffer instances appended by reference after the bytes of
+   * m_data, none of which has fragments itself.
+   */
+  struct Fragments
+  {
+    std::vector<Buffer> buffers; //!< the fragments, in order
+    uint32_t size;               //!< the total size of the fragments
+  };
+  /**
+   * the fragments appended by reference, or zero if all the bytes
+   * are in m_data.
+   */
+  struct Fragments *m_fragments;
+
 #ifdef BUFFER_FREE_LIST
   /// Container for buffer data
   typedef std::vector<struct Buffer::Data*> FreeList;
@@ -1047,14 +1118,25 @@ Buffer::Iterator::Read (Buffer::Iterator start, uint32_t size)
 }
 
 
+void
+Buffer::Flatten (void) const
+{
+  if (m_fragments != 0)
+    {
+      DoFlatten ();
+    }
+}
+
 Buffer::Buffer (Buffer const&o)
-  : m_data (o.m_data),
-    m_maxZeroAreaStart (o.m_zeroAreaStart),
-    m_zeroAreaStart (o.m_zeroAreaStart),
-    m_zeroAreaEnd (o.m_zeroAreaEnd),
-    m_start (o.m_start),
-    m_end (o.m_end)
+  : m_fragments (0)
 {
+  o.Flatten ();
+  m_data = o.m_data;
+  m_maxZeroAreaStart = o.m_zeroAreaStart;
+  m_zeroAreaStart = o.m_zeroAreaStart;
+  m_zeroAreaEnd = o.m_zeroAreaEnd;
+  m_start = o.m_start;
+  m_end = o.m_end;
   m_data->m_count++;
   NS_ASSERT (CheckInternalState ());
 }
@@ -1062,6 +1144,10 @@ Buffer::Buffer (Buffer const&o)
 uint32_t 
 Buffer::GetSize (void) const
 {
+  if (m_fragments != 0)
+    {
+      return m_end - m_start + m_fragments->size;
+    }
   return m_end - m_start;
 }
 
@@ -1069,12 +1155,14 @@ Buffer::Iterator
 Buffer::Begin (void) const
 {
   NS_ASSERT (CheckInternalState ());
+  Flatten ();
   return Buffer::Iterator (this);
 }
 Buffer::Iterator 
 Buffer::End (void) const
 {
   NS_ASSERT (CheckInternalState ());
+  Flatten ();
   return Buffer::Iterator (this, false);
 }
 
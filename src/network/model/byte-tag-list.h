@@ -45,9 +45,13 @@ struct ByteTagListData;
  *     as 4 32bit integers (TypeId, tag data size, start, end) followed 
  *     by the tag data as generated by Tag::Serialize.
  *
- *   - The struct ByteTagListData structure which contains the tag byte buffer
- *     is shared and, thus, reference-counted. This data structure is unshared
- *     as-needed to emulate COW semantics.
+ *   - While the tags fit in #INLINE_SIZE bytes, the byte buffer is stored
+ *     in the list itself, and copied with it, so that the few byte tags most
+ *     packets carry do not allocate.
+ *
+ *   - Beyond, the struct ByteTagListData structure which contains the tag
+ *     byte buffer is shared and, thus, reference-counted. This data structure
+ *     is unshared as-needed to emulate COW semantics.
  *
  *   - Each tag tags a unique set of bytes identified by the pair of offsets
  *     (start,end). These offsets are relative to the start of the packet
@@ -63,6 +67,12 @@ struct ByteTagListData;
 class ByteTagList
 {
 public:
+  /**
+   * Number of bytes of tags, including their offsets, stored in the list
+   * itself.
+   */
+  static const uint32_t INLINE_SIZE = 40;
+
   /**
    * \brief An iterator for iterating through a byte tag list
    *
@@ -256,7 +266,8 @@ private:
   int32_t m_maxEnd; //!< maximal end offset
   int32_t m_adjustment; //!< adjustment to byte tag offsets
   uint32_t m_used; //!< the number of used bytes in the buffer
-  struct ByteTagListData *m_data; //!< the ByteTagListData structure
+  struct ByteTagListData *m_data; //!< the ByteTagListData structure, 0 if inline
+  uint8_t m_inline[INLINE_SIZE]; //!< the byte buffer, while it fits inline
 };
 
 void
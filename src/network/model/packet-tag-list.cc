@@ -20,7 +20,8 @@
 
 /**
 \file   packet-tag-list.cc
-\brief  Implements a linked list of Packet tags, including copy-on-write semantics.
+\brief  Implements a list of Packet tags, stored inline in the packet while small,
+        with copy-on-write semantics beyond.
 */
 
 #include "packet-tag-list.h"
@@ -28,232 +29,148 @@
 #include "tag.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
-#include <cstring>
+#include <algorithm>
+#include <limits>
+#include <new>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("PacketTagList");
 
-PacketTagList::TagData *
-PacketTagList::CreateTagData (size_t dataSize)
+uint32_t
+PacketTagList::GetRecordSize (uint32_t size)
 {
-  NS_ASSERT_MSG (dataSize
-                 < std::numeric_limits<decltype(TagData::size)>::max (),
-                 "Requested TagData size " << dataSize
-                 << " exceeds maximum "
-                 << std::numeric_limits<decltype(TagData::size)>::max () );
-
-  void * p = std::malloc (sizeof (TagData) + dataSize - 1);
-  // The matching frees are in RemoveAll and RemoveWriter
-
-  TagData * tag = new (p) TagData;
-  tag->size = dataSize;
-  return tag;
+  NS_ASSERT_MSG (size < std::numeric_limits<uint32_t>::max () - sizeof (TagData) - 3,
+                 "Requested TagData size " << size << " exceeds maximum");
+  return sizeof (TagData) + ((size + 3) & ~3U);
 }
 
-bool
-PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
+PacketTagList::SpillData *
+PacketTagList::Allocate (uint32_t size)
 {
-  TypeId tid = tag.GetInstanceTypeId ();
-  NS_LOG_FUNCTION (this << tid);
-  NS_LOG_INFO     ("looking for " << tid);
-
-  // trivial case when list is empty
-  if (m_next == 0)
-    {
-      return false;
-    }
-
-  bool found = false;
-
-  struct TagData ** prevNext = &m_next; // previous node's next pointer
-  struct TagData  * cur      =  m_next; // cursor to current node
-  struct TagData  * it = 0;             // utility
+  // The matching delete is in Deallocate
+  uint8_t *buffer = new uint8_t [sizeof (SpillData) - sizeof (uint32_t) + size];
+  SpillData *data = new (buffer) SpillData;
+  data->count = 1;
+  data->size = size;
+  return data;
+}
 
-  // Search from the head of the list until we find tid or a merge
-  while (cur != 0)
+void
+PacketTagList::Reserve (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  NS_ASSERT (size >= m_used);
+  if (m_spill == 0)
     {
-      if (cur->count > 1)
-        {
-          // found merge
-          NS_LOG_INFO ("found initial merge before tid");
-          break;
-        }
-      else if (cur->tid == tid)
+      if (size <= INLINE_SIZE)
         {
-          NS_LOG_INFO ("found tid before initial merge, calling writer");
-          found = (this->*Writer)(tag, true, cur, prevNext);
-          break;
+          return;
         }
-      else
-        {
-          // no merge or tid found yet, move on
-          prevNext = &cur->next;
-          cur      =  cur->next;
-        }
-    }  // while !found && !cow
-
-  // did we find it or run out of tags?
-  if (cur == 0 || found)
-    {
-      NS_LOG_INFO ("returning after header with found: " << found);
-      return found;
+      NS_LOG_INFO ("spilling over to the heap");
+      SpillData *spill = Allocate (std::max (size, 2 * INLINE_SIZE));
+      std::memcpy (spill->data, m_inline, m_used);
+      m_spill = spill;
+      return;
     }
-
-  // From here on out, we have to copy the list
-  // until we find tid, then link past it
-
-  // Before we do all that work, let's make sure tid really exists
-  for (it = cur; it != 0; it = it->next)
+  if (m_spill->count == 1 && m_spill->size >= size)
     {
-      if (it->tid == tid)
-        {
-          break;
-        }
+      return;
     }
-  if (it == 0)
+  if (size <= INLINE_SIZE)
     {
-      // got to end of list without finding tid
-      NS_LOG_INFO ("tid not found after first merge");
-      return found;
+      NS_LOG_INFO ("copying the shared tags inline");
+      std::memcpy (m_inline, m_spill->data, m_used);
+      Deallocate (m_spill);
+      m_spill = 0;
+      return;
     }
+  NS_LOG_INFO ("copying the tags");
+  SpillData *spill = Allocate (std::max (size, m_spill->size));
+  std::memcpy (spill->data, m_spill->data, m_used);
+  Deallocate (m_spill);
+  m_spill = spill;
+}
 
-  // At this point cur is a merge, but untested for tid
-  NS_ASSERT (cur != 0);
-  NS_ASSERT (cur->count > 1);
-
-  /*
-     Walk the remainder of the list, copying, until we find tid
-     As we put a copy of the cur node onto our list,
-     we move the merge point down the list.
-
-     Starting position                  End position
-       T1 is a merge                     T1.count decremented
-                                         T2 is a merge
-                                         T1' is a copy of T1
-
-          other                             other
-               \                                 \
-      Prev  ->  T1  ->  T2  -> ...                T1  ->  T2  -> ...
-           /   /                                         /|
-      pNext cur                         Prev  ->  T1' --/ |
-                                                     /    |
-                                                pNext   cur
-
-     When we reach tid, we link past it, decrement count, and we're done.
-  */
-
-  // Should normally check for null cur pointer,
-  // but since we know tid exists, we'll skip this test
-  while ( /* cur && */ cur->tid != tid)
+uint32_t
+PacketTagList::Find (TypeId tid) const
+{
+  const uint8_t *data = GetData ();
+  uint32_t offset = 0;
+  while (offset < m_used)
     {
-      NS_ASSERT (cur != 0);
-      NS_ASSERT (cur->count > 1);
-      cur->count--;                       // unmerge cur
-      struct TagData * copy = CreateTagData (cur->size);
-      copy->tid = cur->tid;
-      copy->count = 1;
-      copy->size = cur->size;
-      memcpy (copy->data, cur->data, copy->size);
-      copy->next = cur->next;             // merge into tail
-      copy->next->count++;                // mark new merge
-      *prevNext = copy;                   // point prior list at copy
-      prevNext = &copy->next;             // advance
-      cur      =  copy->next;
+      const TagData *cur = reinterpret_cast<const TagData *> (data + offset);
+      if (cur->tid == tid)
+        {
+          break;
+        }
+      offset += GetRecordSize (cur->size);
     }
-  // Sanity check:
-  NS_ASSERT (cur != 0);                 // cur should be non-zero
-  NS_ASSERT (cur->tid == tid);          // cur->tid should be tid
-  NS_ASSERT (cur->count > 1);           // cur should be a merge
-
-  // link around tid, removing it from our list
-  found = (this->*Writer)(tag, false, cur, prevNext);
-  return found;
-
+  return offset;
 }
 
 bool
 PacketTagList::Remove (Tag & tag)
 {
-  return COWTraverse (tag, &PacketTagList::RemoveWriter);
-}
-
-// COWWriter implementing Remove
-bool
-PacketTagList::RemoveWriter (Tag & tag, bool preMerge,
-                             struct PacketTagList::TagData  * cur,
-                             struct PacketTagList::TagData ** prevNext)
-{
-  NS_LOG_FUNCTION_NOARGS ();
-
-  // found tid
-  bool found = true;
-  tag.Deserialize (TagBuffer (cur->data, cur->data + cur->size));
-  *prevNext = cur->next;            // link around cur
-
-  if (preMerge)
+  TypeId tid = tag.GetInstanceTypeId ();
+  NS_LOG_FUNCTION (this << tid);
+  uint32_t offset = Find (tid);
+  if (offset == m_used)
     {
-      // found tid before first merge, so delete cur
-      cur->~TagData ();
-      std::free (cur);
+      NS_LOG_INFO ("tid not found");
+      return false;
+    }
+  TagData *cur = reinterpret_cast<TagData *> (GetData () + offset);
+  tag.Deserialize (TagBuffer (cur->GetData (), cur->GetData () + cur->size));
+  uint32_t recordSize = GetRecordSize (cur->size);
+  uint32_t used = m_used - recordSize;
+  uint8_t *data = GetData ();
+  if (m_spill != 0 && m_spill->count > 1)
+    {
+      // copy the shared tags, but the one removed
+      NS_LOG_INFO ("copying the shared tags");
+      SpillData *spill = used > INLINE_SIZE ? Allocate (m_spill->size) : 0;
+      uint8_t *copy = reinterpret_cast<uint8_t *> (spill != 0 ? spill->data : m_inline);
+      std::memcpy (copy, data, offset);
+      std::memcpy (copy + offset, data + offset + recordSize, used - offset);
+      Deallocate (m_spill);
+      m_spill = spill;
     }
   else
     {
-      // cur is always a merge at this point
-      // unmerge cur, since we linked around it already
-      cur->count--;
-      if (cur->next != 0)
-        {
-          // there's a next, so make it a merge
-          cur->next->count++;
-        }
+      std::memmove (data + offset, data + offset + recordSize, used - offset);
     }
-  return found;
+  m_used = used;
+  return true;
 }
 
 bool
 PacketTagList::Replace (Tag & tag)
 {
-  bool found = COWTraverse (tag, &PacketTagList::ReplaceWriter);
-  if (!found)
+  TypeId tid = tag.GetInstanceTypeId ();
+  NS_LOG_FUNCTION (this << tid);
+  uint32_t offset = Find (tid);
+  if (offset == m_used)
     {
       Add (tag);
+      return false;
     }
-  return found;
-}
-
-// COWWriter implementing Replace
-bool
-PacketTagList::ReplaceWriter (Tag & tag, bool preMerge,
-                              struct PacketTagList::TagData  * cur,
-                              struct PacketTagList::TagData ** prevNext)
-{
-  NS_LOG_FUNCTION_NOARGS ();
-
-  // found tid
-  bool found = true;
-  if (preMerge)
-    {
-      // found tid before first merge, so just rewrite
-      tag.Serialize (TagBuffer (cur->data, cur->data + cur->size));
-    }
-  else
+  const TagData *old = reinterpret_cast<const TagData *> (GetData () + offset);
+  uint32_t oldSize = GetRecordSize (old->size);
+  uint32_t size = tag.GetSerializedSize ();
+  uint32_t newSize = GetRecordSize (size);
+  uint32_t used = m_used - oldSize + newSize;
+  Reserve (std::max (m_used, used));
+  uint8_t *data = GetData ();
+  if (newSize != oldSize)
     {
-      // cur is always a merge at this point
-      // need to copy, replace, and link past cur
-      cur->count--;                     // unmerge cur
-      struct TagData * copy = CreateTagData (tag.GetSerializedSize ());
-      copy->tid = tag.GetInstanceTypeId ();
-      copy->count = 1;
-      tag.Serialize (TagBuffer (copy->data, copy->data + copy->size));
-      copy->next = cur->next;           // merge into tail
-      if (copy->next != 0)
-        {
-          copy->next->count++;          // mark new merge
-        }
-      *prevNext = copy;                 // point prior list at copy
+      std::memmove (data + offset + newSize, data + offset + oldSize, m_used - offset - oldSize);
+      m_used = used;
     }
-  return found;
+  TagData *cur = reinterpret_cast<TagData *> (data + offset);
+  cur->size = size;
+  tag.Serialize (TagBuffer (cur->GetData (), cur->GetData () + size));
+  return true;
 }
 
 void 
@@ -261,44 +178,58 @@ PacketTagList::Add (const Tag &tag) const
 {
   NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
   // ensure this id was not yet added
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
-    {
-      NS_ASSERT_MSG (cur->tid != tag.GetInstanceTypeId (),
-                     "Error: cannot add the same kind of tag twice.");
-    }
-  struct TagData * head = CreateTagData (tag.GetSerializedSize ());
-  head->count = 1;
-  head->next = 0;
+  NS_ASSERT_MSG (Find (tag.GetInstanceTypeId ()) == m_used,
+                 "Error: cannot add the same kind of tag twice.");
+  PacketTagList *list = const_cast<PacketTagList *> (this);
+  uint32_t size = tag.GetSerializedSize ();
+  uint32_t recordSize = GetRecordSize (size);
+  list->Reserve (m_used + recordSize);
+  uint8_t *data = GetData ();
+  // the most recent tag comes first
+  std::memmove (data + recordSize, data, m_used);
+  TagData *head = new (data) TagData;
   head->tid = tag.GetInstanceTypeId ();
-  head->next = m_next;
-  tag.Serialize (TagBuffer (head->data, head->data + head->size));
-
-  const_cast<PacketTagList *> (this)->m_next = head;
+  head->size = size;
+  tag.Serialize (TagBuffer (head->GetData (), head->GetData () + size));
+  list->m_used += recordSize;
 }
 
 bool
 PacketTagList::Peek (Tag &tag) const
 {
   NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ());
-  TypeId tid = tag.GetInstanceTypeId ();
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
+  uint32_t offset = Find (tag.GetInstanceTypeId ());
+  if (offset == m_used)
     {
-      if (cur->tid == tid) 
-        {
-          /* found tag */
-          tag.Deserialize (TagBuffer (cur->data, cur->data + cur->size));
-          return true;
-        }
+      /* no tag found */
+      return false;
     }
-  /* no tag found */
-  return false;
+  /* found tag */
+  const TagData *cur = reinterpret_cast<const TagData *> (GetData () + offset);
+  tag.Deserialize (TagBuffer (const_cast<uint8_t *> (cur->GetData ()),
+                              const_cast<uint8_t *> (cur->GetData ()) + cur->size));
+  return true;
 }
 
 const struct PacketTagList::TagData *
 PacketTagList::Head (void) const
 {
-  return m_next;
+  if (m_used == 0)
+    {
+      return 0;
+    }
+  return reinterpret_cast<const TagData *> (GetData ());
 }
 
-} /* namespace ns3 */
+const struct PacketTagList::TagData *
+PacketTagList::Next (const struct TagData *cur) const
+{
+  const uint8_t *next = reinterpret_cast<const uint8_t *> (cur) + GetRecordSize (cur->size);
+  if (next == GetData () + m_used)
+    {
+      return 0;
+    }
+  return reinterpret_cast<const TagData *> (next);
+}
 
+} /* namespace ns3 */
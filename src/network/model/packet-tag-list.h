@@ -22,12 +22,17 @@
 
 /**
 \file   packet-tag-list.h
-\brief  Defines a linked list of Packet tags, including copy-on-write semantics.
+\brief  Defines a list of Packet tags, stored inline in the packet while small,
+        with copy-on-write semantics beyond.
 */
 
 #include <stdint.h>
 #include <ostream>
+#include <cstring>
 #include "ns3/type-id.h"
+#ifdef NS3_MTP
+#include <atomic>
+#endif
 
 namespace ns3 {
 
@@ -43,110 +48,57 @@ class Tag;
  *
  * \internal
  *
- * The implementation of this class is a bit tricky.  Refer to this
- * diagram in the discussion that follows.
+ * The tags are serialized, one after the other, from the most recent to
+ * the oldest, each after a TagData header giving its type and size, and
+ * padded to a multiple of 4 bytes:
  *
- * \dot
- *    digraph {
- *        rankdir = "LR";
- *        clusterrank = local;
- *        node [ shape = record, fontname="FreeSans", fontsize="10" ];
- *        oth  [ label="<l> Other branch | <n> next | <c> ..." ];
- *        PTL1 [ label="<l> PacketTagList A | <n> m_next" , shape=Mrecord];
- *        PTL2 [ label="<l> PacketTagList B | <n> m_next" , shape=Mrecord];
- *        oth:n  -> T7:l ;
- *        PTL2:n -> T6:l ;
- *        PTL1:n -> T5:l ;
- *        T1   [ label="<l> T1  | <n> next | <c> count = 1" ];
- *        T2   [ label="<l> T2  | <n> next | <c> count = 1" ];
- *        T3   [ label="<l> T3  | <n> next | <c> count = 2" ];
- *        T4   [ label="<l> T4  | <n> next | <c> count = 1" ];
- *        T5   [ label="<l> T5  | <n> next | <c> count = 2" ];
- *        T6   [ label="<l> T6  | <n> next | <c> count = 1" ];
- *        T7   [ label="<l> T7  | <n> next | <c> count = 1" ];
- *        NULL [ label="0", shape = ellipse ];
- *        subgraph cluster_list {
- *          penwidth = 0;
- *          T6:n -> T5:l ;
- *          T5:n -> T4:l ;
- *          T4:n -> T3:l ;
- *          T7:n -> T3:l ;
- *          T3:n -> T2:l ;
- *          T2:n -> T1:l ;
- *          T1:n -> NULL ;
- *        };
- *      }
- * \enddot
+ *     | TagData | tag 3 | TagData | tag 2 | TagData | tag 1 |
  *
- *   - Tags are stored in serialized form in a tree of TagData
- *     structures. (<tt>T1-T7</tt> in the diagram)
- *
- *   - Each TagData points (\c next pointers in the diagram)
- *     toward the root of the tree, which is a null pointer.
- *
- *   - \c count is the number of incoming pointers to this
- *     TagData.  Branch points, where branches merge or join, have
- *     <tt>count \> 1</tt> (\c T3, \c T5); successive links along
- *     a branch have <tt>count = 1</tt> (\c T1, \c T2, \c T4, \c T6, \c T7).
- *
- *   - Each PacketTagList points to a specific TagData,
- *     which is the most recent Tag added to the packet. (<tt>T5-T7</tt>)
- *
- *   - Conceptually, therefore, each Packet has a PacketTagList which
- *     points to a singly-linked list of TagData.
- *
- * \par <b> Copy-on-write </b> is implemented as follows:
- *
- *   - #Add prepends the new tag to the list (growing that branch of the tree,
- *     as \c T6). This is a constant time operation, and does not affect
- *     any other #PacketTagList's, hence this is a \c const function.
- *
- *   - Copy constructor (PacketTagList(const PacketTagList & o))
- *     and assignment (#operator=(const PacketTagList & o))
- *     simply join the tree at the same place as the original
- *     PacketTagList \c o, incrementing the \c count.
- *     For assignment, the old branch is deleted, up to
- *     the first branch point, which has its \c count decremented.
- *     (PacketTagList \c B started as a copy of PacketTagList \c A,
- *     before \c T6 was added to \c B).
- *
- *   - #Remove and #Replace are a little tricky, depending on where the
- *     target tag is found relative to the first branch point:
- *     - \e Target before <em> the first branch point: </em> \n
- *       The target is just dealt with in place (linked around and deleted,
- *       in the case of #Remove; rewritten in the case of #Replace).
- *     - \e Target at or after <em> the first branch point: </em> \n
- *       The portion of the list between the first branch and the target is
- *       shared. This portion is copied before the #Remove or #Replace is
- *       performed.
+ * While they fit in #INLINE_SIZE bytes, the tags are stored in the list
+ * itself, so that adding, removing and copying the few tags most packets
+ * carry does not allocate.  Beyond, they spill over to a heap buffer,
+ * which the copies of the list share, and which is copied when a shared
+ * list is modified (copy-on-write).
  */
 class PacketTagList 
 {
 public:
   /**
-   * Tree node for sharing serialized tags.
-   *
-   * See PacketTagList for a discussion of the data structure.
+   * Header of a serialized tag.
    *
    * \internal
    * Unfortunately this has to be public, because
    * PacketTagIterator::Item::GetTag() needs the data and size values.
    * The Item nested class can't be forward declared, so friending isn't
    * possible.
-   *
-   * We use placement new so we can allocate enough room for the Tag
-   * type which will be serialized into data.  See Object::Aggregates
-   * for a similar construction.
    */
   struct TagData
   {
-    struct TagData * next;      /**< Pointer to next in list */
-    uint32_t count;             /**< Number of incoming links */
-    TypeId tid;                 /**< Type of the tag serialized into #data */
-    uint32_t size;              /**< Size of the \c data buffer */
-    uint8_t data[1];            /**< Serialization buffer */
+    TypeId tid;                 /**< Type of the tag serialized after this header */
+    uint32_t size;              /**< Size of the serialized tag */
+
+    /**
+     * \returns The serialized tag, following this header.
+     */
+    uint8_t *GetData (void)
+    {
+      return reinterpret_cast<uint8_t *> (this + 1);
+    }
+    /**
+     * \returns The serialized tag, following this header.
+     */
+    const uint8_t *GetData (void) const
+    {
+      return reinterpret_cast<const uint8_t *> (this + 1);
+    }
   };  /* struct TagData */
 
+  /**
+   * Number of bytes of tags, including their TagData headers, stored in
+   * the list itself.
+   */
+  static const uint32_t INLINE_SIZE = 112;
+
   /**
    * Create a new PacketTagList.
    */
@@ -156,8 +108,8 @@ public:
    *
    * \param [in] o The PacketTagList to copy.
    *
-   * This makes a light-weight copy by #RemoveAll, then
-   * pointing to the same \ref TagData as \pname{o}.
+   * This copies the tags stored inline, or shares the heap buffer
+   * of \pname{o}.
    */
   inline PacketTagList (PacketTagList const &o);
   /**
@@ -167,18 +119,19 @@ public:
    * \returns the copied object
    *
    * This makes a light-weight copy by #RemoveAll, then
-   * pointing to the same \ref TagData as \pname{o}.
+   * copying the tags stored inline, or sharing the heap buffer of
+   * \pname{o}.
    */
   inline PacketTagList &operator = (PacketTagList const &o);
   /**
    * Destructor
    *
-   * #RemoveAll's the tags up to the first merge.
+   * #RemoveAll's the tags.
    */
   inline ~PacketTagList ();
 
   /**
-   * Add a tag to the head of this branch.
+   * Add a tag to the head of the list.
    *
    * \param [in] tag The tag to add
    */
@@ -210,78 +163,75 @@ public:
    */
   bool Peek (Tag &tag) const;
   /**
-   * Remove all tags from this list (up to the first merge).
+   * Remove all tags from this list.
    */
   inline void RemoveAll (void);
   /**
-   * \returns pointer to head of tag list
+   * \returns pointer to the most recent tag of the list, or 0 if empty
    */
   const struct PacketTagList::TagData *Head (void) const;
+  /**
+   * \param [in] cur A tag of the list.
+   * \returns pointer to the tag following \pname{cur}, or 0 if none
+   */
+  const struct PacketTagList::TagData *Next (const struct TagData *cur) const;
 
 private:
   /**
-   * Allocate and construct a TagData struct, sizing the data area
-   * large enough to serialize dataSize bytes from a Tag.
-   *
-   * \param [in] dataSize The serialized size of the Tag.
-   * \returns The newly constructed TagData object.
+   * The heap buffer the tags spill over to, shared by the copies of
+   * the list.
    */
-  static
-  TagData * CreateTagData (size_t dataSize);
-  
+  struct SpillData
+  {
+#ifdef NS3_MTP
+    std::atomic<uint32_t> count; /**< Number of lists sharing the buffer */
+#else
+    uint32_t count;             /**< Number of lists sharing the buffer */
+#endif
+    uint32_t size;              /**< Size of the \c data buffer */
+    uint32_t data[1];           /**< The serialized tags */
+  };
+
   /**
-   * Typedef of method function pointer for copy-on-write operations
-   *
-   * \param [in] tag The tag type to operate on.
-   * \param [in] preMerge True if \pname{tag} was found before the first merge,
-   *             false otherwise.
-   * \param [in] cur Pointer to the tag.
-   * \param [in] prevNext Pointer to the struct TagData.next pointer
-   *          pointing to \pname{cur}.
-   * \returns True if operation successful, false otherwise
+   * \param [in] size The size of a serialized tag.
+   * \returns The size of the tag in the list, with its header and padding.
+   */
+  static uint32_t GetRecordSize (uint32_t size);
+  /**
+   * \returns The serialized tags.
    */
-  typedef bool (PacketTagList::*COWWriter)
-    (Tag       & tag, bool         preMerge,
-    struct TagData * cur, struct TagData ** prevNext);
+  inline uint8_t *GetData (void) const;
   /**
-   * Traverse the list implementing copy-on-write, using \pname{Writer}.
+   * Find a tag of the list.
    *
-   * \param [in] tag The tag type to operate on.
-   * \param [in] Writer The copy-on-write function to use.
-   * \returns True if \pname{tag} found, false otherwise.
+   * \param [in] tid The type of the tag.
+   * \returns The offset of the tag in the list, or #m_used if not found.
    */
-  bool COWTraverse   (Tag & tag, PacketTagList::COWWriter Writer);
+  uint32_t Find (TypeId tid) const;
   /**
-   * Copy-on-write implementing Remove.
+   * Make the tags writable, copying them if the heap buffer is shared,
+   * and make room for \pname{size} bytes of tags.
    *
-   * \param [in] tag The target tag type to remove.
-   * \param [in] preMerge True if \pname{tag} was found before the first merge,
-   *             false otherwise.
-   * \param [in] cur Pointer to the tag.
-   * \param [in] prevNext Pointer to the struct TagData.next pointer
-   *          pointing to \pname{cur}.
-   * \returns True, since tag will definitely be removed.
+   * \param [in] size The number of bytes of tags needed.
    */
-  bool RemoveWriter  (Tag & tag, bool preMerge,
-                      struct TagData * cur, struct TagData ** prevNext);
+  void Reserve (uint32_t size);
   /**
-   * Copy-on-write implementing Replace
+   * Allocate a heap buffer, unshared.
    *
-   * \param [in] tag The target tag type to replace
-   * \param [in] preMerge True if \pname{tag} was found before the first merge,
-   *          false otherwise.
-   * \param [in] cur Pointer to the tag
-   * \param [in] prevNext Pointer to the struct TagData.next pointer
-   *          pointing to \pname{cur}.
-   * \returns True, since tag value will definitely be replaced.
+   * \param [in] size The size of the buffer.
+   * \returns The buffer.
    */
-  bool ReplaceWriter (Tag & tag, bool preMerge,
-                      struct TagData * cur, struct TagData ** prevNext);
-
+  static SpillData *Allocate (uint32_t size);
   /**
-   * Pointer to first \ref TagData on the list
+   * Release a heap buffer, deleted when no longer shared.
+   *
+   * \param [in] data The buffer.
    */
-  struct TagData *m_next;
+  inline static void Deallocate (SpillData *data);
+
+  uint32_t m_used;                       //!< Number of bytes of tags
+  SpillData *m_spill;                    //!< The heap buffer, 0 if inline
+  uint32_t m_inline[INLINE_SIZE / 4];    //!< The tags stored inline
 };
 
 } // namespace ns3
@@ -293,16 +243,22 @@ private:
 namespace ns3 {
 
 PacketTagList::PacketTagList ()
-  : m_next ()
+  : m_used (0),
+    m_spill (0)
 {
 }
 
 PacketTagList::PacketTagList (PacketTagList const &o)
-  : m_next (o.m_next)
+  : m_used (o.m_used),
+    m_spill (o.m_spill)
 {
-  if (m_next != 0)
+  if (m_spill != 0)
+    {
+      m_spill->count++;
+    }
+  else
     {
-      m_next->count++;
+      std::memcpy (m_inline, o.m_inline, m_used);
     }
 }
 
@@ -310,15 +266,20 @@ PacketTagList &
 PacketTagList::operator = (PacketTagList const &o)
 {
   // self assignment
-  if (m_next == o.m_next) 
+  if (this == &o)
     {
       return *this;
     }
   RemoveAll ();
-  m_next = o.m_next;
-  if (m_next != 0) 
+  m_used = o.m_used;
+  m_spill = o.m_spill;
+  if (m_spill != 0)
     {
-      m_next->count++;
+      m_spill->count++;
+    }
+  else
+    {
+      std::memcpy (m_inline, o.m_inline, m_used);
     }
   return *this;
 }
@@ -331,27 +292,25 @@ PacketTagList::~PacketTagList ()
 void
 PacketTagList::RemoveAll (void)
 {
-  struct TagData *prev = 0;
-  for (struct TagData *cur = m_next; cur != 0; cur = cur->next)
-    {
-      cur->count--;
-      if (cur->count > 0) 
-        {
-          break;
-        }
-      if (prev != 0) 
-        {
-          prev->~TagData ();
-          std::free (prev);
-        }
-      prev = cur;
-    }
-  if (prev != 0) 
+  Deallocate (m_spill);
+  m_spill = 0;
+  m_used = 0;
+}
+
+uint8_t *
+PacketTagList::GetData (void) const
+{
+  const uint32_t *data = m_spill != 0 ? m_spill->data : m_inline;
+  return reinterpret_cast<uint8_t *> (const_cast<uint32_t *> (data));
+}
+
+void
+PacketTagList::Deallocate (SpillData *data)
+{
+  if (data != 0 && --data->count == 0)
     {
-      prev->~TagData ();
-      std::free (prev);
+      delete [] reinterpret_cast<uint8_t *> (data);
     }
-  m_next = 0;
 }
 
 } // namespace ns3
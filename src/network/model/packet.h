@@ -34,6 +34,9 @@
 #include "ns3/assert.h"
 #include "ns3/ptr.h"
 #include "ns3/deprecated.h"
+#ifdef NS3_MTP
+#include <atomic>
+#endif
 
 namespace ns3 {
 
@@ -173,9 +176,10 @@ private:
   friend class Packet;
   /**
    * Constructor
-   * \param head head of the items
+   * \param list the list of the items
    */
-  PacketTagIterator (const struct PacketTagList::TagData *head);
+  PacketTagIterator (const PacketTagList *list);
+  const PacketTagList *m_list;  //!< the set of tags in a packet
   const struct PacketTagList::TagData *m_current;  //!< actual position over the set of tags in a packet
 };
 
@@ -302,6 +306,24 @@ public:
    * \returns the size in bytes of the packet
    */
   inline uint32_t GetSize (void) const;
+  /**
+   * \brief Get the offset of the synthetic payload of the packet.
+   *
+   * The zero-filled payload of a packet created with Packet (uint32_t)
+   * is not stored in memory: it stays virtual through the headers and
+   * trailers added and removed, and the copies and fragments of the
+   * packet.  The consumers of the packet bytes which do not need them, such as the
+   * pcap writers, may skip it.
+   *
+   * \returns the offset of the synthetic payload from the start of the
+   *          packet, or the size of the packet if it has none.
+   */
+  uint32_t GetSyntheticPayloadOffset (void) const;
+  /**
+   * \returns the size in bytes of the synthetic payload of the packet,
+   *          zero if it has none.
+   */
+  uint32_t GetSyntheticPayloadSize (void) const;
   /**
    * \brief Add header to this packet.
    *
@@ -766,7 +788,11 @@ private:
   /* Please see comments above about nix-vector */
   Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
+#ifdef NS3_MTP
+  static std::atomic<uint32_t> m_globalUid; //!< Global counter of packets Uid
+#else
   static uint32_t m_globalUid; //!< Global counter of packets Uid
+#endif
 };
 
 /**
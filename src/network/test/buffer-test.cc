@@ -22,6 +22,8 @@
 #include "ns3/random-variable-stream.h"
 #include "ns3/double.h"
 #include "ns3/test.h"
+#include <algorithm>
+#include <vector>
 
 using namespace ns3;
 
@@ -378,6 +380,140 @@ BufferTest::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (val1, val2, "Bad ReadNtohU16()");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Buffer fragments unit tests: buffers appended by reference.
+ */
+class BufferFragmentsTest : public TestCase {
+private:
+  /**
+   * Checks the buffer content, through CopyData then through an Iterator
+   * \param b The buffer to check
+   * \param expected The bytes that should be in the buffer
+   * \param msg The message
+   */
+  void CheckBytes (const Buffer &b, const std::vector<uint8_t> &expected, const char *msg);
+public:
+  virtual void DoRun (void);
+  BufferFragmentsTest ();
+};
+
+BufferFragmentsTest::BufferFragmentsTest ()
+  : TestCase ("Buffer fragments") {
+}
+
+void
+BufferFragmentsTest::CheckBytes (const Buffer &b, const std::vector<uint8_t> &expected, const char *msg)
+{
+  NS_TEST_ASSERT_MSG_EQ (b.GetSize (), expected.size (), msg << ": bad size");
+  std::vector<uint8_t> copy (expected.size () + 1, 0xff);
+  uint32_t copied = b.CopyData (&copy[0], expected.size () - 1);
+  NS_TEST_ASSERT_MSG_EQ (copied, expected.size () - 1, msg << ": bad partial copy size");
+  NS_TEST_EXPECT_MSG_EQ ((copy[expected.size () - 1]), 0xff, msg << ": partial copy overflow");
+  copied = b.CopyData (&copy[0], copy.size ());
+  NS_TEST_ASSERT_MSG_EQ (copied, expected.size (), msg << ": bad copy size");
+  NS_TEST_EXPECT_MSG_EQ ((std::equal (expected.begin (), expected.end (), copy.begin ())), true,
+                         msg << ": bad copied data");
+  Buffer::Iterator i = b.Begin ();
+  for (uint32_t j = 0; j < expected.size (); j++)
+    {
+      uint8_t byte = i.ReadU8 ();
+      NS_TEST_ASSERT_MSG_EQ ((uint32_t) byte, (uint32_t) expected[j], msg << ": bad byte " << j);
+    }
+  NS_TEST_EXPECT_MSG_EQ (i.IsEnd (), true, msg << ": bad end");
+}
+
+void
+BufferFragmentsTest::DoRun (void)
+{
+  // aggregate subframes, some of them with a zero area, like A-MPDUs
+  std::vector<uint8_t> expected;
+  Buffer aggregate;
+  for (uint32_t n = 0; n < 64; n++)
+    {
+      uint32_t zeroes = (n % 3 == 0) ? 20 : 0;
+      Buffer subframe (zeroes);
+      subframe.AddAtStart (4 + n % 7);
+      Buffer::Iterator i = subframe.Begin ();
+      for (uint32_t j = 0; j < 4 + n % 7; j++)
+        {
+          i.WriteU8 (n + j);
+          expected.push_back (n + j);
+        }
+      expected.insert (expected.end (), zeroes, 0);
+      aggregate.AddAtEnd (subframe);
+      NS_TEST_ASSERT_MSG_EQ (aggregate.GetSize (), expected.size (), "bad aggregate size");
+    }
+
+  // copies share the bytes, once contiguous
+  Buffer copy = aggregate;
+  CheckBytes (copy, expected, "copy");
+
+  Buffer header;
+  header.AddAtEnd (copy);
+  header.AddAtEnd (aggregate);
+  std::vector<uint8_t> twice (expected);
+  twice.insert (twice.end (), expected.begin (), expected.end ());
+  CheckBytes (header, twice, "aggregate of aggregates");
+
+  // a header added in front of the fragments
+  Buffer prefixed;
+  prefixed.AddAtEnd (aggregate);
+  prefixed.AddAtEnd (aggregate);
+  prefixed.AddAtStart (2);
+  prefixed.Begin ().WriteU16 (0xabcd);
+  std::vector<uint8_t> withHeader (2);
+  withHeader[0] = 0xcd;
+  withHeader[1] = 0xab;
+  withHeader.insert (withHeader.end (), twice.begin (), twice.end ());
+  CheckBytes (prefixed, withHeader, "header");
+
+  // removal across fragments
+  Buffer removed;
+  removed.AddAtEnd (aggregate);
+  removed.AddAtEnd (aggregate);
+  removed.RemoveAtStart (expected.size () + 5);
+  removed.RemoveAtEnd (3);
+  CheckBytes (removed, std::vector<uint8_t> (expected.begin () + 5, expected.end () - 3), "removal");
+
+  Buffer fragment = prefixed.CreateFragment (2 + expected.size () - 7, 14);
+  CheckBytes (fragment, std::vector<uint8_t> (twice.begin () + expected.size () - 7,
+                                              twice.begin () + expected.size () + 7), "fragment");
+  CheckBytes (aggregate, expected, "aggregate");
+
+  // the zero area of the first fragment stays virtual when flattened
+  Buffer synthetic (100);
+  synthetic.AddAtStart (2);
+  synthetic.Begin ().WriteU16 (0xabcd);
+  Buffer trailer;
+  trailer.AddAtStart (4);
+  trailer.Begin ().WriteU32 (0x01020304);
+  synthetic.AddAtEnd (trailer);
+  std::vector<uint8_t> withZeroes (withHeader.begin (), withHeader.begin () + 2);
+  withZeroes.resize (102, 0);
+  withZeroes.push_back (0x04);
+  withZeroes.push_back (0x03);
+  withZeroes.push_back (0x02);
+  withZeroes.push_back (0x01);
+  CheckBytes (synthetic, withZeroes, "synthetic payload");
+#ifndef NS3_MTP
+  NS_TEST_EXPECT_MSG_EQ (synthetic.GetSyntheticPayloadOffset (), 2, "synthetic payload offset");
+  NS_TEST_EXPECT_MSG_EQ (synthetic.GetSyntheticPayloadSize (), 100, "synthetic payload size");
+#endif
+
+  // appending a zero area followed by bytes, as TCP does when it
+  // reassembles payloads, writes the bytes after the zero area
+  synthetic.RemoveAtStart (2);
+  Buffer reassembled;
+  reassembled.AddAtEnd (synthetic);
+  reassembled.AddAtEnd (synthetic);
+  std::vector<uint8_t> twiceZeroes (withZeroes.begin () + 2, withZeroes.end ());
+  twiceZeroes.insert (twiceZeroes.end (), withZeroes.begin () + 2, withZeroes.end ());
+  CheckBytes (reassembled, twiceZeroes, "reassembled synthetic payloads");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -394,6 +530,7 @@ BufferTestSuite::BufferTestSuite ()
   : TestSuite ("buffer", UNIT)
 {
   AddTestCase (new BufferTest, TestCase::QUICK);
+  AddTestCase (new BufferFragmentsTest, TestCase::QUICK);
 }
 
 static BufferTestSuite g_bufferTestSuite; //!< Static variable for test initialization
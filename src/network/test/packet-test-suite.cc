@@ -993,7 +993,38 @@ PacketTagListTest::DoRun (void)
     ReplaceCheck (6);
     ReplaceCheck (7);
   }
-  
+
+  { // Spill-over
+    std::cout << GetName () << "check tags spilled over to the heap" << std::endl;
+    ATestTag<PacketTagList::INLINE_SIZE> big (1);
+    PacketTagList spill = ref;
+    spill.Add (big);
+    CheckRefList (ref,   "spill orig");
+    CheckRefList (spill, "spill copy");
+    CheckRef     (spill, big, "spill copy");
+
+    PacketTagList shared = spill;   // shares the tags on the heap
+    shared.Remove (t4);
+    CheckRefList (spill,  "spill remove orig");
+    CheckRefList (shared, "spill remove copy", 4);
+    CheckRef     (spill,  big, "spill remove orig");
+    CheckRef     (shared, big, "spill remove copy");
+
+    PacketTagList back = spill;     // moves back inline
+    back.Remove (big);
+    CheckRefList (back,  "spill remove big copy");
+    CheckRef     (back,  big, "spill remove big copy", true);
+    CheckRef     (spill, big, "spill remove big orig");
+
+    back = spill;
+    big.m_data = 2;
+    back.Replace (big);
+    CheckRefList (back, "spill replace copy");
+    CheckRef     (back, big, "spill replace copy");
+    big.m_data = 1;
+    CheckRef     (spill, big, "spill replace orig");
+  }
+
   { // Timing
     std::cout << GetName () << "add+remove timing" << std::endl;
     int flm = std::numeric_limits<int>::max ();
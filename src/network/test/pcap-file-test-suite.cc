@@ -25,6 +25,7 @@
 #include "ns3/log.h"
 #include "ns3/test.h"
 #include "ns3/pcap-file.h"
+#include "ns3/packet.h"
 
 using namespace ns3;
 
@@ -1144,6 +1145,106 @@ DiffTestCase::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (usec, 3696, "Files are different from 2.3696 seconds");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test case to make sure that the records written through the
+ * write buffers, from the simulation or from the background thread, are
+ * those written directly, truncated to the snap length.
+ */
+class BufferedWriteTestCase : public TestCase
+{
+public:
+  BufferedWriteTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Write packets of increasing sizes to a file.
+   * \param filename The name of the file.
+   * \param bufferSize The size of the write buffers.
+   * \param background Write the buffers from the background thread.
+   */
+  void WriteFile (std::string filename, uint32_t bufferSize, bool background);
+};
+
+BufferedWriteTestCase::BufferedWriteTestCase ()
+  : TestCase ("Check that the buffered records are written, truncated to the snap length")
+{
+}
+
+void
+BufferedWriteTestCase::WriteFile (std::string filename, uint32_t bufferSize, bool background)
+{
+  PcapFile f;
+  f.SetBuffering (bufferSize, background);
+  f.Open (filename, std::ios::out);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << filename << ", \"std::ios::out\") returns error");
+  f.Init (1, 64);
+
+  uint8_t data[128];
+  for (uint32_t i = 0; i < 128; ++i)
+    {
+      data[i] = i;
+    }
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      uint32_t size = i % 128;
+      if (i % 2)
+        {
+          f.Write (i, 0, data, size);
+        }
+      else
+        {
+          f.Write (i, 0, Create<Packet> (data, size));
+        }
+    }
+  f.Close ();
+  NS_TEST_EXPECT_MSG_EQ (f.Fail (), false, "Writing " << filename << " failed");
+}
+
+void
+BufferedWriteTestCase::DoRun (void)
+{
+  std::string direct = CreateTempDirFilename ("direct.pcap");
+  std::string buffered = CreateTempDirFilename ("buffered.pcap");
+  std::string background = CreateTempDirFilename ("background.pcap");
+  WriteFile (direct, 0, false);
+  WriteFile (buffered, 1000, false);
+  WriteFile (background, 1000, true);
+
+  uint32_t sec (0), usec (0), packets (0);
+  NS_TEST_EXPECT_MSG_EQ (PcapFile::Diff (direct, buffered, sec, usec, packets), false,
+                         "The buffered records differ from packet " << packets);
+  packets = 0;
+  NS_TEST_EXPECT_MSG_EQ (PcapFile::Diff (direct, background, sec, usec, packets), false,
+                         "The records written in background differ from packet " << packets);
+
+  PcapFile f;
+  f.Open (background, std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Open (" << background << ", \"std::ios::in\") returns error");
+  uint8_t data[128];
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      uint32_t tsSec, tsUsec, inclLen, origLen, readLen;
+      f.Read (data, sizeof (data), tsSec, tsUsec, inclLen, origLen, readLen);
+      NS_TEST_ASSERT_MSG_EQ (f.Fail (), false, "Read of packet " << i << " failed");
+      NS_TEST_EXPECT_MSG_EQ (tsSec, i, "Unexpected timestamp of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (origLen, i % 128, "Unexpected length of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (inclLen, std::min<uint32_t> (i % 128, 64), "Packet " << i << " not truncated");
+      for (uint32_t j = 0; j < readLen; ++j)
+        {
+          NS_TEST_EXPECT_MSG_EQ (uint32_t (data[j]), j, "Unexpected data of packet " << i);
+        }
+    }
+  f.Close ();
+
+  remove (direct.c_str ());
+  remove (buffered.c_str ());
+  remove (background.c_str ());
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1170,3 +1271,23 @@ PcapFileTestSuite::PcapFileTestSuite ()
 }
 
 static PcapFileTestSuite pcapFileTestSuite; //!< Static variable for test initialization
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief PCAP file buffered writes TestSuite
+ */
+class PcapFileBufferedTestSuite : public TestSuite
+{
+public:
+  PcapFileBufferedTestSuite ();
+};
+
+PcapFileBufferedTestSuite::PcapFileBufferedTestSuite ()
+  : TestSuite ("pcap-file-buffered", UNIT)
+{
+  AddTestCase (new BufferedWriteTestCase, TestCase::QUICK);
+}
+
+static PcapFileBufferedTestSuite pcapFileBufferedTestSuite; //!< Static variable for test initialization
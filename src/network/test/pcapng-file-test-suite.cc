@@ -0,0 +1,260 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include "ns3/test.h"
+#include "ns3/packet.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/object-factory.h"
+#include "ns3/pcap-file-wrapper.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test case to make sure that the PcapFileWrapper instances sharing
+ * a pcapng file write an interface each, and their packets in order.
+ */
+class PcapngSharedFileTestCase : public TestCase
+{
+public:
+  PcapngSharedFileTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Read a 32 bit field of the file.
+   * \param data The file.
+   * \param offset The offset of the field.
+   * \returns The value of the field.
+   */
+  static uint32_t Get32 (const std::vector<uint8_t> &data, uint32_t offset);
+};
+
+PcapngSharedFileTestCase::PcapngSharedFileTestCase ()
+  : TestCase ("Check that the interfaces and packets of a shared pcapng file are written")
+{
+}
+
+uint32_t
+PcapngSharedFileTestCase::Get32 (const std::vector<uint8_t> &data, uint32_t offset)
+{
+  uint32_t value;
+  std::memcpy (&value, &data[offset], sizeof (value));
+  return value;
+}
+
+void
+PcapngSharedFileTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("shared.pcapng");
+  for (uint32_t background = 0; background < 2; ++background)
+    {
+      Ptr<PcapFileWrapper> wrappers[2];
+      for (uint32_t i = 0; i < 2; ++i)
+        {
+          wrappers[i] = CreateObjectWithAttributes<PcapFileWrapper> ("PcapngFile", StringValue (filename),
+                                                                     "BufferSize", UintegerValue (256),
+                                                                     "BackgroundWriter", BooleanValue (background));
+          wrappers[i]->Open (i == 0 ? "ap" : "sta", std::ios::out);
+          wrappers[i]->Init (105 + i, 100);
+          NS_TEST_ASSERT_MSG_EQ (wrappers[i]->Fail (), false, "Init of interface " << i << " failed");
+        }
+      uint8_t data[150];
+      for (uint32_t i = 0; i < 150; ++i)
+        {
+          data[i] = i;
+        }
+      for (uint32_t i = 0; i < 20; ++i)
+        {
+          wrappers[i % 2]->Write (NanoSeconds (1000000007ULL * i), Create<Packet> (data, 10 * i));
+        }
+      wrappers[0]->Close ();
+      wrappers[1]->Close ();
+
+      std::ifstream is (filename.c_str (), std::ios::in | std::ios::binary);
+      std::vector<uint8_t> file ((std::istreambuf_iterator<char> (is)), std::istreambuf_iterator<char> ());
+
+      NS_TEST_ASSERT_MSG_GT (file.size (), 28, "The file is truncated");
+      NS_TEST_EXPECT_MSG_EQ (Get32 (file, 0), 0x0a0d0d0a, "Missing Section Header Block");
+      NS_TEST_EXPECT_MSG_EQ (Get32 (file, 8), 0x1a2b3c4d, "Wrong byte order magic");
+      uint32_t offset = 28;
+      uint32_t packets = 0;
+      for (uint32_t block = 0; offset + 12 <= file.size (); ++block)
+        {
+          uint32_t type = Get32 (file, offset);
+          uint32_t length = Get32 (file, offset + 4);
+          NS_TEST_ASSERT_MSG_LT_OR_EQ (offset + length, file.size (), "Block " << block << " is truncated");
+          NS_TEST_EXPECT_MSG_EQ (Get32 (file, offset + length - 4), length, "Wrong trailing length of block " << block);
+          NS_TEST_EXPECT_MSG_EQ (length % 4, 0, "Block " << block << " not padded");
+          if (block < 2)
+            {
+              NS_TEST_EXPECT_MSG_EQ (type, 1, "Missing Interface Description Block " << block);
+              NS_TEST_EXPECT_MSG_EQ (Get32 (file, offset + 8), (105 + block), "Wrong link type of interface " << block);
+              NS_TEST_EXPECT_MSG_EQ (Get32 (file, offset + 12), 100, "Wrong snap length of interface " << block);
+            }
+          else
+            {
+              uint32_t i = packets++;
+              uint64_t ns = (uint64_t (Get32 (file, offset + 12)) << 32) | Get32 (file, offset + 16);
+              uint32_t inclLen = Get32 (file, offset + 20);
+              NS_TEST_EXPECT_MSG_EQ (type, 6, "Missing Enhanced Packet Block " << i);
+              NS_TEST_EXPECT_MSG_EQ (Get32 (file, offset + 8), (i % 2), "Wrong interface of packet " << i);
+              NS_TEST_EXPECT_MSG_EQ (ns, 1000000007ULL * i, "Wrong timestamp of packet " << i);
+              NS_TEST_EXPECT_MSG_EQ (Get32 (file, offset + 24), 10 * i, "Wrong length of packet " << i);
+              NS_TEST_EXPECT_MSG_EQ (inclLen, std::min<uint32_t> (10 * i, 100), "Packet " << i << " not truncated");
+              NS_TEST_EXPECT_MSG_EQ (std::memcmp (&file[offset + 28], data, inclLen), 0, "Wrong data of packet " << i);
+            }
+          offset += length;
+        }
+      NS_TEST_EXPECT_MSG_EQ (offset, file.size (), "Trailing bytes in the file");
+      NS_TEST_EXPECT_MSG_EQ (packets, 20, "Missing packets");
+    }
+  std::remove (filename.c_str ());
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Test case to make sure that the synthetic payload of the packets
+ * is left out of the pcap and pcapng records, if asked to.
+ */
+class PcapSyntheticPayloadTestCase : public TestCase
+{
+public:
+  PcapSyntheticPayloadTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+PcapSyntheticPayloadTestCase::PcapSyntheticPayloadTestCase ()
+  : TestCase ("Check that the synthetic payload of the packets is left out of the records")
+{
+}
+
+void
+PcapSyntheticPayloadTestCase::DoRun (void)
+{
+  uint8_t header[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+  Ptr<Packet> synthetic = Create<Packet> (header, sizeof (header));
+  synthetic->AddAtEnd (Create<Packet> (1000));
+  Ptr<Packet> real = Create<Packet> (header, sizeof (header));
+  NS_TEST_ASSERT_MSG_EQ (synthetic->GetSyntheticPayloadOffset (), 8, "Wrong synthetic payload offset");
+  NS_TEST_ASSERT_MSG_EQ (synthetic->GetSyntheticPayloadSize (), 1000, "Wrong synthetic payload size");
+  NS_TEST_ASSERT_MSG_EQ (real->GetSyntheticPayloadOffset (), 8, "Synthetic payload in a real packet");
+  NS_TEST_ASSERT_MSG_EQ (real->GetSyntheticPayloadSize (), 0, "Synthetic payload in a real packet");
+
+  // pcap file: the records hold the headers only
+  std::string filename = CreateTempDirFilename ("synthetic.pcap");
+  Ptr<PcapFileWrapper> wrapper = CreateObjectWithAttributes<PcapFileWrapper> ("TruncateSyntheticPayload",
+                                                                              BooleanValue (true));
+  wrapper->Open (filename, std::ios::out);
+  wrapper->Init (1, 100);
+  wrapper->Write (Seconds (1), synthetic);
+  wrapper->Write (Seconds (2), real);
+  wrapper->Close ();
+
+  PcapFile file;
+  file.Open (filename, std::ios::in);
+  NS_TEST_ASSERT_MSG_EQ (file.Fail (), false, "Open of " << filename << " failed");
+  uint8_t data[100];
+  uint32_t expected[2][2] = { { 8, 1008 }, { 8, 8 } };
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      uint32_t tsSec, tsUsec, inclLen, origLen, readLen;
+      file.Read (data, sizeof (data), tsSec, tsUsec, inclLen, origLen, readLen);
+      NS_TEST_ASSERT_MSG_EQ (file.Fail (), false, "Read of packet " << i << " failed");
+      NS_TEST_EXPECT_MSG_EQ (inclLen, expected[i][0], "Wrong captured length of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (origLen, expected[i][1], "Wrong length of packet " << i);
+      NS_TEST_EXPECT_MSG_EQ (std::memcmp (data, header, sizeof (header)), 0, "Wrong data of packet " << i);
+    }
+  file.Close ();
+  std::remove (filename.c_str ());
+
+  // pcapng file: only the interface asking for it truncates the records
+  filename = CreateTempDirFilename ("synthetic.pcapng");
+  Ptr<PcapFileWrapper> wrappers[2];
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      wrappers[i] = CreateObjectWithAttributes<PcapFileWrapper> ("PcapngFile", StringValue (filename),
+                                                                 "TruncateSyntheticPayload", BooleanValue (i == 0));
+      wrappers[i]->Open (i == 0 ? "truncated" : "full", std::ios::out);
+      wrappers[i]->Init (1, 2000);
+      wrappers[i]->Write (Seconds (i), synthetic);
+    }
+  wrappers[0]->Close ();
+  wrappers[1]->Close ();
+
+  std::ifstream is (filename.c_str (), std::ios::in | std::ios::binary);
+  std::vector<uint8_t> blocks ((std::istreambuf_iterator<char> (is)), std::istreambuf_iterator<char> ());
+  uint32_t offset = 28;
+  uint32_t packets = 0;
+  while (offset + 12 <= blocks.size ())
+    {
+      uint32_t type;
+      uint32_t length;
+      std::memcpy (&type, &blocks[offset], 4);
+      std::memcpy (&length, &blocks[offset + 4], 4);
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (offset + length, blocks.size (), "Block at " << offset << " is truncated");
+      if (type == 6)
+        {
+          uint32_t inclLen;
+          uint32_t origLen;
+          std::memcpy (&inclLen, &blocks[offset + 20], 4);
+          std::memcpy (&origLen, &blocks[offset + 24], 4);
+          NS_TEST_EXPECT_MSG_EQ (inclLen, (packets == 0 ? 8 : 1008), "Wrong captured length of packet " << packets);
+          NS_TEST_EXPECT_MSG_EQ (origLen, 1008, "Wrong length of packet " << packets);
+          NS_TEST_EXPECT_MSG_EQ (std::memcmp (&blocks[offset + 28], header, sizeof (header)), 0,
+                                 "Wrong data of packet " << packets);
+          packets++;
+        }
+      offset += length;
+    }
+  NS_TEST_EXPECT_MSG_EQ (packets, 2, "Missing packets");
+  std::remove (filename.c_str ());
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief pcapng file TestSuite
+ */
+class PcapngFileTestSuite : public TestSuite
+{
+public:
+  PcapngFileTestSuite ();
+};
+
+PcapngFileTestSuite::PcapngFileTestSuite ()
+  : TestSuite ("pcapng-file", UNIT)
+{
+  AddTestCase (new PcapngSharedFileTestCase, TestCase::QUICK);
+  AddTestCase (new PcapSyntheticPayloadTestCase, TestCase::QUICK);
+}
+
+static PcapngFileTestSuite pcapngFileTestSuite; //!< Static variable for test initialization
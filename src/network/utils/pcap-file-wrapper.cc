@@ -19,6 +19,7 @@
 #include "ns3/log.h"
 #include "ns3/boolean.h"
 #include "ns3/uinteger.h"
+#include "ns3/string.h"
 #include "ns3/buffer.h"
 #include "ns3/header.h"
 #include "pcap-file-wrapper.h"
@@ -46,12 +47,39 @@ PcapFileWrapper::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&PcapFileWrapper::m_nanosecMode),
                    MakeBooleanChecker())
+    .AddAttribute ("BufferSize",
+                   "Size of the buffers the packets are written in, before being "
+                   "written to the file; 0 writes each packet as soon as it is traced.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&PcapFileWrapper::m_bufferSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("BackgroundWriter",
+                   "Whether the buffers are written to the file from a background "
+                   "thread, shared by all the files, rather than from the simulation.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PcapFileWrapper::m_background),
+                   MakeBooleanChecker ())
+    .AddAttribute ("PcapngFile",
+                   "Name of a pcapng file the packets are written to, as those of an "
+                   "interface named after the file opened, instead of that file; all "
+                   "the wrappers with the same name share the pcapng file.",
+                   StringValue (""),
+                   MakeStringAccessor (&PcapFileWrapper::m_pcapngName),
+                   MakeStringChecker ())
+    .AddAttribute ("TruncateSyntheticPayload",
+                   "Whether the synthetic payload of the packets, the zero-filled "
+                   "payload of the traffic generators which is not stored in memory, "
+                   "is left out of the records, as if cut by the capture size.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&PcapFileWrapper::m_truncateSynthetic),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
 
 PcapFileWrapper::PcapFileWrapper ()
+  : m_interface (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -66,6 +94,10 @@ bool
 PcapFileWrapper::Fail (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_pcapng != 0)
+    {
+      return m_pcapng->Fail ();
+    }
   return m_file.Fail ();
 }
 
@@ -86,13 +118,36 @@ void
 PcapFileWrapper::Close (void)
 {
   NS_LOG_FUNCTION (this);
+  m_pcapng = 0;
   m_file.Close ();
 }
 
+void
+PcapFileWrapper::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_pcapng != 0)
+    {
+      m_pcapng->Flush ();
+    }
+  else
+    {
+      m_file.Flush ();
+    }
+}
+
 void
 PcapFileWrapper::Open (std::string const &filename, std::ios::openmode mode)
 {
   NS_LOG_FUNCTION (this << filename << mode);
+  m_filename = filename;
+  if (!m_pcapngName.empty () && (mode & std::ios::out))
+    {
+      // the pcapng interface is added by Init
+      return;
+    }
+  m_file.SetBuffering (m_bufferSize, m_background);
+  m_file.SetTruncateSyntheticPayload (m_truncateSynthetic);
   m_file.Open (filename, mode);
 }
 
@@ -105,6 +160,16 @@ PcapFileWrapper::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t tzCorrec
   // a snaplen, we use the one provided.
   //
   NS_LOG_FUNCTION (this << dataLinkType << snapLen << tzCorrection);
+  if (!m_pcapngName.empty ())
+    {
+      m_pcapng = PcapngFile::Get (m_pcapngName, m_bufferSize, m_background);
+      if (snapLen == std::numeric_limits<uint32_t>::max ())
+        {
+          snapLen = m_snapLen;
+        }
+      m_interface = m_pcapng->AddInterface (dataLinkType, snapLen, m_filename, m_truncateSynthetic);
+      return;
+    }
   if (snapLen != std::numeric_limits<uint32_t>::max ())
     {
       m_file.Init (dataLinkType, snapLen, tzCorrection, false, m_nanosecMode);
@@ -119,6 +184,11 @@ void
 PcapFileWrapper::Write (Time t, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << t << p);
+  if (m_pcapng != 0)
+    {
+      m_pcapng->Write (m_interface, t.GetNanoSeconds (), p);
+      return;
+    }
   if (m_file.IsNanoSecMode())
     {
       uint64_t current = t.GetNanoSeconds ();
@@ -139,6 +209,11 @@ void
 PcapFileWrapper::Write (Time t, const Header &header, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << t << &header << p);
+  if (m_pcapng != 0)
+    {
+      m_pcapng->Write (m_interface, t.GetNanoSeconds (), header, p);
+      return;
+    }
   if (m_file.IsNanoSecMode())
     {
       uint64_t current = t.GetNanoSeconds ();
@@ -159,6 +234,11 @@ void
 PcapFileWrapper::Write (Time t, uint8_t const *buffer, uint32_t length)
 {
   NS_LOG_FUNCTION (this << t << &buffer << length);
+  if (m_pcapng != 0)
+    {
+      m_pcapng->Write (m_interface, t.GetNanoSeconds (), buffer, length);
+      return;
+    }
   if (m_file.IsNanoSecMode())
     {
       uint64_t current = t.GetNanoSeconds ();
@@ -27,6 +27,7 @@
 #include "ns3/object.h"
 #include "ns3/nstime.h"
 #include "pcap-file.h"
+#include "pcapng-file.h"
 
 namespace ns3 {
 
@@ -82,6 +83,12 @@ public:
    */
   void Close (void);
 
+  /**
+   * Write the buffered packets to the file, and wait until they are
+   * written, e.g., before the process is forked.
+   */
+  void Flush (void);
+
   /**
    * Initialize the pcap file associated with this wrapper.  This file must have
    * been previously opened with write permissions.
@@ -224,6 +231,13 @@ private:
   PcapFile m_file; //!< Pcap file
   uint32_t m_snapLen; //!< max length of saved packets
   bool     m_nanosecMode; //!< Timestamps in nanosecond mode
+  uint32_t m_bufferSize; //!< size of the write buffers
+  bool     m_background; //!< write the buffers from the background thread
+  bool     m_truncateSynthetic; //!< leave the synthetic payload of the packets out
+  std::string m_pcapngName; //!< name of the shared pcapng file, if any
+  std::string m_filename; //!< name of the file, naming the pcapng interface
+  Ptr<PcapngFile> m_pcapng; //!< shared pcapng file, if any
+  uint32_t m_interface; //!< interface of the packets in the pcapng file
 };
 
 } // namespace ns3
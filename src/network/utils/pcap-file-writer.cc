@@ -0,0 +1,260 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "pcap-file-writer.h"
+#include "ns3/core-config.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+
+#ifdef HAVE_PTHREAD_H
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unistd.h>
+#endif /* HAVE_PTHREAD_H */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PcapFileWriter");
+
+#ifdef HAVE_PTHREAD_H
+
+namespace {
+
+/**
+ * \ingroup network
+ * The thread writing the buffers of all the PcapFileWriter instances.
+ */
+class PcapFileWriterThread
+{
+public:
+  /**
+   * Get the writer thread of this process, started on first use.
+   * \returns The writer thread.
+   */
+  static PcapFileWriterThread *Get (void);
+  /**
+   * Hand a buffer over to the thread.
+   * \param [in] os The stream to write the buffer to.
+   * \param [out] failed Set if writing to the stream fails.
+   * \param [in,out] pending The number of buffers of the stream not written
+   *        yet, incremented now and decremented once the buffer is written.
+   * \param [in,out] buffer The buffer, swapped with an empty buffer.
+   */
+  void Push (std::ostream *os, std::atomic<bool> *failed, uint32_t *pending, std::vector<uint8_t> *buffer);
+  /**
+   * Wait until the buffers of a stream are written.
+   * \param [in] pending The number of buffers of the stream not written yet.
+   */
+  void Wait (uint32_t *pending);
+
+private:
+  PcapFileWriterThread ();
+  /** Write the buffers handed over, until the process exits. */
+  void Run (void);
+
+  /** A buffer to write. */
+  struct Job
+  {
+    std::ostream *os;          //!< The stream to write the buffer to.
+    std::atomic<bool> *failed; //!< Set if writing to the stream fails.
+    uint32_t *pending;         //!< The number of buffers of the stream not written yet.
+    std::vector<uint8_t> data; //!< The buffer.
+  };
+
+  std::mutex m_mutex;                        //!< Mutex protecting the queues.
+  std::condition_variable m_work;            //!< Signaled when a job is pushed.
+  std::condition_variable m_done;            //!< Signaled when a job is written.
+  std::deque<Job> m_jobs;                    //!< The buffers to write.
+  std::vector<std::vector<uint8_t> > m_free; //!< The buffers written, to be reused.
+  std::thread m_thread;                      //!< The thread.
+};
+
+PcapFileWriterThread *
+PcapFileWriterThread::Get (void)
+{
+  // the thread is not copied by fork(), hence a new one in the child
+  // processes; it is never joined, so the process may exit while it
+  // waits for work
+  static PcapFileWriterThread *thread = 0;
+  static pid_t pid = 0;
+  if (thread == 0 || pid != getpid ())
+    {
+      thread = new PcapFileWriterThread ();
+      pid = getpid ();
+    }
+  return thread;
+}
+
+PcapFileWriterThread::PcapFileWriterThread ()
+{
+  m_thread = std::thread (&PcapFileWriterThread::Run, this);
+  m_thread.detach ();
+}
+
+void
+PcapFileWriterThread::Push (std::ostream *os, std::atomic<bool> *failed, uint32_t *pending, std::vector<uint8_t> *buffer)
+{
+  std::unique_lock<std::mutex> lock (m_mutex);
+  m_jobs.push_back (Job ());
+  Job &job = m_jobs.back ();
+  job.os = os;
+  job.failed = failed;
+  job.pending = pending;
+  job.data.swap (*buffer);
+  (*pending)++;
+  if (!m_free.empty ())
+    {
+      buffer->swap (m_free.back ());
+      m_free.pop_back ();
+    }
+  m_work.notify_one ();
+}
+
+void
+PcapFileWriterThread::Wait (uint32_t *pending)
+{
+  std::unique_lock<std::mutex> lock (m_mutex);
+  while (*pending > 0)
+    {
+      m_done.wait (lock);
+    }
+}
+
+void
+PcapFileWriterThread::Run (void)
+{
+  std::unique_lock<std::mutex> lock (m_mutex);
+  while (true)
+    {
+      while (m_jobs.empty ())
+        {
+          m_work.wait (lock);
+        }
+      Job job;
+      job.os = m_jobs.front ().os;
+      job.failed = m_jobs.front ().failed;
+      job.pending = m_jobs.front ().pending;
+      job.data.swap (m_jobs.front ().data);
+      m_jobs.pop_front ();
+
+      lock.unlock ();
+      job.os->write (reinterpret_cast<const char *> (job.data.data ()), job.data.size ());
+      if (job.os->fail ())
+        {
+          job.failed->store (true);
+        }
+      job.data.clear ();
+      lock.lock ();
+
+      (*job.pending)--;
+      m_free.push_back (std::vector<uint8_t> ());
+      m_free.back ().swap (job.data);
+      m_done.notify_all ();
+    }
+}
+
+} // unnamed namespace
+
+#endif /* HAVE_PTHREAD_H */
+
+
+PcapFileWriter::PcapFileWriter (std::ostream *os, uint32_t bufferSize, bool background)
+  : m_os (os),
+    m_bufferSize (bufferSize),
+    m_background (background),
+    m_pending (0),
+    m_failed (false)
+{
+  NS_LOG_FUNCTION (this << os << bufferSize << background);
+#ifndef HAVE_PTHREAD_H
+  m_background = false;
+#endif /* HAVE_PTHREAD_H */
+  if (m_bufferSize == 0)
+    {
+      m_background = false;
+    }
+  m_buffer.reserve (m_bufferSize);
+}
+
+PcapFileWriter::~PcapFileWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  Flush ();
+  Wait ();
+}
+
+uint8_t *
+PcapFileWriter::Reserve (uint32_t size)
+{
+  size_t offset = m_buffer.size ();
+  m_buffer.resize (offset + size);
+  return &m_buffer[offset];
+}
+
+void
+PcapFileWriter::Commit (void)
+{
+  if (m_buffer.size () >= m_bufferSize)
+    {
+      Flush ();
+    }
+}
+
+void
+PcapFileWriter::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_buffer.empty ())
+    {
+      return;
+    }
+#ifdef HAVE_PTHREAD_H
+  if (m_background)
+    {
+      PcapFileWriterThread::Get ()->Push (m_os, &m_failed, &m_pending, &m_buffer);
+      m_buffer.reserve (m_bufferSize);
+      return;
+    }
+#endif /* HAVE_PTHREAD_H */
+  m_os->write (reinterpret_cast<const char *> (m_buffer.data ()), m_buffer.size ());
+  m_buffer.clear ();
+}
+
+void
+PcapFileWriter::Wait (void)
+{
+  NS_LOG_FUNCTION (this);
+#ifdef HAVE_PTHREAD_H
+  if (m_background)
+    {
+      PcapFileWriterThread::Get ()->Wait (&m_pending);
+    }
+#endif /* HAVE_PTHREAD_H */
+}
+
+bool
+PcapFileWriter::Fail (void) const
+{
+  if (m_background)
+    {
+      return m_failed.load ();
+    }
+  return m_os->fail ();
+}
+
+} // namespace ns3
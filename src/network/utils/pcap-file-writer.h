@@ -0,0 +1,106 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAP_FILE_WRITER_H
+#define PCAP_FILE_WRITER_H
+
+#include <atomic>
+#include <ostream>
+#include <vector>
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ *
+ * \brief Buffers the records of a trace file, and writes them to the file
+ * in large blocks, optionally from a background thread.
+ *
+ * The records are serialized directly in the buffer, at the location
+ * returned by Reserve().  When the buffer holds at least its size, it is
+ * handed over to the writer thread, shared by all the files, and a new
+ * buffer is used, so that the simulation thread never waits for the
+ * disk.  Without threading support, the buffers are written synchronously.
+ */
+class PcapFileWriter
+{
+public:
+  /**
+   * \param os The stream of the file.
+   * \param bufferSize The size of the buffers, in bytes.  If 0, each record
+   *        is written to the file as soon as it is complete.
+   * \param background Write the buffers from the background thread.
+   */
+  PcapFileWriter (std::ostream *os, uint32_t bufferSize, bool background);
+  /** Write the buffered records, and wait until they are written. */
+  ~PcapFileWriter ();
+
+  /**
+   * \brief Reserve room for a record at the end of the buffer.
+   * \param size The size of the record.
+   * \returns The location of the record, valid until Commit() is called.
+   */
+  uint8_t *Reserve (uint32_t size);
+  /**
+   * \brief Complete the record of the last Reserve(), and write the buffer
+   * if it is full.
+   */
+  void Commit (void);
+  /**
+   * \brief Hand the buffered records over to the writer thread, or write
+   * them to the file.
+   */
+  void Flush (void);
+  /**
+   * \brief Wait until all the records handed over to the writer thread
+   * are written to the file.
+   */
+  void Wait (void);
+  /**
+   * \brief Check whether writing to the file failed.
+   *
+   * Once buffers are handed over to the writer thread, only that thread
+   * touches the stream, and it reports its errors through a flag.
+   *
+   * \returns true if a write failed
+   */
+  bool Fail (void) const;
+
+private:
+  /**
+   * Copy constructor, not implemented.
+   * \param o The object to copy.
+   */
+  PcapFileWriter (const PcapFileWriter &o);
+  /**
+   * Assignment operator, not implemented.
+   * \param o The object to copy.
+   * \returns This object.
+   */
+  PcapFileWriter & operator = (const PcapFileWriter &o);
+
+  std::ostream *m_os;            //!< The stream of the file.
+  std::vector<uint8_t> m_buffer; //!< The buffered records.
+  uint32_t m_bufferSize;         //!< The size of the buffers.
+  bool m_background;             //!< Write the buffers from the background thread.
+  uint32_t m_pending;            //!< Number of buffers not written yet by the thread.
+  std::atomic<bool> m_failed;    //!< Whether the writer thread failed to write a buffer.
+};
+
+} // namespace ns3
+
+#endif /* PCAP_FILE_WRITER_H */
@@ -27,6 +27,7 @@
 #include "ns3/header.h"
 #include "ns3/buffer.h"
 #include "pcap-file.h"
+#include "pcap-file-writer.h"
 #include "ns3/log.h"
 #include "ns3/build-profile.h"
 //
@@ -50,7 +51,11 @@ const uint16_t VERSION_MINOR = 4;             /**< Minor version of supported pc
 PcapFile::PcapFile ()
   : m_file (),
     m_swapMode (false),
-    m_nanosecMode (false)
+    m_nanosecMode (false),
+    m_writer (0),
+    m_bufferSize (0),
+    m_background (false),
+    m_truncateSynthetic (false)
 {
   NS_LOG_FUNCTION (this);
   FatalImpl::RegisterStream (&m_file); 
@@ -68,6 +73,15 @@ bool
 PcapFile::Fail (void) const
 {
   NS_LOG_FUNCTION (this);
+  if (m_writer != 0)
+    {
+      // the file is not touched by the writer thread once it is done
+      m_writer->Wait ();
+      if (m_writer->Fail ())
+        {
+          return true;
+        }
+    }
   return m_file.fail ();
 }
 bool 
@@ -88,9 +102,50 @@ void
 PcapFile::Close (void)
 {
   NS_LOG_FUNCTION (this);
+  // the writer writes the buffered records when destroyed
+  delete m_writer;
+  m_writer = 0;
   m_file.close ();
 }
 
+void
+PcapFile::SetBuffering (uint32_t bufferSize, bool background)
+{
+  NS_LOG_FUNCTION (this << bufferSize << background);
+  m_bufferSize = bufferSize;
+  m_background = background;
+  if (m_writer != 0)
+    {
+      delete m_writer;
+      m_writer = new PcapFileWriter (&m_file, m_bufferSize, m_background);
+    }
+}
+
+void
+PcapFile::SetTruncateSyntheticPayload (bool truncate)
+{
+  NS_LOG_FUNCTION (this << truncate);
+  m_truncateSynthetic = truncate;
+}
+
+uint32_t
+PcapFile::GetCaptureLength (Ptr<const Packet> p) const
+{
+  return m_truncateSynthetic ? p->GetSyntheticPayloadOffset () : p->GetSize ();
+}
+
+void
+PcapFile::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_writer != 0)
+    {
+      m_writer->Flush ();
+      m_writer->Wait ();
+    }
+  m_file.flush ();
+}
+
 uint32_t
 PcapFile::GetMagic (void)
 {
@@ -334,6 +389,8 @@ PcapFile::Open (std::string const &filename, std::ios::openmode mode)
 
   m_filename=filename;
   m_file.open (filename.c_str (), mode);
+  delete m_writer;
+  m_writer = new PcapFileWriter (&m_file, m_bufferSize, m_background);
   if (mode & std::ios::in)
     {
       // will set the fail bit if file header is invalid.
@@ -399,13 +456,14 @@ PcapFile::Init (uint32_t dataLinkType, uint32_t snapLen, int32_t timeZoneCorrect
   WriteFileHeader ();
 }
 
-uint32_t
-PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
+uint8_t *
+PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen, uint32_t capLen, uint32_t &inclLen)
 {
-  NS_LOG_FUNCTION (this << tsSec << tsUsec << totalLen);
-  NS_ASSERT (m_file.good ());
+  NS_LOG_FUNCTION (this << tsSec << tsUsec << totalLen << capLen);
+  NS_ASSERT (m_writer != 0);
+  NS_ASSERT (!m_writer->Fail ());
 
-  uint32_t inclLen = totalLen > m_fileHeader.m_snapLen ? m_fileHeader.m_snapLen : totalLen;
+  inclLen = capLen > m_fileHeader.m_snapLen ? m_fileHeader.m_snapLen : capLen;
 
   PcapRecordHeader header;
   header.m_tsSec = tsSec;
@@ -419,33 +477,43 @@ PcapFile::WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen)
     }
 
   //
-  // Watch out for memory alignment differences between machines, so write
-  // them all individually.
+  // The header and the data are written in a single record, only the data
+  // saved in the file being copied.  Watch out for memory alignment
+  // differences between machines, so copy the fields individually.
   //
-  m_file.write ((const char *)&header.m_tsSec, sizeof(header.m_tsSec));
-  m_file.write ((const char *)&header.m_tsUsec, sizeof(header.m_tsUsec));
-  m_file.write ((const char *)&header.m_inclLen, sizeof(header.m_inclLen));
-  m_file.write ((const char *)&header.m_origLen, sizeof(header.m_origLen));
-  NS_BUILD_DEBUG(m_file.flush());
-  return inclLen;
+  uint8_t *record = m_writer->Reserve (16 + inclLen);
+  std::memcpy (record, &header.m_tsSec, sizeof(header.m_tsSec));
+  std::memcpy (record + 4, &header.m_tsUsec, sizeof(header.m_tsUsec));
+  std::memcpy (record + 8, &header.m_inclLen, sizeof(header.m_inclLen));
+  std::memcpy (record + 12, &header.m_origLen, sizeof(header.m_origLen));
+  return record + 16;
+}
+
+void
+PcapFile::CommitRecord (void)
+{
+  m_writer->Commit ();
+  NS_BUILD_DEBUG (if (m_bufferSize == 0) m_file.flush ());
 }
 
 void
 PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, uint8_t const * const data, uint32_t totalLen)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << &data << totalLen);
-  uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, totalLen);
-  m_file.write ((const char *)data, inclLen);
-  NS_BUILD_DEBUG(m_file.flush());
+  uint32_t inclLen;
+  uint8_t *record = WritePacketHeader (tsSec, tsUsec, totalLen, totalLen, inclLen);
+  std::memcpy (record, data, inclLen);
+  CommitRecord ();
 }
 
 void 
 PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, Ptr<const Packet> p)
 {
   NS_LOG_FUNCTION (this << tsSec << tsUsec << p);
-  uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, p->GetSize ());
-  p->CopyData (&m_file, inclLen);
-  NS_BUILD_DEBUG(m_file.flush());
+  uint32_t inclLen;
+  uint8_t *record = WritePacketHeader (tsSec, tsUsec, p->GetSize (), GetCaptureLength (p), inclLen);
+  p->CopyData (record, inclLen);
+  CommitRecord ();
 }
 
 void 
@@ -454,15 +522,16 @@ PcapFile::Write (uint32_t tsSec, uint32_t tsUsec, const Header &header, Ptr<cons
   NS_LOG_FUNCTION (this << tsSec << tsUsec << &header << p);
   uint32_t headerSize = header.GetSerializedSize ();
   uint32_t totalSize = headerSize + p->GetSize ();
-  uint32_t inclLen = WritePacketHeader (tsSec, tsUsec, totalSize);
+  uint32_t inclLen;
+  uint8_t *record = WritePacketHeader (tsSec, tsUsec, totalSize, headerSize + GetCaptureLength (p), inclLen);
 
   Buffer headerBuffer;
   headerBuffer.AddAtStart (headerSize);
   header.Serialize (headerBuffer.Begin ());
   uint32_t toCopy = std::min (headerSize, inclLen);
-  headerBuffer.CopyData (&m_file, toCopy);
-  inclLen -= toCopy;
-  p->CopyData (&m_file, inclLen);
+  headerBuffer.CopyData (record, toCopy);
+  p->CopyData (record + toCopy, inclLen - toCopy);
+  CommitRecord ();
 }
 
 void
@@ -476,6 +545,11 @@ PcapFile::Read (
   uint32_t &readLen)
 {
   NS_LOG_FUNCTION (this << &data <<maxBytes << tsSec << tsUsec << inclLen << origLen << readLen);
+  if (m_writer != 0)
+    {
+      // the file is not touched by the writer thread once it is done
+      m_writer->Wait ();
+    }
   NS_ASSERT (m_file.good ());
 
   PcapRecordHeader header;
@@ -30,6 +30,7 @@ namespace ns3 {
 
 class Packet;
 class Header;
+class PcapFileWriter;
 
 
 /**
@@ -81,10 +82,46 @@ public:
   void Open (std::string const &filename, std::ios::openmode mode);
 
   /**
-   * Close the underlying file.
+   * Close the underlying file, after writing the buffered records.
    */
   void Close (void);
 
+  /**
+   * \brief Buffer the records written, instead of writing each record as
+   * soon as it is complete.
+   *
+   * The records are serialized in buffers of \p bufferSize bytes, which
+   * are written to the file when full, from the calling thread or from a
+   * background thread shared by all the files.  The buffered records are
+   * written by Flush() and Close().
+   *
+   * \param bufferSize The size of the buffers, in bytes; 0 disables the
+   *        buffering.
+   * \param background Write the buffers from the background thread.
+   */
+  void SetBuffering (uint32_t bufferSize, bool background);
+
+  /**
+   * \brief Leave the synthetic payload of the packets out of the records.
+   *
+   * The records of the packets with a synthetic payload (see
+   * Packet::GetSyntheticPayloadOffset) are truncated in front of it, as
+   * if by the snap length, so that only the headers of the packets of
+   * the traffic generators are copied and written.
+   *
+   * \param truncate Whether the synthetic payload is left out.
+   */
+  void SetTruncateSyntheticPayload (bool truncate);
+
+  /**
+   * \brief Write the buffered records to the file, and wait until they
+   * are written.
+   *
+   * This must be called before the file is read, or the process forked,
+   * while the file is open.
+   */
+  void Flush (void);
+
   /**
    * Initialize the pcap file associated with this object.  This file must have
    * been previously opened with write permissions.
@@ -349,17 +386,31 @@ private:
    */
   void WriteFileHeader (void);
   /**
-   * \brief Write a Pcap packet header
+   * \brief Reserve a record in the write buffer, and write its Pcap packet
+   * header
    *
-   * The pcap header has a fixed length of 24 bytes. The last 4 bytes
-   * represent the link-layer type
+   * The header is followed by the room for the packet data, truncated to
+   * the snap length, to be filled before calling CommitRecord().
    *
    * \param tsSec Time stamp (seconds part)
    * \param tsUsec Time stamp (microseconds part)
    * \param totalLen total packet length
-   * \returns the length of the packet to write in the Pcap file
+   * \param capLen the length of the packet worth writing, before the snap length
+   * \param inclLen [out] the length of the packet to write in the Pcap file
+   * \returns the location of the packet data
+   */
+  uint8_t *WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen, uint32_t capLen, uint32_t &inclLen);
+  /**
+   * \brief Get the length of a packet worth writing, before the snap length.
+   * \param p the packet
+   * \returns the length of the packet, or of its headers if its synthetic
+   *          payload is left out
+   */
+  uint32_t GetCaptureLength (Ptr<const Packet> p) const;
+  /**
+   * \brief Complete the record of the last WritePacketHeader().
    */
-  uint32_t WritePacketHeader (uint32_t tsSec, uint32_t tsUsec, uint32_t totalLen);
+  void CommitRecord (void);
 
   /**
    * \brief Read and verify a Pcap file header
@@ -371,6 +422,10 @@ private:
   PcapFileHeader m_fileHeader;  //!< file header
   bool m_swapMode;              //!< swap mode
   bool m_nanosecMode;           //!< nanosecond timestamp mode
+  PcapFileWriter *m_writer;     //!< the writer of the records, if open
+  uint32_t m_bufferSize;        //!< size of the write buffers
+  bool m_background;            //!< write the buffers from the background thread
+  bool m_truncateSynthetic;     //!< leave the synthetic payload of the packets out
 };
 
 } // namespace ns3
@@ -0,0 +1,254 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstring>
+#include <map>
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/fatal-impl.h"
+#include "ns3/packet.h"
+#include "ns3/header.h"
+#include "ns3/buffer.h"
+#include "pcapng-file.h"
+#include "pcap-file-writer.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PcapngFile");
+
+const uint32_t SECTION_HEADER_BLOCK = 0x0a0d0d0a;   /**< Type of the Section Header Block */
+const uint32_t INTERFACE_DESCRIPTION_BLOCK = 1;     /**< Type of the Interface Description Block */
+const uint32_t ENHANCED_PACKET_BLOCK = 6;           /**< Type of the Enhanced Packet Block */
+const uint32_t BYTE_ORDER_MAGIC = 0x1a2b3c4d;       /**< Byte order magic of the sections */
+const uint16_t OPTION_END = 0;                      /**< End of the options */
+const uint16_t OPTION_IF_NAME = 2;                  /**< Name of the interface */
+const uint16_t OPTION_IF_TSRESOL = 9;               /**< Resolution of the timestamps */
+
+namespace {
+
+/**
+ * The pcapng files open, by name.
+ * \returns The files.
+ */
+std::map<std::string, PcapngFile *> &
+GetPcapngFiles (void)
+{
+  static std::map<std::string, PcapngFile *> files;
+  return files;
+}
+
+/**
+ * Round a length up to a multiple of 4 bytes.
+ * \param [in] length The length.
+ * \returns The padded length.
+ */
+uint32_t
+Pad (uint32_t length)
+{
+  return (length + 3) & ~3U;
+}
+
+/**
+ * Write a 16 bit field of a block.
+ * \param [in,out] p The location of the field, moved past it.
+ * \param [in] value The value of the field.
+ */
+void
+Put16 (uint8_t *&p, uint16_t value)
+{
+  std::memcpy (p, &value, sizeof (value));
+  p += sizeof (value);
+}
+
+/**
+ * Write a 32 bit field of a block.
+ * \param [in,out] p The location of the field, moved past it.
+ * \param [in] value The value of the field.
+ */
+void
+Put32 (uint8_t *&p, uint32_t value)
+{
+  std::memcpy (p, &value, sizeof (value));
+  p += sizeof (value);
+}
+
+} // unnamed namespace
+
+Ptr<PcapngFile>
+PcapngFile::Get (std::string const &filename, uint32_t bufferSize, bool background)
+{
+  NS_LOG_FUNCTION (filename << bufferSize << background);
+  std::map<std::string, PcapngFile *>::const_iterator it = GetPcapngFiles ().find (filename);
+  if (it != GetPcapngFiles ().end ())
+    {
+      return Ptr<PcapngFile> (it->second);
+    }
+  Ptr<PcapngFile> file = Ptr<PcapngFile> (new PcapngFile (filename, bufferSize, background), false);
+  GetPcapngFiles ()[filename] = PeekPointer (file);
+  return file;
+}
+
+PcapngFile::PcapngFile (std::string const &filename, uint32_t bufferSize, bool background)
+  : m_filename (filename)
+{
+  NS_LOG_FUNCTION (this << filename << bufferSize << background);
+  FatalImpl::RegisterStream (&m_file);
+  m_file.open (filename.c_str (), std::ios::out | std::ios::binary);
+  m_writer = new PcapFileWriter (&m_file, bufferSize, background);
+
+  uint8_t *p = m_writer->Reserve (28);
+  Put32 (p, SECTION_HEADER_BLOCK);
+  Put32 (p, 28);
+  Put32 (p, BYTE_ORDER_MAGIC);
+  Put16 (p, 1);
+  Put16 (p, 0);
+  // unknown section length
+  Put32 (p, 0xffffffff);
+  Put32 (p, 0xffffffff);
+  Put32 (p, 28);
+  m_writer->Commit ();
+}
+
+PcapngFile::~PcapngFile ()
+{
+  NS_LOG_FUNCTION (this);
+  GetPcapngFiles ().erase (m_filename);
+  delete m_writer;
+  FatalImpl::UnregisterStream (&m_file);
+  m_file.close ();
+}
+
+bool
+PcapngFile::Fail (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_file.fail ();
+}
+
+uint32_t
+PcapngFile::AddInterface (uint32_t dataLinkType, uint32_t snapLen, std::string const &name,
+                          bool truncateSynthetic)
+{
+  NS_LOG_FUNCTION (this << dataLinkType << snapLen << name << truncateSynthetic);
+  uint32_t nameLength = name.size ();
+  uint32_t length = 20 + 4 + Pad (nameLength) + 4 + 4 + 4;
+
+  uint8_t *p = m_writer->Reserve (length);
+  std::memset (p, 0, length);
+  Put32 (p, INTERFACE_DESCRIPTION_BLOCK);
+  Put32 (p, length);
+  Put16 (p, dataLinkType);
+  Put16 (p, 0);
+  Put32 (p, snapLen);
+  Put16 (p, OPTION_IF_NAME);
+  Put16 (p, nameLength);
+  std::memcpy (p, name.data (), nameLength);
+  p += Pad (nameLength);
+  Put16 (p, OPTION_IF_TSRESOL);
+  Put16 (p, 1);
+  *p = 9;
+  p += 4;
+  Put16 (p, OPTION_END);
+  Put16 (p, 0);
+  Put32 (p, length);
+  m_writer->Commit ();
+
+  m_snapLens.push_back (snapLen);
+  m_truncateSynthetic.push_back (truncateSynthetic);
+  return m_snapLens.size () - 1;
+}
+
+uint32_t
+PcapngFile::GetCaptureLength (uint32_t interface, Ptr<const Packet> p) const
+{
+  NS_ASSERT (interface < m_truncateSynthetic.size ());
+  return m_truncateSynthetic[interface] ? p->GetSyntheticPayloadOffset () : p->GetSize ();
+}
+
+uint8_t *
+PcapngFile::WritePacketBlock (uint32_t interface, uint64_t ns, uint32_t totalLen, uint32_t capLen,
+                              uint32_t &inclLen)
+{
+  NS_LOG_FUNCTION (this << interface << ns << totalLen << capLen);
+  NS_ASSERT (interface < m_snapLens.size ());
+  uint32_t snapLen = m_snapLens[interface];
+  inclLen = (snapLen != 0 && capLen > snapLen) ? snapLen : capLen;
+  uint32_t length = 28 + Pad (inclLen) + 4;
+
+  uint8_t *p = m_writer->Reserve (length);
+  Put32 (p, ENHANCED_PACKET_BLOCK);
+  Put32 (p, length);
+  Put32 (p, interface);
+  Put32 (p, ns >> 32);
+  Put32 (p, ns & 0xffffffff);
+  Put32 (p, inclLen);
+  Put32 (p, totalLen);
+  // padding and trailing length, the data being filled by the caller
+  std::memset (p + inclLen, 0, Pad (inclLen) - inclLen);
+  uint8_t *trailer = p + Pad (inclLen);
+  Put32 (trailer, length);
+  return p;
+}
+
+void
+PcapngFile::Write (uint32_t interface, uint64_t ns, uint8_t const * const data, uint32_t totalLen)
+{
+  NS_LOG_FUNCTION (this << interface << ns << &data << totalLen);
+  uint32_t inclLen;
+  uint8_t *p = WritePacketBlock (interface, ns, totalLen, totalLen, inclLen);
+  std::memcpy (p, data, inclLen);
+  m_writer->Commit ();
+}
+
+void
+PcapngFile::Write (uint32_t interface, uint64_t ns, Ptr<const Packet> packet)
+{
+  NS_LOG_FUNCTION (this << interface << ns << packet);
+  uint32_t inclLen;
+  uint8_t *p = WritePacketBlock (interface, ns, packet->GetSize (),
+                                GetCaptureLength (interface, packet), inclLen);
+  packet->CopyData (p, inclLen);
+  m_writer->Commit ();
+}
+
+void
+PcapngFile::Write (uint32_t interface, uint64_t ns, const Header &header, Ptr<const Packet> packet)
+{
+  NS_LOG_FUNCTION (this << interface << ns << &header << packet);
+  uint32_t headerSize = header.GetSerializedSize ();
+  uint32_t inclLen;
+  uint8_t *p = WritePacketBlock (interface, ns, headerSize + packet->GetSize (),
+                                headerSize + GetCaptureLength (interface, packet), inclLen);
+
+  Buffer headerBuffer;
+  headerBuffer.AddAtStart (headerSize);
+  header.Serialize (headerBuffer.Begin ());
+  uint32_t toCopy = std::min (headerSize, inclLen);
+  headerBuffer.CopyData (p, toCopy);
+  packet->CopyData (p + toCopy, inclLen - toCopy);
+  m_writer->Commit ();
+}
+
+void
+PcapngFile::Flush (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_writer->Flush ();
+  m_writer->Wait ();
+  m_file.flush ();
+}
+
+} // namespace ns3
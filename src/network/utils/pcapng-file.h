@@ -0,0 +1,154 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef PCAPNG_FILE_H
+#define PCAPNG_FILE_H
+
+#include <string>
+#include <fstream>
+#include <vector>
+#include <stdint.h>
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+
+namespace ns3 {
+
+class Packet;
+class Header;
+class PcapFileWriter;
+
+/**
+ * \ingroup network
+ *
+ * \brief A pcapng file, holding the packets of several interfaces
+ *
+ * The file is made of a single section, with an Interface Description
+ * Block per interface, added by AddInterface(), and an Enhanced Packet
+ * Block per packet.  The timestamps are in nanoseconds, and the blocks
+ * are in the byte order of the host.
+ *
+ * The files are shared by name: Get() returns the file of a name,
+ * created on first use, and closed when the last reference is dropped,
+ * so that the PcapFileWrapper instances of all the devices can write to
+ * the same file.
+ */
+class PcapngFile : public SimpleRefCount<PcapngFile>
+{
+public:
+  /**
+   * \brief Get the pcapng file of a name, created if not open yet.
+   *
+   * The buffering parameters are those of PcapFile::SetBuffering, and
+   * are only used when the file is created.
+   *
+   * \param filename The name of the file.
+   * \param bufferSize The size of the write buffers, in bytes.
+   * \param background Write the buffers from the background thread.
+   * \returns The file.
+   */
+  static Ptr<PcapngFile> Get (std::string const &filename, uint32_t bufferSize, bool background);
+
+  ~PcapngFile ();
+
+  /**
+   * \return true if the 'fail' bit is set in the underlying iostream, false otherwise.
+   */
+  bool Fail (void) const;
+
+  /**
+   * \brief Add an interface to the file.
+   *
+   * \param dataLinkType The data link type of the interface, as in
+   *        PcapFile::Init.
+   * \param snapLen The maximum number of octets saved per packet.
+   * \param name The name of the interface.
+   * \param truncateSynthetic Leave the synthetic payload of the packets
+   *        out, as in PcapFile::SetTruncateSyntheticPayload.
+   * \returns The index of the interface, for Write().
+   */
+  uint32_t AddInterface (uint32_t dataLinkType, uint32_t snapLen, std::string const &name,
+                         bool truncateSynthetic = false);
+
+  /**
+   * \brief Write a packet to the file.
+   * \param interface The index of the interface.
+   * \param ns The timestamp, in nanoseconds.
+   * \param data The packet data.
+   * \param totalLen The total packet length.
+   */
+  void Write (uint32_t interface, uint64_t ns, uint8_t const * const data, uint32_t totalLen);
+  /**
+   * \brief Write a packet to the file.
+   * \param interface The index of the interface.
+   * \param ns The timestamp, in nanoseconds.
+   * \param p The packet.
+   */
+  void Write (uint32_t interface, uint64_t ns, Ptr<const Packet> p);
+  /**
+   * \brief Write a packet to the file.
+   * \param interface The index of the interface.
+   * \param ns The timestamp, in nanoseconds.
+   * \param header The header to write, in front of the packet.
+   * \param p The packet.
+   */
+  void Write (uint32_t interface, uint64_t ns, const Header &header, Ptr<const Packet> p);
+
+  /**
+   * \brief Write the buffered blocks to the file, and wait until they
+   * are written.
+   */
+  void Flush (void);
+
+private:
+  /**
+   * Open a file, and write its Section Header Block.
+   * \param filename The name of the file.
+   * \param bufferSize The size of the write buffers, in bytes.
+   * \param background Write the buffers from the background thread.
+   */
+  PcapngFile (std::string const &filename, uint32_t bufferSize, bool background);
+
+  /**
+   * \brief Reserve an Enhanced Packet Block in the write buffer, and write
+   * all but its packet data.
+   * \param interface The index of the interface.
+   * \param ns The timestamp, in nanoseconds.
+   * \param totalLen The total packet length.
+   * \param capLen The length of the packet worth saving, before the snap length.
+   * \param inclLen [out] The length of the packet data saved in the block.
+   * \returns The location of the packet data.
+   */
+  uint8_t *WritePacketBlock (uint32_t interface, uint64_t ns, uint32_t totalLen, uint32_t capLen,
+                             uint32_t &inclLen);
+  /**
+   * \brief Get the length of a packet worth saving, before the snap length.
+   * \param interface The index of the interface.
+   * \param p The packet.
+   * \returns The length of the packet, or of its headers if the interface
+   *          leaves its synthetic payload out.
+   */
+  uint32_t GetCaptureLength (uint32_t interface, Ptr<const Packet> p) const;
+
+  std::string m_filename;             //!< The name of the file.
+  std::fstream m_file;                //!< The file stream.
+  PcapFileWriter *m_writer;           //!< The writer of the blocks.
+  std::vector<uint32_t> m_snapLens;   //!< The snap length of each interface.
+  std::vector<bool> m_truncateSynthetic;  //!< Whether each interface leaves the synthetic payload out.
+};
+
+} // namespace ns3
+
+#endif /* PCAPNG_FILE_H */
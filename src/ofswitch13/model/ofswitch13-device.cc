@@ -1015,7 +1015,7 @@ OFSwitch13Device::SendToSwitchPort (struct packet *pkt, uint32_t portNo,
           // Create a new packet with modified data and copy tags from the
           // original packet.
           NS_LOG_DEBUG ("Packet " << pkt->ns3_uid << " modified by switch.");
-          packet = ofs::PacketFromBuffer (pkt->buffer);
+          packet = ofs::PacketFromBuffer (pkt->buffer, m_pipePkt.GetPacket ());
           OFSwitch13Device::CopyTags (m_pipePkt.GetPacket (), packet);
         }
       else
@@ -108,6 +108,30 @@ PacketFromBuffer (struct ofpbuf *buffer)
   return Create<Packet> ((uint8_t*)buffer->data, buffer->size);
 }
 
+Ptr<Packet>
+PacketFromBuffer (struct ofpbuf *buffer, Ptr<const Packet> original)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  uint8_t *data = (uint8_t*)buffer->data;
+  uint32_t offset = original->GetSyntheticPayloadOffset ();
+  uint32_t size = original->GetSyntheticPayloadSize ();
+  // The payload is still zero-filled if its first byte is zero, and each
+  // of its bytes equals the next one.
+  if (size == 0 || buffer->size != original->GetSize ()
+      || data[offset] != 0 || memcmp (data + offset, data + offset + 1, size - 1))
+    {
+      return PacketFromBuffer (buffer);
+    }
+
+  // Copy the headers and the trailers only, keeping the payload synthetic.
+  uint32_t end = offset + size;
+  Ptr<Packet> packet = Create<Packet> (data, offset);
+  packet->AddAtEnd (Create<Packet> (size));
+  packet->AddAtEnd (Create<Packet> (data + end, buffer->size - end));
+  return packet;
+}
+
 } // namespace ofs
 } // namespace ns3
 
@@ -156,6 +156,19 @@ Ptr<Packet> PacketFromMsg (struct ofl_msg_header *msg, uint32_t xid = 0);
  */
 Ptr<Packet> PacketFromBuffer (struct ofpbuf *buffer);
 
+/**
+ * \ingroup ofswitch13
+ * Create a new ns3::Packet from internal ofsoftswitch13 buffer, holding a
+ * modified copy of an ns-3 packet. When the switch changed neither the size
+ * of the packet nor its synthetic payload (see
+ * Packet::GetSyntheticPayloadOffset), the payload of the new packet is
+ * synthetic as well, and only the bytes around it are copied.
+ * \param buffer The internal buffer.
+ * \param original The ns-3 packet the buffer was created from.
+ * \return The ns3::Packet created.
+ */
+Ptr<Packet> PacketFromBuffer (struct ofpbuf *buffer, Ptr<const Packet> original);
+
 } // namespace ofs
 } // namespace ns3
 #endif /* OFSWITCH13_INTERFACE_H */
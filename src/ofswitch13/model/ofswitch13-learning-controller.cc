@@ -53,103 +53,122 @@ OFSwitch13LearningController::DoDispose ()
 {
   NS_LOG_FUNCTION (this);
 
+  m_arpTable.clear ();
   m_learnedInfo.clear ();
   OFSwitch13Controller::DoDispose ();
 }
 
-ofl_err
-OFSwitch13LearningController::HandlePacketIn (
-  struct ofl_msg_packet_in *msg, Ptr<const RemoteSwitch> swtch,
-  uint32_t xid)
+uint32_t
+OFSwitch13LearningController::LearnL2 (
+  struct ofl_msg_packet_in *msg, Ptr<const RemoteSwitch> swtch)
 {
-  NS_LOG_FUNCTION (this << swtch << xid);
+  NS_LOG_FUNCTION (this << swtch);
 
   static int prio = 100;
   uint32_t outPort = OFPP_FLOOD;
   uint64_t dpId = swtch->GetDpId ();
-  enum ofp_packet_in_reason reason = msg->reason;
 
-  char *msgStr =
-    ofl_structs_match_to_string ((struct ofl_match_header*)msg->match, 0);
-  NS_LOG_DEBUG ("Packet in match: " << msgStr);
-  free (msgStr);
+  // Let's get necessary information (input port and mac address)
+  uint32_t inPort;
+  size_t portLen = OXM_LENGTH (OXM_OF_IN_PORT); // (Always 4 bytes)
+  struct ofl_match_tlv *input =
+    oxm_match_lookup (OXM_OF_IN_PORT, (struct ofl_match*)msg->match);
+  memcpy (&inPort, input->value, portLen);
 
-  if (reason == OFPR_NO_MATCH)
-    {
-      // Let's get necessary information (input port and mac address)
-      uint32_t inPort;
-      size_t portLen = OXM_LENGTH (OXM_OF_IN_PORT); // (Always 4 bytes)
-      struct ofl_match_tlv *input =
-        oxm_match_lookup (OXM_OF_IN_PORT, (struct ofl_match*)msg->match);
-      memcpy (&inPort, input->value, portLen);
+  Mac48Address src48;
+  struct ofl_match_tlv *ethSrc =
+    oxm_match_lookup (OXM_OF_ETH_SRC, (struct ofl_match*)msg->match);
+  src48.CopyFrom (ethSrc->value);
 
-      Mac48Address src48;
-      struct ofl_match_tlv *ethSrc =
-        oxm_match_lookup (OXM_OF_ETH_SRC, (struct ofl_match*)msg->match);
-      src48.CopyFrom (ethSrc->value);
+  Mac48Address dst48;
+  struct ofl_match_tlv *ethDst =
+    oxm_match_lookup (OXM_OF_ETH_DST, (struct ofl_match*)msg->match);
+  dst48.CopyFrom (ethDst->value);
 
-      Mac48Address dst48;
-      struct ofl_match_tlv *ethDst =
-        oxm_match_lookup (OXM_OF_ETH_DST, (struct ofl_match*)msg->match);
-      dst48.CopyFrom (ethDst->value);
+  // Get L2Table for this datapath
+  auto it = m_learnedInfo.find (dpId);
+  if (it != m_learnedInfo.end ())
+    {
+      L2Table_t *l2Table = &it->second;
 
-      // Get L2Table for this datapath
-      auto it = m_learnedInfo.find (dpId);
-      if (it != m_learnedInfo.end ())
+      // Looking for out port based on dst address (except for broadcast)
+      if (!dst48.IsBroadcast ())
         {
-          L2Table_t *l2Table = &it->second;
-
-          // Looking for out port based on dst address (except for broadcast)
-          if (!dst48.IsBroadcast ())
+          auto itDst = l2Table->find (dst48);
+          if (itDst != l2Table->end ())
             {
-              auto itDst = l2Table->find (dst48);
-              if (itDst != l2Table->end ())
-                {
-                  outPort = itDst->second;
-                }
-              else
-                {
-                  NS_LOG_DEBUG ("No L2 info for mac " << dst48 << ". Flood.");
-                }
+              outPort = itDst->second;
             }
+          else
+            {
+              NS_LOG_DEBUG ("No L2 info for mac " << dst48 << ". Flood.");
+            }
+        }
 
-          // Learning port from source address
-          NS_ASSERT_MSG (!src48.IsBroadcast (), "Invalid src broadcast addr");
-          auto itSrc = l2Table->find (src48);
-          if (itSrc == l2Table->end ())
+      // Learning port from source address
+      NS_ASSERT_MSG (!src48.IsBroadcast (), "Invalid src broadcast addr");
+      auto itSrc = l2Table->find (src48);
+      if (itSrc == l2Table->end ())
+        {
+          std::pair<Mac48Address, uint32_t> entry (src48, inPort);
+          auto ret = l2Table->insert (entry);
+          if (ret.second == false)
             {
-              std::pair<Mac48Address, uint32_t> entry (src48, inPort);
-              auto ret = l2Table->insert (entry);
-              if (ret.second == false)
-                {
-                  NS_LOG_ERROR ("Can't insert mac48address / port pair");
-                }
-              else
-                {
-                  NS_LOG_DEBUG ("Learning that mac " << src48 <<
-                                " can be found at port " << inPort);
-
-                  // Send a flow-mod to switch creating this flow. Let's
-                  // configure the flow entry to 10s idle timeout and to
-                  // notify the controller when flow expires. (flags=0x0001)
-                  std::ostringstream cmd;
-                  cmd << "flow-mod cmd=add,table=0,idle=10,flags=0x0001"
-                      << ",prio=" << ++prio << " eth_dst=" << src48
-                      << " apply:output=" << inPort;
-                  DpctlExecute (swtch, cmd.str ());
-                }
+              NS_LOG_ERROR ("Can't insert mac48address / port pair");
             }
           else
             {
-	       //xyy:?
-              //NS_ASSERT_MSG (itSrc->second == inPort,
-               //              "Inconsistent L2 switching table");
+              NS_LOG_DEBUG ("Learning that mac " << src48 <<
+                            " can be found at port " << inPort);
+
+              // Send a flow-mod to switch creating this flow. Let's
+              // configure the flow entry to 10s idle timeout and to
+              // notify the controller when flow expires. (flags=0x0001)
+              std::ostringstream cmd;
+              cmd << "flow-mod cmd=add,table=0,idle=10,flags=0x0001"
+                  << ",prio=" << ++prio << " eth_dst=" << src48
+                  << " apply:output=" << inPort;
+              DpctlExecute (swtch, cmd.str ());
             }
         }
       else
         {
-          NS_LOG_ERROR ("No L2 table for this datapath id " << dpId);
+	   //xyy:?
+          //NS_ASSERT_MSG (itSrc->second == inPort,
+           //              "Inconsistent L2 switching table");
         }
+    }
+  else
+    {
+      NS_LOG_ERROR ("No L2 table for this datapath id " << dpId);
+    }
+  return outPort;
+}
+
+ofl_err
+OFSwitch13LearningController::HandlePacketIn (
+  struct ofl_msg_packet_in *msg, Ptr<const RemoteSwitch> swtch,
+  uint32_t xid)
+{
+  NS_LOG_FUNCTION (this << swtch << xid);
+
+  enum ofp_packet_in_reason reason = msg->reason;
+
+  char *msgStr =
+    ofl_structs_match_to_string ((struct ofl_match_header*)msg->match, 0);
+  NS_LOG_DEBUG ("Packet in match: " << msgStr);
+  free (msgStr);
+
+  if (reason == OFPR_NO_MATCH)
+    {
+      // Learn the source port and look for the destination one
+      uint32_t outPort = LearnL2 (msg, swtch);
+
+      uint32_t inPort;
+      size_t portLen = OXM_LENGTH (OXM_OF_IN_PORT); // (Always 4 bytes)
+      struct ofl_match_tlv *input =
+        oxm_match_lookup (OXM_OF_IN_PORT, (struct ofl_match*)msg->match);
+      memcpy (&inPort, input->value, portLen);
 
       // Lets send the packet out to switch.
       struct ofl_msg_packet_out reply;
@@ -72,11 +72,24 @@ protected:
   // Inherited from OFSwitch13Controller
   void HandshakeSuccessful (Ptr<const RemoteSwitch> swtch);
 
-private:
+  /**
+   * Perform the L2 learning for a packet-in message: learn the port of the
+   * source MAC address, installing a flow entry towards it, and look for the
+   * port of the destination MAC address.
+   *
+   * \param msg The packet-in message.
+   * \param swtch The switch information.
+   * \return The port of the destination, or OFPP_FLOOD if unknown.
+   */
+  uint32_t LearnL2 (struct ofl_msg_packet_in *msg,
+                    Ptr<const RemoteSwitch> swtch);
+
   /** Map saving <IPv4 address / MAC address> */
   typedef std::map<Ipv4Address, Mac48Address> IpMacMap_t;
   IpMacMap_t m_arpTable; //!< ARP resolution table.
 
+private:
+
   /**
    * \name L2 switching structures
    */
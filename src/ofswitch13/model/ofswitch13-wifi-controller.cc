@@ -21,6 +21,12 @@
 #ifdef NS3_OFSWITCH13
 
 #include "ofswitch13-wifi-controller.h"
+#include <ns3/boolean.h>
+#include <ns3/node.h>
+#include <ns3/arp-header.h>
+#include <ns3/arp-l3-protocol.h>
+#include <ns3/ethernet-header.h>
+#include <ns3/ethernet-trailer.h>
 
 NS_LOG_COMPONENT_DEFINE ("OFSwitch13WifiController");
 
@@ -29,6 +35,7 @@ namespace ns3 {
 NS_OBJECT_ENSURE_REGISTERED (OFSwitch13WifiController);
 
 OFSwitch13WifiController::OFSwitch13WifiController()
+	: m_proxyArp (true)
 {
 	NS_LOG_FUNCTION (this);
 	m_wifiNetworkStatus = Create<WifiNetworkStatus>();
@@ -46,7 +53,13 @@ OFSwitch13WifiController::GetTypeId (void)
 	static TypeId tid = TypeId ("ns3::OFSwitch13WifiController")
 						.SetParent<OFSwitch13Controller> ()
 						.SetGroupName ("OFSwitch13")
-						.AddConstructor<OFSwitch13WifiController> ();
+						.AddConstructor<OFSwitch13WifiController> ()
+						.AddAttribute ("ProxyArp",
+									   "Answer the ARP requests at the datapaths "
+									   "instead of flooding them.",
+									   BooleanValue (true),
+									   MakeBooleanAccessor (&OFSwitch13WifiController::m_proxyArp),
+									   MakeBooleanChecker ());
 	return tid;
 }
 
@@ -412,6 +425,227 @@ OFSwitch13WifiController::ConfigAssocLBStrategy (void)
 	}
 }
 
+void
+OFSwitch13WifiController::AddArpEntry (Ipv4Address ipAddr, Mac48Address macAddr)
+{
+	NS_LOG_FUNCTION (this << ipAddr << macAddr);
+	m_arpTable[ipAddr] = macAddr;
+}
+
+void
+OFSwitch13WifiController::HandshakeSuccessful (Ptr<const RemoteSwitch> swtch)
+{
+	NS_LOG_FUNCTION (this << swtch);
+	OFSwitch13LearningController::HandshakeSuccessful (swtch);
+	if (m_proxyArp)
+	{
+		// Redirect ARP requests to the controller, so that they are answered
+		// at the datapath instead of being flooded over the air. The learned
+		// unicast flows keep their precedence.
+		DpctlExecute (swtch, "flow-mod cmd=add,table=0,prio=20 "
+					  "eth_type=0x0806,arp_op=1 apply:output=ctrl");
+	}
+}
+
+ofl_err
+OFSwitch13WifiController::HandlePacketIn (
+	struct ofl_msg_packet_in *msg, Ptr<const RemoteSwitch> swtch,
+	uint32_t xid)
+{
+	NS_LOG_FUNCTION (this << swtch << xid);
+	LearnArpEntry ((struct ofl_match*)msg->match);
+	if (msg->reason == OFPR_ACTION)
+	{
+		// Get Ethernet frame type
+		struct ofl_match_tlv *tlv =
+			oxm_match_lookup (OXM_OF_ETH_TYPE, (struct ofl_match*)msg->match);
+		uint16_t ethType = 0;
+		if (tlv != 0)
+		{
+			memcpy (&ethType, tlv->value, OXM_LENGTH (OXM_OF_ETH_TYPE));
+		}
+		if (ethType == ArpL3Protocol::PROT_NUMBER)
+		{
+			return HandleArpPacketIn (msg, swtch, xid);
+		}
+	}
+	return OFSwitch13LearningController::HandlePacketIn (msg, swtch, xid);
+}
+
+ofl_err
+OFSwitch13WifiController::HandleArpPacketIn (
+	struct ofl_msg_packet_in *msg, Ptr<const RemoteSwitch> swtch,
+	uint32_t xid)
+{
+	NS_LOG_FUNCTION (this << swtch << xid);
+	struct ofl_match *match = (struct ofl_match*)msg->match;
+	struct ofl_match_tlv *tlv;
+	
+	// Get ARP operation
+	uint16_t arpOp;
+	tlv = oxm_match_lookup (OXM_OF_ARP_OP, match);
+	memcpy (&arpOp, tlv->value, OXM_LENGTH (OXM_OF_ARP_OP));
+	
+	// Get input port
+	uint32_t inPort;
+	tlv = oxm_match_lookup (OXM_OF_IN_PORT, match);
+	memcpy (&inPort, tlv->value, OXM_LENGTH (OXM_OF_IN_PORT));
+	
+	// Get source and target addresses
+	Ipv4Address srcIp = ExtractIpv4Address (OXM_OF_ARP_SPA, match);
+	Ipv4Address dstIp = ExtractIpv4Address (OXM_OF_ARP_TPA, match);
+	Mac48Address srcMac;
+	tlv = oxm_match_lookup (OXM_OF_ARP_SHA, match);
+	srcMac.CopyFrom (tlv->value);
+	
+	// Learn the port of the sender, as for any other frame, so that the
+	// unicast ARP reply and the next frames towards it are not flooded
+	uint32_t outPort = LearnL2 (msg, swtch);
+	
+	struct ofl_action_output *action =
+		(struct ofl_action_output*)xmalloc (sizeof (struct ofl_action_output));
+	action->header.type = OFPAT_OUTPUT;
+	action->max_len = 0;
+	
+	struct ofl_msg_packet_out reply;
+	reply.header.type = OFPT_PACKET_OUT;
+	reply.in_port = inPort;
+	reply.actions_num = 1;
+	reply.actions = (struct ofl_action_header**)&action;
+	
+	uint8_t replyData[64];
+	auto entry = m_arpTable.find (dstIp);
+	if (arpOp == ArpHeader::ARP_TYPE_REQUEST && entry != m_arpTable.end ()
+		&& entry->second != srcMac)
+	{
+		// Send the ARP reply back to the input port
+		NS_LOG_DEBUG ("Proxy ARP: " << dstIp << " is at " << entry->second
+					  << ", answering " << srcIp);
+		Ptr<Packet> pkt = CreateArpReply (entry->second, dstIp, srcMac, srcIp);
+		NS_ASSERT_MSG (pkt->GetSize () == 64, "Invalid packet size.");
+		pkt->CopyData (replyData, 64);
+		action->port = OFPP_IN_PORT;
+		reply.buffer_id = NO_BUFFER;
+		reply.data_length = 64;
+		reply.data = &replyData[0];
+		SendToSwitch (swtch, (struct ofl_msg_header*)&reply, xid);
+		
+		// Drop the request buffered at the switch, if any
+		if (msg->buffer_id != NO_BUFFER)
+		{
+			reply.buffer_id = msg->buffer_id;
+			reply.data_length = 0;
+			reply.data = 0;
+			reply.actions_num = 0;
+			SendToSwitch (swtch, (struct ofl_msg_header*)&reply, xid);
+		}
+	}
+	else
+	{
+		// Unknown target: forward the request as the L2 switching does,
+		// i.e., flood it unless its destination has been learned
+		NS_LOG_DEBUG ("No ARP entry for " << dstIp << ". Forward to port "
+					  << outPort << ".");
+		action->port = outPort;
+		reply.buffer_id = msg->buffer_id;
+		reply.data_length = 0;
+		reply.data = 0;
+		if (msg->buffer_id == NO_BUFFER)
+		{
+			// No packet buffer. Send data back to switch
+			reply.data_length = msg->data_length;
+			reply.data = msg->data;
+		}
+		SendToSwitch (swtch, (struct ofl_msg_header*)&reply, xid);
+	}
+	free (action);
+	
+	// All handlers must free the message when everything is ok
+	ofl_msg_free ((struct ofl_msg_header*)msg, &dp_exp);
+	return 0;
+}
+
+void
+OFSwitch13WifiController::LearnArpEntry (struct ofl_match* match)
+{
+	// Only the ARP packets are trusted for the bindings: the IPv4 packets
+	// from the core carry the MAC address of the last hop
+	struct ofl_match_tlv *tlv = oxm_match_lookup (OXM_OF_ETH_TYPE, match);
+	uint16_t ethType = 0;
+	if (tlv != 0)
+	{
+		memcpy (&ethType, tlv->value, OXM_LENGTH (OXM_OF_ETH_TYPE));
+	}
+	struct ofl_match_tlv *sha = oxm_match_lookup (OXM_OF_ARP_SHA, match);
+	if (ethType != ArpL3Protocol::PROT_NUMBER || sha == 0
+		|| oxm_match_lookup (OXM_OF_ARP_SPA, match) == 0)
+	{
+		return;
+	}
+	Ipv4Address ip = ExtractIpv4Address (OXM_OF_ARP_SPA, match);
+	Mac48Address mac;
+	mac.CopyFrom (sha->value);
+	if (ip == Ipv4Address::GetAny ())
+	{
+		// ARP probe, the sender has no address yet
+		return;
+	}
+	auto entry = m_arpTable.find (ip);
+	if (entry == m_arpTable.end () || entry->second != mac)
+	{
+		NS_LOG_INFO ("New ARP entry: " << ip << " - " << mac);
+		m_arpTable[ip] = mac;
+	}
+}
+
+Ipv4Address
+OFSwitch13WifiController::ExtractIpv4Address (uint32_t oxm_of, struct ofl_match* match)
+{
+	uint32_t ip;
+	struct ofl_match_tlv *tlv = oxm_match_lookup (oxm_of, match);
+	NS_ABORT_MSG_IF (tlv == 0 || OXM_LENGTH (oxm_of) != sizeof (ip), "Invalid IP field.");
+	memcpy (&ip, tlv->value, sizeof (ip));
+	return Ipv4Address (ntohl (ip));
+}
+
+Ptr<Packet>
+OFSwitch13WifiController::CreateArpReply (Mac48Address srcMac, Ipv4Address srcIp,
+										  Mac48Address dstMac, Ipv4Address dstIp)
+{
+	NS_LOG_FUNCTION (this << srcMac << srcIp << dstMac << dstIp);
+	
+	Ptr<Packet> packet = Create<Packet> ();
+	
+	// ARP header
+	ArpHeader arp;
+	arp.SetReply (srcMac, srcIp, dstMac, dstIp);
+	packet->AddHeader (arp);
+	
+	// Ethernet header
+	EthernetHeader eth (false);
+	eth.SetSource (srcMac);
+	eth.SetDestination (dstMac);
+	if (packet->GetSize () < 46)
+	{
+		uint8_t buffer[46];
+		memset (buffer, 0, 46);
+		Ptr<Packet> padd = Create<Packet> (buffer, 46 - packet->GetSize ());
+		packet->AddAtEnd (padd);
+	}
+	eth.SetLengthType (ArpL3Protocol::PROT_NUMBER);
+	packet->AddHeader (eth);
+	
+	// Ethernet trailer
+	EthernetTrailer trailer;
+	if (Node::ChecksumEnabled ())
+	{
+		trailer.EnableFcs (true);
+	}
+	trailer.CalcFcs (packet);
+	packet->AddTrailer (trailer);
+	
+	return packet;
+}
 
 } // namespace ns3
 
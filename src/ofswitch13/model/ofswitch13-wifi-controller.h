@@ -55,7 +55,70 @@ public:
 	void ConfigAssocLBStrategy (void); //for RSSI based load balance 
 	void PrintAssocStatus(void);
 	void PrintChannelquality(void);
+	
+	/**
+	 * Bind an IP address to a MAC address, for the proxy ARP to answer
+	 * the requests for the address before learning it from the traffic.
+	 * \param ipAddr The IPv4 address.
+	 * \param macAddr The MAC address.
+	 */
+	void AddArpEntry (Ipv4Address ipAddr, Mac48Address macAddr);
+	
+	/**
+	 * Answer the ARP requests intercepted at the datapaths, and learn the
+	 * IP / MAC bindings, before the L2 switching of the other packets.
+	 * \param msg The packet-in message.
+	 * \param swtch The switch information.
+	 * \param xid Transaction id.
+	 * \return 0 if everything's ok, otherwise an error number.
+	 */
+	virtual ofl_err HandlePacketIn (
+		struct ofl_msg_packet_in *msg, Ptr<const RemoteSwitch> swtch,
+		uint32_t xid);
+
+protected:
+	// Inherited from OFSwitch13Controller
+	void HandshakeSuccessful (Ptr<const RemoteSwitch> swtch);
+
 private:
+	/**
+	 * Handle the ARP requests sent to the controller: reply on the input
+	 * port if the target is known, or flood the request otherwise.
+	 * \param msg The packet-in message.
+	 * \param swtch The switch information.
+	 * \param xid Transaction id.
+	 * \return 0 if everything's ok, otherwise an error number.
+	 */
+	ofl_err HandleArpPacketIn (
+		struct ofl_msg_packet_in *msg, Ptr<const RemoteSwitch> swtch,
+		uint32_t xid);
+	
+	/**
+	 * Learn the IP / MAC binding of the sender of a packet, if any.
+	 * \param match The packet-in match.
+	 */
+	void LearnArpEntry (struct ofl_match* match);
+	
+	/**
+	 * Extract an IPv4 address from packet match.
+	 * \param oxm_of The OXM_OF_* IPv4 field, present in the match.
+	 * \param match The ofl_match structure pointer.
+	 * \return The IPv4 address.
+	 */
+	Ipv4Address ExtractIpv4Address (uint32_t oxm_of, struct ofl_match* match);
+	
+	/**
+	 * Create an ARP reply packet, encapsulated inside of an Ethernet frame.
+	 * \param srcMac Source MAC address.
+	 * \param srcIp Source IP address.
+	 * \param dstMac Destination MAC address.
+	 * \param dstIp Destination IP address.
+	 * \return The ns3 Ptr<Packet> with the ARP reply.
+	 */
+	Ptr<Packet> CreateArpReply (Mac48Address srcMac, Ipv4Address srcIp,
+								Mac48Address dstMac, Ipv4Address dstIp);
+	
+
 	void ConfigChannel (const Address& address, const uint8_t& channelNumber,
 						const uint16_t frequency, const uint16_t& channelWidth);
 	
@@ -72,6 +135,8 @@ private:
 	
 	Ptr<WifiNetworkStatus> m_wifiNetworkStatus;
 	std::map<Address, Address> AssocControlMap;
+	
+	bool m_proxyArp;               //!< Answer the ARP requests at the datapaths
 };
 
 }  //namespace ns3
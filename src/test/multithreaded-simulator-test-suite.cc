@@ -0,0 +1,357 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This test needs links of the point-to-point and csma modules, which the
+// mpi module does not depend on, hence it lives with the system tests.
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "ns3/csma-helper.h"
+#include "ns3/data-rate.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+#include "ns3/node-container.h"
+#include "ns3/packet.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+#include "ns3/uinteger.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup mpi
+ * \ingroup tests
+ *
+ * \brief Check the partitions of a topology made of point-to-point links and
+ * of a CSMA segment, and that the packets received by each node, and their
+ * order, do not depend on the number of threads.
+ */
+class MultithreadedSimulatorTraceTestCase : public TestCase
+{
+public:
+  MultithreadedSimulatorTraceTestCase ();
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Run the scenario.
+   * \param threads the maximum number of threads
+   * \return the packets received by each node
+   */
+  std::vector<std::string> RunScenario (uint32_t threads);
+  /**
+   * Send a packet on every device of a node, and schedule the next one.
+   * \param node the node
+   * \param size the size of the packets
+   * \param interval the interval between two packets
+   * \param seq the sequence number of the packet
+   */
+  void Send (Ptr<Node> node, uint32_t size, Time interval, uint8_t seq);
+  /**
+   * Record a received packet, and forward it on the other devices of the
+   * node if it has not been forwarded twice yet.
+   * \param device the receiving device
+   * \param packet the packet
+   * \param protocol the protocol
+   * \param from the source address
+   * \param to the destination address
+   * \param type the type of packet
+   */
+  void Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                const Address &from, const Address &to, NetDevice::PacketType type);
+
+  std::vector<std::ostringstream *> m_traces; //!< the packets received by each node
+  std::vector<Time> m_firstRx;                //!< the time of the first packet received by each node
+  uint32_t m_nPartitions;                     //!< the number of LPs
+  Time m_lookahead;                           //!< the lookahead
+};
+
+MultithreadedSimulatorTraceTestCase::MultithreadedSimulatorTraceTestCase ()
+  : TestCase ("Check that the traces of a multithreaded simulation do not depend on the number of threads"),
+    m_nPartitions (0)
+{
+}
+
+void
+MultithreadedSimulatorTraceTestCase::Send (Ptr<Node> node, uint32_t size, Time interval, uint8_t seq)
+{
+  std::vector<uint8_t> payload (size, 0);
+  payload[0] = node->GetId ();
+  payload[1] = seq;
+  payload[2] = 0;
+  for (uint32_t i = 0; i < node->GetNDevices (); i++)
+    {
+      Ptr<NetDevice> device = node->GetDevice (i);
+      device->Send (Create<Packet> (payload.data (), size), device->GetBroadcast (), 0x0800);
+    }
+  if (seq < 20)
+    {
+      Simulator::Schedule (interval, &MultithreadedSimulatorTraceTestCase::Send, this, node, size, interval, seq + 1);
+    }
+}
+
+void
+MultithreadedSimulatorTraceTestCase::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol,
+                                               const Address &from, const Address &to, NetDevice::PacketType type)
+{
+  Ptr<Node> node = device->GetNode ();
+  std::vector<uint8_t> payload (packet->GetSize ());
+  packet->CopyData (payload.data (), payload.size ());
+  *m_traces[node->GetId ()] << Simulator::Now ().GetTimeStep () << " " << device->GetIfIndex ()
+                            << " " << uint32_t (payload[0]) << " " << uint32_t (payload[1])
+                            << " " << uint32_t (payload[2]) << std::endl;
+  if (m_firstRx[node->GetId ()].IsStrictlyNegative ())
+    {
+      m_firstRx[node->GetId ()] = Simulator::Now ();
+    }
+  if (payload[2] < 2)
+    {
+      payload[2]++;
+      for (uint32_t i = 0; i < node->GetNDevices (); i++)
+        {
+          Ptr<NetDevice> out = node->GetDevice (i);
+          if (out != device)
+            {
+              out->Send (Create<Packet> (payload.data (), payload.size ()), out->GetBroadcast (), 0x0800);
+            }
+        }
+    }
+}
+
+std::vector<std::string>
+MultithreadedSimulatorTraceTestCase::RunScenario (uint32_t threads)
+{
+  Ptr<MultithreadedSimulatorImpl> impl = CreateObject<MultithreadedSimulatorImpl> ();
+  impl->SetAttribute ("MaxThreads", UintegerValue (threads));
+  Simulator::SetImplementation (impl);
+
+  // 0 --- 1 --- 2 --- 3 === {4, 5}: point-to-point links, then a CSMA segment
+  NodeContainer nodes;
+  nodes.Create (6);
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", StringValue ("8Mbps"));
+  p2p.SetChannelAttribute ("Delay", StringValue ("2ms"));
+  p2p.Install (nodes.Get (0), nodes.Get (1));
+  p2p.SetChannelAttribute ("Delay", StringValue ("3ms"));
+  p2p.Install (nodes.Get (1), nodes.Get (2));
+  p2p.SetChannelAttribute ("Delay", StringValue ("2ms"));
+  p2p.Install (nodes.Get (2), nodes.Get (3));
+  CsmaHelper csma;
+  csma.SetChannelAttribute ("DataRate", StringValue ("100Mbps"));
+  csma.SetChannelAttribute ("Delay", StringValue ("5us"));
+  NodeContainer segment (nodes.Get (3), nodes.Get (4), nodes.Get (5));
+  csma.Install (segment);
+
+  m_traces.clear ();
+  m_firstRx.clear ();
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      m_traces.push_back (new std::ostringstream);
+      m_firstRx.push_back (Seconds (-1));
+      nodes.Get (i)->RegisterProtocolHandler (MakeCallback (&MultithreadedSimulatorTraceTestCase::Receive, this),
+                                              0x0800, 0);
+    }
+  Simulator::ScheduleWithContext (0, MilliSeconds (1), &MultithreadedSimulatorTraceTestCase::Send,
+                                  this, nodes.Get (0), 100, MilliSeconds (1), 0);
+  Simulator::ScheduleWithContext (2, MilliSeconds (1), &MultithreadedSimulatorTraceTestCase::Send,
+                                  this, nodes.Get (2), 200, MicroSeconds (700), 0);
+  Simulator::ScheduleWithContext (4, MilliSeconds (1), &MultithreadedSimulatorTraceTestCase::Send,
+                                  this, nodes.Get (4), 300, MicroSeconds (1500), 0);
+
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+  m_nPartitions = impl->GetNPartitions ();
+  m_lookahead = impl->GetLookahead ();
+  Simulator::Destroy ();
+
+  std::vector<std::string> traces;
+  for (std::vector<std::ostringstream *>::iterator i = m_traces.begin (); i != m_traces.end (); i++)
+    {
+      traces.push_back ((*i)->str ());
+      delete *i;
+    }
+  m_traces.clear ();
+  return traces;
+}
+
+void
+MultithreadedSimulatorTraceTestCase::DoRun (void)
+{
+  std::vector<std::string> reference = RunScenario (1);
+
+  // the nodes of the CSMA segment share an LP, the point-to-point links
+  // separate the other nodes
+  NS_TEST_ASSERT_MSG_EQ (m_nPartitions, 4, "Wrong number of LPs");
+  NS_TEST_EXPECT_MSG_EQ (m_lookahead, MilliSeconds (2), "Wrong lookahead");
+  for (uint32_t i = 0; i < reference.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_NE (reference[i].size (), 0, "Node " << i << " received nothing");
+    }
+  // the first packet of node 0 (100 bytes and the PPP header, at 8 Mbps)
+  // reaches node 1 after the delay of their link
+  NS_TEST_EXPECT_MSG_EQ (m_firstRx[1], MilliSeconds (1) + DataRate ("8Mbps").CalculateBytesTxTime (102) + MilliSeconds (2),
+                         "Wrong reception time of a packet crossing LPs");
+
+  // the same LPs, run by several threads when packets can be shared by them
+#ifdef NS3_MTP
+  std::vector<std::string> traces = RunScenario (4);
+  NS_TEST_ASSERT_MSG_EQ (traces.size (), reference.size (), "Wrong number of nodes");
+  for (uint32_t i = 0; i < reference.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (traces[i], reference[i], "Node " << i << " received different packets");
+    }
+#endif
+}
+
+/**
+ * \ingroup mpi
+ * \ingroup tests
+ *
+ * \brief Check when the events sent by an LP to another LP, and to the
+ * global LP, are run.
+ */
+class MultithreadedSimulatorMessageTestCase : public TestCase
+{
+public:
+  /**
+   * Constructor
+   * \param threads the maximum number of threads
+   */
+  MultithreadedSimulatorMessageTestCase (uint32_t threads);
+
+private:
+  virtual void DoRun (void);
+  /**
+   * Record an event of a node.
+   * \param node the node
+   */
+  void NodeEvent (uint32_t node);
+  /**
+   * Send events to the other node and to the global LP.
+   */
+  void SendEvents (void);
+  /**
+   * Record an event of the global LP.
+   */
+  void GlobalEvent (void);
+
+  uint32_t m_threads;                      //!< the maximum number of threads
+  std::vector<Time> m_nodeEvents[2];       //!< the events run by each node
+  std::vector<Time> m_globalEvents;        //!< the events run by the global LP
+  std::vector<uint32_t> m_nodeEventsSeen;  //!< events of the nodes run before each global event
+};
+
+MultithreadedSimulatorMessageTestCase::MultithreadedSimulatorMessageTestCase (uint32_t threads)
+  : TestCase ("Check the scheduling of the events sent to other LPs"),
+    m_threads (threads)
+{
+}
+
+void
+MultithreadedSimulatorMessageTestCase::NodeEvent (uint32_t node)
+{
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetContext (), node, "Event run in the wrong context");
+  m_nodeEvents[node].push_back (Simulator::Now ());
+}
+
+void
+MultithreadedSimulatorMessageTestCase::SendEvents (void)
+{
+  NodeEvent (0);
+  // after the lookahead, to the other node
+  Simulator::ScheduleWithContext (1, MilliSeconds (10), &MultithreadedSimulatorMessageTestCase::NodeEvent, this, 1);
+  // to the global LP, within and after the current window
+  Simulator::ScheduleWithContext (Simulator::NO_CONTEXT, MilliSeconds (1), &MultithreadedSimulatorMessageTestCase::GlobalEvent, this);
+  Simulator::ScheduleWithContext (Simulator::NO_CONTEXT, MilliSeconds (20), &MultithreadedSimulatorMessageTestCase::GlobalEvent, this);
+}
+
+void
+MultithreadedSimulatorMessageTestCase::GlobalEvent (void)
+{
+  NS_TEST_EXPECT_MSG_EQ (Simulator::GetContext (), Simulator::NO_CONTEXT, "Event run in the wrong context");
+  m_globalEvents.push_back (Simulator::Now ());
+  m_nodeEventsSeen.push_back (m_nodeEvents[0].size () + m_nodeEvents[1].size ());
+}
+
+void
+MultithreadedSimulatorMessageTestCase::DoRun (void)
+{
+  Ptr<MultithreadedSimulatorImpl> impl = CreateObject<MultithreadedSimulatorImpl> ();
+  impl->SetAttribute ("MaxThreads", UintegerValue (m_threads));
+  Simulator::SetImplementation (impl);
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  PointToPointHelper p2p;
+  p2p.SetChannelAttribute ("Delay", StringValue ("10ms"));
+  p2p.Install (nodes);
+
+  // the first window ends at the global event at 5 ms, and the second one
+  // at 6 + 10 ms, hence the global event sent at 7 ms for 8 ms is delayed
+  // to 16 ms
+  Simulator::ScheduleWithContext (0, MilliSeconds (1), &MultithreadedSimulatorMessageTestCase::NodeEvent, this, 0);
+  Simulator::ScheduleWithContext (0, MilliSeconds (4), &MultithreadedSimulatorMessageTestCase::NodeEvent, this, 0);
+  Simulator::ScheduleWithContext (0, MilliSeconds (6), &MultithreadedSimulatorMessageTestCase::NodeEvent, this, 0);
+  Simulator::ScheduleWithContext (0, MilliSeconds (7), &MultithreadedSimulatorMessageTestCase::SendEvents, this);
+  Simulator::ScheduleWithContext (1, MilliSeconds (4), &MultithreadedSimulatorMessageTestCase::NodeEvent, this, 1);
+  Simulator::ScheduleWithContext (1, MilliSeconds (6), &MultithreadedSimulatorMessageTestCase::NodeEvent, this, 1);
+  Simulator::Schedule (MilliSeconds (5), &MultithreadedSimulatorMessageTestCase::GlobalEvent, this);
+
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (impl->GetNPartitions (), 2, "Wrong number of LPs");
+  NS_TEST_EXPECT_MSG_EQ (impl->GetLookahead (), MilliSeconds (10), "Wrong lookahead");
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_nodeEvents[1].size (), 3, "Wrong number of events of node 1");
+  NS_TEST_EXPECT_MSG_EQ (m_nodeEvents[1][2], MilliSeconds (17), "Event sent to another LP run at the wrong time");
+  NS_TEST_ASSERT_MSG_EQ (m_globalEvents.size (), 3, "Wrong number of global events");
+  // a global event runs once all the earlier events of the nodes ran, and
+  // before any later one
+  NS_TEST_EXPECT_MSG_EQ (m_globalEvents[0], MilliSeconds (5), "Wrong time of the global event");
+  NS_TEST_EXPECT_MSG_EQ (m_nodeEventsSeen[0], 3, "Wrong events run before the global event");
+  NS_TEST_EXPECT_MSG_EQ (m_globalEvents[1], MilliSeconds (16), "Global event not delayed to the end of the window");
+  NS_TEST_EXPECT_MSG_EQ (m_nodeEventsSeen[1], 6, "Wrong events run before the delayed global event");
+  NS_TEST_EXPECT_MSG_EQ (m_globalEvents[2], MilliSeconds (27), "Global event after the window run at the wrong time");
+}
+
+/**
+ * \ingroup mpi
+ * \ingroup tests
+ *
+ * \brief Multithreaded simulator TestSuite
+ */
+class MultithreadedSimulatorTestSuite : public TestSuite
+{
+public:
+  MultithreadedSimulatorTestSuite ();
+};
+
+MultithreadedSimulatorTestSuite::MultithreadedSimulatorTestSuite ()
+  : TestSuite ("multithreaded-simulator", SYSTEM)
+{
+  AddTestCase (new MultithreadedSimulatorTraceTestCase, TestCase::QUICK);
+  AddTestCase (new MultithreadedSimulatorMessageTestCase (1), TestCase::QUICK);
+#ifdef NS3_MTP
+  AddTestCase (new MultithreadedSimulatorMessageTestCase (2), TestCase::QUICK);
+#endif
+}
+
+static MultithreadedSimulatorTestSuite g_multithreadedSimulatorTestSuite; //!< Static variable for test initialization
@@ -0,0 +1,190 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program benchmarks the bookkeeping performed by the BlockAckManager
+// of an HE originator: MPDUs are stored as they are sent in an A-MPDU, the
+// block ack is processed and the lost MPDUs are retransmitted, using a
+// transmission window of 64 or 256 MPDUs.
+//
+// Since compressed block acks only carry a 64-bit bitmap, a 256-MPDU window
+// is acknowledged by four block acks, each covering a quarter of the window.
+//
+// Sample usage:  ./waf --run 'bench-block-ack-manager --window=256 --per=0.1'
+
+#include <iostream>
+#include <vector>
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/packet.h"
+#include "ns3/block-ack-manager.h"
+#include "ns3/mac-tx-middle.h"
+#include "ns3/wifi-mac-queue.h"
+#include "ns3/yans-wifi-phy.h"
+#include "ns3/constant-rate-wifi-manager.h"
+#include "ns3/mgt-headers.h"
+#include "ns3/ctrl-headers.h"
+
+using namespace ns3;
+
+/// Nothing to do when the block ack manager blocks or unblocks a destination
+static void
+Ignore (Mac48Address recipient, uint8_t tid)
+{
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint16_t window = 64;
+  uint32_t nAmpdus = 100000;
+  double per = 0.1;
+  uint32_t payloadSize = 1500;
+
+  CommandLine cmd;
+  cmd.AddValue ("window", "The transmission window, in MPDUs (64 or 256)", window);
+  cmd.AddValue ("n", "The number of A-MPDUs to transmit", nAmpdus);
+  cmd.AddValue ("per", "The probability that an MPDU is lost", per);
+  cmd.AddValue ("payloadSize", "The MSDU size, in bytes", payloadSize);
+  cmd.Parse (argc, argv);
+
+  if (window != 64 && window != 256)
+    {
+      std::cerr << "The window must be 64 or 256 MPDUs" << std::endl;
+      return 1;
+    }
+
+  Mac48Address originator ("00:00:00:00:00:01");
+  Mac48Address recipient ("00:00:00:00:00:02");
+  uint8_t tid = 0;
+
+  Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+  phy->ConfigureStandard (WIFI_PHY_STANDARD_80211ax_5GHZ);
+  Ptr<ConstantRateWifiManager> stationManager = CreateObject<ConstantRateWifiManager> ();
+  stationManager->SetupPhy (phy);
+  stationManager->SetHtSupported (true);
+  stationManager->SetVhtSupported (true);
+  stationManager->SetHeSupported (true);
+
+  Ptr<MacTxMiddle> txMiddle = Create<MacTxMiddle> ();
+  Ptr<WifiMacQueue> queue = CreateObject<WifiMacQueue> ();
+  Ptr<BlockAckManager> manager = CreateObject<BlockAckManager> ();
+  manager->SetWifiRemoteStationManager (stationManager);
+  manager->SetTxMiddle (txMiddle);
+  manager->SetQueue (queue);
+  manager->SetBlockAckType (COMPRESSED_BLOCK_ACK);
+  manager->SetBlockAckThreshold (2);
+  manager->SetMaxPacketDelay (Seconds (10));
+  manager->SetBlockDestinationCallback (MakeCallback (&Ignore));
+  manager->SetUnblockDestinationCallback (MakeCallback (&Ignore));
+
+  MgtAddBaRequestHeader reqHdr;
+  reqHdr.SetImmediateBlockAck ();
+  reqHdr.SetTid (tid);
+  reqHdr.SetTimeout (0);
+  reqHdr.SetBufferSize (window - 1);
+  reqHdr.SetStartingSequence (0);
+  manager->CreateAgreement (&reqHdr, recipient);
+
+  MgtAddBaResponseHeader respHdr;
+  respHdr.SetImmediateBlockAck ();
+  respHdr.SetTid (tid);
+  respHdr.SetTimeout (0);
+  respHdr.SetBufferSize (window - 1);
+  manager->UpdateAgreement (&respHdr, recipient);
+
+  WifiMacHeader hdr;
+  hdr.SetType (WIFI_MAC_QOSDATA);
+  hdr.SetAddr1 (recipient);
+  hdr.SetAddr2 (originator);
+  hdr.SetQosTid (tid);
+  hdr.SetQosAckPolicy (WifiMacHeader::NORMAL_ACK);
+  Ptr<const Packet> packet = Create<Packet> (payloadSize);
+
+  RngSeedManager::SetSeed (1);
+  Ptr<UniformRandomVariable> loss = CreateObject<UniformRandomVariable> ();
+
+  // sequence numbers sent and not acknowledged yet
+  std::vector<bool> outstanding (4096, false);
+  uint16_t winStart = 0;
+  uint16_t nextSeq = 0;
+  uint64_t nMpdus = 0;
+  uint64_t nRetries = 0;
+  uint64_t nBlockAcks = 0;
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t n = 0; n < nAmpdus; n++)
+    {
+      // the A-MPDU carries the MPDUs to retransmit first
+      WifiMacHeader retryHdr;
+      while (manager->GetNextPacket (retryHdr, true) != 0)
+        {
+          manager->StorePacket (packet, retryHdr, Seconds (0));
+          nRetries++;
+        }
+      // then new MPDUs, as long as they fit in the transmission window
+      while (outstanding[nextSeq] == false
+             && ((nextSeq - winStart + 4096) % 4096) < window)
+        {
+          hdr.SetSequenceNumber (txMiddle->GetNextSequenceNumberFor (&hdr));
+          NS_ASSERT (hdr.GetSequenceNumber () == nextSeq);
+          manager->StorePacket (packet, hdr, Seconds (0));
+          outstanding[nextSeq] = true;
+          nextSeq = (nextSeq + 1) % 4096;
+          nMpdus++;
+        }
+      for (uint16_t start = winStart; start != (winStart + window) % 4096; start = (start + 64) % 4096)
+        {
+          CtrlBAckResponseHeader blockAck;
+          blockAck.SetType (COMPRESSED_BLOCK_ACK);
+          blockAck.SetTidInfo (tid);
+          blockAck.SetStartingSequence (start);
+          for (uint16_t i = 0; i < 64; i++)
+            {
+              uint16_t seq = (start + i) % 4096;
+              if (outstanding[seq] && loss->GetValue () >= per)
+                {
+                  blockAck.SetReceivedPacket (seq);
+                  outstanding[seq] = false;
+                }
+            }
+          manager->NotifyGotBlockAck (&blockAck, recipient, 0, phy->GetHeMcs0 (), 0);
+          nBlockAcks++;
+        }
+      while (winStart != nextSeq && outstanding[winStart] == false)
+        {
+          winStart = (winStart + 1) % 4096;
+        }
+    }
+  int64_t elapsed = clock.End ();
+
+  std::cout << "window=" << window << " per=" << per << std::endl
+            << "MPDUs sent:       " << nMpdus << " (+" << nRetries << " retransmissions)" << std::endl
+            << "block acks:       " << nBlockAcks << std::endl
+            << "elapsed (ms):     " << elapsed << std::endl;
+  if (elapsed > 0)
+    {
+      std::cout << "MPDUs/s:          " << (nMpdus + nRetries) * 1000 / elapsed << std::endl
+                << "ns per block ack: " << elapsed * 1000000 / nBlockAcks << std::endl;
+    }
+
+  manager->Dispose ();
+  stationManager->Dispose ();
+  phy->Dispose ();
+  return 0;
+}
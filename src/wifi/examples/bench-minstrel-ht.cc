@@ -0,0 +1,125 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program benchmarks the statistics update of Minstrel-HT for a
+// station supporting the largest set of groups (VHT, 160 MHz, 4 spatial
+// streams, both guard intervals). A-MPDU transmission reports are fed to the
+// rate manager, and the statistics are updated after every report, so that
+// the time per report is dominated by the statistics update.
+//
+// Minstrel-HT does not support HE rates in this version, hence the benchmark
+// relies on VHT stations.
+//
+// Sample usage:  ./waf --run 'bench-minstrel-ht --n=100000'
+
+#include <iostream>
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/config.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
+#include "ns3/simulator.h"
+#include "ns3/nstime.h"
+#include "ns3/rng-seed-manager.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/node-container.h"
+#include "ns3/net-device-container.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/yans-wifi-helper.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/regular-wifi-mac.h"
+#include "ns3/wifi-remote-station-manager.h"
+#include "ns3/ht-capabilities.h"
+#include "ns3/vht-capabilities.h"
+
+using namespace ns3;
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t nReports = 100000;
+  uint16_t ampduSize = 64;
+  double per = 0.1;
+
+  CommandLine cmd;
+  cmd.AddValue ("n", "The number of A-MPDU transmission reports", nReports);
+  cmd.AddValue ("ampduSize", "The number of MPDUs per A-MPDU (at most 255)", ampduSize);
+  cmd.AddValue ("per", "The probability that an MPDU is lost", per);
+  cmd.Parse (argc, argv);
+
+  // update the statistics upon every report
+  Config::SetDefault ("ns3::MinstrelHtWifiManager::UpdateStatistics", TimeValue (Seconds (0)));
+
+  NodeContainer nodes;
+  nodes.Create (2);
+  MobilityHelper mobility;
+  mobility.Install (nodes);
+
+  YansWifiChannelHelper channel = YansWifiChannelHelper::Default ();
+  YansWifiPhyHelper phy = YansWifiPhyHelper::Default ();
+  phy.SetChannel (channel.Create ());
+  phy.Set ("Antennas", UintegerValue (4));
+  phy.Set ("MaxSupportedTxSpatialStreams", UintegerValue (4));
+  phy.Set ("MaxSupportedRxSpatialStreams", UintegerValue (4));
+  phy.Set ("ShortGuardEnabled", BooleanValue (true));
+
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211ac);
+  wifi.SetRemoteStationManager ("ns3::MinstrelHtWifiManager");
+  WifiMacHelper mac;
+  mac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (phy, mac, nodes);
+  Config::Set ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Phy/ChannelWidth", UintegerValue (160));
+
+  Ptr<WifiNetDevice> device = DynamicCast<WifiNetDevice> (devices.Get (0));
+  Ptr<WifiNetDevice> peer = DynamicCast<WifiNetDevice> (devices.Get (1));
+  Ptr<RegularWifiMac> peerMac = DynamicCast<RegularWifiMac> (peer->GetMac ());
+  Mac48Address peerAddress = Mac48Address::ConvertFrom (peer->GetAddress ());
+
+  Ptr<WifiRemoteStationManager> manager = device->GetRemoteStationManager ();
+  manager->AddAllSupportedModes (peerAddress);
+  manager->AddStationHtCapabilities (peerAddress, peerMac->GetHtCapabilities ());
+  manager->AddStationVhtCapabilities (peerAddress, peerMac->GetVhtCapabilities ());
+
+  RngSeedManager::SetSeed (1);
+  Ptr<UniformRandomVariable> loss = CreateObject<UniformRandomVariable> ();
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t n = 0; n < nReports; n++)
+    {
+      uint8_t nSuccessful = 0;
+      for (uint16_t i = 0; i < ampduSize; i++)
+        {
+          if (loss->GetValue () >= per)
+            {
+              nSuccessful++;
+            }
+        }
+      manager->ReportAmpduTxStatus (peerAddress, 0, nSuccessful, ampduSize - nSuccessful, 30, 30);
+    }
+  int64_t elapsed = clock.End ();
+
+  WifiMacHeader hdr;
+  hdr.SetType (WIFI_MAC_QOSDATA);
+  std::cout << "reports:         " << nReports << std::endl
+            << "elapsed (ms):    " << elapsed << std::endl
+            << "ns per update:   " << elapsed * 1000000 / nReports << std::endl
+            << "final rate:      " << manager->GetDataTxVector (peerAddress, &hdr, 0).GetMode () << std::endl;
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -90,7 +90,8 @@ ApWifiMac::GetTypeId (void)
 }
 
 ApWifiMac::ApWifiMac ()
-  : m_enableBeaconGeneration (false)
+  : m_enableBeaconGeneration (false),
+    m_beaconTemplateValid (false)
 {
   NS_LOG_FUNCTION (this);
   m_beaconTxop = CreateObject<Txop> ();
@@ -197,6 +198,7 @@ ApWifiMac::DisassocSTA(const Mac48Address& from)
 			break;
 		}
 	}
+	InvalidateBeaconTemplate ();
 	
 }
 
@@ -404,6 +406,7 @@ ApWifiMac::AssocSTA(const Mac48Address& from, Packet pkt)
 			m_nonErpStations.push_back (from);
 			m_nonErpStations.unique ();
 		}
+		InvalidateBeaconTemplate ();
 	}
 
 	return 0;
@@ -455,6 +458,7 @@ ApWifiMac::SetWifiRemoteStationManager (const Ptr<WifiRemoteStationManager> stat
   m_beaconTxop->SetWifiRemoteStationManager (stationManager);
   RegularWifiMac::SetWifiRemoteStationManager (stationManager);
   m_stationManager->SetPcfSupported (GetPcfSupported ());
+  InvalidateBeaconTemplate ();
 }
 
 void
@@ -1075,6 +1079,8 @@ ApWifiMac::SendAssocResp (Mac48Address to, bool success, bool isReassoc)
           aid = GetNextAssociationId ();
           m_staList.insert (std::make_pair (aid, to));
         }
+      //the associated stations and their capabilities contribute to the beacon
+      InvalidateBeaconTemplate ();
       assoc.SetAssociationId (aid);
     }
   else
@@ -1117,18 +1123,50 @@ ApWifiMac::SendAssocResp (Mac48Address to, bool success, bool isReassoc)
   m_txop->Queue (packet, hdr);
 }
 
+bool
+ApWifiMac::IsBeaconTemplateUpToDate (void) const
+{
+  if (!m_beaconTemplateValid
+      || m_beaconChannelNumber != m_phy->GetChannelNumber ()
+      || m_beaconChannelWidth != m_phy->GetChannelWidth ()
+      || m_beaconFrequency != m_phy->GetFrequency ()
+      || m_beaconTemplateInterval != GetBeaconInterval ()
+      || !m_beaconSsid.IsEqual (GetSsid ()))
+    {
+      return false;
+    }
+  GetBeaconEdcaParameters (m_currentEdcaParameters);
+  return m_currentEdcaParameters == m_beaconEdcaParameters;
+}
+
 void
-ApWifiMac::SendOneBeacon (void)
+ApWifiMac::GetBeaconEdcaParameters (std::vector<uint64_t> &parameters) const
+{
+  parameters.clear ();
+  if (!GetQosSupported ())
+    {
+      return;
+    }
+  for (EdcaQueues::const_iterator i = m_edca.begin (); i != m_edca.end (); ++i)
+    {
+      parameters.push_back (i->second->GetMinCw ());
+      parameters.push_back (i->second->GetMaxCw ());
+      parameters.push_back (i->second->GetAifsn ());
+      parameters.push_back (i->second->GetTxopLimit ().GetMicroSeconds ());
+    }
+}
+
+void
+ApWifiMac::InvalidateBeaconTemplate (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_beaconTemplateValid = false;
+}
+
+void
+ApWifiMac::UpdateBeaconTemplate (void)
 {
   NS_LOG_FUNCTION (this);
-  WifiMacHeader hdr;
-  hdr.SetType (WIFI_MAC_MGT_BEACON);
-  hdr.SetAddr1 (Mac48Address::GetBroadcast ());
-  hdr.SetAddr2 (GetAddress ());
-  hdr.SetAddr3 (GetAddress ());
-  hdr.SetDsNotFrom ();
-  hdr.SetDsNotTo ();
-  Ptr<Packet> packet = Create<Packet> ();
   MgtBeaconHeader beacon;
   beacon.SetSsid (GetSsid ());
   beacon.SetSupportedRates (GetSupportedRates ());
@@ -1168,7 +1206,33 @@ ApWifiMac::SendOneBeacon (void)
       beacon.SetHeCapabilities (GetHeCapabilities ());
       beacon.SetHeOperation (GetHeOperation ());
     }
-  packet->AddHeader (beacon);
+  m_beaconTemplate = beacon;
+  m_beaconTemplateValid = true;
+  m_beaconChannelNumber = m_phy->GetChannelNumber ();
+  m_beaconChannelWidth = m_phy->GetChannelWidth ();
+  m_beaconFrequency = m_phy->GetFrequency ();
+  m_beaconTemplateInterval = GetBeaconInterval ();
+  m_beaconSsid = GetSsid ();
+  GetBeaconEdcaParameters (m_beaconEdcaParameters);
+}
+
+void
+ApWifiMac::SendOneBeacon (void)
+{
+  NS_LOG_FUNCTION (this);
+  WifiMacHeader hdr;
+  hdr.SetType (WIFI_MAC_MGT_BEACON);
+  hdr.SetAddr1 (Mac48Address::GetBroadcast ());
+  hdr.SetAddr2 (GetAddress ());
+  hdr.SetAddr3 (GetAddress ());
+  hdr.SetDsNotFrom ();
+  hdr.SetDsNotTo ();
+  Ptr<Packet> packet = Create<Packet> ();
+  if (!IsBeaconTemplateUpToDate ())
+    {
+      UpdateBeaconTemplate ();
+    }
+  packet->AddHeader (m_beaconTemplate);
 
   //The beacon has it's own special queue, so we load it in there
   m_beaconTxop->Queue (packet, hdr);
@@ -1794,6 +1858,7 @@ ApWifiMac::Receive (Ptr<Packet> packet, const WifiMacHeader *hdr)
                       break;
                     }
                 }
+              InvalidateBeaconTemplate ();
               return;
             }
         }
@@ -24,6 +24,7 @@
 #define AP_WIFI_MAC_H
 
 #include "infrastructure-wifi-mac.h"
+#include "mgt-headers.h"
 
 namespace ns3 {
 
@@ -231,6 +232,30 @@ private:
    * Forward a beacon packet to the beacon special DCF.
    */
   void SendOneBeacon (void);
+  /**
+   * Check whether the cached beacon body still reflects the current
+   * configuration, i.e. it has not been invalidated and the channel,
+   * the SSID, the beacon interval and the EDCA parameters it was built
+   * with have not changed since.
+   *
+   * \return true if the beacon template can be sent as is
+   */
+  bool IsBeaconTemplateUpToDate (void) const;
+  /**
+   * Rebuild the cached beacon body from the current configuration.
+   */
+  void UpdateBeaconTemplate (void);
+  /**
+   * Force the beacon body to be rebuilt before the next beacon is sent.
+   * This is called whenever the set of associated stations changes, since
+   * the ERP and HT protection state and the HT operation depend on it.
+   */
+  void InvalidateBeaconTemplate (void);
+  /**
+   * \param parameters the vector to fill with the EDCA parameters (CWmin,
+   *        CWmax, AIFSN and TXOP limit) of all the access categories
+   */
+  void GetBeaconEdcaParameters (std::vector<uint64_t> &parameters) const;
   /**
    * Determine what is the next PCF frame and trigger its transmission.
    */
@@ -347,6 +372,16 @@ private:
   bool m_enableNonErpProtection;             //!< Flag whether protection mechanism is used or not when non-ERP STAs are present within the BSS
   bool m_disableRifs;                        //!< Flag whether to force RIFS to be disabled within the BSS If non-HT STAs are detected
   
+  MgtBeaconHeader m_beaconTemplate;          //!< Cached beacon body, only the timestamp is refreshed at every beacon
+  bool m_beaconTemplateValid;                //!< Flag whether m_beaconTemplate has been built and not invalidated since
+  uint8_t m_beaconChannelNumber;             //!< Channel number m_beaconTemplate was built for
+  uint16_t m_beaconChannelWidth;             //!< Channel width m_beaconTemplate was built for
+  uint16_t m_beaconFrequency;                //!< Frequency m_beaconTemplate was built for
+  Ssid m_beaconSsid;                         //!< SSID m_beaconTemplate was built for
+  Time m_beaconTemplateInterval;             //!< Beacon interval m_beaconTemplate was built for
+  std::vector<uint64_t> m_beaconEdcaParameters; //!< EDCA parameters m_beaconTemplate was built with
+  mutable std::vector<uint64_t> m_currentEdcaParameters; //!< Scratch vector used to compare the EDCA parameters
+
   std::map<Mac48Address, Packet> m_staMgtAssocReqHeaders;  //!< Record MgtAssocRequestHeader for STAs
   bool m_assocTrigger;
 };
@@ -40,6 +40,200 @@ BlockAckManager::Item::Item (Ptr<const Packet> packet, const WifiMacHeader &hdr,
   NS_LOG_FUNCTION (this << packet << hdr << tStamp);
 }
 
+BlockAckManager::PacketQueue::Slot::Slot ()
+  : retry (false)
+{
+}
+
+BlockAckManager::PacketQueue::PacketQueue ()
+  : m_slots (64),
+    m_head (0),
+    m_span (0),
+    m_nPackets (0),
+    m_nRetry (0)
+{
+}
+
+bool
+BlockAckManager::PacketQueue::IsEmpty (void) const
+{
+  return (m_nPackets == 0);
+}
+
+uint32_t
+BlockAckManager::PacketQueue::GetNPackets (void) const
+{
+  return m_nPackets;
+}
+
+uint32_t
+BlockAckManager::PacketQueue::GetNRetryPackets (void) const
+{
+  return m_nRetry;
+}
+
+uint16_t
+BlockAckManager::PacketQueue::GetSpan (void) const
+{
+  return m_span;
+}
+
+uint16_t
+BlockAckManager::PacketQueue::GetSequenceAt (uint16_t offset) const
+{
+  return (m_head + offset) % 4096;
+}
+
+bool
+BlockAckManager::PacketQueue::IsInSpan (uint16_t seq) const
+{
+  return (((seq - m_head + 4096) % 4096) < m_span);
+}
+
+BlockAckManager::PacketQueue::Slot &
+BlockAckManager::PacketQueue::GetSlot (uint16_t seq)
+{
+  return m_slots[seq & (m_slots.size () - 1)];
+}
+
+const BlockAckManager::PacketQueue::Slot &
+BlockAckManager::PacketQueue::GetSlot (uint16_t seq) const
+{
+  return m_slots[seq & (m_slots.size () - 1)];
+}
+
+std::vector<BlockAckManager::Item> &
+BlockAckManager::PacketQueue::GetItems (uint16_t seq)
+{
+  NS_ASSERT (IsInSpan (seq));
+  return GetSlot (seq).items;
+}
+
+bool
+BlockAckManager::PacketQueue::IsRetryNeeded (uint16_t seq) const
+{
+  return (IsInSpan (seq) && GetSlot (seq).retry);
+}
+
+void
+BlockAckManager::PacketQueue::SetRetryNeeded (uint16_t seq, bool retry)
+{
+  NS_ASSERT (IsInSpan (seq));
+  Slot &slot = GetSlot (seq);
+  NS_ASSERT (!retry || !slot.items.empty ());
+  if (slot.retry != retry)
+    {
+      slot.retry = retry;
+      if (retry)
+        {
+          m_nRetry++;
+        }
+      else
+        {
+          m_nRetry--;
+        }
+    }
+}
+
+void
+BlockAckManager::PacketQueue::Insert (const Item &item)
+{
+  uint16_t seq = item.hdr.GetSequenceNumber ();
+  Trim ();
+  if (m_span == 0)
+    {
+      m_head = seq;
+      m_span = 1;
+    }
+  else
+    {
+      uint16_t offset = (seq - m_head + 4096) % 4096;
+      if (offset >= m_span)
+        {
+          //same ordering rule as the one used to sort the packets of a window
+          uint16_t span = (offset > 2047) ? m_span + 4096 - offset : offset + 1;
+          if (span > m_slots.size ())
+            {
+              Grow (span);
+            }
+          if (offset > 2047)
+            {
+              m_head = seq;
+            }
+          m_span = span;
+        }
+    }
+  Slot &slot = GetSlot (seq);
+  if (slot.items.empty ())
+    {
+      m_nPackets++;
+    }
+  slot.items.push_back (item);
+}
+
+void
+BlockAckManager::PacketQueue::Erase (uint16_t seq, std::size_t index)
+{
+  NS_ASSERT (IsInSpan (seq));
+  Slot &slot = GetSlot (seq);
+  NS_ASSERT (index < slot.items.size ());
+  slot.items.erase (slot.items.begin () + index);
+  if (slot.items.empty ())
+    {
+      SetRetryNeeded (seq, false);
+      m_nPackets--;
+    }
+}
+
+void
+BlockAckManager::PacketQueue::EraseAll (uint16_t seq)
+{
+  NS_ASSERT (IsInSpan (seq));
+  Slot &slot = GetSlot (seq);
+  if (!slot.items.empty ())
+    {
+      slot.items.clear ();
+      SetRetryNeeded (seq, false);
+      m_nPackets--;
+    }
+}
+
+void
+BlockAckManager::PacketQueue::Trim (void)
+{
+  if (m_nPackets == 0)
+    {
+      m_span = 0;
+      return;
+    }
+  while (GetSlot (m_head).items.empty ())
+    {
+      m_head = (m_head + 1) % 4096;
+      m_span--;
+    }
+  while (GetSlot (GetSequenceAt (m_span - 1)).items.empty ())
+    {
+      m_span--;
+    }
+}
+
+void
+BlockAckManager::PacketQueue::Grow (uint16_t span)
+{
+  std::size_t size = m_slots.size ();
+  while (size < span)
+    {
+      size *= 2;
+    }
+  std::vector<Slot> slots (size);
+  for (uint16_t offset = 0; offset < m_span; offset++)
+    {
+      uint16_t seq = GetSequenceAt (offset);
+      std::swap (slots[seq & (size - 1)], GetSlot (seq));
+    }
+  m_slots.swap (slots);
+}
+
 Bar::Bar ()
 {
   NS_LOG_FUNCTION (this);
@@ -77,7 +271,6 @@ BlockAckManager::~BlockAckManager ()
   NS_LOG_FUNCTION (this);
   m_queue = 0;
   m_agreements.clear ();
-  m_retryPackets.clear ();
 }
 
 bool
@@ -149,17 +342,6 @@ BlockAckManager::DestroyAgreement (Mac48Address recipient, uint8_t tid)
   AgreementsI it = m_agreements.find (std::make_pair (recipient, tid));
   if (it != m_agreements.end ())
     {
-      for (std::list<PacketQueueI>::const_iterator i = m_retryPackets.begin (); i != m_retryPackets.end (); )
-        {
-          if ((*i)->hdr.GetAddr1 () == recipient && (*i)->hdr.GetQosTid () == tid)
-            {
-              i = m_retryPackets.erase (i);
-            }
-          else
-            {
-              i++;
-            }
-        }
       m_agreements.erase (it);
       //remove scheduled bar
       for (std::list<Bar>::const_iterator i = m_bars.begin (); i != m_bars.end (); )
@@ -221,23 +403,7 @@ BlockAckManager::StorePacket (Ptr<const Packet> packet, const WifiMacHeader &hdr
   Item item (packet, hdr, tStamp);
   AgreementsI it = m_agreements.find (std::make_pair (recipient, tid));
   NS_ASSERT (it != m_agreements.end ());
-  PacketQueueI queueIt = it->second.second.begin ();
-  for (; queueIt != it->second.second.end (); )
-    {
-      if (((hdr.GetSequenceNumber () - queueIt->hdr.GetSequenceNumber () + 4096) % 4096) > 2047)
-        {
-          queueIt = it->second.second.insert (queueIt, item);
-          break;
-        }
-      else
-        {
-          queueIt++;
-        }
-    }
-  if (queueIt == it->second.second.end ())
-    {
-      it->second.second.push_back (item);
-    }
+  it->second.second.Insert (item);
 }
 
 void
@@ -257,49 +423,44 @@ BlockAckManager::GetNextPacket (WifiMacHeader &hdr, bool removePacket)
   uint8_t tid;
   Mac48Address recipient;
   CleanupBuffers ();
-  if (!m_retryPackets.empty ())
+  for (AgreementsI agreement = m_agreements.begin (); agreement != m_agreements.end () && packet == 0; agreement++)
     {
-      NS_LOG_DEBUG ("Retry buffer size is " << m_retryPackets.size ());
-      std::list<PacketQueueI>::const_iterator it = m_retryPackets.begin ();
-      while (it != m_retryPackets.end ())
+      PacketQueue &queue = agreement->second.second;
+      if (queue.GetNRetryPackets () > 0)
+        {
+          NS_LOG_DEBUG ("Retry buffer size is " << queue.GetNRetryPackets ());
+        }
+      for (uint16_t offset = 0; queue.GetNRetryPackets () > 0 && offset < queue.GetSpan (); offset++)
         {
-          if ((*it)->hdr.IsQosData ())
+          uint16_t seq = queue.GetSequenceAt (offset);
+          if (!queue.IsRetryNeeded (seq))
             {
-              tid = (*it)->hdr.GetQosTid ();
+              continue;
             }
-          else
+          const Item &item = queue.GetItems (seq).front ();
+          if (!item.hdr.IsQosData ())
             {
               NS_FATAL_ERROR ("Packet in blockAck manager retry queue is not Qos Data");
             }
-          recipient = (*it)->hdr.GetAddr1 ();
-          AgreementsI agreement = m_agreements.find (std::make_pair (recipient, tid));
-          NS_ASSERT (agreement != m_agreements.end ());
           if (removePacket)
             {
-              if (QosUtilsIsOldPacket (agreement->second.first.GetStartingSequence (),(*it)->hdr.GetSequenceNumber ()))
+              if (QosUtilsIsOldPacket (agreement->second.first.GetStartingSequence (), seq))
                 {
                   //Standard says the originator should not send a packet with seqnum < winstart
-                  NS_LOG_DEBUG ("The Retry packet have sequence number < WinStartO --> Discard " << (*it)->hdr.GetSequenceNumber () << " " << agreement->second.first.GetStartingSequence ());
-                  agreement->second.second.erase ((*it));
-                  it = m_retryPackets.erase (it);
+                  NS_LOG_DEBUG ("The Retry packet have sequence number < WinStartO --> Discard " << seq << " " << agreement->second.first.GetStartingSequence ());
+                  queue.SetRetryNeeded (seq, false);
+                  queue.Erase (seq, 0);
                   continue;
                 }
-              else if ((*it)->hdr.GetSequenceNumber () > (agreement->second.first.GetStartingSequence () + 63) % 4096)
+              else if (seq > (agreement->second.first.GetStartingSequence () + 63) % 4096)
                 {
-                  agreement->second.first.SetStartingSequence ((*it)->hdr.GetSequenceNumber ());
+                  agreement->second.first.SetStartingSequence (seq);
                 }
             }
-          packet = (*it)->packet->Copy ();
-          hdr = (*it)->hdr;
+          packet = item.packet->Copy ();
+          hdr = item.hdr;
           hdr.SetRetry ();
-          if (hdr.IsQosData ())
-            {
-              tid = hdr.GetQosTid ();
-            }
-          else
-            {
-              NS_FATAL_ERROR ("Packet in blockAck manager retry queue is not Qos Data");
-            }
+          tid = hdr.GetQosTid ();
           recipient = hdr.GetAddr1 ();
           if (!agreement->second.first.IsHtSupported ()
               && (ExistsAgreementInState (recipient, tid, OriginatorBlockAckAgreement::ESTABLISHED)
@@ -319,18 +480,18 @@ BlockAckManager::GetNextPacket (WifiMacHeader &hdr, bool removePacket)
               hdr.SetQosAckPolicy (WifiMacHeader::NORMAL_ACK);
               if (removePacket)
                 {
-                  AgreementsI i = m_agreements.find (std::make_pair (recipient, tid));
-                  i->second.second.erase (*it);
+                  queue.Erase (seq, 0);
                 }
             }
           if (removePacket)
             {
               NS_LOG_INFO ("Retry packet seq = " << hdr.GetSequenceNumber ());
-              it = m_retryPackets.erase (it);
-              NS_LOG_DEBUG ("Removed one packet, retry buffer size = " << m_retryPackets.size ());
+              queue.SetRetryNeeded (seq, false);
+              NS_LOG_DEBUG ("Removed one packet, retry buffer size = " << queue.GetNRetryPackets ());
             }
           break;
         }
+      queue.Trim ();
     }
   return packet;
 }
@@ -344,79 +505,74 @@ BlockAckManager::PeekNextPacketByTidAndAddress (WifiMacHeader &hdr, uint8_t tid,
   Mac48Address recipient = hdr.GetAddr1 ();
   AgreementsI agreement = m_agreements.find (std::make_pair (recipient, tid));
   NS_ASSERT (agreement != m_agreements.end ());
-  std::list<PacketQueueI>::const_iterator it = m_retryPackets.begin ();
-  for (; it != m_retryPackets.end (); it++)
+  PacketQueue &queue = agreement->second.second;
+  for (uint16_t offset = 0; queue.GetNRetryPackets () > 0 && offset < queue.GetSpan (); offset++)
     {
-      if (!(*it)->hdr.IsQosData ())
+      uint16_t seq = queue.GetSequenceAt (offset);
+      if (!queue.IsRetryNeeded (seq))
+        {
+          continue;
+        }
+      const Item &item = queue.GetItems (seq).front ();
+      if (!item.hdr.IsQosData ())
         {
           NS_FATAL_ERROR ("Packet in blockAck manager retry queue is not Qos Data");
         }
-      if ((*it)->hdr.GetAddr1 () == recipient && (*it)->hdr.GetQosTid () == tid)
+      if (QosUtilsIsOldPacket (agreement->second.first.GetStartingSequence (), seq))
         {
-          if (QosUtilsIsOldPacket (agreement->second.first.GetStartingSequence (),(*it)->hdr.GetSequenceNumber ()))
-            {
-              //standard says the originator should not send a packet with seqnum < winstart
-              NS_LOG_DEBUG ("The Retry packet have sequence number < WinStartO --> Discard " << (*it)->hdr.GetSequenceNumber () << " " << agreement->second.first.GetStartingSequence ());
-              agreement->second.second.erase ((*it));
-              it = m_retryPackets.erase (it);
-              it--;
-              continue;
-            }
-          else if ((*it)->hdr.GetSequenceNumber () > (agreement->second.first.GetStartingSequence () + 63) % 4096)
-            {
-              agreement->second.first.SetStartingSequence ((*it)->hdr.GetSequenceNumber ());
-            }
-          packet = (*it)->packet->Copy ();
-          hdr = (*it)->hdr;
-          hdr.SetRetry ();
-          *tstamp = (*it)->timestamp;
-          NS_LOG_INFO ("Retry packet seq = " << hdr.GetSequenceNumber ());
-          if (!agreement->second.first.IsHtSupported ()
-              && (ExistsAgreementInState (recipient, tid, OriginatorBlockAckAgreement::ESTABLISHED)
-                  || SwitchToBlockAckIfNeeded (recipient, tid, hdr.GetSequenceNumber ())))
-            {
-              hdr.SetQosAckPolicy (WifiMacHeader::BLOCK_ACK);
-            }
-          else
-            {
-              /* From section 9.10.3 in IEEE802.11e standard:
-               * In order to improve efficiency, originators using the Block Ack facility
-               * may send MPDU frames with the Ack Policy subfield in QoS control frames
-               * set to Normal Ack if only a few MPDUs are available for transmission.[...]
-               * When there are sufficient number of MPDUs, the originator may switch back to
-               * the use of Block Ack.
-               */
-              hdr.SetQosAckPolicy (WifiMacHeader::NORMAL_ACK);
-            }
-          NS_LOG_DEBUG ("Peeked one packet from retry buffer size = " << m_retryPackets.size () );
-          return packet;
+          //standard says the originator should not send a packet with seqnum < winstart
+          NS_LOG_DEBUG ("The Retry packet have sequence number < WinStartO --> Discard " << seq << " " << agreement->second.first.GetStartingSequence ());
+          queue.SetRetryNeeded (seq, false);
+          queue.Erase (seq, 0);
+          continue;
+        }
+      else if (seq > (agreement->second.first.GetStartingSequence () + 63) % 4096)
+        {
+          agreement->second.first.SetStartingSequence (seq);
         }
+      packet = item.packet->Copy ();
+      hdr = item.hdr;
+      hdr.SetRetry ();
+      *tstamp = item.timestamp;
+      NS_LOG_INFO ("Retry packet seq = " << hdr.GetSequenceNumber ());
+      if (!agreement->second.first.IsHtSupported ()
+          && (ExistsAgreementInState (recipient, tid, OriginatorBlockAckAgreement::ESTABLISHED)
+              || SwitchToBlockAckIfNeeded (recipient, tid, hdr.GetSequenceNumber ())))
+        {
+          hdr.SetQosAckPolicy (WifiMacHeader::BLOCK_ACK);
+        }
+      else
+        {
+          /* From section 9.10.3 in IEEE802.11e standard:
+           * In order to improve efficiency, originators using the Block Ack facility
+           * may send MPDU frames with the Ack Policy subfield in QoS control frames
+           * set to Normal Ack if only a few MPDUs are available for transmission.[...]
+           * When there are sufficient number of MPDUs, the originator may switch back to
+           * the use of Block Ack.
+           */
+          hdr.SetQosAckPolicy (WifiMacHeader::NORMAL_ACK);
+        }
+      NS_LOG_DEBUG ("Peeked one packet from retry buffer size = " << queue.GetNRetryPackets ());
+      break;
     }
+  queue.Trim ();
   return packet;
 }
 
 bool
 BlockAckManager::RemovePacket (uint8_t tid, Mac48Address recipient, uint16_t seqnumber)
 {
-
-  std::list<PacketQueueI>::const_iterator it = m_retryPackets.begin ();
-  for (; it != m_retryPackets.end (); it++)
+  AgreementsI it = m_agreements.find (std::make_pair (recipient, tid));
+  if (it == m_agreements.end () || !it->second.second.IsRetryNeeded (seqnumber))
     {
-      if (!(*it)->hdr.IsQosData ())
-        {
-          NS_FATAL_ERROR ("Packet in blockAck manager retry queue is not Qos Data");
-        }
-      if ((*it)->hdr.GetAddr1 () == recipient && (*it)->hdr.GetQosTid () == tid && (*it)->hdr.GetSequenceNumber () == seqnumber)
-        {
-          WifiMacHeader hdr = (*it)->hdr;
-          AgreementsI i = m_agreements.find (std::make_pair (recipient, tid));
-          i->second.second.erase ((*it));
-          m_retryPackets.erase (it);
-          NS_LOG_DEBUG ("Removed Packet from retry queue = " << hdr.GetSequenceNumber () << " " << +tid << " " << recipient << " Buffer Size = " << m_retryPackets.size ());
-          return true;
-        }
+      return false;
     }
-  return false;
+  PacketQueue &queue = it->second.second;
+  queue.SetRetryNeeded (seqnumber, false);
+  queue.Erase (seqnumber, 0);
+  queue.Trim ();
+  NS_LOG_DEBUG ("Removed Packet from retry queue = " << seqnumber << " " << +tid << " " << recipient << " Buffer Size = " << queue.GetNRetryPackets ());
+  return true;
 }
 
 bool
@@ -436,7 +592,18 @@ bool
 BlockAckManager::HasPackets (void) const
 {
   NS_LOG_FUNCTION (this);
-  return (m_retryPackets.size () > 0 || m_bars.size () > 0);
+  if (m_bars.size () > 0)
+    {
+      return true;
+    }
+  for (AgreementsCI it = m_agreements.begin (); it != m_agreements.end (); it++)
+    {
+      if (it->second.second.GetNRetryPackets () > 0)
+        {
+          return true;
+        }
+    }
+  return false;
 }
 
 uint32_t
@@ -448,54 +615,20 @@ BlockAckManager::GetNBufferedPackets (Mac48Address recipient, uint8_t tid) const
     {
       return 0;
     }
-  uint32_t nPackets = 0;
-  PacketQueueCI queueIt = (*it).second.second.begin ();
-  while (queueIt != (*it).second.second.end ())
-    {
-      uint16_t currentSeq = (*queueIt).hdr.GetSequenceNumber ();
-      nPackets++;
-      /* a fragmented packet must be counted as one packet */
-      while (queueIt != (*it).second.second.end () && (*queueIt).hdr.GetSequenceNumber () == currentSeq)
-        {
-          queueIt++;
-        }
-    }
-  return nPackets;
+  /* a fragmented packet is counted as one packet */
+  return it->second.second.GetNPackets ();
 }
 
 uint32_t
 BlockAckManager::GetNRetryNeededPackets (Mac48Address recipient, uint8_t tid) const
 {
   NS_LOG_FUNCTION (this << recipient << +tid);
-  uint32_t nPackets = 0;
-  uint16_t currentSeq = 0;
-  if (ExistsAgreement (recipient, tid))
+  AgreementsCI it = m_agreements.find (std::make_pair (recipient, tid));
+  if (it == m_agreements.end ())
     {
-      std::list<PacketQueueI>::const_iterator it = m_retryPackets.begin ();
-      while (it != m_retryPackets.end ())
-        {
-          if (!(*it)->hdr.IsQosData ())
-            {
-              NS_FATAL_ERROR ("Packet in blockAck manager retry queue is not Qos Data");
-            }
-          if ((*it)->hdr.GetAddr1 () == recipient && (*it)->hdr.GetQosTid () == tid)
-            {
-              currentSeq = (*it)->hdr.GetSequenceNumber ();
-              nPackets++;
-              /* a fragmented packet must be counted as one packet */
-              while (it != m_retryPackets.end () && (*it)->hdr.GetSequenceNumber () == currentSeq)
-                {
-                  it++;
-                }
-            }
-          //go to next packet
-          else
-            {
-              it++;
-            }
-        }
+      return 0;
     }
-  return nPackets;
+  return it->second.second.GetNRetryPackets ();
 }
 
 void
@@ -515,21 +648,9 @@ BlockAckManager::SetWifiRemoteStationManager (const Ptr<WifiRemoteStationManager
 bool
 BlockAckManager::AlreadyExists (uint16_t currentSeq, Mac48Address recipient, uint8_t tid) const
 {
-  std::list<PacketQueueI>::const_iterator it = m_retryPackets.begin ();
-  while (it != m_retryPackets.end ())
-    {
-      NS_LOG_FUNCTION (this << (*it)->hdr.GetType ());
-      if (!(*it)->hdr.IsQosData ())
-        {
-          NS_FATAL_ERROR ("Packet in blockAck manager retry queue is not Qos Data");
-        }
-      if ((*it)->hdr.GetAddr1 () == recipient && (*it)->hdr.GetQosTid () == tid && currentSeq == (*it)->hdr.GetSequenceNumber ())
-        {
-          return true;
-        }
-      it++;
-    }
-  return false;
+  NS_LOG_FUNCTION (this << currentSeq << recipient << +tid);
+  AgreementsCI it = m_agreements.find (std::make_pair (recipient, tid));
+  return (it != m_agreements.end () && it->second.second.IsRetryNeeded (currentSeq));
 }
 
 void
@@ -546,7 +667,6 @@ BlockAckManager::NotifyGotBlockAck (const CtrlBAckResponseHeader *blockAck, Mac4
           uint8_t nSuccessfulMpdus = 0;
           uint8_t nFailedMpdus = 0;
           AgreementsI it = m_agreements.find (std::make_pair (recipient, tid));
-          PacketQueueI queueEnd = it->second.second.end ();
 
           if (it->second.first.m_inactivityEvent.IsRunning ())
             {
@@ -560,74 +680,79 @@ BlockAckManager::NotifyGotBlockAck (const CtrlBAckResponseHeader *blockAck, Mac4
                                                                         this,
                                                                         recipient, tid);
             }
+          PacketQueue &queue = it->second.second;
           if (blockAck->IsBasic ())
             {
-              for (PacketQueueI queueIt = it->second.second.begin (); queueIt != queueEnd; )
+              for (uint16_t offset = 0; offset < queue.GetSpan (); offset++)
                 {
-                  if (blockAck->IsFragmentReceived ((*queueIt).hdr.GetSequenceNumber (),
-                                                    (*queueIt).hdr.GetFragmentNumber ()))
-                    {
-                      nSuccessfulMpdus++;
-                      RemoveFromRetryQueue (recipient, tid, (*queueIt).hdr.GetSequenceNumber ());
-                      queueIt = it->second.second.erase (queueIt);
-                    }
-                  else
+                  uint16_t seq = queue.GetSequenceAt (offset);
+                  std::vector<Item> &items = queue.GetItems (seq);
+                  for (std::size_t i = 0; i < items.size (); )
                     {
-                      if (!foundFirstLost)
+                      if (blockAck->IsFragmentReceived (seq, items[i].hdr.GetFragmentNumber ()))
                         {
-                          foundFirstLost = true;
-                          sequenceFirstLost = (*queueIt).hdr.GetSequenceNumber ();
-                          (*it).second.first.SetStartingSequence (sequenceFirstLost);
+                          nSuccessfulMpdus++;
+                          queue.SetRetryNeeded (seq, false);
+                          queue.Erase (seq, i);
                         }
-                      nFailedMpdus++;
-                      if (!AlreadyExists ((*queueIt).hdr.GetSequenceNumber (),recipient,tid))
+                      else
                         {
-                          InsertInRetryQueue (queueIt);
+                          if (!foundFirstLost)
+                            {
+                              foundFirstLost = true;
+                              sequenceFirstLost = seq;
+                              (*it).second.first.SetStartingSequence (sequenceFirstLost);
+                            }
+                          nFailedMpdus++;
+                          queue.SetRetryNeeded (seq, true);
+                          i++;
                         }
-                      queueIt++;
                     }
                 }
             }
           else if (blockAck->IsCompressed ())
             {
-              for (PacketQueueI queueIt = it->second.second.begin (); queueIt != queueEnd; )
+              for (uint16_t offset = 0; offset < queue.GetSpan (); offset++)
                 {
-                  uint16_t currentSeq = (*queueIt).hdr.GetSequenceNumber ();
-                  if (blockAck->IsPacketReceived (currentSeq))
+                  uint16_t seq = queue.GetSequenceAt (offset);
+                  std::vector<Item> &items = queue.GetItems (seq);
+                  if (items.empty ())
                     {
-                      while (queueIt != queueEnd
-                             && (*queueIt).hdr.GetSequenceNumber () == currentSeq)
+                      continue;
+                    }
+                  if (blockAck->IsPacketReceived (seq))
+                    {
+                      for (std::size_t i = 0; i < items.size (); i++)
                         {
                           nSuccessfulMpdus++;
                           if (!m_txOkCallback.IsNull ())
                             {
-                              m_txOkCallback ((*queueIt).hdr);
+                              m_txOkCallback (items[i].hdr);
                             }
-                          RemoveFromRetryQueue (recipient, tid, currentSeq);
-                          queueIt = it->second.second.erase (queueIt);
                         }
+                      queue.EraseAll (seq);
                     }
                   else
                     {
                       if (!foundFirstLost)
                         {
                           foundFirstLost = true;
-                          sequenceFirstLost = (*queueIt).hdr.GetSequenceNumber ();
+                          sequenceFirstLost = seq;
                           (*it).second.first.SetStartingSequence (sequenceFirstLost);
                         }
-                      nFailedMpdus++;
-                      if (!m_txFailedCallback.IsNull ())
-                        {
-                          m_txFailedCallback ((*queueIt).hdr);
-                        }
-                      if (!AlreadyExists ((*queueIt).hdr.GetSequenceNumber (),recipient,tid))
+                      for (std::size_t i = 0; i < items.size (); i++)
                         {
-                          InsertInRetryQueue (queueIt);
+                          nFailedMpdus++;
+                          if (!m_txFailedCallback.IsNull ())
+                            {
+                              m_txFailedCallback (items[i].hdr);
+                            }
                         }
-                      queueIt++;
+                      queue.SetRetryNeeded (seq, true);
                     }
                 }
             }
+          queue.Trim ();
           m_stationManager->ReportAmpduTxStatus (recipient, tid, nSuccessfulMpdus, nFailedMpdus, rxSnr, dataSnr);
           uint16_t newSeq = m_txMiddle->GetNextSeqNumberByTidAndAddress (tid, recipient);
           if ((foundFirstLost && !SwitchToBlockAckIfNeeded (recipient, tid, sequenceFirstLost))
@@ -807,20 +932,11 @@ bool BlockAckManager::NeedBarRetransmission (uint8_t tid, uint16_t seqNumber, Ma
 void
 BlockAckManager::RemoveFromRetryQueue (Mac48Address address, uint8_t tid, uint16_t seq)
 {
-  /* remove retry packet iterator if it's present in retry queue */
-  std::list<PacketQueueI>::const_iterator it = m_retryPackets.begin ();
-  while (it != m_retryPackets.end ())
+  /* clear the retry flag if the packet is stored */
+  AgreementsI it = m_agreements.find (std::make_pair (address, tid));
+  if (it != m_agreements.end () && it->second.second.IsRetryNeeded (seq))
     {
-      if ((*it)->hdr.GetAddr1 () == address
-          && (*it)->hdr.GetQosTid () == tid
-          && (*it)->hdr.GetSequenceNumber () == seq)
-        {
-          it = m_retryPackets.erase (it);
-        }
-      else
-        {
-          it++;
-        }
+      it->second.second.SetRetryNeeded (seq, false);
     }
 }
 
@@ -830,28 +946,50 @@ BlockAckManager::CleanupBuffers (void)
   NS_LOG_FUNCTION (this);
   for (AgreementsI j = m_agreements.begin (); j != m_agreements.end (); j++)
     {
-      if (j->second.second.empty ())
+      PacketQueue &queue = j->second.second;
+      if (queue.IsEmpty ())
         {
           continue;
         }
+      queue.Trim ();
       Time now = Simulator::Now ();
-      PacketQueueI end = j->second.second.begin ();
-      for (PacketQueueI i = j->second.second.begin (); i != j->second.second.end (); i++)
+      uint16_t endSeq = queue.GetSequenceAt (0);
+      uint16_t endOffset = 0;
+      std::size_t endIndex = 0;
+      bool found = false;
+      for (uint16_t offset = 0; offset < queue.GetSpan () && !found; offset++)
+        {
+          uint16_t seq = queue.GetSequenceAt (offset);
+          std::vector<Item> &items = queue.GetItems (seq);
+          for (std::size_t i = 0; i < items.size (); i++)
+            {
+              if (items[i].timestamp + m_maxDelay > now)
+                {
+                  endSeq = seq;
+                  endOffset = offset;
+                  endIndex = i;
+                  found = true;
+                  break;
+                }
+              else
+                {
+                  queue.SetRetryNeeded (seq, false);
+                }
+            }
+        }
+      if (found)
         {
-          if (i->timestamp + m_maxDelay > now)
+          for (uint16_t offset = 0; offset < endOffset; offset++)
             {
-              end = i;
-              break;
+              queue.EraseAll (queue.GetSequenceAt (offset));
             }
-          else
+          for (std::size_t i = 0; i < endIndex; i++)
             {
-              RemoveFromRetryQueue (j->second.first.GetPeer (),
-                                    j->second.first.GetTid (),
-                                    i->hdr.GetSequenceNumber ());
+              queue.Erase (endSeq, 0);
             }
+          queue.Trim ();
         }
-      j->second.second.erase (j->second.second.begin (), end);
-      j->second.first.SetStartingSequence (end->hdr.GetSequenceNumber ());
+      j->second.first.SetStartingSequence (endSeq);
     }
 }
 
@@ -894,18 +1032,18 @@ uint16_t
 BlockAckManager::GetSeqNumOfNextRetryPacket (Mac48Address recipient, uint8_t tid) const
 {
   NS_LOG_FUNCTION (this << recipient << +tid);
-  std::list<PacketQueueI>::const_iterator it = m_retryPackets.begin ();
-  while (it != m_retryPackets.end ())
+  AgreementsCI it = m_agreements.find (std::make_pair (recipient, tid));
+  if (it != m_agreements.end ())
     {
-      if (!(*it)->hdr.IsQosData ())
-        {
-          NS_FATAL_ERROR ("Packet in blockAck manager retry queue is not Qos Data");
-        }
-      if ((*it)->hdr.GetAddr1 () == recipient && (*it)->hdr.GetQosTid () == tid)
+      const PacketQueue &queue = it->second.second;
+      for (uint16_t offset = 0; queue.GetNRetryPackets () > 0 && offset < queue.GetSpan (); offset++)
         {
-          return (*it)->hdr.GetSequenceNumber ();
+          uint16_t seq = queue.GetSequenceAt (offset);
+          if (queue.IsRetryNeeded (seq))
+            {
+              return seq;
+            }
         }
-      it++;
     }
   return 4096;
 }
@@ -922,33 +1060,4 @@ BlockAckManager::SetTxFailedCallback (TxFailed callback)
   m_txFailedCallback = callback;
 }
 
-void
-BlockAckManager::InsertInRetryQueue (PacketQueueI item)
-{
-  NS_LOG_INFO ("Adding to retry queue " << (*item).hdr.GetSequenceNumber ());
-  if (m_retryPackets.size () == 0)
-    {
-      m_retryPackets.push_back (item);
-    }
-  else
-    {
-      for (std::list<PacketQueueI>::const_iterator it = m_retryPackets.begin (); it != m_retryPackets.end (); )
-        {
-          if (((item->hdr.GetSequenceNumber () - (*it)->hdr.GetSequenceNumber () + 4096) % 4096) > 2047)
-            {
-              it = m_retryPackets.insert (it, item);
-              break;
-            }
-          else
-            {
-              it++;
-              if (it == m_retryPackets.end ())
-                {
-                  m_retryPackets.push_back (item);
-                }
-            }
-        }
-    }
-}
-
 } //namespace ns3
@@ -22,6 +22,8 @@
 #define BLOCK_ACK_MANAGER_H
 
 #include <map>
+#include <vector>
+#include "ns3/object.h"
 #include "ns3/nstime.h"
 #include "wifi-mac-header.h"
 #include "originator-block-ack-agreement.h"
@@ -409,35 +411,6 @@ private:
    */
   void InactivityTimeout (Mac48Address recipient, uint8_t tid);
 
-  struct Item;
-  /**
-   * typedef for a list of Item struct.
-   */
-  typedef std::list<Item> PacketQueue;
-  /**
-   * typedef for an iterator for PacketQueue.
-   */
-  typedef std::list<Item>::iterator PacketQueueI;
-  /**
-   * typedef for a const iterator for PacketQueue.
-   */
-  typedef std::list<Item>::const_iterator PacketQueueCI;
-  /**
-   * typedef for a map between MAC address and block ACK agreement.
-   */
-  typedef std::map<std::pair<Mac48Address, uint8_t>,
-                   std::pair<OriginatorBlockAckAgreement, PacketQueue> > Agreements;
-  /**
-   * typedef for an iterator for Agreements.
-   */
-  typedef std::map<std::pair<Mac48Address, uint8_t>,
-                   std::pair<OriginatorBlockAckAgreement, PacketQueue> >::iterator AgreementsI;
-  /**
-   * typedef for a const iterator for Agreements.
-   */
-  typedef std::map<std::pair<Mac48Address, uint8_t>,
-                   std::pair<OriginatorBlockAckAgreement, PacketQueue> >::const_iterator AgreementsCI;
-
   /**
    * A struct for packet, Wifi header, and timestamp.
    * Used in queue by block ACK manager.
@@ -458,13 +431,142 @@ private:
     WifiMacHeader hdr; ///< header
     Time timestamp; ///< timestamp
   };
+
   /**
-   * \param item
+   * \brief Packets sent under a block ack agreement and not acknowledged yet.
+   *
+   * Packets are stored in a circular buffer of slots indexed by their sequence
+   * number modulo the capacity of the buffer, hence the packet having a given
+   * sequence number is found in constant time. A slot holds the fragments
+   * sharing a sequence number and a flag telling whether the packet needs to
+   * be retransmitted. The buffer only grows when a packet falls outside the
+   * range of sequence numbers it can hold, so that no allocation is performed
+   * once it has adapted to the size of the transmission window.
    *
-   * Insert item in retransmission queue.
-   * This method ensures packets are retransmitted in the correct order.
+   * Erasing packets leaves empty slots at the edges of the buffer, so that
+   * offsets remain valid while iterating; call Trim () once done.
+   */
+  class PacketQueue
+  {
+  public:
+    PacketQueue ();
+
+    /**
+     * \return true if no packet is stored
+     */
+    bool IsEmpty (void) const;
+    /**
+     * \return the number of distinct sequence numbers stored
+     */
+    uint32_t GetNPackets (void) const;
+    /**
+     * \return the number of packets that need to be retransmitted
+     */
+    uint32_t GetNRetryPackets (void) const;
+    /**
+     * \return the number of sequence numbers between the first and the
+     *         last stored packets, both included
+     */
+    uint16_t GetSpan (void) const;
+    /**
+     * \param offset the offset from the first stored packet
+     * \return the sequence number located at the given offset
+     */
+    uint16_t GetSequenceAt (uint16_t offset) const;
+    /**
+     * \param seq a sequence number within the span of the queue
+     * \return the fragments having the given sequence number, in the order
+     *         they were stored
+     */
+    std::vector<Item> & GetItems (uint16_t seq);
+    /**
+     * \param seq the sequence number
+     * \return true if the packet having the given sequence number needs to
+     *         be retransmitted
+     */
+    bool IsRetryNeeded (uint16_t seq) const;
+    /**
+     * \param seq a sequence number within the span of the queue
+     * \param retry whether the packet needs to be retransmitted
+     */
+    void SetRetryNeeded (uint16_t seq, bool retry);
+    /**
+     * Store a packet after the fragments having the same sequence number.
+     *
+     * \param item the packet to store
+     */
+    void Insert (const Item &item);
+    /**
+     * Erase a fragment. The retry flag is cleared if no fragment is left.
+     *
+     * \param seq a sequence number within the span of the queue
+     * \param index the index of the fragment in the slot
+     */
+    void Erase (uint16_t seq, std::size_t index);
+    /**
+     * Erase all the fragments having the given sequence number.
+     *
+     * \param seq a sequence number within the span of the queue
+     */
+    void EraseAll (uint16_t seq);
+    /**
+     * Drop the empty slots at both edges of the span.
+     */
+    void Trim (void);
+
+  private:
+    /// A slot of the circular buffer
+    struct Slot
+    {
+      Slot ();
+      std::vector<Item> items; ///< fragments having the same sequence number
+      bool retry; ///< whether the packet needs to be retransmitted
+    };
+
+    /**
+     * \param seq the sequence number
+     * \return true if the sequence number is within the span of the queue
+     */
+    bool IsInSpan (uint16_t seq) const;
+    /**
+     * \param seq the sequence number
+     * \return the slot mapped to the given sequence number
+     */
+    Slot & GetSlot (uint16_t seq);
+    /**
+     * \param seq the sequence number
+     * \return the slot mapped to the given sequence number
+     */
+    const Slot & GetSlot (uint16_t seq) const;
+    /**
+     * Enlarge the buffer so that it can hold the given span.
+     *
+     * \param span the number of sequence numbers to hold
+     */
+    void Grow (uint16_t span);
+
+    std::vector<Slot> m_slots; ///< the circular buffer, whose size is a power of two
+    uint16_t m_head; ///< the sequence number of the first slot of the span
+    uint16_t m_span; ///< the number of slots in the span
+    uint32_t m_nPackets; ///< the number of non-empty slots
+    uint32_t m_nRetry; ///< the number of slots flagged for retransmission
+  };
+
+  /**
+   * typedef for a map between MAC address and block ACK agreement.
    */
-  void InsertInRetryQueue (PacketQueueI item);
+  typedef std::map<std::pair<Mac48Address, uint8_t>,
+                   std::pair<OriginatorBlockAckAgreement, PacketQueue> > Agreements;
+  /**
+   * typedef for an iterator for Agreements.
+   */
+  typedef std::map<std::pair<Mac48Address, uint8_t>,
+                   std::pair<OriginatorBlockAckAgreement, PacketQueue> >::iterator AgreementsI;
+  /**
+   * typedef for a const iterator for Agreements.
+   */
+  typedef std::map<std::pair<Mac48Address, uint8_t>,
+                   std::pair<OriginatorBlockAckAgreement, PacketQueue> >::const_iterator AgreementsCI;
 
   /**
    * Remove items from retransmission queue.
@@ -480,16 +582,10 @@ private:
    * This data structure contains, for each block ack agreement (recipient, tid), a set of packets
    * for which an ack by block ack is requested.
    * Every packet or fragment indicated as correctly received in block ack frame is
-   * erased from this data structure. Pushed back in retransmission queue otherwise.
+   * erased from this data structure. Flagged for retransmission otherwise.
    */
   Agreements m_agreements;
 
-  /**
-   * This list contains all iterators to stored packets that need to be retransmitted.
-   * A packet needs retransmission if it's indicated as not correctly received in a block ack
-   * frame.
-   */
-  std::list<PacketQueueI> m_retryPackets;
   std::list<Bar> m_bars; ///< list of BARs
 
   uint8_t m_blockAckThreshold; ///< block ack threshold
@@ -122,7 +122,8 @@ InterferenceHelper::InterferenceHelper ()
   : m_errorRateModel (0),
     m_numRxAntennas (1),
     m_firstPower (0),
-    m_rxing (false)
+    m_rxing (false),
+    m_linkAbstraction (false)
 {
   // Always have a zero power noise event in the list
   AddNiChangeEvent (Time (0), NiChange (0.0, 0));
@@ -162,6 +163,7 @@ void
 InterferenceHelper::SetErrorRateModel (const Ptr<ErrorRateModel> rate)
 {
   m_errorRateModel = rate;
+  m_successRateCurves.clear ();
 }
 
 Ptr<ErrorRateModel>
@@ -176,6 +178,18 @@ InterferenceHelper::SetNumberOfReceiveAntennas (uint8_t rx)
   m_numRxAntennas = rx;
 }
 
+void
+InterferenceHelper::SetLinkAbstraction (bool enable)
+{
+  m_linkAbstraction = enable;
+}
+
+bool
+InterferenceHelper::GetLinkAbstraction (void) const
+{
+  return m_linkAbstraction;
+}
+
 Time
 InterferenceHelper::GetEnergyDuration (double energyW) const
 {
@@ -321,6 +335,112 @@ InterferenceHelper::CalculatePlcpPayloadPer (Ptr<const Event> event, NiChanges *
   return per;
 }
 
+double
+InterferenceHelper::CalculatePlcpPayloadPerAbstraction (Ptr<const Event> event, NiChanges *ni) const
+{
+  NS_LOG_FUNCTION (this);
+  const WifiTxVector txVector = event->GetTxVector ();
+  auto j = ni->begin ();
+  Time previous = j->first;
+  WifiMode payloadMode = event->GetPayloadMode ();
+  WifiPreamble preamble = txVector.GetPreambleType ();
+  Time plcpPayloadStart = j->first + WifiPhy::GetPlcpPreambleDuration (txVector) + WifiPhy::GetPlcpHeaderDuration (txVector)
+    + WifiPhy::GetPlcpHtSigHeaderDuration (preamble) + WifiPhy::GetPlcpSigA1Duration (preamble) + WifiPhy::GetPlcpSigA2Duration (preamble)
+    + WifiPhy::GetPlcpTrainingSymbolDuration (txVector) + WifiPhy::GetPlcpSigBDuration (preamble);
+  double noiseInterferenceW = m_firstPower;
+  double powerW = event->GetRxPowerW ();
+  double snrDbTimesSeconds = 0;
+  Time payloadDuration = Seconds (0);
+  while (++j != ni->end ())
+    {
+      Time current = j->first;
+      NS_ASSERT (current >= previous);
+      if (current > plcpPayloadStart)
+        {
+          Time chunkDuration = current - Max (previous, plcpPayloadStart);
+          double snr = CalculateSnr (powerW, noiseInterferenceW, txVector.GetChannelWidth ());
+          snrDbTimesSeconds += 10 * std::log10 (snr) * chunkDuration.GetSeconds ();
+          payloadDuration += chunkDuration;
+        }
+      noiseInterferenceW = j->second.GetPower () - powerW;
+      previous = j->first;
+    }
+  if (payloadDuration.IsZero ())
+    {
+      return 0;
+    }
+  double snir = std::pow (10.0, snrDbTimesSeconds / payloadDuration.GetSeconds () / 10);
+  uint64_t nbits = static_cast<uint64_t> (payloadMode.GetPhyRate (txVector) * payloadDuration.GetSeconds ());
+  if (payloadMode.GetModulationClass () == WIFI_MOD_CLASS_HT || payloadMode.GetModulationClass () == WIFI_MOD_CLASS_VHT || payloadMode.GetModulationClass () == WIFI_MOD_CLASS_HE)
+    {
+      nbits /= txVector.GetNss (); //same as in CalculateChunkSuccessRate
+      snir *= txVector.GetNTx () * m_numRxAntennas;
+    }
+  double per = 1 - GetCachedChunkSuccessRate (snir, nbits, payloadMode, txVector);
+  NS_LOG_DEBUG ("effective snir(linear)=" << snir << ", mode=" << payloadMode << ", per=" << per);
+  return per;
+}
+
+double
+InterferenceHelper::GetCachedChunkSuccessRate (double snir, uint64_t nbits, WifiMode mode, WifiTxVector txVector) const
+{
+  //the curves sample the success rate every half dB between -10 dB and 60 dB
+  static const double minSnrDb = -10;
+  static const double maxSnrDb = 60;
+  static const double stepDb = 0.5;
+  static const std::size_t nPoints = static_cast<std::size_t> ((maxSnrDb - minSnrDb) / stepDb) + 1;
+  if (nbits == 0)
+    {
+      return 1.0;
+    }
+  uint8_t log2Bits = 0;
+  while ((static_cast<uint64_t> (1) << log2Bits) < nbits)
+    {
+      log2Bits++;
+    }
+  uint64_t curveBits = static_cast<uint64_t> (1) << log2Bits;
+  SuccessRateCurve &curve = m_successRateCurves[std::make_tuple (mode.GetUid (), txVector.GetChannelWidth (),
+                                                                 txVector.GetGuardInterval (), txVector.GetNss (),
+                                                                 log2Bits)];
+  if (curve.empty ())
+    {
+      curve.reserve (nPoints);
+      for (std::size_t i = 0; i < nPoints; i++)
+        {
+          double snr = std::pow (10.0, (minSnrDb + i * stepDb) / 10);
+          curve.push_back (m_errorRateModel->GetChunkSuccessRate (mode, txVector, snr, curveBits));
+        }
+    }
+  double position = (10 * std::log10 (snir) - minSnrDb) / stepDb;
+  double psr;
+  if (position <= 0)
+    {
+      psr = curve.front ();
+    }
+  else if (position >= nPoints - 1)
+    {
+      psr = curve.back ();
+    }
+  else
+    {
+      std::size_t i = static_cast<std::size_t> (position);
+      double weight = position - i;
+      if (curve[i] > 0 && curve[i + 1] < 1)
+        {
+          //-log (psr) is proportional to the bit error rate, whose logarithm
+          //varies slowly with the SNR in dB, unlike the success rate itself
+          psr = std::exp (-std::exp (std::log (-std::log (curve[i])) * (1 - weight)
+                                     + std::log (-std::log (curve[i + 1])) * weight));
+        }
+      else
+        {
+          psr = curve[i] * (1 - weight) + curve[i + 1] * weight;
+        }
+    }
+  //the success rate of a chunk decreases geometrically with its size
+  return std::pow (psr, static_cast<double> (nbits) / curveBits);
+}
+
 double
 InterferenceHelper::CalculatePlcpHeaderPer (Ptr<const Event> event, NiChanges *ni) const
 {
@@ -748,7 +868,7 @@ InterferenceHelper::CalculatePlcpPayloadSnrPer (Ptr<Event> event) const
   /* calculate the SNIR at the start of the packet and accumulate
    * all SNIR changes in the snir vector.
    */
-  double per = CalculatePlcpPayloadPer (event, &ni);
+  double per = m_linkAbstraction ? CalculatePlcpPayloadPerAbstraction (event, &ni) : CalculatePlcpPayloadPer (event, &ni);
 
   struct SnrPer snrPer;
   snrPer.snr = snr;
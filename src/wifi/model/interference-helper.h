@@ -24,6 +24,8 @@
 #include "ns3/nstime.h"
 #include "wifi-tx-vector.h"
 #include <map>
+#include <vector>
+#include <tuple>
 
 namespace ns3 {
 
@@ -143,6 +145,20 @@ public:
    * \param rx the number of RX antennas
    */
   void SetNumberOfReceiveAntennas (uint8_t rx);
+  /**
+   * Enable or disable the link abstraction of the plcp payload. When enabled,
+   * the error rate of the payload is read from a cached curve of the error
+   * rate model, at the effective SNIR of the payload (the average of the
+   * SNIR in dB of its chunks, weighted by their duration), instead of
+   * combining the success rates of all the chunks.
+   *
+   * \param enable true to enable the link abstraction
+   */
+  void SetLinkAbstraction (bool enable);
+  /**
+   * \return true if the link abstraction of the plcp payload is enabled
+   */
+  bool GetLinkAbstraction (void) const;
 
   /**
    * \param energyW the minimum energy (W) requested
@@ -306,6 +322,41 @@ private:
    * \return the error rate of the packet
    */
   double CalculatePlcpHeaderPer (Ptr<const Event> event, NiChanges *ni) const;
+  /**
+   * Calculate the error rate of the given plcp payload from the effective
+   * SNIR of its chunks, using the cached success rate curves.
+   *
+   * \param event
+   * \param ni
+   *
+   * \return the error rate of the packet
+   */
+  double CalculatePlcpPayloadPerAbstraction (Ptr<const Event> event, NiChanges *ni) const;
+  /**
+   * Return the success rate of a chunk from the cached success rate curve of
+   * the given mode, which is built the first time the mode is used with the
+   * same channel width, guard interval and number of spatial streams for
+   * chunks whose size falls in the same power of two.
+   *
+   * \param snir SINR (linear ratio), including the MIMO gain
+   * \param nbits the number of bits of the chunk
+   * \param mode the Wi-Fi mode of the chunk
+   * \param txVector the TXVECTOR used to build the curve
+   *
+   * \return the success rate
+   */
+  double GetCachedChunkSuccessRate (double snir, uint64_t nbits, WifiMode mode, WifiTxVector txVector) const;
+
+  /// Success rates sampled at regularly spaced SNR values (dB)
+  typedef std::vector<double> SuccessRateCurve;
+  /**
+   * Key of a success rate curve: the mode UID, the channel width (MHz), the
+   * guard interval (ns) and the number of spatial streams, on which the phy
+   * rate depends, and the log2 of the chunk size in bits
+   */
+  typedef std::tuple<uint32_t, uint16_t, uint16_t, uint8_t, uint8_t> SuccessRateCurveKey;
+  /// Success rate curves indexed by their key
+  typedef std::map<SuccessRateCurveKey, SuccessRateCurve> SuccessRateCurves;
 
   double m_noiseFigure; /**< noise figure (linear) */
   Ptr<ErrorRateModel> m_errorRateModel; ///< error rate model
@@ -314,6 +365,8 @@ private:
   NiChanges m_niChanges;
   double m_firstPower; ///< first power
   bool m_rxing; ///< flag whether it is in receiving state
+  bool m_linkAbstraction; ///< flag whether the link abstraction of the plcp payload is enabled
+  mutable SuccessRateCurves m_successRateCurves; ///< success rate curves cached by the link abstraction
 
   /**
    * Returns an iterator to the first nichange that is later than moment
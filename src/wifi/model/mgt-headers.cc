@@ -191,6 +191,7 @@ MgtProbeRequestHeader::Deserialize (Buffer::Iterator start)
 NS_OBJECT_ENSURE_REGISTERED (MgtProbeResponseHeader);
 
 MgtProbeResponseHeader::MgtProbeResponseHeader ()
+  : m_serializedElementsValid (false)
 {
 }
 
@@ -226,6 +227,7 @@ void
 MgtProbeResponseHeader::SetCapabilities (CapabilityInformation capabilities)
 {
   m_capability = capabilities;
+  m_serializedElementsValid = false;
 }
 
 CapabilityInformation
@@ -238,6 +240,7 @@ void
 MgtProbeResponseHeader::SetExtendedCapabilities (ExtendedCapabilities extendedcapabilities)
 {
   m_extendedCapability = extendedcapabilities;
+  m_serializedElementsValid = false;
 }
 
 ExtendedCapabilities
@@ -250,6 +253,7 @@ void
 MgtProbeResponseHeader::SetHtCapabilities (HtCapabilities htcapabilities)
 {
   m_htCapability = htcapabilities;
+  m_serializedElementsValid = false;
 }
 
 HtCapabilities
@@ -262,6 +266,7 @@ void
 MgtProbeResponseHeader::SetHtOperation (HtOperation htoperation)
 {
   m_htOperation = htoperation;
+  m_serializedElementsValid = false;
 }
 
 HtOperation
@@ -274,6 +279,7 @@ void
 MgtProbeResponseHeader::SetVhtCapabilities (VhtCapabilities vhtcapabilities)
 {
   m_vhtCapability = vhtcapabilities;
+  m_serializedElementsValid = false;
 }
 
 VhtCapabilities
@@ -286,6 +292,7 @@ void
 MgtProbeResponseHeader::SetVhtOperation (VhtOperation vhtoperation)
 {
   m_vhtOperation = vhtoperation;
+  m_serializedElementsValid = false;
 }
 
 VhtOperation
@@ -298,6 +305,7 @@ void
 MgtProbeResponseHeader::SetHeCapabilities (HeCapabilities hecapabilities)
 {
   m_heCapability = hecapabilities;
+  m_serializedElementsValid = false;
 }
 
 HeCapabilities
@@ -310,6 +318,7 @@ void
 MgtProbeResponseHeader::SetHeOperation (HeOperation heoperation)
 {
   m_heOperation = heoperation;
+  m_serializedElementsValid = false;
 }
 
 HeOperation
@@ -322,6 +331,7 @@ void
 MgtProbeResponseHeader::SetCfParameterSet (CfParameterSet cfparameterset)
 {
   m_cfParameterSet = cfparameterset;
+  m_serializedElementsValid = false;
 }
 
 CfParameterSet
@@ -334,6 +344,7 @@ void
 MgtProbeResponseHeader::SetSsid (Ssid ssid)
 {
   m_ssid = ssid;
+  m_serializedElementsValid = false;
 }
 
 void
@@ -346,12 +357,14 @@ void
 MgtProbeResponseHeader::SetSupportedRates (SupportedRates rates)
 {
   m_rates = rates;
+  m_serializedElementsValid = false;
 }
 
 void
 MgtProbeResponseHeader::SetDsssParameterSet (DsssParameterSet dsssParameterSet)
 {
   m_dsssParameterSet = dsssParameterSet;
+  m_serializedElementsValid = false;
 }
 
 DsssParameterSet
@@ -364,6 +377,7 @@ void
 MgtProbeResponseHeader::SetErpInformation (ErpInformation erpInformation)
 {
   m_erpInformation = erpInformation;
+  m_serializedElementsValid = false;
 }
 
 ErpInformation
@@ -376,6 +390,7 @@ void
 MgtProbeResponseHeader::SetEdcaParameterSet (EdcaParameterSet edcaparameters)
 {
   m_edcaParameterSet = edcaparameters;
+  m_serializedElementsValid = false;
 }
 
 EdcaParameterSet
@@ -407,6 +422,18 @@ MgtProbeResponseHeader::GetSerializedSize (void) const
   uint32_t size = 0;
   size += 8; //timestamp
   size += 2; //beacon interval
+  if (m_serializedElementsValid)
+    {
+      return size + static_cast<uint32_t> (m_serializedElements.size ());
+    }
+  size += GetElementsSerializedSize ();
+  return size;
+}
+
+uint32_t
+MgtProbeResponseHeader::GetElementsSerializedSize (void) const
+{
+  uint32_t size = 0;
   size += m_capability.GetSerializedSize ();
   size += m_ssid.GetSerializedSize ();
   size += m_rates.GetSerializedSize ();
@@ -455,6 +482,13 @@ MgtProbeResponseHeader::Serialize (Buffer::Iterator start) const
   Buffer::Iterator i = start;
   i.WriteHtolsbU64 (Simulator::Now ().GetMicroSeconds ());
   i.WriteHtolsbU16 (static_cast<uint16_t> (m_beaconInterval / 1024));
+  if (m_serializedElementsValid)
+    {
+      //only the timestamp and the beacon interval may differ from the last serialization
+      i.Write (m_serializedElements.data (), static_cast<uint32_t> (m_serializedElements.size ()));
+      return;
+    }
+  Buffer::Iterator elements = i;
   i = m_capability.Serialize (i);
   i = m_ssid.Serialize (i);
   i = m_rates.Serialize (i);
@@ -470,12 +504,16 @@ MgtProbeResponseHeader::Serialize (Buffer::Iterator start) const
   i = m_vhtOperation.Serialize (i);
   i = m_heCapability.Serialize (i);
   i = m_heOperation.Serialize (i);
+  m_serializedElements.resize (i.GetDistanceFrom (elements));
+  elements.Read (m_serializedElements.data (), static_cast<uint32_t> (m_serializedElements.size ()));
+  m_serializedElementsValid = true;
 }
 
 uint32_t
 MgtProbeResponseHeader::Deserialize (Buffer::Iterator start)
 {
   Buffer::Iterator i = start;
+  m_serializedElementsValid = false;
   m_timestamp = i.ReadLsbtohU64 ();
   m_beaconInterval = i.ReadLsbtohU16 ();
   m_beaconInterval *= 1024;
@@ -815,6 +815,11 @@ public:
 
 
 private:
+  /**
+   * \return the size of the information elements following the beacon interval
+   */
+  uint32_t GetElementsSerializedSize (void) const;
+
   uint64_t m_timestamp;                //!< Timestamp
   Ssid m_ssid;                         //!< Service set ID (SSID)
   uint64_t m_beaconInterval;           //!< Beacon interval
@@ -831,6 +836,15 @@ private:
   ErpInformation m_erpInformation;     //!< ERP information
   EdcaParameterSet m_edcaParameterSet; //!< EDCA Parameter Set
   CfParameterSet m_cfParameterSet;     //!< CF parameter set
+
+  /**
+   * Serialized form of the fields following the beacon interval, kept from
+   * the last call to Serialize so that a header which is sent repeatedly
+   * (e.g. the beacon template of an AP) is only serialized once. Any setter
+   * invalidates it.
+   */
+  mutable std::vector<uint8_t> m_serializedElements;
+  mutable bool m_serializedElementsValid; //!< whether m_serializedElements matches the fields
 };
 
 
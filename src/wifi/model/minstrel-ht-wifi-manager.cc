@@ -65,6 +65,7 @@ struct MinstrelHtWifiRemoteStation : MinstrelWifiRemoteStation
   uint32_t m_ampduPacketCount; //!< Number of A-MPDUs transmitted.
 
   McsGroupData m_groupsTable;  //!< Table of groups with stats.
+  HtRateStats m_rateStats;     //!< Statistics of all the rates, indexed by rate index.
   bool m_isHt;                 //!< If the station is HT capable.
 
   std::ofstream m_statsFile;   //!< File where statistics table is written.
@@ -458,9 +459,12 @@ MinstrelHtWifiManager::CheckInit (MinstrelHtWifiRemoteStation *station)
           station->m_sampleTable = SampleRate (m_numRates, std::vector<uint8_t> (m_nSampleCol));
           InitSampleTable (station);
           RateInit (station);
-          std::ostringstream tmp;
-          tmp << "minstrel-ht-stats-" << station->m_state->m_address << ".txt";
-          station->m_statsFile.open (tmp.str ().c_str (), std::ios::out);
+          if (m_printStats)
+            {
+              std::ostringstream tmp;
+              tmp << "minstrel-ht-stats-" << station->m_state->m_address << ".txt";
+              station->m_statsFile.open (tmp.str ().c_str (), std::ios::out);
+            }
           station->m_initialized = true;
         }
     }
@@ -527,9 +531,7 @@ MinstrelHtWifiManager::DoReportDataFailed (WifiRemoteStation *st)
     }
   else
     {
-      uint8_t rateId = GetRateId (station->m_txrate);
-      uint8_t groupId = GetGroupId (station->m_txrate);
-      station->m_groupsTable[groupId].m_ratesTable[rateId].numRateAttempt++; // Increment the attempts counter for the rate used.
+      AddRateAttempts (station, station->m_txrate, 0, 1); // Increment the attempts counter for the rate used.
       UpdateRate (station);
     }
 }
@@ -567,10 +569,7 @@ MinstrelHtWifiManager::DoReportDataOk (WifiRemoteStation *st, double ackSnr, Wif
     }
   else
     {
-      uint8_t rateId = GetRateId (station->m_txrate);
-      uint8_t groupId = GetGroupId (station->m_txrate);
-      station->m_groupsTable[groupId].m_ratesTable[rateId].numRateSuccess++;
-      station->m_groupsTable[groupId].m_ratesTable[rateId].numRateAttempt++;
+      AddRateAttempts (station, station->m_txrate, 1, 1);
 
       UpdatePacketCounters (station, 1, 0);
 
@@ -663,10 +662,7 @@ MinstrelHtWifiManager::DoReportAmpduTxStatus (WifiRemoteStation *st, uint8_t nSu
 
   UpdatePacketCounters (station, nSuccessfulMpdus, nFailedMpdus);
 
-  uint8_t rateId = GetRateId (station->m_txrate);
-  uint8_t groupId = GetGroupId (station->m_txrate);
-  station->m_groupsTable[groupId].m_ratesTable[rateId].numRateSuccess += nSuccessfulMpdus;
-  station->m_groupsTable[groupId].m_ratesTable[rateId].numRateAttempt += nSuccessfulMpdus + nFailedMpdus;
+  AddRateAttempts (station, station->m_txrate, nSuccessfulMpdus, nSuccessfulMpdus + nFailedMpdus);
 
   if (nSuccessfulMpdus == 0 && station->m_longRetry < CountRetries (station))
     {
@@ -825,6 +821,23 @@ MinstrelHtWifiManager::UpdatePacketCounters (MinstrelHtWifiRemoteStation *statio
     }
 }
 
+void
+MinstrelHtWifiManager::AddRateAttempts (MinstrelHtWifiRemoteStation *station, uint16_t index, uint32_t nSuccess, uint32_t nAttempts)
+{
+  NS_LOG_FUNCTION (this << station << index << nSuccess << nAttempts);
+  HtRateStats &stats = station->m_rateStats;
+  if (nAttempts == 0)
+    {
+      return;
+    }
+  if (stats.numRateAttempt[index] == 0)
+    {
+      stats.dirtyRates.push_back (index);
+    }
+  stats.numRateSuccess[index] += nSuccess;
+  stats.numRateAttempt[index] += nAttempts;
+}
+
 WifiTxVector
 MinstrelHtWifiManager::DoGetDataTxVector (WifiRemoteStation *st)
 {
@@ -1098,13 +1111,14 @@ MinstrelHtWifiManager::FindRate (MinstrelHtWifiRemoteStation *station)
            * Also do not sample if the probability is already higher than 95%
            * to avoid wasting airtime.
            */
-          HtRateInfo sampleRateInfo = station->m_groupsTable[sampleGroupId].m_ratesTable[sampleRateId];
+          const HtRateInfo &sampleRateInfo = station->m_groupsTable[sampleGroupId].m_ratesTable[sampleRateId];
+          double sampleEwmaProb = station->m_rateStats.ewmaProb[sampleIdx];
 
           NS_LOG_DEBUG ("Use sample rate? MaxTpRate= " << station->m_maxTpRate << " CurrentRate= " << station->m_txrate <<
-                        " SampleRate= " << sampleIdx << " SampleProb= " << sampleRateInfo.ewmaProb);
+                        " SampleRate= " << sampleIdx << " SampleProb= " << sampleEwmaProb);
 
           if (sampleIdx != station->m_maxTpRate && sampleIdx != station->m_maxTpRate2
-              && sampleIdx != station->m_maxProbRate && sampleRateInfo.ewmaProb <= 95)
+              && sampleIdx != station->m_maxProbRate && sampleEwmaProb <= 95)
             {
 
               /**
@@ -1143,7 +1157,7 @@ MinstrelHtWifiManager::FindRate (MinstrelHtWifiRemoteStation *station)
               else
                 {
                   station->m_numSamplesSlow++;
-                  if (sampleRateInfo.numSamplesSkipped >= 20 && station->m_numSamplesSlow <= 2)
+                  if (station->m_rateStats.numSamplesSkipped[sampleIdx] >= 20 && station->m_numSamplesSlow <= 2)
                     {
                       /// Set flag that we are currently sampling.
                       station->m_isSampling = true;
@@ -1194,7 +1208,70 @@ MinstrelHtWifiManager::UpdateStats (MinstrelHtWifiRemoteStation *station)
   station->m_maxTpRate2 = GetLowestIndex (station);
   station->m_maxProbRate = GetLowestIndex (station);
 
-  /// Update throughput and EWMA for each rate inside each group.
+  HtRateStats &stats = station->m_rateStats;
+
+  /// Rates not attempted since the last update skip this one.
+  for (std::size_t k = 0; k < stats.numSamplesSkipped.size (); k++)
+    {
+      stats.numSamplesSkipped[k]++;
+    }
+  stats.retryUpdated.assign (stats.retryUpdated.size (), false);
+  for (std::vector<uint16_t>::const_iterator k = stats.prevDirtyRates.begin (); k != stats.prevDirtyRates.end (); k++)
+    {
+      HtRateInfo &rate = station->m_groupsTable[GetGroupId (*k)].m_ratesTable[GetRateId (*k)];
+      rate.prevNumRateSuccess = 0;
+      rate.prevNumRateAttempt = 0;
+    }
+
+  /// Update throughput and EWMA of the rates attempted since the last update.
+  for (std::vector<uint16_t>::const_iterator k = stats.dirtyRates.begin (); k != stats.dirtyRates.end (); k++)
+    {
+      uint8_t j = GetGroupId (*k);
+      uint8_t i = GetRateId (*k);
+      HtRateInfo &rate = station->m_groupsTable[j].m_ratesTable[i];
+      NS_ASSERT (station->m_groupsTable[j].m_supported && rate.supported);
+
+      NS_LOG_DEBUG (+i << " " << GetMcsSupported (station, rate.mcsIndex) <<
+                    "\t attempt=" << stats.numRateAttempt[*k] <<
+                    "\t success=" << stats.numRateSuccess[*k]);
+
+      stats.numSamplesSkipped[*k] = 0;
+      /**
+       * Calculate the probability of success.
+       * Assume probability scales from 0 to 100.
+       */
+      tempProb = (100 * stats.numRateSuccess[*k]) / stats.numRateAttempt[*k];
+
+      /// Bookkeeping.
+      rate.prob = tempProb;
+
+      if (rate.successHist == 0)
+        {
+          stats.ewmaProb[*k] = tempProb;
+        }
+      else
+        {
+          rate.ewmsdProb = CalculateEwmsd (rate.ewmsdProb, tempProb, stats.ewmaProb[*k], m_ewmaLevel);
+          /// EWMA probability
+          tempProb = (tempProb * (100 - m_ewmaLevel) + stats.ewmaProb[*k] * m_ewmaLevel)  / 100;
+          stats.ewmaProb[*k] = tempProb;
+        }
+
+      stats.throughput[*k] = CalculateThroughput (station, j, i, tempProb);
+
+      rate.successHist += stats.numRateSuccess[*k];
+      rate.attemptHist += stats.numRateAttempt[*k];
+
+      /// Bookkeeping.
+      rate.prevNumRateSuccess = stats.numRateSuccess[*k];
+      rate.prevNumRateAttempt = stats.numRateAttempt[*k];
+      stats.numRateSuccess[*k] = 0;
+      stats.numRateAttempt[*k] = 0;
+    }
+  stats.prevDirtyRates.swap (stats.dirtyRates);
+  stats.dirtyRates.clear ();
+
+  /// Select the best rates among the ones providing some throughput.
   for (uint8_t j = 0; j < m_numGroups; j++)
     {
       if (station->m_groupsTable[j].m_supported)
@@ -1206,65 +1283,13 @@ MinstrelHtWifiManager::UpdateStats (MinstrelHtWifiRemoteStation *station)
           station->m_groupsTable[j].m_maxTpRate2 = GetLowestIndex (station, j);
           station->m_groupsTable[j].m_maxProbRate = GetLowestIndex (station, j);
 
-          for (uint8_t i = 0; i < m_numRates; i++)
+          uint16_t first = GetIndex (j, 0);
+          for (uint16_t k = first; k < first + m_numRates; k++)
             {
-              if (station->m_groupsTable[j].m_ratesTable[i].supported)
+              if (stats.throughput[k] != 0)
                 {
-                  station->m_groupsTable[j].m_ratesTable[i].retryUpdated = false;
-
-                  NS_LOG_DEBUG (+i << " " << GetMcsSupported (station, station->m_groupsTable[j].m_ratesTable[i].mcsIndex) <<
-                                "\t attempt=" << station->m_groupsTable[j].m_ratesTable[i].numRateAttempt <<
-                                "\t success=" << station->m_groupsTable[j].m_ratesTable[i].numRateSuccess);
-
-                  /// If we've attempted something.
-                  if (station->m_groupsTable[j].m_ratesTable[i].numRateAttempt > 0)
-                    {
-                      station->m_groupsTable[j].m_ratesTable[i].numSamplesSkipped = 0;
-                      /**
-                       * Calculate the probability of success.
-                       * Assume probability scales from 0 to 100.
-                       */
-                      tempProb = (100 * station->m_groupsTable[j].m_ratesTable[i].numRateSuccess) / station->m_groupsTable[j].m_ratesTable[i].numRateAttempt;
-
-                      /// Bookkeeping.
-                      station->m_groupsTable[j].m_ratesTable[i].prob = tempProb;
-
-                      if (station->m_groupsTable[j].m_ratesTable[i].successHist == 0)
-                        {
-                          station->m_groupsTable[j].m_ratesTable[i].ewmaProb = tempProb;
-                        }
-                      else
-                        {
-                          station->m_groupsTable[j].m_ratesTable[i].ewmsdProb = CalculateEwmsd (station->m_groupsTable[j].m_ratesTable[i].ewmsdProb,
-                                                                                                tempProb, station->m_groupsTable[j].m_ratesTable[i].ewmaProb,
-                                                                                                m_ewmaLevel);
-                          /// EWMA probability
-                          tempProb = (tempProb * (100 - m_ewmaLevel) + station->m_groupsTable[j].m_ratesTable[i].ewmaProb * m_ewmaLevel)  / 100;
-                          station->m_groupsTable[j].m_ratesTable[i].ewmaProb = tempProb;
-                        }
-
-                      station->m_groupsTable[j].m_ratesTable[i].throughput = CalculateThroughput (station, j, i, tempProb);
-
-                      station->m_groupsTable[j].m_ratesTable[i].successHist += station->m_groupsTable[j].m_ratesTable[i].numRateSuccess;
-                      station->m_groupsTable[j].m_ratesTable[i].attemptHist += station->m_groupsTable[j].m_ratesTable[i].numRateAttempt;
-                    }
-                  else
-                    {
-                      station->m_groupsTable[j].m_ratesTable[i].numSamplesSkipped++;
-                    }
-
-                  /// Bookkeeping.
-                  station->m_groupsTable[j].m_ratesTable[i].prevNumRateSuccess = station->m_groupsTable[j].m_ratesTable[i].numRateSuccess;
-                  station->m_groupsTable[j].m_ratesTable[i].prevNumRateAttempt = station->m_groupsTable[j].m_ratesTable[i].numRateAttempt;
-                  station->m_groupsTable[j].m_ratesTable[i].numRateSuccess = 0;
-                  station->m_groupsTable[j].m_ratesTable[i].numRateAttempt = 0;
-
-                  if (station->m_groupsTable[j].m_ratesTable[i].throughput != 0)
-                    {
-                      SetBestStationThRates (station, GetIndex (j, i));
-                      SetBestProbabilityRate (station, GetIndex (j, i));
-                    }
-
+                  SetBestStationThRates (station, k);
+                  SetBestProbabilityRate (station, k);
                 }
             }
         }
@@ -1318,37 +1343,23 @@ MinstrelHtWifiManager::CalculateThroughput (MinstrelHtWifiRemoteStation *station
 void
 MinstrelHtWifiManager::SetBestProbabilityRate (MinstrelHtWifiRemoteStation *station, uint16_t index)
 {
-  GroupInfo *group;
-  HtRateInfo rate;
-  uint8_t tmpGroupId, tmpRateId;
-  double tmpTh, tmpProb;
-  uint8_t groupId, rateId;
-  double currentTh;
-  // maximum group probability (GP) variables
-  uint8_t maxGPGroupId, maxGPRateId;
-  double maxGPTh;
-
-  groupId = GetGroupId (index);
-  rateId = GetRateId (index);
-  group = &station->m_groupsTable[groupId];
-  rate = group->m_ratesTable[rateId];
-
-  tmpGroupId = GetGroupId (station->m_maxProbRate);
-  tmpRateId = GetRateId (station->m_maxProbRate);
-  tmpProb = station->m_groupsTable[tmpGroupId].m_ratesTable[tmpRateId].ewmaProb;
-  tmpTh =  station->m_groupsTable[tmpGroupId].m_ratesTable[tmpRateId].throughput;
-
-  if (rate.ewmaProb > 75)
-    {
-      currentTh = station->m_groupsTable[groupId].m_ratesTable[rateId].throughput;
+  const HtRateStats &stats = station->m_rateStats;
+  GroupInfo *group = &station->m_groupsTable[GetGroupId (index)];
+  double prob = stats.ewmaProb[index];
+
+  double tmpProb = stats.ewmaProb[station->m_maxProbRate];
+  double tmpTh = stats.throughput[station->m_maxProbRate];
+
+  if (prob > 75)
+    {
+      double currentTh = stats.throughput[index];
       if (currentTh > tmpTh)
         {
           station->m_maxProbRate = index;
         }
 
-      maxGPGroupId = GetGroupId (group->m_maxProbRate);
-      maxGPRateId = GetRateId (group->m_maxProbRate);
-      maxGPTh = station->m_groupsTable[maxGPGroupId].m_ratesTable[maxGPRateId].throughput;
+      // maximum group probability (GP) throughput
+      double maxGPTh = stats.throughput[group->m_maxProbRate];
 
       if (currentTh > maxGPTh)
         {
@@ -1357,12 +1368,11 @@ MinstrelHtWifiManager::SetBestProbabilityRate (MinstrelHtWifiRemoteStation *stat
     }
   else
     {
-      if (rate.ewmaProb > tmpProb)
+      if (prob > tmpProb)
         {
           station->m_maxProbRate = index;
         }
-      maxGPRateId = GetRateId (group->m_maxProbRate);
-      if (rate.ewmaProb > group->m_ratesTable[maxGPRateId].ewmaProb)
+      if (prob > stats.ewmaProb[group->m_maxProbRate])
         {
           group->m_maxProbRate = index;
         }
@@ -1379,27 +1389,14 @@ MinstrelHtWifiManager::SetBestProbabilityRate (MinstrelHtWifiRemoteStation *stat
 void
 MinstrelHtWifiManager::SetBestStationThRates (MinstrelHtWifiRemoteStation *station, uint16_t index)
 {
-  uint8_t groupId, rateId;
-  double th, prob;
-  uint8_t maxTpGroupId, maxTpRateId;
-  uint8_t maxTp2GroupId, maxTp2RateId;
-  double maxTpTh, maxTpProb;
-  double maxTp2Th, maxTp2Prob;
-
-  groupId = GetGroupId (index);
-  rateId = GetRateId (index);
-  prob = station->m_groupsTable[groupId].m_ratesTable[rateId].ewmaProb;
-  th = station->m_groupsTable[groupId].m_ratesTable[rateId].throughput;
-
-  maxTpGroupId = GetGroupId (station->m_maxTpRate);
-  maxTpRateId = GetRateId (station->m_maxTpRate);
-  maxTpProb = station->m_groupsTable[maxTpGroupId].m_ratesTable[maxTpRateId].ewmaProb;
-  maxTpTh = station->m_groupsTable[maxTpGroupId].m_ratesTable[maxTpRateId].throughput;
-
-  maxTp2GroupId = GetGroupId (station->m_maxTpRate2);
-  maxTp2RateId = GetRateId (station->m_maxTpRate2);
-  maxTp2Prob = station->m_groupsTable[maxTp2GroupId].m_ratesTable[maxTp2RateId].ewmaProb;
-  maxTp2Th = station->m_groupsTable[maxTp2GroupId].m_ratesTable[maxTp2RateId].throughput;
+  const HtRateStats &stats = station->m_rateStats;
+  double prob = stats.ewmaProb[index];
+  double th = stats.throughput[index];
+
+  double maxTpProb = stats.ewmaProb[station->m_maxTpRate];
+  double maxTpTh = stats.throughput[station->m_maxTpRate];
+  double maxTp2Prob = stats.ewmaProb[station->m_maxTpRate2];
+  double maxTp2Th = stats.throughput[station->m_maxTpRate2];
 
   if (th > maxTpTh || (th == maxTpTh && prob > maxTpProb))
     {
@@ -1413,16 +1410,11 @@ MinstrelHtWifiManager::SetBestStationThRates (MinstrelHtWifiRemoteStation *stati
 
   //Find best rates per group
 
-  GroupInfo *group = &station->m_groupsTable[groupId];
-  maxTpGroupId = GetGroupId (group->m_maxTpRate);
-  maxTpRateId = GetRateId (group->m_maxTpRate);
-  maxTpProb = group->m_ratesTable[maxTpRateId].ewmaProb;
-  maxTpTh = station->m_groupsTable[maxTpGroupId].m_ratesTable[maxTpRateId].throughput;
-
-  maxTp2GroupId = GetGroupId (group->m_maxTpRate2);
-  maxTp2RateId = GetRateId (group->m_maxTpRate2);
-  maxTp2Prob = group->m_ratesTable[maxTp2RateId].ewmaProb;
-  maxTp2Th = station->m_groupsTable[maxTp2GroupId].m_ratesTable[maxTp2RateId].throughput;
+  GroupInfo *group = &station->m_groupsTable[GetGroupId (index)];
+  maxTpProb = stats.ewmaProb[group->m_maxTpRate];
+  maxTpTh = stats.throughput[group->m_maxTpRate];
+  maxTp2Prob = stats.ewmaProb[group->m_maxTpRate2];
+  maxTp2Th = stats.throughput[group->m_maxTpRate2];
 
   if (th > maxTpTh || (th == maxTpTh && prob > maxTpProb))
     {
@@ -1442,6 +1434,16 @@ MinstrelHtWifiManager::RateInit (MinstrelHtWifiRemoteStation *station)
 
   station->m_groupsTable = McsGroupData (m_numGroups);
 
+  uint16_t nRates = m_numGroups * m_numRates;
+  station->m_rateStats.numRateAttempt.assign (nRates, 0);
+  station->m_rateStats.numRateSuccess.assign (nRates, 0);
+  station->m_rateStats.ewmaProb.assign (nRates, 0);
+  station->m_rateStats.throughput.assign (nRates, 0);
+  station->m_rateStats.numSamplesSkipped.assign (nRates, 0);
+  station->m_rateStats.retryUpdated.assign (nRates, false);
+  station->m_rateStats.dirtyRates.clear ();
+  station->m_rateStats.prevDirtyRates.clear ();
+
   /**
   * Initialize groups supported by the receiver.
   */
@@ -1493,16 +1495,11 @@ MinstrelHtWifiManager::RateInit (MinstrelHtWifiRemoteStation *station)
 
                       station->m_groupsTable[groupId].m_ratesTable[rateId].supported = true;
                       station->m_groupsTable[groupId].m_ratesTable[rateId].mcsIndex = i;         ///Mapping between rateId and operationalMcsSet
-                      station->m_groupsTable[groupId].m_ratesTable[rateId].numRateAttempt = 0;
-                      station->m_groupsTable[groupId].m_ratesTable[rateId].numRateSuccess = 0;
                       station->m_groupsTable[groupId].m_ratesTable[rateId].prob = 0;
-                      station->m_groupsTable[groupId].m_ratesTable[rateId].ewmaProb = 0;
                       station->m_groupsTable[groupId].m_ratesTable[rateId].prevNumRateAttempt = 0;
                       station->m_groupsTable[groupId].m_ratesTable[rateId].prevNumRateSuccess = 0;
-                      station->m_groupsTable[groupId].m_ratesTable[rateId].numSamplesSkipped = 0;
                       station->m_groupsTable[groupId].m_ratesTable[rateId].successHist = 0;
                       station->m_groupsTable[groupId].m_ratesTable[rateId].attemptHist = 0;
-                      station->m_groupsTable[groupId].m_ratesTable[rateId].throughput = 0;
                       station->m_groupsTable[groupId].m_ratesTable[rateId].perfectTxTime = GetFirstMpduTxTime (groupId, GetMcsSupported (station, i));
                       station->m_groupsTable[groupId].m_ratesTable[rateId].retryCount = 0;
                       station->m_groupsTable[groupId].m_ratesTable[rateId].adjustedRetryCount = 0;
@@ -1523,7 +1520,7 @@ MinstrelHtWifiManager::CalculateRetransmits (MinstrelHtWifiRemoteStation *statio
   NS_LOG_FUNCTION (this << station << index);
   uint8_t groupId = GetGroupId (index);
   uint8_t rateId = GetRateId (index);
-  if (!station->m_groupsTable[groupId].m_ratesTable[rateId].retryUpdated)
+  if (!station->m_rateStats.retryUpdated[index])
     {
       CalculateRetransmits (station, groupId, rateId);
     }
@@ -1540,14 +1537,15 @@ MinstrelHtWifiManager::CalculateRetransmits (MinstrelHtWifiRemoteStation *statio
   Time slotTime = GetMac ()->GetSlot ();
   Time ackTime = GetMac ()->GetBasicBlockAckTimeout ();
 
-  if (station->m_groupsTable[groupId].m_ratesTable[rateId].ewmaProb < 1)
+  uint16_t index = GetIndex (groupId, rateId);
+  if (station->m_rateStats.ewmaProb[index] < 1)
     {
       station->m_groupsTable[groupId].m_ratesTable[rateId].retryCount = 1;
     }
   else
     {
       station->m_groupsTable[groupId].m_ratesTable[rateId].retryCount = 2;
-      station->m_groupsTable[groupId].m_ratesTable[rateId].retryUpdated = true;
+      station->m_rateStats.retryUpdated[index] = true;
 
       dataTxTime = GetFirstMpduTxTime (groupId, GetMcsSupported (station, station->m_groupsTable[groupId].m_ratesTable[rateId].mcsIndex)) +
         GetMpduTxTime (groupId, GetMcsSupported (station, station->m_groupsTable[groupId].m_ratesTable[rateId].mcsIndex)) * (station->m_avgAmpduLen - 1);
@@ -1713,8 +1711,8 @@ MinstrelHtWifiManager::StatsDump (MinstrelHtWifiRemoteStation *station, uint8_t
           of << std::setw (6) << txTime.GetMicroSeconds () << "  ";
 
           of << std::setw (7) << CalculateThroughput (station, groupId, i, 100) / 100 << "   " <<
-            std::setw (7) << station->m_groupsTable[groupId].m_ratesTable[i].throughput / 100 << "   " <<
-            std::setw (7) << station->m_groupsTable[groupId].m_ratesTable[i].ewmaProb << "  " <<
+            std::setw (7) << station->m_rateStats.throughput[idx] / 100 << "   " <<
+            std::setw (7) << station->m_rateStats.ewmaProb[idx] << "  " <<
             std::setw (7) << station->m_groupsTable[groupId].m_ratesTable[i].ewmsdProb << "  " <<
             std::setw (7) << station->m_groupsTable[groupId].m_ratesTable[i].prob << "  " <<
             std::setw (2) << station->m_groupsTable[groupId].m_ratesTable[i].retryCount << "   " <<
@@ -64,6 +64,9 @@ typedef std::vector<McsGroup> MinstrelMcsGroups;
 struct MinstrelHtWifiRemoteStation;
 /**
  * A struct to contain all statistics information related to a data rate.
+ *
+ * The statistics read at every update (attempts, EWMA probability and
+ * throughput) are kept apart in HtRateStats.
  */
 struct HtRateInfo
 {
@@ -76,23 +79,12 @@ struct HtRateInfo
   uint8_t mcsIndex;             //!< The index in the operationalMcsSet of the WifiRemoteStationManager.
   uint32_t retryCount;          //!< Retry limit.
   uint32_t adjustedRetryCount;  //!< Adjust the retry limit for this rate.
-  uint32_t numRateAttempt;      //!< Number of transmission attempts so far.
-  uint32_t numRateSuccess;      //!< Number of successful frames transmitted so far.
   double prob;                  //!< Current probability within last time interval. (# frame success )/(# total frames)
-  bool retryUpdated;            //!< If number of retries was updated already.
-  /**
-   * Exponential weighted moving average of probability.
-   * EWMA calculation:
-   * ewma_prob =[prob *(100 - ewma_level) + (ewma_prob_old * ewma_level)]/100
-   */
-  double ewmaProb;
   double ewmsdProb;             //!< Exponential weighted moving standard deviation of probability.
   uint32_t prevNumRateAttempt;  //!< Number of transmission attempts with previous rate.
   uint32_t prevNumRateSuccess;  //!< Number of successful frames transmitted with previous rate.
-  uint32_t numSamplesSkipped;   //!< Number of times this rate statistics were not updated because no attempts have been made.
   uint64_t successHist;         //!< Aggregate of all transmission successes.
   uint64_t attemptHist;         //!< Aggregate of all transmission attempts.
-  double throughput;            //!< Throughput of this rate (in pkts per second).
 };
 
 /**
@@ -101,6 +93,31 @@ struct HtRateInfo
  */
 typedef std::vector<HtRateInfo> HtMinstrelRate;
 
+/**
+ * Statistics of all the rates of a station, stored as a structure of arrays
+ * indexed by the rate index (see MinstrelHtWifiManager::GetIndex).
+ *
+ * Only the rates attempted since the last update (listed in dirtyRates) have
+ * their probability and throughput recomputed, while the selection of the
+ * best rates scans the contiguous throughput array.
+ */
+struct HtRateStats
+{
+  std::vector<uint32_t> numRateAttempt;    //!< Number of transmission attempts so far.
+  std::vector<uint32_t> numRateSuccess;    //!< Number of successful frames transmitted so far.
+  /**
+   * Exponential weighted moving average of probability.
+   * EWMA calculation:
+   * ewma_prob =[prob *(100 - ewma_level) + (ewma_prob_old * ewma_level)]/100
+   */
+  std::vector<double> ewmaProb;
+  std::vector<double> throughput;          //!< Throughput of the rates (in pkts per second).
+  std::vector<uint32_t> numSamplesSkipped; //!< Number of times the statistics were not updated because no attempts have been made.
+  std::vector<bool> retryUpdated;          //!< If number of retries was updated already.
+  std::vector<uint16_t> dirtyRates;        //!< Rates attempted since the last update.
+  std::vector<uint16_t> prevDirtyRates;    //!< Rates attempted before the last update.
+};
+
 /**
  * A struct to contain information of a group.
  */
@@ -323,6 +340,17 @@ private:
    */
   void UpdatePacketCounters (MinstrelHtWifiRemoteStation *station, uint8_t nSuccessfulMpdus, uint8_t nFailedMpdus);
 
+  /**
+   * Account for the transmission attempts made at a rate, which is then
+   * part of the next statistics update.
+   *
+   * \param station the minstrel HT wifi remote station
+   * \param index the rate index
+   * \param nSuccess the number of successful frames
+   * \param nAttempts the number of transmission attempts
+   */
+  void AddRateAttempts (MinstrelHtWifiRemoteStation *station, uint16_t index, uint32_t nSuccess, uint32_t nAttempts);
+
   /**
    * Getting the next sample from Sample Table.
    *
@@ -349,6 +377,8 @@ private:
   /**
    * Updating the Minstrel Table every 1/10 seconds.
    *
+   * Only the rates attempted since the last update are recomputed.
+   *
    * \param station the minstrel HT wifi remote station
    */
   void UpdateStats (MinstrelHtWifiRemoteStation *station);
@@ -228,6 +228,15 @@ WifiPhy::GetTypeId (void)
                    DoubleValue (7),
                    MakeDoubleAccessor (&WifiPhy::SetRxNoiseFigure),
                    MakeDoubleChecker<double> ())
+    .AddAttribute ("LinkAbstraction",
+                   "If true, the error rate of the PLCP payload is read from cached error rate curves "
+                   "at the effective SNIR of the payload, instead of combining the success rates of "
+                   "all the chunks delimited by interference changes. This speeds up large simulations "
+                   "at the expense of accuracy when the interference varies during the payload.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&WifiPhy::SetLinkAbstraction,
+                                        &WifiPhy::GetLinkAbstraction),
+                   MakeBooleanChecker ())
     .AddAttribute ("State",
                    "The state of the PHY layer.",
                    PointerValue (),
@@ -502,6 +511,19 @@ WifiPhy::SetRxNoiseFigure (double noiseFigureDb)
   m_interference.SetNumberOfReceiveAntennas (GetNumberOfAntennas ());
 }
 
+void
+WifiPhy::SetLinkAbstraction (bool enable)
+{
+  NS_LOG_FUNCTION (this << enable);
+  m_interference.SetLinkAbstraction (enable);
+}
+
+bool
+WifiPhy::GetLinkAbstraction (void) const
+{
+  return m_interference.GetLinkAbstraction ();
+}
+
 void
 WifiPhy::SetTxPowerStart (double start)
 {
@@ -1944,22 +1966,42 @@ WifiPhy::GetPayloadDuration (uint32_t size, WifiTxVector txVector, uint16_t freq
   return GetPayloadDuration (size, txVector, frequency, NORMAL_MPDU, 0);
 }
 
-Time
-WifiPhy::GetPayloadDuration (uint32_t size, WifiTxVector txVector, uint16_t frequency, MpduType mpdutype, uint8_t incFlag)
+uint64_t
+WifiPhy::GetTxDurationCacheKey (const WifiTxVector &txVector)
+{
+  return (static_cast<uint64_t> (txVector.GetMode ().GetUid () & 0xffff) << 48)
+         | (static_cast<uint64_t> (txVector.GetChannelWidth () & 0x0fff) << 36)
+         | (static_cast<uint64_t> (txVector.GetGuardInterval () & 0x0fff) << 24)
+         | (static_cast<uint64_t> (txVector.GetPreambleType () & 0xff) << 16)
+         | (static_cast<uint64_t> (txVector.GetNss ()) << 8)
+         | (static_cast<uint64_t> (txVector.GetNess () & 0x0f) << 4)
+         | (txVector.IsStbc () ? 1 : 0);
+}
+
+WifiPhy::TxDurationParameters
+WifiPhy::ComputeTxDurationParameters (const WifiTxVector &txVector)
 {
   WifiMode payloadMode = txVector.GetMode ();
-  WifiPreamble preamble = txVector.GetPreambleType ();
-  NS_LOG_FUNCTION (size << payloadMode);
+  TxDurationParameters params;
+  params.preambleAndHeaderDuration = CalculatePlcpPreambleAndHeaderDuration (txVector);
+  params.symbolDuration = Seconds (0);
+  params.numDataBitsPerSymbol = 0;
+  params.stbc = 1;
+  params.nes = 1;
+  if (payloadMode.GetModulationClass () == WIFI_MOD_CLASS_DSSS
+      || payloadMode.GetModulationClass () == WIFI_MOD_CLASS_HR_DSSS)
+    {
+      //DSSS payload duration only depends on the data rate
+      return params;
+    }
 
-  double stbc = 1;
   if (txVector.IsStbc ()
       && (payloadMode.GetModulationClass () == WIFI_MOD_CLASS_HT
           || payloadMode.GetModulationClass () == WIFI_MOD_CLASS_VHT))
     {
-      stbc = 2;
+      params.stbc = 2;
     }
 
-  double Nes = 1;
   //todo: improve logic to reduce the number of if cases
   //todo: extend to NSS > 4 for VHT rates
   if (payloadMode == GetHtMcs21()
@@ -1970,7 +2012,7 @@ WifiPhy::GetPayloadDuration (uint32_t size, WifiTxVector txVector, uint16_t freq
       || payloadMode == GetHtMcs30 ()
       || payloadMode == GetHtMcs31 ())
     {
-      Nes = 2;
+      params.nes = 2;
     }
   if (payloadMode.GetModulationClass () == WIFI_MOD_CLASS_VHT)
     {
@@ -1978,100 +2020,99 @@ WifiPhy::GetPayloadDuration (uint32_t size, WifiTxVector txVector, uint16_t freq
           && txVector.GetNss () == 3
           && payloadMode.GetMcsValue () >= 8)
         {
-          Nes = 2;
+          params.nes = 2;
         }
       if (txVector.GetChannelWidth () == 80
           && txVector.GetNss () == 2
           && payloadMode.GetMcsValue () >= 7)
         {
-          Nes = 2;
+          params.nes = 2;
         }
       if (txVector.GetChannelWidth () == 80
           && txVector.GetNss () == 3
           && payloadMode.GetMcsValue () >= 7)
         {
-          Nes = 2;
+          params.nes = 2;
         }
       if (txVector.GetChannelWidth () == 80
           && txVector.GetNss () == 3
           && payloadMode.GetMcsValue () == 9)
         {
-          Nes = 3;
+          params.nes = 3;
         }
       if (txVector.GetChannelWidth () == 80
           && txVector.GetNss () == 4
           && payloadMode.GetMcsValue () >= 4)
         {
-          Nes = 2;
+          params.nes = 2;
         }
       if (txVector.GetChannelWidth () == 80
           && txVector.GetNss () == 4
           && payloadMode.GetMcsValue () >= 7)
         {
-          Nes = 3;
+          params.nes = 3;
         }
       if (txVector.GetChannelWidth () == 160
           && payloadMode.GetMcsValue () >= 7)
         {
-          Nes = 2;
+          params.nes = 2;
         }
       if (txVector.GetChannelWidth () == 160
           && txVector.GetNss () == 2
           && payloadMode.GetMcsValue () >= 4)
         {
-          Nes = 2;
+          params.nes = 2;
         }
       if (txVector.GetChannelWidth () == 160
           && txVector.GetNss () == 2
           && payloadMode.GetMcsValue () >= 7)
         {
-          Nes = 3;
+          params.nes = 3;
         }
       if (txVector.GetChannelWidth () == 160
           && txVector.GetNss () == 3
           && payloadMode.GetMcsValue () >= 3)
         {
-          Nes = 2;
+          params.nes = 2;
         }
       if (txVector.GetChannelWidth () == 160
           && txVector.GetNss () == 3
           && payloadMode.GetMcsValue () >= 5)
         {
-          Nes = 3;
+          params.nes = 3;
         }
       if (txVector.GetChannelWidth () == 160
           && txVector.GetNss () == 3
           && payloadMode.GetMcsValue () >= 7)
         {
-          Nes = 4;
+          params.nes = 4;
         }
       if (txVector.GetChannelWidth () == 160
           && txVector.GetNss () == 4
           && payloadMode.GetMcsValue () >= 2)
         {
-          Nes = 2;
+          params.nes = 2;
         }
       if (txVector.GetChannelWidth () == 160
           && txVector.GetNss () == 4
           && payloadMode.GetMcsValue () >= 4)
         {
-          Nes = 3;
+          params.nes = 3;
         }
       if (txVector.GetChannelWidth () == 160
           && txVector.GetNss () == 4
           && payloadMode.GetMcsValue () >= 5)
         {
-          Nes = 4;
+          params.nes = 4;
         }
       if (txVector.GetChannelWidth () == 160
           && txVector.GetNss () == 4
           && payloadMode.GetMcsValue () >= 7)
         {
-          Nes = 6;
+          params.nes = 6;
         }
     }
 
-  Time symbolDuration = Seconds (0);
   switch (payloadMode.GetModulationClass ())
     {
     case WIFI_MOD_CLASS_OFDM:
@@ -2083,13 +2124,13 @@ WifiPhy::GetPayloadDuration (uint32_t size, WifiTxVector txVector, uint16_t freq
           {
           case 20:
           default:
-            symbolDuration = MicroSeconds (4);
+            params.symbolDuration = MicroSeconds (4);
             break;
           case 10:
-            symbolDuration = MicroSeconds (8);
+            params.symbolDuration = MicroSeconds (8);
             break;
           case 5:
-            symbolDuration = MicroSeconds (16);
+            params.symbolDuration = MicroSeconds (16);
             break;
           }
         break;
@@ -2101,7 +2142,7 @@ WifiPhy::GetPayloadDuration (uint32_t size, WifiTxVector txVector, uint16_t freq
         //In the future has to create a stationmanager that only uses these data rates if sender and receiver support GI
         uint16_t gi = txVector.GetGuardInterval ();
         NS_ASSERT (gi == 400 || gi == 800);
-        symbolDuration = NanoSeconds (3200 + gi);
+        params.symbolDuration = NanoSeconds (3200 + gi);
       }
       break;
     case WIFI_MOD_CLASS_HE:
@@ -2110,14 +2151,41 @@ WifiPhy::GetPayloadDuration (uint32_t size, WifiTxVector txVector, uint16_t freq
         //In the future has to create a stationmanager that only uses these data rates if sender and receiver support GI
         uint16_t gi = txVector.GetGuardInterval ();
         NS_ASSERT (gi == 800 || gi == 1600 || gi == 3200);
-        symbolDuration = NanoSeconds (12800 + gi);
+        params.symbolDuration = NanoSeconds (12800 + gi);
       }
       break;
     default:
       break;
     }
 
-  double numDataBitsPerSymbol = payloadMode.GetDataRate (txVector) * symbolDuration.GetNanoSeconds () / 1e9;
+  params.numDataBitsPerSymbol = payloadMode.GetDataRate (txVector) * params.symbolDuration.GetNanoSeconds () / 1e9;
+  return params;
+}
+
+const WifiPhy::TxDurationParameters &
+WifiPhy::GetTxDurationParameters (const WifiTxVector &txVector)
+{
+  uint64_t key = GetTxDurationCacheKey (txVector);
+  TxDurationCache::const_iterator it = m_txDurationCache.find (key);
+  if (it == m_txDurationCache.end ())
+    {
+      it = m_txDurationCache.insert (std::make_pair (key, ComputeTxDurationParameters (txVector))).first;
+    }
+  return it->second;
+}
+
+Time
+WifiPhy::GetPayloadDuration (uint32_t size, WifiTxVector txVector, uint16_t frequency, MpduType mpdutype, uint8_t incFlag)
+{
+  WifiMode payloadMode = txVector.GetMode ();
+  WifiPreamble preamble = txVector.GetPreambleType ();
+  NS_LOG_FUNCTION (size << payloadMode);
+
+  const TxDurationParameters &params = GetTxDurationParameters (txVector);
+  double stbc = params.stbc;
+  double Nes = params.nes;
+  Time symbolDuration = params.symbolDuration;
+  double numDataBitsPerSymbol = params.numDataBitsPerSymbol;
 
   double numSymbols = 0;
   if (mpdutype == MPDU_IN_AGGREGATE && preamble != WIFI_PREAMBLE_NONE)
@@ -2233,7 +2301,7 @@ WifiPhy::CalculatePlcpPreambleAndHeaderDuration (WifiTxVector txVector)
 Time
 WifiPhy::CalculateTxDuration (uint32_t size, WifiTxVector txVector, uint16_t frequency, MpduType mpdutype, uint8_t incFlag)
 {
-  Time duration = CalculatePlcpPreambleAndHeaderDuration (txVector)
+  Time duration = GetTxDurationParameters (txVector).preambleAndHeaderDuration
     + GetPayloadDuration (size, txVector, frequency, mpdutype, incFlag);
   return duration;
 }
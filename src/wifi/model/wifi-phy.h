@@ -1219,6 +1219,18 @@ public:
    * \param noiseFigureDb noise figure in dB
    */
   void SetRxNoiseFigure (double noiseFigureDb);
+  /**
+   * Enable or disable the link abstraction, whereby the error rate of the
+   * PLCP payload is derived from its effective SNIR using cached error rate
+   * curves rather than from the success rate of each of its chunks.
+   *
+   * \param enable true to enable the link abstraction
+   */
+  void SetLinkAbstraction (bool enable);
+  /**
+   * \return true if the link abstraction is enabled
+   */
+  bool GetLinkAbstraction (void) const;
   /**
    * Sets the minimum available transmission power level (dBm).
    *
@@ -1632,6 +1644,44 @@ private:
                 Time rxDuration,
                 Ptr<Event> event);
 
+  /**
+   * Transmission timing parameters that only depend on the TXVECTOR, i.e.
+   * everything GetPayloadDuration and CalculateTxDuration need besides the
+   * PSDU size, the frequency band and the MPDU type.
+   */
+  struct TxDurationParameters
+  {
+    Time preambleAndHeaderDuration; //!< duration of the PLCP preamble and header
+    Time symbolDuration;            //!< OFDM symbol duration (zero for DSSS)
+    double numDataBitsPerSymbol;    //!< number of data bits per OFDM symbol
+    double stbc;                    //!< STBC factor (1 or 2)
+    double nes;                     //!< number of BCC encoders
+  };
+
+  /**
+   * \param txVector the TXVECTOR used for the transmission
+   *
+   * \return the key identifying the TXVECTOR fields the transmission timing depends on
+   */
+  static uint64_t GetTxDurationCacheKey (const WifiTxVector &txVector);
+  /**
+   * Compute the timing parameters for a given TXVECTOR.
+   *
+   * \param txVector the TXVECTOR used for the transmission
+   *
+   * \return the timing parameters of the TXVECTOR
+   */
+  static TxDurationParameters ComputeTxDurationParameters (const WifiTxVector &txVector);
+  /**
+   * Return the timing parameters for a given TXVECTOR, computing and
+   * caching them the first time this TXVECTOR is seen by this PHY.
+   *
+   * \param txVector the TXVECTOR used for the transmission
+   *
+   * \return the (cached) timing parameters of the TXVECTOR
+   */
+  const TxDurationParameters & GetTxDurationParameters (const WifiTxVector &txVector);
+
   /**
    * The trace source fired when a packet begins the transmission process on
    * the medium.
@@ -1786,6 +1836,9 @@ private:
   uint32_t m_totalAmpduSize;     //!< Total size of the previously transmitted MPDUs in an A-MPDU, used for the computation of the number of symbols needed for the last MPDU in the A-MPDU
   double m_totalAmpduNumSymbols; //!< Number of symbols previously transmitted for the MPDUs in an A-MPDU, used for the computation of the number of symbols needed for the last MPDU in the A-MPDU
 
+  typedef std::map<uint64_t, TxDurationParameters> TxDurationCache; //!< TXVECTOR key to timing parameters map typedef
+  TxDurationCache m_txDurationCache; //!< memoized timing parameters, indexed by GetTxDurationCacheKey
+
   Ptr<NetDevice>     m_device;   //!< Pointer to the device
   Ptr<MobilityModel> m_mobility; //!< Pointer to the mobility model
 
@@ -732,7 +732,8 @@ WifiRemoteStationManager::RecordGotAssocTxOk (Mac48Address address, bool send)
 {
   NS_ASSERT (!address.IsGroup ());
   LookupState (address)->m_state = WifiRemoteStationState::GOT_ASSOC_TX_OK;
-  if (send && (DynamicCast<ApWifiMac, WifiMac>(m_wifiMac)->GetAssocTrigger()))
+  Ptr<ApWifiMac> apMac = DynamicCast<ApWifiMac, WifiMac>(m_wifiMac);
+  if (send && apMac != 0 && apMac->GetAssocTrigger())
   {
 	  NS_LOG_INFO("&");
 	  m_assocCallback(address);
@@ -753,7 +754,8 @@ WifiRemoteStationManager::RecordDisassociated (Mac48Address address, bool send)
 {
   NS_ASSERT (!address.IsGroup ());
   LookupState (address)->m_state = WifiRemoteStationState::DISASSOC;
-  if (send && (DynamicCast<ApWifiMac, WifiMac>(m_wifiMac)->GetAssocTrigger()))
+  Ptr<ApWifiMac> apMac = DynamicCast<ApWifiMac, WifiMac>(m_wifiMac);
+  if (send && apMac != 0 && apMac->GetAssocTrigger())
   {
 	  m_disassocCallback(address);
   }
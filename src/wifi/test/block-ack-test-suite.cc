@@ -21,6 +21,13 @@
 #include "ns3/test.h"
 #include "ns3/qos-utils.h"
 #include "ns3/ctrl-headers.h"
+#include "ns3/mgt-headers.h"
+#include "ns3/packet.h"
+#include "ns3/block-ack-manager.h"
+#include "ns3/mac-tx-middle.h"
+#include "ns3/wifi-mac-queue.h"
+#include "ns3/yans-wifi-phy.h"
+#include "ns3/constant-rate-wifi-manager.h"
 
 using namespace ns3;
 
@@ -306,6 +313,144 @@ CtrlBAckResponseHeaderTest::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (m_blockAckHdr.IsPacketReceived (80), false, "error in compressed bitmap");
 }
 
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Originator buffer of the Block Ack Manager
+ *
+ * Stores MPDUs whose sequence numbers wrap around 4095 under a 256-MPDU
+ * agreement, then checks that a compressed block ack releases the acknowledged
+ * MPDUs and that the lost ones are retransmitted in sequence number order.
+ */
+class BlockAckManagerBufferTest : public TestCase
+{
+public:
+  BlockAckManagerBufferTest ();
+  virtual ~BlockAckManagerBufferTest ();
+private:
+  virtual void DoRun (void);
+  /**
+   * Nothing to do when a destination is blocked or unblocked
+   * \param recipient the recipient
+   * \param tid the TID
+   */
+  void Ignore (Mac48Address recipient, uint8_t tid);
+};
+
+BlockAckManagerBufferTest::BlockAckManagerBufferTest ()
+  : TestCase ("Check the originator buffer of the block ack manager")
+{
+}
+
+BlockAckManagerBufferTest::~BlockAckManagerBufferTest ()
+{
+}
+
+void
+BlockAckManagerBufferTest::Ignore (Mac48Address recipient, uint8_t tid)
+{
+}
+
+void
+BlockAckManagerBufferTest::DoRun (void)
+{
+  Mac48Address recipient ("00:00:00:00:00:02");
+  uint8_t tid = 0;
+  uint16_t startSeq = 4000;
+
+  Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+  phy->ConfigureStandard (WIFI_PHY_STANDARD_80211ax_5GHZ);
+  Ptr<ConstantRateWifiManager> stationManager = CreateObject<ConstantRateWifiManager> ();
+  stationManager->SetupPhy (phy);
+  stationManager->SetHtSupported (true);
+  stationManager->SetHeSupported (true);
+
+  Ptr<BlockAckManager> manager = CreateObject<BlockAckManager> ();
+  manager->SetWifiRemoteStationManager (stationManager);
+  manager->SetTxMiddle (Create<MacTxMiddle> ());
+  manager->SetQueue (CreateObject<WifiMacQueue> ());
+  manager->SetBlockAckType (COMPRESSED_BLOCK_ACK);
+  manager->SetBlockAckThreshold (2);
+  manager->SetMaxPacketDelay (Seconds (10));
+  manager->SetBlockDestinationCallback (MakeCallback (&BlockAckManagerBufferTest::Ignore, this));
+  manager->SetUnblockDestinationCallback (MakeCallback (&BlockAckManagerBufferTest::Ignore, this));
+
+  MgtAddBaRequestHeader reqHdr;
+  reqHdr.SetImmediateBlockAck ();
+  reqHdr.SetTid (tid);
+  reqHdr.SetTimeout (0);
+  reqHdr.SetBufferSize (255);
+  reqHdr.SetStartingSequence (startSeq);
+  manager->CreateAgreement (&reqHdr, recipient);
+  MgtAddBaResponseHeader respHdr;
+  respHdr.SetImmediateBlockAck ();
+  respHdr.SetTid (tid);
+  respHdr.SetTimeout (0);
+  respHdr.SetBufferSize (255);
+  manager->UpdateAgreement (&respHdr, recipient);
+
+  WifiMacHeader hdr;
+  hdr.SetType (WIFI_MAC_QOSDATA);
+  hdr.SetAddr1 (recipient);
+  hdr.SetQosTid (tid);
+  Ptr<const Packet> packet = Create<Packet> (100);
+
+  //store 256 MPDUs from 4000 to 159, in reverse order to check sorting
+  for (uint16_t i = 256; i > 0; i--)
+    {
+      hdr.SetSequenceNumber ((startSeq + i - 1) % 4096);
+      manager->StorePacket (packet, hdr, Seconds (0));
+    }
+  NS_TEST_EXPECT_MSG_EQ (manager->GetNBufferedPackets (recipient, tid), 256, "Unexpected number of buffered MPDUs");
+  NS_TEST_EXPECT_MSG_EQ (manager->HasPackets (), false, "No MPDU should need to be retransmitted");
+
+  //acknowledge the 64 MPDUs starting at 4064, except 4090 and 5
+  CtrlBAckResponseHeader blockAck;
+  blockAck.SetType (COMPRESSED_BLOCK_ACK);
+  blockAck.SetTidInfo (tid);
+  blockAck.SetStartingSequence (4064);
+  for (uint16_t i = 0; i < 64; i++)
+    {
+      uint16_t seq = (4064 + i) % 4096;
+      if (seq != 4090 && seq != 5)
+        {
+          blockAck.SetReceivedPacket (seq);
+        }
+    }
+  manager->NotifyGotBlockAck (&blockAck, recipient, 0, phy->GetHeMcs0 (), 0);
+  NS_TEST_EXPECT_MSG_EQ (manager->GetNBufferedPackets (recipient, tid), 194, "Acknowledged MPDUs should have been released");
+  NS_TEST_EXPECT_MSG_EQ (manager->GetNRetryNeededPackets (recipient, tid), 194, "Unacknowledged MPDUs should be retransmitted");
+  NS_TEST_EXPECT_MSG_EQ (manager->AlreadyExists (4090, recipient, tid), true, "4090 should be retransmitted");
+  NS_TEST_EXPECT_MSG_EQ (manager->AlreadyExists (4091, recipient, tid), false, "4091 has been acknowledged");
+
+  //retransmissions follow the sequence number order, across the wraparound
+  uint16_t expected[] = {4000, 4001};
+  for (uint8_t i = 0; i < 2; i++)
+    {
+      WifiMacHeader retryHdr;
+      Ptr<const Packet> retry = manager->GetNextPacket (retryHdr, true);
+      NS_TEST_ASSERT_MSG_EQ ((retry != 0), true, "A retransmission was expected");
+      NS_TEST_EXPECT_MSG_EQ (retryHdr.GetSequenceNumber (), expected[i], "Unexpected retransmission");
+      NS_TEST_EXPECT_MSG_EQ (retryHdr.IsRetry (), true, "The retry bit should be set");
+    }
+  NS_TEST_EXPECT_MSG_EQ (manager->RemovePacket (tid, recipient, 4090), true, "4090 should be in the retry queue");
+  NS_TEST_EXPECT_MSG_EQ (manager->RemovePacket (tid, recipient, 4090), false, "4090 was already removed");
+  for (uint16_t seq = 4002; seq != 160; seq = (seq + 1) % 4096)
+    {
+      if ((seq >= 4002 && seq < 4064) || seq == 5 || (seq >= 32 && seq < 160))
+        {
+          NS_TEST_EXPECT_MSG_EQ (manager->RemovePacket (tid, recipient, seq), true, "MPDU " << seq << " should be in the retry queue");
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (manager->GetNBufferedPackets (recipient, tid), 0, "All MPDUs should have been released");
+  NS_TEST_EXPECT_MSG_EQ (manager->HasPackets (), false, "No MPDU should be left");
+
+  manager->Dispose ();
+  stationManager->Dispose ();
+  phy->Dispose ();
+}
+
 /**
  * \ingroup wifi-test
  * \ingroup tests
@@ -324,6 +469,7 @@ BlockAckTestSuite::BlockAckTestSuite ()
   AddTestCase (new PacketBufferingCaseA, TestCase::QUICK);
   AddTestCase (new PacketBufferingCaseB, TestCase::QUICK);
   AddTestCase (new CtrlBAckResponseHeaderTest, TestCase::QUICK);
+  AddTestCase (new BlockAckManagerBufferTest, TestCase::QUICK);
 }
 
 static BlockAckTestSuite g_blockAckTestSuite; ///< the test suite
@@ -0,0 +1,203 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/yans-wifi-helper.h"
+#include "ns3/wifi-net-device.h"
+#include "ns3/regular-wifi-mac.h"
+#include "ns3/ht-capabilities.h"
+#include "ns3/wifi-remote-station-manager.h"
+#include "ns3/wifi-mac-header.h"
+
+#include <map>
+
+using namespace ns3;
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Minstrel-HT rate selection test
+ *
+ * The transmissions of a Minstrel-HT station are reported as if every
+ * attempt at an MCS up to a limit succeeded, and every attempt at a higher
+ * MCS failed. Since the statistics are only updated for the rates attempted
+ * in each interval, this checks that Minstrel-HT still settles on the best
+ * MCS, both when the limit is lowered and when it is raised again, i.e.,
+ * when the rates which were not attempted for a while become the best ones.
+ */
+class MinstrelHtRateSelectionTest : public TestCase
+{
+public:
+  MinstrelHtRateSelectionTest ();
+
+  virtual void DoRun (void);
+private:
+  /**
+   * Transmit a packet, retrying until it succeeds or the retry limit is
+   * reached, and record the MCS of its first attempt.
+   */
+  void TransmitPacket (void);
+  /**
+   * \param maxMcs the highest MCS whose attempts succeed
+   */
+  void SetMaxMcs (uint8_t maxMcs);
+  /**
+   * Start recording the MCS used by the next packets.
+   */
+  void StartRecording (void);
+  /**
+   * Check that most of the packets recorded since StartRecording() used the
+   * expected MCS, and stop recording.
+   * \param expectedMcs the expected MCS
+   */
+  void CheckMcs (uint8_t expectedMcs);
+
+  Ptr<WifiRemoteStationManager> m_manager; ///< Minstrel-HT manager
+  Mac48Address m_remote;                   ///< address of the remote station
+  WifiMacHeader m_hdr;                     ///< header of the packets
+  Ptr<Packet> m_packet;                    ///< transmitted packet
+  uint8_t m_maxMcs;                        ///< highest MCS whose attempts succeed
+  bool m_recording;                        ///< whether the MCS of the packets are recorded
+  std::map<uint8_t, uint32_t> m_mcsCount;  ///< number of packets recorded per MCS
+};
+
+MinstrelHtRateSelectionTest::MinstrelHtRateSelectionTest ()
+  : TestCase ("Minstrel-HT rate selection"),
+    m_maxMcs (0),
+    m_recording (false)
+{
+}
+
+void
+MinstrelHtRateSelectionTest::TransmitPacket (void)
+{
+  for (uint32_t attempt = 0; attempt < 64; attempt++)
+    {
+      WifiTxVector txVector = m_manager->GetDataTxVector (m_remote, &m_hdr, m_packet);
+      uint8_t mcs = txVector.GetMode ().GetMcsValue ();
+      if (attempt == 0 && m_recording)
+        {
+          m_mcsCount[mcs]++;
+        }
+      if (mcs <= m_maxMcs)
+        {
+          m_manager->ReportDataOk (m_remote, &m_hdr, 0, txVector.GetMode (), 0, m_packet->GetSize ());
+          break;
+        }
+      m_manager->ReportDataFailed (m_remote, &m_hdr, m_packet->GetSize ());
+      if (!m_manager->NeedRetransmission (m_remote, &m_hdr, m_packet))
+        {
+          m_manager->ReportFinalDataFailed (m_remote, &m_hdr, m_packet->GetSize ());
+          break;
+        }
+    }
+  Simulator::Schedule (MilliSeconds (1), &MinstrelHtRateSelectionTest::TransmitPacket, this);
+}
+
+void
+MinstrelHtRateSelectionTest::SetMaxMcs (uint8_t maxMcs)
+{
+  m_maxMcs = maxMcs;
+}
+
+void
+MinstrelHtRateSelectionTest::StartRecording (void)
+{
+  m_mcsCount.clear ();
+  m_recording = true;
+}
+
+void
+MinstrelHtRateSelectionTest::CheckMcs (uint8_t expectedMcs)
+{
+  m_recording = false;
+  uint32_t total = 0;
+  for (std::map<uint8_t, uint32_t>::const_iterator i = m_mcsCount.begin (); i != m_mcsCount.end (); i++)
+    {
+      total += i->second;
+    }
+  NS_TEST_ASSERT_MSG_GT (total, 0, "No packet recorded");
+  // the other packets are sampling ones
+  NS_TEST_EXPECT_MSG_GT (m_mcsCount[expectedMcs] * 2, total, "MCS " << +expectedMcs << " not selected at " << Simulator::Now ().As (Time::S));
+}
+
+void
+MinstrelHtRateSelectionTest::DoRun (void)
+{
+  NodeContainer node;
+  node.Create (1);
+  YansWifiPhyHelper phy = YansWifiPhyHelper::Default ();
+  phy.SetChannel (YansWifiChannelHelper::Default ().Create ());
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211n_5GHZ);
+  wifi.SetRemoteStationManager ("ns3::MinstrelHtWifiManager");
+  WifiMacHelper mac;
+  mac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (phy, mac, node);
+  Ptr<WifiNetDevice> dev = DynamicCast<WifiNetDevice> (devices.Get (0));
+  m_manager = dev->GetRemoteStationManager ();
+
+  // The remote station supports the same rates, as in ad hoc mode
+  m_remote = Mac48Address::Allocate ();
+  Ptr<RegularWifiMac> regularMac = DynamicCast<RegularWifiMac> (dev->GetMac ());
+  m_manager->AddAllSupportedMcs (m_remote);
+  m_manager->AddStationHtCapabilities (m_remote, regularMac->GetHtCapabilities ());
+  m_manager->AddAllSupportedModes (m_remote);
+
+  m_hdr.SetType (WIFI_MAC_QOSDATA);
+  m_hdr.SetQosTid (0);
+  m_hdr.SetAddr1 (m_remote);
+  m_hdr.SetAddr2 (dev->GetMac ()->GetAddress ());
+  m_packet = Create<Packet> (1000);
+
+  Simulator::Schedule (Seconds (0), &MinstrelHtRateSelectionTest::SetMaxMcs, this, 4);
+  Simulator::Schedule (Seconds (0), &MinstrelHtRateSelectionTest::TransmitPacket, this);
+  Simulator::Schedule (Seconds (2), &MinstrelHtRateSelectionTest::StartRecording, this);
+  Simulator::Schedule (Seconds (3), &MinstrelHtRateSelectionTest::CheckMcs, this, 4);
+  Simulator::Schedule (Seconds (3), &MinstrelHtRateSelectionTest::SetMaxMcs, this, 7);
+  Simulator::Schedule (Seconds (5), &MinstrelHtRateSelectionTest::StartRecording, this);
+  Simulator::Schedule (Seconds (6), &MinstrelHtRateSelectionTest::CheckMcs, this, 7);
+  Simulator::Schedule (Seconds (6), &MinstrelHtRateSelectionTest::SetMaxMcs, this, 2);
+  Simulator::Schedule (Seconds (8), &MinstrelHtRateSelectionTest::StartRecording, this);
+  Simulator::Schedule (Seconds (9), &MinstrelHtRateSelectionTest::CheckMcs, this, 2);
+  Simulator::Stop (Seconds (9.1));
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Minstrel-HT Test Suite
+ */
+class MinstrelHtTestSuite : public TestSuite
+{
+public:
+  MinstrelHtTestSuite ();
+};
+
+MinstrelHtTestSuite::MinstrelHtTestSuite ()
+  : TestSuite ("wifi-minstrel-ht", UNIT)
+{
+  AddTestCase (new MinstrelHtRateSelectionTest, TestCase::QUICK);
+}
+
+static MinstrelHtTestSuite g_minstrelHtTestSuite; ///< the test suite
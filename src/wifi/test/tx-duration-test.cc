@@ -426,6 +426,159 @@ TxDurationTest::DoRun (void)
   NS_TEST_EXPECT_MSG_EQ (retval, true, "an 802.11ax duration failed");
 }
 
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Tx Duration Cache Test
+ *
+ * Check that the durations returned once the timing parameters of a
+ * TXVECTOR are memoized are exactly the ones given by the HE payload
+ * duration formula, including for the A-MPDU subframes.
+ */
+class TxDurationCacheTest : public TestCase
+{
+public:
+  TxDurationCacheTest ();
+  virtual ~TxDurationCacheTest ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Compute the HE payload duration the way WifiPhy::GetPayloadDuration
+   * does, from the TXVECTOR alone (no memoized parameters).
+   *
+   * \param size the size of the PSDU or of the A-MPDU subframe (in bytes)
+   * \param txVector the TXVECTOR used for the transmission
+   * \param mpdutype the type of the MPDU
+   * \param totalAmpduSize the size of the A-MPDU subframes seen so far (in bytes)
+   * \param totalAmpduNumSymbols the number of symbols of the A-MPDU subframes seen so far
+   *
+   * \return the payload duration (in femtoseconds), before truncation to the time resolution
+   */
+  static uint64_t GetHePayloadFemtoSeconds (uint32_t size, WifiTxVector txVector, MpduType mpdutype,
+                                            uint32_t &totalAmpduSize, double &totalAmpduNumSymbols);
+};
+
+TxDurationCacheTest::TxDurationCacheTest ()
+  : TestCase ("Wifi TX Duration cache")
+{
+}
+
+TxDurationCacheTest::~TxDurationCacheTest ()
+{
+}
+
+uint64_t
+TxDurationCacheTest::GetHePayloadFemtoSeconds (uint32_t size, WifiTxVector txVector, MpduType mpdutype,
+                                               uint32_t &totalAmpduSize, double &totalAmpduNumSymbols)
+{
+  //HE: no STBC, a single BCC encoder
+  Time symbolDuration = NanoSeconds (12800 + txVector.GetGuardInterval ());
+  double numDataBitsPerSymbol = txVector.GetMode ().GetDataRate (txVector) * symbolDuration.GetNanoSeconds () / 1e9;
+  double numSymbols;
+  if (mpdutype == MPDU_IN_AGGREGATE)
+    {
+      if (txVector.GetPreambleType () != WIFI_PREAMBLE_NONE)
+        {
+          numSymbols = (16 + size * 8.0 + 6) / numDataBitsPerSymbol;
+        }
+      else
+        {
+          numSymbols = (size * 8.0) / numDataBitsPerSymbol;
+        }
+      totalAmpduSize += size;
+      totalAmpduNumSymbols += numSymbols;
+    }
+  else if (mpdutype == LAST_MPDU_IN_AGGREGATE)
+    {
+      numSymbols = lrint (ceil ((16 + (totalAmpduSize + size) * 8.0 + 6) / numDataBitsPerSymbol));
+      numSymbols -= totalAmpduNumSymbols;
+      totalAmpduSize = 0;
+      totalAmpduNumSymbols = 0;
+    }
+  else
+    {
+      numSymbols = lrint (ceil ((16 + size * 8.0 + 6) / numDataBitsPerSymbol));
+    }
+  return static_cast<uint64_t> (numSymbols * symbolDuration.GetFemtoSeconds ());
+}
+
+void
+TxDurationCacheTest::DoRun (void)
+{
+  Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+  const uint16_t widths[] = {20, 40, 80, 160};
+  const uint16_t guardIntervals[] = {800, 1600, 3200};
+  const uint32_t sizes[] = {14, 76, 1536, 65535};
+  const WifiMode modes[] = {WifiPhy::GetHeMcs0 (), WifiPhy::GetHeMcs1 (), WifiPhy::GetHeMcs2 (), WifiPhy::GetHeMcs3 (),
+                            WifiPhy::GetHeMcs4 (), WifiPhy::GetHeMcs5 (), WifiPhy::GetHeMcs6 (), WifiPhy::GetHeMcs7 (),
+                            WifiPhy::GetHeMcs8 (), WifiPhy::GetHeMcs9 (), WifiPhy::GetHeMcs10 (), WifiPhy::GetHeMcs11 ()};
+  uint32_t totalAmpduSize = 0;
+  double totalAmpduNumSymbols = 0;
+
+  //the first round fills the cache, the second one only reads it; TXVECTORs are
+  //interleaved so that the cached entries of several of them are looked up in turn
+  for (uint8_t round = 0; round < 2; round++)
+    {
+      for (const WifiMode &mode : modes)
+        {
+          for (uint16_t width : widths)
+            {
+              for (uint16_t gi : guardIntervals)
+                {
+                  for (uint32_t size : sizes)
+                    {
+                      WifiTxVector txVector;
+                      txVector.SetMode (mode);
+                      txVector.SetPreambleType (WIFI_PREAMBLE_HE_SU);
+                      txVector.SetChannelWidth (width);
+                      txVector.SetGuardInterval (gi);
+                      txVector.SetNss (1);
+                      Time expected = WifiPhy::CalculatePlcpPreambleAndHeaderDuration (txVector)
+                        + FemtoSeconds (GetHePayloadFemtoSeconds (size, txVector, NORMAL_MPDU, totalAmpduSize, totalAmpduNumSymbols));
+                      NS_TEST_EXPECT_MSG_EQ (phy->CalculateTxDuration (size, txVector, CHANNEL_36_MHZ), expected,
+                                             "Wrong duration for " << mode << " size " << size);
+                      NS_TEST_EXPECT_MSG_EQ (phy->CalculateTxDuration (size, txVector, CHANNEL_1_MHZ), expected + MicroSeconds (6),
+                                             "Wrong duration at 2.4 GHz for " << mode << " size " << size);
+                    }
+                }
+            }
+        }
+    }
+
+  //A-MPDU made of 64 subframes. Each subframe but the last one lasts a fractional
+  //number of symbols and its duration is truncated to the time resolution by
+  //GetPayloadDuration, so the sum of the subframe durations falls short of the
+  //PSDU duration by the sum of the truncated parts (less than 64 ns here).
+  WifiTxVector txVector;
+  txVector.SetMode (WifiPhy::GetHeMcs7 ());
+  txVector.SetChannelWidth (80);
+  txVector.SetGuardInterval (800);
+  txVector.SetNss (1);
+  for (uint8_t round = 0; round < 2; round++)
+    {
+      Time ampduDuration = Seconds (0);
+      Time expected = Seconds (0);
+      uint64_t untruncated = 0;
+      for (uint8_t i = 0; i < 64; i++)
+        {
+          txVector.SetPreambleType (i == 0 ? WIFI_PREAMBLE_HE_SU : WIFI_PREAMBLE_NONE);
+          MpduType mpdutype = (i == 63 ? LAST_MPDU_IN_AGGREGATE : MPDU_IN_AGGREGATE);
+          ampduDuration += phy->CalculateTxDuration (1536, txVector, CHANNEL_36_MHZ, mpdutype, 1);
+          uint64_t fs = GetHePayloadFemtoSeconds (1536, txVector, mpdutype, totalAmpduSize, totalAmpduNumSymbols);
+          expected += FemtoSeconds (fs);
+          untruncated += fs;
+        }
+      txVector.SetPreambleType (WIFI_PREAMBLE_HE_SU);
+      Time preamble = WifiPhy::CalculatePlcpPreambleAndHeaderDuration (txVector);
+      NS_TEST_EXPECT_MSG_EQ (ampduDuration, preamble + expected, "Wrong A-MPDU subframe durations");
+      NS_TEST_EXPECT_MSG_EQ (phy->CalculateTxDuration (64 * 1536, txVector, CHANNEL_36_MHZ),
+                             preamble + NanoSeconds (lrint (untruncated / 1e6)),
+                             "A-MPDU subframes do not cover the PSDU duration once untruncated");
+    }
+}
+
 /**
  * \ingroup wifi-test
  * \ingroup tests
@@ -442,6 +595,7 @@ TxDurationTestSuite::TxDurationTestSuite ()
   : TestSuite ("devices-wifi-tx-duration", UNIT)
 {
   AddTestCase (new TxDurationTest, TestCase::QUICK);
+  AddTestCase (new TxDurationCacheTest, TestCase::QUICK);
 }
 
 static TxDurationTestSuite g_txDurationTestSuite; ///< the test suite
@@ -43,6 +43,8 @@
 #include "ns3/wifi-phy-tag.h"
 #include "ns3/yans-wifi-phy.h"
 #include "ns3/mgt-headers.h"
+#include "ns3/interference-helper.h"
+#include "ns3/nist-error-rate-model.h"
 
 using namespace ns3;
 
@@ -1514,6 +1516,425 @@ Bug2831TestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (m_countOperationalChannelWidth40, 20, "Incorrect operational channel width after channel change");
 }
 
+//-----------------------------------------------------------------------------
+/**
+ * Make sure that the serialized information elements that a beacon header
+ * keeps from one serialization to the next are refreshed when one of its
+ * fields is modified, while the timestamp is always the current time.
+ */
+
+class BeaconSerializationCacheTestCase : public TestCase
+{
+public:
+  BeaconSerializationCacheTestCase ();
+  virtual ~BeaconSerializationCacheTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Serialize the beacon template into a new packet and check its content
+   * \param expectedSsid the SSID the beacon is expected to carry
+   */
+  void SendBeacon (Ssid expectedSsid);
+
+  MgtBeaconHeader m_beacon; ///< beacon header which is serialized several times
+};
+
+BeaconSerializationCacheTestCase::BeaconSerializationCacheTestCase ()
+  : TestCase ("Test case for the beacon serialization cache")
+{
+}
+
+BeaconSerializationCacheTestCase::~BeaconSerializationCacheTestCase ()
+{
+}
+
+void
+BeaconSerializationCacheTestCase::SendBeacon (Ssid expectedSsid)
+{
+  Ptr<Packet> packet = Create<Packet> ();
+  packet->AddHeader (m_beacon);
+  NS_TEST_EXPECT_MSG_EQ (packet->GetSize (), m_beacon.GetSerializedSize (), "Unexpected beacon size");
+  MgtBeaconHeader received;
+  packet->RemoveHeader (received);
+  NS_TEST_EXPECT_MSG_EQ (received.GetSsid ().IsEqual (expectedSsid), true, "Unexpected SSID");
+  NS_TEST_EXPECT_MSG_EQ (received.GetBeaconIntervalUs (), m_beacon.GetBeaconIntervalUs (), "Unexpected beacon interval");
+  NS_TEST_EXPECT_MSG_EQ (received.GetTimestamp (), static_cast<uint64_t> (Simulator::Now ().GetMicroSeconds ()), "Unexpected timestamp");
+  NS_TEST_EXPECT_MSG_EQ (packet->GetSize (), 0, "Beacon not entirely deserialized");
+}
+
+void
+BeaconSerializationCacheTestCase::DoRun (void)
+{
+  m_beacon.SetSsid (Ssid ("short"));
+  m_beacon.SetBeaconIntervalUs (102400);
+  Simulator::Schedule (MilliSeconds (100), &BeaconSerializationCacheTestCase::SendBeacon, this, Ssid ("short"));
+  Simulator::Schedule (MilliSeconds (200), &BeaconSerializationCacheTestCase::SendBeacon, this, Ssid ("short"));
+  Simulator::Schedule (MilliSeconds (250), &MgtBeaconHeader::SetSsid, &m_beacon, Ssid ("a-much-longer-ssid"));
+  Simulator::Schedule (MilliSeconds (300), &BeaconSerializationCacheTestCase::SendBeacon, this, Ssid ("a-much-longer-ssid"));
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * Make sure that the link abstraction of the PHY, which reads the error rate
+ * of the payload from cached curves, matches the error rate computed by the
+ * error rate model when the SNR of the payload falls on a sample of the
+ * curves, and remains close to it otherwise.
+ */
+
+class LinkAbstractionTestCase : public TestCase
+{
+public:
+  LinkAbstractionTestCase ();
+  virtual ~LinkAbstractionTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Compute the error rate of the payload of a packet received without
+   * interference
+   * \param snrDb the SNR of the packet (dB)
+   * \param linkAbstraction whether the link abstraction is enabled
+   * \return the error rate of the payload
+   */
+  double GetPayloadPer (double snrDb, bool linkAbstraction);
+};
+
+LinkAbstractionTestCase::LinkAbstractionTestCase ()
+  : TestCase ("Test case for the link abstraction of the PHY")
+{
+}
+
+LinkAbstractionTestCase::~LinkAbstractionTestCase ()
+{
+}
+
+double
+LinkAbstractionTestCase::GetPayloadPer (double snrDb, bool linkAbstraction)
+{
+  double noiseFigure = 5;
+  double noiseW = 1.3803e-23 * 290 * 20e6 * noiseFigure;
+  Ptr<YansWifiPhy> phy = CreateObject<YansWifiPhy> ();
+  phy->ConfigureStandard (WIFI_PHY_STANDARD_80211a);
+  WifiTxVector txVector;
+  txVector.SetMode (WifiPhy::GetOfdmRate24Mbps ());
+  txVector.SetPreambleType (WIFI_PREAMBLE_LONG);
+  txVector.SetChannelWidth (20);
+  Ptr<Packet> packet = Create<Packet> (1500);
+
+  InterferenceHelper interference;
+  interference.SetNoiseFigure (noiseFigure);
+  interference.SetErrorRateModel (CreateObject<NistErrorRateModel> ());
+  interference.SetNumberOfReceiveAntennas (1);
+  interference.SetLinkAbstraction (linkAbstraction);
+  Ptr<Event> event = interference.Add (packet, txVector, phy->CalculateTxDuration (packet->GetSize (), txVector, 5180),
+                                       noiseW * std::pow (10.0, snrDb / 10));
+  double per = interference.CalculatePlcpPayloadSnrPer (event).per;
+  phy->Dispose ();
+  return per;
+}
+
+void
+LinkAbstractionTestCase::DoRun (void)
+{
+  for (double snrDb = 8; snrDb <= 16; snrDb += 0.5)
+    {
+      NS_TEST_EXPECT_MSG_EQ_TOL (GetPayloadPer (snrDb, true), GetPayloadPer (snrDb, false), 1e-6,
+                                 "Unexpected PER at " << snrDb << " dB");
+    }
+  for (double snrDb = 8.25; snrDb <= 16; snrDb += 0.5)
+    {
+      double per = GetPayloadPer (snrDb, true);
+      NS_TEST_EXPECT_MSG_EQ_TOL (per, GetPayloadPer (snrDb, false), 0.1, "Unexpected PER at " << snrDb << " dB");
+      NS_TEST_EXPECT_MSG_LT_OR_EQ (per, GetPayloadPer (snrDb - 0.25, true), "PER increases with the SNR at " << snrDb << " dB");
+      NS_TEST_EXPECT_MSG_GT_OR_EQ (per, GetPayloadPer (snrDb + 0.25, true), "PER increases with the SNR at " << snrDb << " dB");
+    }
+  Simulator::Destroy ();
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * Make sure that the link abstraction of the PHY does not share the success
+ * rate curve of an MCS between TXVECTORs whose channel width or guard
+ * interval differ, since the error rate of the YANS model depends on them.
+ */
+
+class LinkAbstractionTxVectorTestCase : public TestCase
+{
+public:
+  LinkAbstractionTxVectorTestCase ();
+  virtual ~LinkAbstractionTxVectorTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Compute the error rate of the payload of a packet received without
+   * interference
+   * \param interference the interference helper
+   * \param txVector the TXVECTOR of the packet
+   * \param snrDb the SNR of the packet (dB)
+   * \return the error rate of the payload
+   */
+  double GetPayloadPer (InterferenceHelper &interference, WifiTxVector txVector, double snrDb);
+
+  Ptr<YansWifiPhy> m_phy; ///< the PHY, used to compute the duration of the packets
+};
+
+LinkAbstractionTxVectorTestCase::LinkAbstractionTxVectorTestCase ()
+  : TestCase ("Test case for the link abstraction of the PHY with several TXVECTORs of an MCS")
+{
+}
+
+LinkAbstractionTxVectorTestCase::~LinkAbstractionTxVectorTestCase ()
+{
+}
+
+double
+LinkAbstractionTxVectorTestCase::GetPayloadPer (InterferenceHelper &interference, WifiTxVector txVector, double snrDb)
+{
+  double noiseFigure = 5;
+  double noiseW = 1.3803e-23 * 290 * txVector.GetChannelWidth () * 1e6 * noiseFigure;
+  Ptr<Packet> packet = Create<Packet> (1500);
+  interference.SetNoiseFigure (noiseFigure);
+  Ptr<Event> event = interference.Add (packet, txVector, m_phy->CalculateTxDuration (packet->GetSize (), txVector, 5180),
+                                       noiseW * std::pow (10.0, snrDb / 10));
+  double per = interference.CalculatePlcpPayloadSnrPer (event).per;
+  interference.EraseEvents ();
+  return per;
+}
+
+void
+LinkAbstractionTxVectorTestCase::DoRun (void)
+{
+  m_phy = CreateObject<YansWifiPhy> ();
+  m_phy->ConfigureStandard (WIFI_PHY_STANDARD_80211n_5GHZ);
+  std::vector<WifiTxVector> txVectors;
+  for (uint16_t channelWidth = 20; channelWidth <= 40; channelWidth *= 2)
+    {
+      for (uint16_t guardInterval = 400; guardInterval <= 800; guardInterval *= 2)
+        {
+          WifiTxVector txVector;
+          txVector.SetMode (WifiPhy::GetHtMcs4 ());
+          txVector.SetPreambleType (WIFI_PREAMBLE_HT_MF);
+          txVector.SetChannelWidth (channelWidth);
+          txVector.SetGuardInterval (guardInterval);
+          txVector.SetNss (1);
+          txVectors.push_back (txVector);
+        }
+    }
+
+  //the curves of all the TXVECTORs are cached by the same helper
+  InterferenceHelper cached;
+  cached.SetErrorRateModel (CreateObject<YansErrorRateModel> ());
+  cached.SetNumberOfReceiveAntennas (1);
+  cached.SetLinkAbstraction (true);
+  InterferenceHelper uncached;
+  uncached.SetErrorRateModel (CreateObject<YansErrorRateModel> ());
+  uncached.SetNumberOfReceiveAntennas (1);
+  bool differ = false;
+  for (double snrDb = 8; snrDb <= 16; snrDb += 0.5)
+    {
+      double firstPer = GetPayloadPer (uncached, txVectors.front (), snrDb);
+      for (std::vector<WifiTxVector>::const_iterator it = txVectors.begin (); it != txVectors.end (); it++)
+        {
+          double per = GetPayloadPer (uncached, *it, snrDb);
+          NS_TEST_EXPECT_MSG_EQ_TOL (GetPayloadPer (cached, *it, snrDb), per, 1e-6,
+                                     "Unexpected PER at " << snrDb << " dB with a width of " << it->GetChannelWidth ()
+                                                          << " MHz and a guard interval of " << it->GetGuardInterval () << " ns");
+          differ = differ || std::abs (per - firstPer) > 0.01;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (differ, true, "The PER does not depend on the TXVECTOR");
+  m_phy->Dispose ();
+  m_phy = 0;
+  Simulator::Destroy ();
+}
+
+//-----------------------------------------------------------------------------
+/**
+ * Make sure that the beacon template of an AP is rebuilt whenever the state
+ * it reflects changes: the ERP protection and the slot time once a non-ERP
+ * STA is associated, the SSID and the channel.
+ */
+
+class BeaconTemplateUpdateTestCase : public TestCase
+{
+public:
+  BeaconTemplateUpdateTestCase ();
+  virtual ~BeaconTemplateUpdateTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * Callback function on STA assoc event
+   * \param context context string
+   * \param bssid the associated AP's bssid
+   */
+  void AssocCallback (std::string context, Mac48Address bssid);
+  /**
+   * Callback triggered when a packet starts being transmitted by the AP PHY
+   * \param p the transmitted packet
+   */
+  void TxCallback (Ptr<const Packet> p);
+  /**
+   * Function called to change the SSID of the AP
+   */
+  void ChangeSsid (void);
+  /**
+   * Function called to change the channel of the AP
+   */
+  void ChangeChannel (void);
+
+  Ptr<WifiNetDevice> m_apDevice; ///< AP device
+  bool m_associated;             ///< whether the STA is associated
+  bool m_ssidChanged;            ///< whether the SSID of the AP has been changed
+  bool m_channelChanged;         ///< whether the channel of the AP has been changed
+  uint32_t m_beaconCount;        ///< count number of beacons
+  uint32_t m_assocBeaconCount;   ///< count number of beacons sent once the STA is associated
+  uint32_t m_ssidBeaconCount;    ///< count number of beacons sent once the SSID has been changed
+  uint32_t m_channelBeaconCount; ///< count number of beacons sent once the channel has been changed
+};
+
+BeaconTemplateUpdateTestCase::BeaconTemplateUpdateTestCase ()
+  : TestCase ("Test case for the beacon template update"),
+    m_associated (false),
+    m_ssidChanged (false),
+    m_channelChanged (false),
+    m_beaconCount (0),
+    m_assocBeaconCount (0),
+    m_ssidBeaconCount (0),
+    m_channelBeaconCount (0)
+{
+}
+
+BeaconTemplateUpdateTestCase::~BeaconTemplateUpdateTestCase ()
+{
+}
+
+void
+BeaconTemplateUpdateTestCase::AssocCallback (std::string context, Mac48Address bssid)
+{
+  m_associated = true;
+}
+
+void
+BeaconTemplateUpdateTestCase::ChangeSsid (void)
+{
+  m_apDevice->GetMac ()->SetSsid (Ssid ("changed-ssid"));
+  m_ssidChanged = true;
+}
+
+void
+BeaconTemplateUpdateTestCase::ChangeChannel (void)
+{
+  m_apDevice->GetPhy ()->SetChannelNumber (6);
+  m_channelChanged = true;
+}
+
+void
+BeaconTemplateUpdateTestCase::TxCallback (Ptr<const Packet> p)
+{
+  Ptr<Packet> packet = p->Copy ();
+  WifiMacHeader hdr;
+  packet->RemoveHeader (hdr);
+  if (!hdr.IsBeacon ())
+    {
+      return;
+    }
+  MgtBeaconHeader beacon;
+  packet->RemoveHeader (beacon);
+  Ptr<WifiRemoteStationManager> manager = m_apDevice->GetRemoteStationManager ();
+  if (m_beaconCount++ == 0)
+    {
+      // The STA waits for a beacon before requesting the association
+      NS_TEST_EXPECT_MSG_EQ (m_associated, false, "STA associated before the first beacon");
+      NS_TEST_EXPECT_MSG_EQ (+beacon.GetErpInformation ().GetNonErpPresent (), 0, "Non-ERP STA present before association");
+      NS_TEST_EXPECT_MSG_EQ (+beacon.GetErpInformation ().GetUseProtection (), 0, "ERP protection used before association");
+      NS_TEST_EXPECT_MSG_EQ (beacon.GetCapabilities ().IsShortSlotTime (), true, "Short slot time not announced before association");
+      NS_TEST_EXPECT_MSG_EQ (manager->GetShortSlotTimeEnabled (), true, "Short slot time not enabled before association");
+    }
+  if (m_associated)
+    {
+      m_assocBeaconCount++;
+      NS_TEST_EXPECT_MSG_EQ (+beacon.GetErpInformation ().GetNonErpPresent (), 1, "Non-ERP STA not announced once associated");
+      NS_TEST_EXPECT_MSG_EQ (+beacon.GetErpInformation ().GetUseProtection (), 1, "ERP protection not announced once the non-ERP STA is associated");
+      NS_TEST_EXPECT_MSG_EQ (beacon.GetCapabilities ().IsShortSlotTime (), false, "Short slot time announced once the non-ERP STA is associated");
+      NS_TEST_EXPECT_MSG_EQ (manager->GetShortSlotTimeEnabled (), false, "Short slot time enabled once the non-ERP STA is associated");
+    }
+  if (m_ssidChanged)
+    {
+      m_ssidBeaconCount++;
+      NS_TEST_EXPECT_MSG_EQ (beacon.GetSsid ().IsEqual (Ssid ("changed-ssid")), true, "Beacon not updated after the SSID change");
+    }
+  else
+    {
+      NS_TEST_EXPECT_MSG_EQ (beacon.GetSsid ().IsEqual (Ssid ("initial-ssid")), true, "Unexpected SSID");
+    }
+  if (m_channelChanged)
+    {
+      m_channelBeaconCount++;
+      NS_TEST_EXPECT_MSG_EQ (+beacon.GetHtOperation ().GetPrimaryChannel (), 6, "Beacon not updated after the channel change");
+    }
+  else
+    {
+      NS_TEST_EXPECT_MSG_EQ (+beacon.GetHtOperation ().GetPrimaryChannel (), 1, "Unexpected primary channel");
+    }
+}
+
+void
+BeaconTemplateUpdateTestCase::DoRun (void)
+{
+  Ptr<Node> apNode = CreateObject<Node> ();
+  Ptr<Node> staNode = CreateObject<Node> ();
+
+  YansWifiPhyHelper phy = YansWifiPhyHelper::Default ();
+  YansWifiChannelHelper channel = YansWifiChannelHelper::Default ();
+  phy.SetChannel (channel.Create ());
+
+  WifiHelper wifi;
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager");
+
+  WifiMacHelper mac;
+  Ssid ssid = Ssid ("initial-ssid");
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211n_2_4GHZ);
+  mac.SetType ("ns3::ApWifiMac",
+               "Ssid", SsidValue (ssid));
+  NetDeviceContainer apDevice = wifi.Install (phy, mac, apNode);
+  m_apDevice = DynamicCast<WifiNetDevice> (apDevice.Get (0));
+
+  // The 802.11b STA is neither ERP nor HT
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211b);
+  mac.SetType ("ns3::StaWifiMac",
+               "Ssid", SsidValue (ssid));
+  wifi.Install (phy, mac, staNode);
+
+  MobilityHelper mobility;
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  positionAlloc->Add (Vector (0.0, 0.0, 0.0));
+  positionAlloc->Add (Vector (1.0, 0.0, 0.0));
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (apNode);
+  mobility.Install (staNode);
+
+  Config::Connect ("/NodeList/*/DeviceList/*/$ns3::WifiNetDevice/Mac/$ns3::StaWifiMac/Assoc", MakeCallback (&BeaconTemplateUpdateTestCase::AssocCallback, this));
+  m_apDevice->GetPhy ()->TraceConnectWithoutContext ("PhyTxBegin", MakeCallback (&BeaconTemplateUpdateTestCase::TxCallback, this));
+
+  Simulator::Schedule (Seconds (1.0), &BeaconTemplateUpdateTestCase::ChangeSsid, this);
+  Simulator::Schedule (Seconds (1.5), &BeaconTemplateUpdateTestCase::ChangeChannel, this);
+
+  Simulator::Stop (Seconds (2.0));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_associated, true, "STA not associated");
+  NS_TEST_ASSERT_MSG_GT (m_assocBeaconCount, 0, "No beacon sent once the STA is associated");
+  NS_TEST_ASSERT_MSG_GT (m_ssidBeaconCount, 0, "No beacon sent after the SSID change");
+  NS_TEST_ASSERT_MSG_GT (m_channelBeaconCount, 0, "No beacon sent after the channel change");
+}
+
 //-----------------------------------------------------------------------------
 /**
  * Make sure that Wifi STA is correctly associating to the best AP (i.e.,
@@ -1715,6 +2136,10 @@ WifiTestSuite::WifiTestSuite ()
   AddTestCase (new Bug2483TestCase, TestCase::QUICK); //Bug 2483
   AddTestCase (new Bug2831TestCase, TestCase::QUICK); //Bug 2831
   AddTestCase (new StaWifiMacScanningTestCase, TestCase::QUICK); //Bug 2399
+  AddTestCase (new BeaconSerializationCacheTestCase, TestCase::QUICK);
+  AddTestCase (new BeaconTemplateUpdateTestCase, TestCase::QUICK);
+  AddTestCase (new LinkAbstractionTestCase, TestCase::QUICK);
+  AddTestCase (new LinkAbstractionTxVectorTestCase, TestCase::QUICK);
 }
 
 static WifiTestSuite g_wifiTestSuite; ///< the test suite
@@ -0,0 +1,292 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the hookup of the traces at the
+// start of a simulation, in a tree of 'n' nodes with 'devices' devices
+// each, mimicking the NodeList of the network module.  The same paths,
+// one per node and a few wildcard ones, are set and connected one at a
+// time with Config::Set and Config::Connect, then with a Config::PathBatch.
+// Sample usage:  ./waf --run 'bench-config --n=1000,2000,4000'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/config.h"
+#include "ns3/object.h"
+#include "ns3/object-vector.h"
+#include "ns3/pointer.h"
+#include "ns3/uinteger.h"
+#include "ns3/traced-value.h"
+#include "ns3/trace-source-accessor.h"
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+/** A physical layer, with a trace source. */
+class BenchPhy : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return The object TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::BenchPhy")
+      .SetParent<Object> ()
+      .AddConstructor<BenchPhy> ()
+      .AddTraceSource ("State", "The state of the phy.",
+                       MakeTraceSourceAccessor (&BenchPhy::m_state),
+                       "ns3::TracedValueCallback::Uint32")
+    ;
+    return tid;
+  }
+  TracedValue<uint32_t> m_state;  //!< The traced state.
+};
+
+/** A device, with an attribute, a trace source and a phy. */
+class BenchDevice : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return The object TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::BenchDevice")
+      .SetParent<Object> ()
+      .AddConstructor<BenchDevice> ()
+      .AddAttribute ("Mtu", "The MTU of the device.",
+                     UintegerValue (1500),
+                     MakeUintegerAccessor (&BenchDevice::m_mtu),
+                     MakeUintegerChecker<uint16_t> ())
+      .AddAttribute ("Phy", "The phy of the device.",
+                     PointerValue (),
+                     MakePointerAccessor (&BenchDevice::m_phy),
+                     MakePointerChecker<BenchPhy> ())
+      .AddTraceSource ("Tx", "The number of transmitted packets.",
+                       MakeTraceSourceAccessor (&BenchDevice::m_tx),
+                       "ns3::TracedValueCallback::Uint32")
+    ;
+    return tid;
+  }
+  uint16_t m_mtu;               //!< The MTU.
+  Ptr<BenchPhy> m_phy;          //!< The phy.
+  TracedValue<uint32_t> m_tx;   //!< The traced packet count.
+};
+
+/** A node, with a vector of devices. */
+class BenchNode : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return The object TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::BenchNode")
+      .SetParent<Object> ()
+      .AddConstructor<BenchNode> ()
+      .AddAttribute ("DeviceList", "The devices of the node.",
+                     ObjectVectorValue (),
+                     MakeObjectVectorAccessor (&BenchNode::m_devices),
+                     MakeObjectVectorChecker<BenchDevice> ())
+    ;
+    return tid;
+  }
+  std::vector<Ptr<BenchDevice> > m_devices;  //!< The devices.
+};
+
+/** The root of the tree, with a vector of nodes. */
+class BenchRoot : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return The object TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::BenchRoot")
+      .SetParent<Object> ()
+      .AddConstructor<BenchRoot> ()
+      .AddAttribute ("BenchNodeList", "The nodes.",
+                     ObjectVectorValue (),
+                     MakeObjectVectorAccessor (&BenchRoot::m_nodes),
+                     MakeObjectVectorChecker<BenchNode> ())
+    ;
+    return tid;
+  }
+  std::vector<Ptr<BenchNode> > m_nodes;  //!< The nodes.
+};
+
+/** The number of traces called. */
+static uint64_t g_calls = 0;
+
+/**
+ * Count the trace calls with a context.
+ * \param [in] context The context.
+ * \param [in] oldValue The old value.
+ * \param [in] newValue The new value.
+ */
+static void
+TraceWithContext (std::string context, uint32_t oldValue, uint32_t newValue)
+{
+  g_calls++;
+}
+
+/**
+ * Count the trace calls without context.
+ * \param [in] oldValue The old value.
+ * \param [in] newValue The new value.
+ */
+static void
+TraceWithoutContext (uint32_t oldValue, uint32_t newValue)
+{
+  g_calls++;
+}
+
+/**
+ * Build a tree of nodes and register it as a root namespace object.
+ * \param [in] n The number of nodes.
+ * \param [in] devices The number of devices of each node.
+ * \returns The root of the tree.
+ */
+static Ptr<BenchRoot>
+BuildTree (uint32_t n, uint32_t devices)
+{
+  Ptr<BenchRoot> root = CreateObject<BenchRoot> ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<BenchNode> node = CreateObject<BenchNode> ();
+      for (uint32_t j = 0; j < devices; j++)
+        {
+          Ptr<BenchDevice> device = CreateObject<BenchDevice> ();
+          device->m_phy = CreateObject<BenchPhy> ();
+          node->m_devices.push_back (device);
+        }
+      root->m_nodes.push_back (node);
+    }
+  Config::RegisterRootNamespaceObject (root);
+  return root;
+}
+
+/**
+ * Fire every trace source of the tree once.
+ * \param [in] root The root of the tree.
+ */
+static void
+FireTraces (Ptr<BenchRoot> root)
+{
+  for (uint32_t i = 0; i < root->m_nodes.size (); i++)
+    {
+      for (uint32_t j = 0; j < root->m_nodes[i]->m_devices.size (); j++)
+        {
+          Ptr<BenchDevice> device = root->m_nodes[i]->m_devices[j];
+          device->m_tx = device->m_tx + 1;
+          device->m_phy->m_state = device->m_phy->m_state + 1;
+        }
+    }
+}
+
+/**
+ * Time the hookup of the paths of a tree, one path at a time and in a batch.
+ * \param [in] n The number of nodes.
+ * \param [in] devices The number of devices of each node.
+ */
+static void
+RunBench (uint32_t n, uint32_t devices)
+{
+  std::vector<std::string> perNode;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      std::ostringstream oss;
+      oss << "/BenchNodeList/" << i << "/DeviceList/*/";
+      perNode.push_back (oss.str ());
+    }
+  std::string allDevices = "/BenchNodeList/*/DeviceList/*/";
+
+  Ptr<BenchRoot> root = BuildTree (n, devices);
+  g_calls = 0;
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Config::Set (perNode[i] + "Mtu", UintegerValue (1400));
+      Config::Connect (perNode[i] + "Tx", MakeCallback (&TraceWithContext));
+    }
+  Config::ConnectWithoutContext (allDevices + "Phy/State", MakeCallback (&TraceWithoutContext));
+  Config::Connect (allDevices + "$ns3::BenchDevice/Phy/State", MakeCallback (&TraceWithContext));
+  int64_t single = time.End ();
+  FireTraces (root);
+  uint64_t singleCalls = g_calls;
+  Config::UnregisterRootNamespaceObject (root);
+
+  root = BuildTree (n, devices);
+  g_calls = 0;
+  time.Start ();
+  Config::PathBatch batch;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      batch.Set (perNode[i] + "Mtu", UintegerValue (1400));
+      batch.Connect (perNode[i] + "Tx", MakeCallback (&TraceWithContext));
+    }
+  batch.ConnectWithoutContext (allDevices + "Phy/State", MakeCallback (&TraceWithoutContext));
+  batch.Connect (allDevices + "$ns3::BenchDevice/Phy/State", MakeCallback (&TraceWithContext));
+  batch.Apply ();
+  int64_t batched = time.End ();
+  FireTraces (root);
+  uint64_t batchCalls = g_calls;
+  Config::UnregisterRootNamespaceObject (root);
+
+  std::cout << "nodes=" << std::setw (7) << n
+            << " single=" << std::setw (7) << single << " ms"
+            << " batch=" << std::setw (7) << batched << " ms"
+            << (singleCalls == batchCalls ? "" : " (different traces!)")
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  std::string n = "250,500,1000,2000";
+  uint32_t devices = 2;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the hookup of the traces of many nodes.");
+  cmd.AddValue ("n", "comma-separated numbers of nodes", n);
+  cmd.AddValue ("devices", "number of devices of each node", devices);
+  cmd.Parse (argc, argv);
+
+  std::istringstream iss (n);
+  std::string item;
+  while (std::getline (iss, item, ','))
+    {
+      uint32_t nodes = 0;
+      std::istringstream (item) >> nodes;
+      if (nodes == 0)
+        {
+          std::cerr << "invalid number of nodes: " << item << std::endl;
+          return 1;
+        }
+      RunBench (nodes, devices);
+    }
+  return 0;
+}
@@ -0,0 +1,95 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the logging backends, logging 'n'
+// messages with all the prefixes, like the reports of the controllers, on
+// std::clog redirected to a file, then with the binary backend.
+// The logging macros must be enabled, i.e., in a debug build, or in a
+// build configured with --enable-logs.
+// Sample usage:  ./waf --run 'bench-log --n=1000000'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/log.h"
+#include "ns3/log-binary.h"
+#include "ns3/simulator.h"
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("BenchLog");
+
+/**
+ * Log messages in an event.
+ * \param [in] n The number of messages.
+ */
+static void
+LogMessages (uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      NS_LOG_INFO ("AP " << i % 16 << " STA " << i << " rssi " << -60.5 - (i % 20)
+                   << " dBm, snr " << 25.25 + (i % 7) << " dB, load " << i % 100 << "%");
+    }
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 1000000;
+  std::string text = "bench-log.txt";
+  std::string binary = "bench-log.nslog";
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the text and binary logging backends.");
+  cmd.AddValue ("n", "number of messages logged", n);
+  cmd.AddValue ("text", "file the text messages are written to", text);
+  cmd.AddValue ("binary", "file the binary records are written to", binary);
+  cmd.Parse (argc, argv);
+
+#ifndef NS3_LOG_ENABLE
+  std::cerr << "the logging macros are disabled in this build" << std::endl;
+  return 1;
+#endif
+
+  LogComponentEnable ("BenchLog", LogLevel (LOG_LEVEL_INFO | LOG_PREFIX_ALL));
+  Simulator::ScheduleWithContext (3, Seconds (1), &LogMessages, n);
+
+  std::ofstream os (text.c_str ());
+  std::streambuf *clog = std::clog.rdbuf (os.rdbuf ());
+  SystemWallClockMs time;
+  time.Start ();
+  Simulator::Run ();
+  int64_t textMs = time.End ();
+  std::clog.rdbuf (clog);
+  os.close ();
+  Simulator::Destroy ();
+
+  Simulator::ScheduleWithContext (3, Seconds (1), &LogMessages, n);
+  LogBinaryOpen (binary);
+  time.Start ();
+  Simulator::Run ();
+  LogBinaryClose ();
+  int64_t binaryMs = time.End ();
+  Simulator::Destroy ();
+
+  std::cout << "text=" << std::setw (7) << (textMs * 1e6) / n << " ns/message"
+            << " binary=" << std::setw (7) << (binaryMs * 1e6) / n << " ns/message"
+            << std::endl;
+  return 0;
+}
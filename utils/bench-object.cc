@@ -0,0 +1,216 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark Object::GetObject on an aggregate
+// of 'n' objects, shaped like a node with its protocols, for the
+// objects of the aggregate, one of their base classes and a type
+// which is not aggregated.
+// Sample usage:  ./waf --run 'bench-object --n=12 --lookups=10000000'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/object.h"
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace ns3;
+
+/// Base class of the aggregated objects, a few levels below Object
+class BenchBase : public Object
+{
+public:
+  /**
+   * Register this type.
+   * \return The TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::BenchBase")
+      .SetParent<Object> ()
+    ;
+    return tid;
+  }
+};
+
+/// Intermediate class of the aggregated objects
+class BenchProtocol : public BenchBase
+{
+public:
+  /**
+   * Register this type.
+   * \return The TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::BenchProtocol")
+      .SetParent<BenchBase> ()
+    ;
+    return tid;
+  }
+};
+
+/// Aggregated object type, one per N
+template <int N>
+class BenchObject : public BenchProtocol
+{
+public:
+  /**
+   * Register this type.
+   * \return The TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId (GetTypeName ().c_str ())
+      .SetParent<BenchProtocol> ()
+      .AddConstructor<BenchObject<N> > ()
+    ;
+    return tid;
+  }
+
+private:
+  /**
+   * Get type name function
+   * \returns the type name string
+   */
+  static std::string GetTypeName (void)
+  {
+    std::ostringstream oss;
+    oss << "ns3::BenchObject<" << N << ">";
+    return oss.str ();
+  }
+};
+
+/// A type which is never aggregated
+class BenchMissing : public Object
+{
+public:
+  /**
+   * Register this type.
+   * \return The TypeId.
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::BenchMissing")
+      .SetParent<Object> ()
+    ;
+    return tid;
+  }
+};
+
+/**
+ * Aggregate an object of type BenchObject<N> if there are less than
+ * n objects in the aggregate.
+ *
+ * \param [in] aggregate The aggregate
+ * \param [in] n The number of objects of the aggregate
+ */
+template <int N>
+static void
+AddObject (Ptr<Object> aggregate, uint32_t n)
+{
+  if (static_cast<uint32_t> (N) < n)
+    {
+      aggregate->AggregateObject (CreateObject<BenchObject<N> > ());
+    }
+}
+
+/**
+ * Time a number of lookups of a type in an aggregate.
+ *
+ * \tparam T \explicit The type looked up
+ * \param [in] aggregate The aggregate
+ * \param [in] lookups The number of lookups
+ * \param [in] name The name of the benchmark
+ */
+template <typename T>
+static void
+RunBench (Ptr<Object> aggregate, uint32_t lookups, std::string name)
+{
+  SystemWallClockMs time;
+  uint32_t found = 0;
+  time.Start ();
+  for (uint32_t i = 0; i < lookups; i++)
+    {
+      if (aggregate->GetObject<T> () != 0)
+        {
+          found++;
+        }
+    }
+  int64_t ms = time.End ();
+  std::cout << name << "=" << (ms * 1e6) / lookups << " ns/lookup, "
+            << found << " found" << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 12;
+  uint32_t lookups = 10000000;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the lookups of Object::GetObject.");
+  cmd.AddValue ("n", "number of objects of the aggregate (at most 16)", n);
+  cmd.AddValue ("lookups", "number of lookups of each benchmark", lookups);
+  cmd.Parse (argc, argv);
+
+  if (n == 0 || n > 16)
+    {
+      std::cerr << "n must be between 1 and 16" << std::endl;
+      return 1;
+    }
+
+  Ptr<Object> aggregate = CreateObject<BenchObject<0> > ();
+  AddObject<1> (aggregate, n);
+  AddObject<2> (aggregate, n);
+  AddObject<3> (aggregate, n);
+  AddObject<4> (aggregate, n);
+  AddObject<5> (aggregate, n);
+  AddObject<6> (aggregate, n);
+  AddObject<7> (aggregate, n);
+  AddObject<8> (aggregate, n);
+  AddObject<9> (aggregate, n);
+  AddObject<10> (aggregate, n);
+  AddObject<11> (aggregate, n);
+  AddObject<12> (aggregate, n);
+  AddObject<13> (aggregate, n);
+  AddObject<14> (aggregate, n);
+  AddObject<15> (aggregate, n);
+
+  RunBench<BenchObject<0> > (aggregate, lookups, "first");
+  RunBench<BenchObject<1> > (aggregate, lookups, "second");
+  if (n > 11)
+    {
+      RunBench<BenchObject<11> > (aggregate, lookups, "twelfth");
+    }
+  RunBench<BenchProtocol> (aggregate, lookups, "base");
+  RunBench<BenchMissing> (aggregate, lookups, "missing");
+
+  // alternate between a few types, as the protocols of a node do
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint32_t i = 0; i < lookups / 4; i++)
+    {
+      aggregate->GetObject<BenchObject<0> > ();
+      aggregate->GetObject<BenchObject<1> > ();
+      aggregate->GetObject<BenchProtocol> ();
+      aggregate->GetObject<BenchMissing> ();
+    }
+  int64_t ms = time.End ();
+  std::cout << "mixed=" << (ms * 1e6) / (lookups / 4 * 4) << " ns/lookup" << std::endl;
+
+  aggregate->Dispose ();
+  return 0;
+}
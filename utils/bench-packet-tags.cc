@@ -0,0 +1,223 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the packet and byte tag lists,
+// counting the heap allocations made per packet forwarded from a wifi
+// station to a CSMA host through an OpenFlow switch, for 'n' packets.
+// The tags are those of the wifi, OpenFlow and FlowMonitor models, with
+// the same sizes.  The allocations are counted with the glibc allocator.
+// Sample usage:  ./waf --run 'bench-packet-tags --n=1000000'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/packet.h"
+#include "ns3/tag.h"
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <cstdlib>
+
+using namespace ns3;
+
+#ifdef __GLIBC__
+/// The number of heap allocations.
+static uint64_t g_allocations = 0;
+
+extern "C" void *__libc_malloc (size_t size);
+
+/**
+ * Count the allocations of the process, including those of operator new.
+ * \param [in] size The size of the allocation.
+ * \returns The allocated memory.
+ */
+extern "C" void *
+malloc (size_t size)
+{
+  g_allocations++;
+  return __libc_malloc (size);
+}
+#endif /* __GLIBC__ */
+
+/// Tag of N bytes, standing for a tag of the models with that size.
+template <int N, int K = 0>
+class BenchTag : public Tag
+{
+public:
+  /**
+   * Get the bench tag name.
+   * \return the name.
+   */
+  static std::string GetName (void) {
+    std::ostringstream oss;
+    oss << "anon::BenchTag<" << N << "," << K << ">";
+    return oss.str ();
+  }
+  /**
+   * Register this type.
+   * \return The TypeId.
+   */
+  static TypeId GetTypeId (void) {
+    static TypeId tid = TypeId (GetName ().c_str ())
+      .SetParent<Tag> ()
+      .SetGroupName ("Utils")
+      .HideFromDocumentation ()
+      .AddConstructor<BenchTag<N, K> > ()
+      ;
+    return tid;
+  }
+  virtual TypeId GetInstanceTypeId (void) const {
+    return GetTypeId ();
+  }
+  virtual uint32_t GetSerializedSize (void) const {
+    return N;
+  }
+  virtual void Serialize (TagBuffer buf) const {
+    for (uint32_t i = 0; i < N; ++i)
+      {
+        buf.WriteU8 (N);
+      }
+  }
+  virtual void Deserialize (TagBuffer buf) {
+    for (uint32_t i = 0; i < N; ++i)
+      {
+        buf.ReadU8 ();
+      }
+  }
+  virtual void Print (std::ostream &os) const {
+    os << "N=" << N;
+  }
+  BenchTag ()
+    : Tag () {}
+};
+
+typedef BenchTag<20> FlowProbeTag;        //!< Ipv4FlowProbeTag
+typedef BenchTag<24, 1> DataTxVectorTag;  //!< HighLatencyDataTxVectorTag
+typedef BenchTag<24, 2> RtsTxVectorTag;   //!< HighLatencyRtsTxVectorTag
+typedef BenchTag<24, 3> CtsTxVectorTag;   //!< HighLatencyCtsToSelfTxVectorTag
+typedef BenchTag<27> PhyTag;              //!< WifiPhyTag
+typedef BenchTag<8> SnrTag;               //!< SnrTag
+typedef BenchTag<4> QueueTag;             //!< QueueTag
+typedef BenchTag<8, 1> TunnelIdTag;       //!< TunnelIdTag
+
+/**
+ * Copy the tags of a packet to another packet, like OFSwitch13Device::CopyTags.
+ * \param [in] src The packet with the tags.
+ * \param [in] dst The packet the tags are copied to.
+ */
+static void
+CopyTags (Ptr<const Packet> src, Ptr<const Packet> dst)
+{
+  PacketTagIterator pktIt = src->GetPacketTagIterator ();
+  while (pktIt.HasNext ())
+    {
+      PacketTagIterator::Item item = pktIt.Next ();
+      Callback<ObjectBase *> constructor = item.GetTypeId ().GetConstructor ();
+      Tag *tag = dynamic_cast <Tag *> (constructor ());
+      item.GetTag (*tag);
+      dst->AddPacketTag (*tag);
+      delete tag;
+    }
+  ByteTagIterator bytIt = src->GetByteTagIterator ();
+  while (bytIt.HasNext ())
+    {
+      ByteTagIterator::Item item = bytIt.Next ();
+      Callback<ObjectBase *> constructor = item.GetTypeId ().GetConstructor ();
+      Tag *tag = dynamic_cast<Tag *> (constructor ());
+      item.GetTag (*tag);
+      dst->AddByteTag (*tag);
+      delete tag;
+    }
+}
+
+/**
+ * Forward packets from a wifi station to a CSMA host, through an
+ * OpenFlow switch, with the tags of the models along the path.
+ * \param [in] n The number of packets.
+ */
+static void
+Forward (uint32_t n)
+{
+  FlowProbeTag flowProbe;
+  DataTxVectorTag dataTxVector;
+  RtsTxVectorTag rtsTxVector;
+  CtsTxVectorTag ctsTxVector;
+  PhyTag phy;
+  SnrTag snr;
+  QueueTag queue;
+  TunnelIdTag tunnelId;
+  for (uint32_t i = 0; i < n; i++)
+    {
+      // the application sends a packet, tagged by the flow monitor
+      Ptr<Packet> p = Create<Packet> (1000);
+      p->AddByteTag (flowProbe);
+
+      // the station queues a copy, tagged with the tx vectors
+      Ptr<Packet> sta = p->Copy ();
+      sta->AddPacketTag (dataTxVector);
+      sta->AddPacketTag (rtsTxVector);
+      sta->AddPacketTag (ctsTxVector);
+      sta->RemovePacketTag (dataTxVector);
+      sta->RemovePacketTag (rtsTxVector);
+      sta->RemovePacketTag (ctsTxVector);
+      sta->AddPacketTag (phy);
+
+      // the AP receives a copy, tagged with its SNR
+      Ptr<Packet> ap = sta->Copy ();
+      ap->RemovePacketTag (phy);
+      ap->AddPacketTag (snr);
+      ap->RemovePacketTag (snr);
+
+      // the switch rebuilds the packet from its datapath, and queues it
+      Ptr<Packet> sw = Create<Packet> (1000);
+      CopyTags (ap, sw);
+      sw->AddPacketTag (tunnelId);
+      sw->AddPacketTag (queue);
+      sw->RemovePacketTag (queue);
+      sw->RemovePacketTag (tunnelId);
+
+      // the host receives a copy, and the flow monitor finds its tag
+      Ptr<Packet> host = sw->Copy ();
+      host->FindFirstMatchingByteTag (flowProbe);
+    }
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 1000000;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the packet and byte tag lists.");
+  cmd.AddValue ("n", "number of packets forwarded", n);
+  cmd.Parse (argc, argv);
+
+  // register the tags before counting
+  Forward (1);
+
+#ifdef __GLIBC__
+  uint64_t allocations = g_allocations;
+#endif /* __GLIBC__ */
+  SystemWallClockMs time;
+  time.Start ();
+  Forward (n);
+  int64_t ms = time.End ();
+
+  std::cout << "time=" << (ms * 1e6) / n << " ns/packet";
+#ifdef __GLIBC__
+  std::cout << " allocations=" << double (g_allocations - allocations) / n << "/packet";
+#endif /* __GLIBC__ */
+  std::cout << std::endl;
+  return 0;
+}
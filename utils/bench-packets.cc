@@ -32,6 +32,7 @@
 #include <stdlib.h> // for exit ()
 #include <limits>
 #include <algorithm>
+#include <deque>
 
 using namespace ns3;
 
@@ -328,6 +329,53 @@ benchByteTags (uint32_t n)
     }
 }
 
+static Ptr<Packet>
+createMpdu (void)
+{
+  BenchHeader<30> mac;
+  Ptr<Packet> p = Create<Packet> (1500);
+  p->AddHeader (mac);
+  return p;
+}
+
+static void
+benchAggregation (uint32_t n)
+{
+  BenchHeader<4> subframe;
+  BenchHeader<30> mac;
+
+  // the packets waiting in the MAC queue
+  std::deque<Ptr<Packet> > queue;
+  for (uint32_t i = 0; i < 1024; i++)
+    {
+      queue.push_back (createMpdu ());
+    }
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      // 256 MPDUs, each with its subframe header, like an 802.11ax A-MPDU
+      Ptr<Packet> aggregate = Create<Packet> ();
+      for (uint32_t j = 0; j < 256; j++)
+        {
+          queue.push_back (createMpdu ());
+          Ptr<Packet> mpdu = queue.front ()->Copy ();
+          queue.pop_front ();
+          mpdu->AddHeader (subframe);
+          aggregate->AddAtEnd (mpdu);
+        }
+
+      // the receiver gets a copy, and extracts the MPDUs
+      Ptr<Packet> received = aggregate->Copy ();
+      while (received->GetSize () > 0)
+        {
+          received->RemoveHeader (subframe);
+          Ptr<Packet> mpdu = received->CreateFragment (0, 1530);
+          received->RemoveAtStart (1530);
+          mpdu->RemoveHeader (mac);
+        }
+    }
+}
+
 static uint64_t
 runBenchOneIteration (void (*bench) (uint32_t), uint32_t n)
 {
@@ -385,6 +433,7 @@ int main (int argc, char *argv[])
   runBench (&benchD, n, minIterations, "Intermixed add/remove headers and tags");
   runBench (&benchFragment, n, minIterations, "Fragmentation and concatenation");
   runBench (&benchByteTags, n, minIterations, "Benchmark byte tags");
+  runBench (&benchAggregation, n, minIterations, "Aggregation and de-aggregation of 256 packets");
 
   return 0;
 }
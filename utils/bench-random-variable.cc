@@ -0,0 +1,108 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the random variable streams,
+// drawing 'n' values of each distribution one at a time with GetValue,
+// and in batches of 'batch' values with GetValues.
+// Sample usage:  ./waf --run 'bench-random-variable --n=10000000 --batch=64'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/integer.h"
+#include "ns3/object-factory.h"
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Time the draws of a random variable stream.
+ *
+ * \param [in] name The name of the distribution
+ * \param [in] rv The random variable stream
+ * \param [in] n The number of values to draw
+ * \param [in] batch The number of values drawn by each call to GetValues
+ */
+static void
+RunBench (std::string name, Ptr<RandomVariableStream> rv, uint32_t n, uint32_t batch)
+{
+  // the streams are deterministic, so that the sums are reproducible
+  double sum = 0;
+  rv->SetStream (1);
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      sum += rv->GetValue ();
+    }
+  int64_t single = time.End ();
+
+  double batchSum = 0;
+  std::vector<double> values (batch);
+  rv->SetStream (1);
+  time.Start ();
+  for (uint32_t i = 0; i < n; i += batch)
+    {
+      uint32_t count = std::min (batch, n - i);
+      rv->GetValues (&values[0], count);
+      for (uint32_t j = 0; j < count; j++)
+        {
+          batchSum += values[j];
+        }
+    }
+  int64_t batched = time.End ();
+
+  std::cout << std::left << std::setw (12) << name << std::right
+            << " single=" << std::setw (7) << (single * 1e6) / n << " ns/value"
+            << " batch=" << std::setw (7) << (batched * 1e6) / n << " ns/value"
+            << (sum == batchSum ? "" : " (different values!)")
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 10000000;
+  uint32_t batch = 64;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the draws of the random variable streams.");
+  cmd.AddValue ("n", "number of values drawn from each distribution", n);
+  cmd.AddValue ("batch", "number of values drawn by each call to GetValues", batch);
+  cmd.Parse (argc, argv);
+
+  if (batch == 0)
+    {
+      std::cerr << "batch must be positive" << std::endl;
+      return 1;
+    }
+
+  RunBench ("uniform", CreateObject<UniformRandomVariable> (), n, batch);
+  RunBench ("exponential", CreateObject<ExponentialRandomVariable> (), n, batch);
+  RunBench ("pareto", CreateObject<ParetoRandomVariable> (), n, batch);
+  RunBench ("weibull", CreateObject<WeibullRandomVariable> (), n, batch);
+  RunBench ("normal", CreateObject<NormalRandomVariable> (), n, batch);
+  RunBench ("lognormal", CreateObject<LogNormalRandomVariable> (), n, batch);
+  RunBench ("gamma", CreateObject<GammaRandomVariable> (), n, batch);
+  RunBench ("erlang", CreateObject<ErlangRandomVariable> (), n, batch);
+  RunBench ("triangular", CreateObject<TriangularRandomVariable> (), n, batch);
+  RunBench ("zipf", CreateObjectWithAttributes<ZipfRandomVariable> ("N", IntegerValue (100)), n, batch);
+  RunBench ("zeta", CreateObject<ZetaRandomVariable> (), n, batch);
+  return 0;
+}
@@ -0,0 +1,146 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program can be used to benchmark the SACK processing of the TCP
+// transmission and reception buffers, for windows of increasing sizes,
+// like the ones of a long fat network.  In each window, one segment in
+// 'loss' is lost: the sender processes a SACK block per received segment
+// and retransmits the lost segments, and the receiver buffers the
+// segments out of order until the retransmissions fill the holes.
+// Sample usage:  ./waf --run 'bench-tcp-buffers --loss=100'
+
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/packet.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tcp-option-sack.h"
+#include "ns3/tcp-tx-buffer.h"
+#include "ns3/tcp-rx-buffer.h"
+#include <iostream>
+#include <iomanip>
+
+using namespace ns3;
+
+/// The size of the segments.
+static const uint32_t SEGMENT_SIZE = 1448;
+
+/**
+ * Send a window, process the SACK blocks and retransmit the lost segments.
+ * \param segments The number of segments of the window.
+ * \param loss One segment in loss is lost.
+ * \return The time per segment, in nanoseconds.
+ */
+static double
+Send (uint32_t segments, uint32_t loss)
+{
+  TcpTxBuffer txBuf;
+  SequenceNumber32 head (1);
+  SequenceNumber32 seq;
+  txBuf.SetHeadSequence (head);
+  txBuf.SetSegmentSize (SEGMENT_SIZE);
+  txBuf.SetDupAckThresh (3);
+  txBuf.SetMaxBufferSize (SEGMENT_SIZE * segments);
+  txBuf.Add (Create<Packet> (SEGMENT_SIZE * segments));
+  Ptr<TcpOptionSack> sack = CreateObject<TcpOptionSack> ();
+
+  SystemWallClockMs time;
+  time.Start ();
+  while (txBuf.NextSeg (&seq, false))
+    {
+      txBuf.CopyFromSequence (SEGMENT_SIZE, seq);
+    }
+  for (uint32_t i = 0; i < segments; i++)
+    {
+      if (i % loss != 0)
+        {
+          SequenceNumber32 begin = head + SEGMENT_SIZE * i;
+          sack->AddSackBlock (TcpOptionSack::SackBlock (begin, begin + SEGMENT_SIZE));
+          txBuf.Update (sack->GetSackList ());
+          sack->ClearSackList ();
+        }
+    }
+  uint32_t retransmitted = 0;
+  while (txBuf.NextSeg (&seq, true))
+    {
+      txBuf.CopyFromSequence (SEGMENT_SIZE, seq);
+      retransmitted++;
+    }
+  txBuf.DiscardUpTo (head + SEGMENT_SIZE * segments);
+  int64_t ms = time.End ();
+  if (retransmitted != (segments + loss - 1) / loss)
+    {
+      std::cerr << "Unexpected retransmissions" << std::endl;
+    }
+  return (ms * 1e6) / segments;
+}
+
+/**
+ * Receive a window out of order, then the retransmitted segments.
+ * \param segments The number of segments of the window.
+ * \param loss One segment in loss is lost.
+ * \return The time per segment, in nanoseconds.
+ */
+static double
+Receive (uint32_t segments, uint32_t loss)
+{
+  TcpRxBuffer rxBuf;
+  SequenceNumber32 head (1);
+  rxBuf.SetNextRxSequence (head);
+  rxBuf.SetMaxBufferSize (SEGMENT_SIZE * segments);
+  Ptr<Packet> segment = Create<Packet> (SEGMENT_SIZE);
+  TcpHeader header;
+
+  SystemWallClockMs time;
+  time.Start ();
+  for (uint32_t pass = 0; pass < 2; pass++)
+    {
+      for (uint32_t i = 0; i < segments; i++)
+        {
+          if ((i % loss == 0) == (pass == 1))
+            {
+              header.SetSequenceNumber (head + SEGMENT_SIZE * i);
+              rxBuf.Add (segment->Copy (), header);
+            }
+        }
+    }
+  int64_t ms = time.End ();
+  if (rxBuf.NextRxSequence () != head + SEGMENT_SIZE * segments)
+    {
+      std::cerr << "Missing segments" << std::endl;
+    }
+  return (ms * 1e6) / segments;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t loss = 100;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the SACK processing of the TCP buffers.");
+  cmd.AddValue ("loss", "one segment in loss is lost", loss);
+  cmd.Parse (argc, argv);
+
+  std::cout << std::setw (10) << "segments"
+            << std::setw (20) << "tx ns/segment"
+            << std::setw (20) << "rx ns/segment" << std::endl;
+  for (uint32_t segments = 1000; segments <= 64000; segments *= 4)
+    {
+      std::cout << std::setw (10) << segments
+                << std::setw (20) << Send (segments, loss)
+                << std::setw (20) << Receive (segments, loss) << std::endl;
+    }
+  return 0;
+}
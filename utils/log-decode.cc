@@ -0,0 +1,66 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// This program renders a binary log, recorded with NS_LOG_BINARY or
+// LogBinaryOpen, as the text the messages would have been logged as.
+// Sample usage:  ./waf --run 'log-decode --file=run.nslog --component=WifiElements'
+
+#include "ns3/command-line.h"
+#include "ns3/log.h"
+#include "ns3/log-binary.h"
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using namespace ns3;
+
+int main (int argc, char *argv[])
+{
+  std::string file;
+  std::string component;
+  bool time = true;
+  bool node = true;
+  bool func = true;
+  bool level = true;
+
+  CommandLine cmd;
+  cmd.Usage ("Render a binary log as text.");
+  cmd.AddValue ("file", "the binary log", file);
+  cmd.AddValue ("component", "only render the messages of this log component", component);
+  cmd.AddValue ("time", "prefix the messages with the simulation time", time);
+  cmd.AddValue ("node", "prefix the messages with the context", node);
+  cmd.AddValue ("func", "prefix the messages with the component and function", func);
+  cmd.AddValue ("level", "prefix the messages with the log level", level);
+  cmd.Parse (argc, argv);
+
+  std::ifstream is (file.c_str (), std::ios::in | std::ios::binary);
+  if (!is.is_open ())
+    {
+      std::cerr << "could not open " << file << std::endl;
+      return 1;
+    }
+  uint32_t prefixes = 0;
+  prefixes |= time ? LOG_PREFIX_TIME : 0;
+  prefixes |= node ? LOG_PREFIX_NODE : 0;
+  prefixes |= func ? LOG_PREFIX_FUNC : 0;
+  prefixes |= level ? LOG_PREFIX_LEVEL : 0;
+  if (!LogBinaryDecode (is, std::cout, prefixes, component))
+    {
+      std::cerr << file << " is not a binary log, or is truncated" << std::endl;
+      return 1;
+    }
+  return 0;
+}